@@ -1490,7 +1490,11 @@ void ClientGameCommandManager::SetBaseAndAmplitude(Event *ev, Vector& base, Vect
 //=============
 ClientGameCommandManager::ClientGameCommandManager()
 {
-    m_seed = 0;
+    m_seed                   = 0;
+    m_tempmodels             = NULL;
+    m_iAllocatedtempmodels   = 0;
+    m_iActivetempmodels      = 0;
+    m_iTempmodelphysicsframe = 0;
 
     InitializeTempModels();
     InitializeEmitters();
@@ -5933,7 +5937,7 @@ int ClientGameCommandManager::IdForTempModel(const ctempmodel_t *model)
     }
 
     index = model - m_tempmodels;
-    if (index >= MAX_TEMPMODELS) {
+    if (index < 0 || index >= m_iAllocatedtempmodels) {
         return -2;
     }
 
@@ -6086,14 +6090,34 @@ void ClientGameCommandManager::ArchiveToMemory(MemArchiver& archiver)
         }
     }
 
+    // Added in OPM
+    //  The pool size comes first so pointers can be resolved when reading
+    if (archiver.IsReading()) {
+        archiver.ArchiveInteger(&num);
+        if (m_iAllocatedtempmodels != num) {
+            AllocateTempModelPool(num);
+        }
+    } else {
+        archiver.ArchiveInteger(&m_iAllocatedtempmodels);
+    }
+
     ArchiveTempModelPointerToMemory(archiver, &m_active_tempmodels.prev);
     ArchiveTempModelPointerToMemory(archiver, &m_active_tempmodels.next);
     ArchiveTempModelPointerToMemory(archiver, &m_free_tempmodels);
 
-    for (i = 0; i < MAX_TEMPMODELS; i++) {
+    for (i = 0; i < m_iAllocatedtempmodels; i++) {
         m_tempmodels[i].ArchiveToMemory(archiver);
     }
 
+    if (archiver.IsReading()) {
+        ctempmodel_t *p;
+
+        m_iActivetempmodels = 0;
+        for (p = m_active_tempmodels.next; p != &m_active_tempmodels; p = p->next) {
+            m_iActivetempmodels++;
+        }
+    }
+
     if (archiver.IsReading()) {
         archiver.ArchiveInteger(&num);
         if (m_iAllocatedvsssources != num) {
@@ -253,6 +253,12 @@ public:
     qboolean      lastEntValid;
     spawnthing_t *m_spawnthing;
 
+    // Added in OPM
+    //  frame of the last batched physics, and whether it was the first one.
+    //  Only valid during the frame, not archived
+    int  physicsFrame;
+    bool physicsInitial;
+
     void (*touchfcn)(ctempmodel_t *ct, trace_t *trace);
 
 public:
@@ -271,6 +277,8 @@ inline ctempmodel_t::ctempmodel_t()
     aliveTime             = 0;
     addedOnce             = qfalse;
     lastEntValid          = qfalse;
+    physicsFrame          = -1;
+    physicsInitial        = false;
 }
 
 enum class vsstypes_t : unsigned char {
@@ -735,16 +743,58 @@ public:
     byte     modulate[4];
 };
 
-#define MAX_TEMPMODELS 2048
+// Added in OPM
+//  Upper limit of cg_max_tempmodels, the pool is sized from the cvar
+#define MAX_TEMPMODELS 16384
 #define MAX_BEAMS      4096
 
+// Added in OPM
+//  Physics of the temp models for one frame, as structure of arrays
+//  so the integration and the collision run in batches
+class tempModelPhysics_t
+{
+public:
+    int            count;
+    int            allocated;
+    float          scale;
+    ctempmodel_t **models;
+    float         *ftime;
+    float         *moveTime;  // ftime if the velocity moves the origin, else 0
+    float         *accelTime; // ftime if the velocity is accelerated, else 0
+    float         *friction;  // factor of the velocity, 1 without friction
+    float         *origin[3];
+    float         *velocity[3];
+    float         *accel[3];
+    Vector        *parentOrigin;
+    qboolean      *alive;
+    trace_t       *traces;
+
+    // collision traces, sorted by mask
+    int      numTraces;
+    int     *traceModels;
+    vec3_t  *traceStarts;
+    vec3_t  *traceEnds;
+    trace_t *traceResults;
+
+public:
+    tempModelPhysics_t();
+    ~tempModelPhysics_t();
+
+    void Allocate(int size);
+    void Free(void);
+};
+
 class ClientGameCommandManager : public Listener
 {
 private:
     spawnthing_t              m_localemitter; // local emitter used by animation commands
     ctempmodel_t              m_active_tempmodels;
     ctempmodel_t             *m_free_tempmodels;
-    ctempmodel_t              m_tempmodels[MAX_TEMPMODELS];
+    ctempmodel_t             *m_tempmodels;
+    int                       m_iAllocatedtempmodels;
+    int                       m_iActivetempmodels;
+    tempModelPhysics_t        m_tempmodelphysics;
+    int                       m_iTempmodelphysicsframe;
     cvssource_t               m_active_vsssources;
     cvssource_t              *m_free_vsssources;
     cvssource_t              *m_vsssources;
@@ -888,6 +938,11 @@ private:
     void          SetClampVelAxis(Event *ev);
     ctempmodel_t *AllocateTempModel(void);
     qboolean      TempModelPhysics(ctempmodel_t *p, float ftime, float scale);
+    void          TempModelPhysicsStart(ctempmodel_t *p);
+    qboolean      TempModelPhysicsLink(ctempmodel_t *p, float ftime, float scale, Vector& parentOrigin);
+    qboolean      TempModelPhysicsFinish(ctempmodel_t *p, float ftime, trace_t *trace, const Vector& parentOrigin);
+    void          TraceTempModels(void);
+    void          RunTempModelPhysics(int frameTime, float effectTime, float scale);
     qboolean      TempModelRealtimeEffects(ctempmodel_t *p, float ftime, float scale);
     qboolean      LerpTempModel(refEntity_t *newEnt, ctempmodel_t *p, float frac);
     void          SpawnEffect(int count, int timealive);
@@ -950,6 +1005,7 @@ public:
     void          RestartAllEmitters(void);
 
     void InitializeTempModels(void);
+    void AllocateTempModelPool(int numtempmodels);
     void InitializeTempModelCvars(void);
     void InitializeEmitters(void);
     void RemoveClientEntity(int number, dtiki_t *tiki, centity_t *cent, ctempmodel_t *p = NULL);
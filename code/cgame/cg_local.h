@@ -568,6 +568,7 @@ extern "C" {
     extern cvar_t *cg_detail;
     extern cvar_t *cg_effectdetail;
     extern cvar_t *cg_effect_physicsrate;
+    extern cvar_t *cg_tempmodelthreads;
 
     void CG_AddTempModels(void);
     void CG_ResetTempModels(void);
@@ -671,6 +672,7 @@ extern "C" {
         qboolean     cliptoentities,
         const char  *description
     );
+    void CG_ShowTrace(trace_t *trace, int passent, const char *reason);
     void CG_PredictPlayerState(void);
 
     //
@@ -442,6 +442,24 @@ functions exported to the main executable
         clientAnim_t *anim;
         stopWatch_t  *stopWatch;
 
+        // Added in OPM
+        //  same as Malloc, but the allocation is counted for caller in the zone statistics
+        void *(*MallocCaller)(int size, const void *caller);
+        //  same as CM_BoxTrace for each start and end, the traces are spread on up to numThreads threads
+        void (*CM_BoxTraceBatch)(
+            trace_t      *results,
+            const vec3_t *starts,
+            const vec3_t *ends,
+            int           count,
+            const vec3_t  mins,
+            const vec3_t  maxs,
+            int           brushmask,
+            int           cylinder,
+            int           numThreads
+        );
+        //  calls func for each index from 0 to count - 1 on up to numThreads threads
+        void (*RunJobs)(void (*func)(void *data, int index), void *data, int count, int numThreads);
+
     } clientGameImport_t;
 
     /*
@@ -33,6 +33,7 @@ cvar_t *cg_reserve_tempmodels;
 cvar_t *cg_detail;
 cvar_t *cg_effectdetail;
 cvar_t *cg_effect_physicsrate;
+cvar_t *cg_tempmodelthreads;
 
 extern refEntity_t *current_entity;
 extern int          current_entity_number;
@@ -65,6 +66,13 @@ ctempmodel_t *ClientGameCommandManager::AllocateTempModel(void)
     m_active_tempmodels.next->prev = p;
     m_active_tempmodels.next       = p;
 
+    m_iActivetempmodels++;
+
+    // Added in OPM
+    //  not part of the physics batch of this frame
+    p->physicsFrame   = -1;
+    p->physicsInitial = false;
+
     return p;
 }
 
@@ -92,6 +100,8 @@ void ClientGameCommandManager::FreeTempModel(ctempmodel_t *p)
     p->next           = m_free_tempmodels;
     m_free_tempmodels = p;
 
+    m_iActivetempmodels--;
+
     if (p->m_spawnthing) {
         p->m_spawnthing->numtempmodels--;
         // delete unused spawnthings
@@ -131,18 +141,18 @@ void ClientGameCommandManager::FreeAllTempModels(void)
 //===============
 void ClientGameCommandManager::FreeSomeTempModels(void)
 {
-    ctempmodel_t *model;
-    int           count = 0;
-    unsigned int  i;
-    unsigned int  numToFree;
+    int          count;
+    unsigned int i;
+    unsigned int numToFree;
 
     if (!m_free_tempmodels) {
         return;
     }
 
-    for (model = m_active_tempmodels.prev; model != &m_active_tempmodels; model = model->prev) {
-        count++;
-    }
+    // Added in OPM
+    //  The active count is kept up to date instead of walking the list,
+    //  this is called for every spawn
+    count = m_iActivetempmodels;
 
     if (cg_reserve_tempmodels->integer <= (cg_max_tempmodels->integer - count)) {
         // nothing to free
@@ -207,16 +217,53 @@ void CG_ResetTempModels(void)
     lastTempModelFrameTime = cg.time;
 }
 
+//=============
+// AllocateTempModelPool
+//=============
+void ClientGameCommandManager::AllocateTempModelPool(int numtempmodels)
+{
+    if (m_tempmodels) {
+        delete[] m_tempmodels;
+        m_tempmodels = NULL;
+    }
+
+    m_iAllocatedtempmodels = numtempmodels;
+    if (m_iAllocatedtempmodels) {
+        m_tempmodels = new ctempmodel_t[m_iAllocatedtempmodels];
+    }
+
+    m_tempmodelphysics.Allocate(m_iAllocatedtempmodels);
+}
+
 //=============
 // InitializeTempModels
 //=============
 void ClientGameCommandManager::InitializeTempModels(void)
 {
     int i;
-    int numtempmodels = MAX_TEMPMODELS;
+    int numtempmodels;
+
+    // Added in OPM
+    //  The pool is sized from cg_max_tempmodels rather than MAX_TEMPMODELS.
+    //  The cvar isn't registered yet when the manager is constructed
+    if (cg_max_tempmodels) {
+        numtempmodels = cg_max_tempmodels->integer;
+    } else {
+        numtempmodels = 0;
+    }
+
+    if (numtempmodels != m_iAllocatedtempmodels) {
+        AllocateTempModelPool(numtempmodels);
+    }
 
     m_active_tempmodels.next = &m_active_tempmodels;
     m_active_tempmodels.prev = &m_active_tempmodels;
+    m_iActivetempmodels      = 0;
+
+    if (!numtempmodels) {
+        m_free_tempmodels = NULL;
+        return;
+    }
 
     m_free_tempmodels = &m_tempmodels[0];
 
@@ -235,10 +282,15 @@ void ClientGameCommandManager::InitializeTempModelCvars(void)
     cgi.Cvar_CheckRange(cg_effectdetail, 0.2, 1.0, qfalse);
 
     cg_effect_physicsrate = cgi.Cvar_Get("cg_effect_physicsrate", "10", CVAR_ARCHIVE);
-    cg_max_tempmodels     = cgi.Cvar_Get("cg_max_tempmodels", "1100", CVAR_ARCHIVE);
+    // Changed in OPM
+    //  Latched, as it sets the size of the pool
+    cg_max_tempmodels     = cgi.Cvar_Get("cg_max_tempmodels", "1100", CVAR_ARCHIVE | CVAR_LATCH);
     cgi.Cvar_CheckRange(cg_max_tempmodels, 200, MAX_TEMPMODELS, qtrue);
 
     cg_reserve_tempmodels = cgi.Cvar_Get("cg_reserve_tempmodels", "200", CVAR_ARCHIVE);
+    // Added in OPM
+    //  threads for the temp model physics, 0 or 1 to run them on the main thread
+    cg_tempmodelthreads = cgi.Cvar_Get("cg_tempmodelthreads", "0", CVAR_ARCHIVE);
 
     if (cg_max_tempmodels->integer > MAX_TEMPMODELS) {
         // 2.40 sets the integer value directly rather than calling Cvar_Set()
@@ -538,32 +590,32 @@ void ClientGameCommandManager::OtherTempModelEffects(ctempmodel_t *p, Vector ori
     }
 }
 
-qboolean ClientGameCommandManager::TempModelPhysics(ctempmodel_t *p, float ftime, float scale)
+//===============
+// TempModelPhysicsStart
+//
+// Added in OPM
+// The physics of a temp model are split in steps so they can also run in
+// batches with the other temp models (see RunTempModelPhysics):
+// start, move, link, collision trace, acceleration and finish
+//===============
+void ClientGameCommandManager::TempModelPhysicsStart(ctempmodel_t *p)
 {
-    int     dtime;
-    Vector  parentOrigin(0, 0, 0);
-    Vector  parentAngles(0, 0, 0);
-    Vector  tempangles;
-    trace_t trace;
-    float   dot;
-    int     i;
-
     VectorCopy(p->ent.origin, p->lastEnt.origin);
     AxisCopy(p->ent.axis, p->lastEnt.axis);
 
-    dtime = (cg.time - p->cgd.createTime);
-
     // Save oldorigin
     p->cgd.oldorigin = p->cgd.origin;
+}
 
-    // Update based on swarm
-    if (p->cgd.flags & T_SWARM) {
-        p->cgd.origin += p->cgd.velocity * ftime * scale;
-    }
-    // Update the orign and the angles based on velocities first
-    else if (p->cgd.flags2 & (T2_MOVE | T2_ACCEL)) {
-        p->cgd.origin += p->cgd.velocity * ftime * scale;
-    }
+//===============
+// TempModelPhysicsLink
+//===============
+qboolean ClientGameCommandManager::TempModelPhysicsLink(ctempmodel_t *p, float ftime, float scale, Vector& parentOrigin)
+{
+    Vector parentAngles(0, 0, 0);
+    Vector tempangles;
+
+    parentOrigin = vec_zero;
 
     // If linked to the parent or hardlinked, get the parent's origin
     if ((p->cgd.flags & (T_PARENTLINK | T_HARDLINK)) && (p->cgd.parent != ENTITYNUM_NONE)) {
@@ -621,42 +673,20 @@ qboolean ClientGameCommandManager::TempModelPhysics(ctempmodel_t *p, float ftime
         AnglesToAxis(tempangles, p->ent.axis);
     }
 
-    // Only do real collision if necessary
-    if (p->cgd.flags & T_COLLISION) {
-        // trace a line from previous position to new position
-        CG_Trace(
-            &trace,
-            p->cgd.oldorigin,
-            vec3_origin,
-            vec3_origin,
-            p->cgd.origin,
-            -1,
-            p->cgd.collisionmask,
-            qfalse,
-            qfalse,
-            "Collision"
-        );
-    } else {
-        // Fake it out so it never collides
-        trace.fraction = 1.0;
-    }
-
-    // Check for collision
-    if (trace.fraction == 1.0) {
-        // Acceleration of velocity
-        if (p->cgd.flags2 & T2_ACCEL) {
-            p->cgd.velocity = p->cgd.velocity + ftime * p->cgd.accel;
-        }
+    return true;
+}
 
-        if (p->cgd.flags2 & T2_FRICTION) {
-            float fFriction = 1.0f - ftime * p->cgd.friction;
-            if (fFriction > 0.0f) {
-                p->cgd.velocity *= fFriction;
-            } else {
-                p->cgd.velocity = vec_zero;
-            }
-        }
+//===============
+// TempModelPhysicsFinish
+//===============
+qboolean
+ClientGameCommandManager::TempModelPhysicsFinish(ctempmodel_t *p, float ftime, trace_t *trace, const Vector& parentOrigin)
+{
+    float dot;
+    int   i;
 
+    // Check for collision
+    if (trace->fraction == 1.0) {
         if (p->cgd.flags2 & T2_CLAMP_VEL) {
             p->cgd.velocity.x = Q_clamp_float(p->cgd.velocity.x, p->cgd.minVel.x, p->cgd.maxVel.x);
             p->cgd.velocity.y = Q_clamp_float(p->cgd.velocity.y, p->cgd.minVel.y, p->cgd.maxVel.y);
@@ -723,7 +753,7 @@ qboolean ClientGameCommandManager::TempModelPhysics(ctempmodel_t *p, float ftime
         Vector normal;
 
         // Set the origin
-        p->cgd.origin = trace.endpos;
+        p->cgd.origin = trace->endpos;
 
         if ((p->cgd.flags2 & T2_BOUNCE_DECAL) && (p->cgd.bouncecount < p->cgd.maxbouncecount)) {
             // Put down a bounce decal
@@ -731,8 +761,8 @@ qboolean ClientGameCommandManager::TempModelPhysics(ctempmodel_t *p, float ftime
 
             CG_ImpactMarkSimple(
                 shader,
-                trace.endpos,
-                trace.plane.normal,
+                trace->endpos,
+                trace->plane.normal,
                 p->cgd.decal_orientation,
                 p->cgd.decal_radius,
                 p->cgd.color[0],
@@ -753,11 +783,11 @@ qboolean ClientGameCommandManager::TempModelPhysics(ctempmodel_t *p, float ftime
         }
 
         // calculate the bounce
-        normal = trace.plane.normal;
+        normal = trace->plane.normal;
 
         // reflect the velocity on the trace plane
         if (p->cgd.flags2 & T2_ACCEL) {
-            p->cgd.velocity = p->cgd.velocity + ftime * trace.fraction * p->cgd.accel;
+            p->cgd.velocity = p->cgd.velocity + ftime * trace->fraction * p->cgd.accel;
         }
 
         dot             = p->cgd.velocity * normal;
@@ -766,7 +796,7 @@ qboolean ClientGameCommandManager::TempModelPhysics(ctempmodel_t *p, float ftime
         p->cgd.avelocity *= -p->cgd.bouncefactor;
 
         // check for stop
-        if (trace.plane.normal[2] > 0 && p->cgd.velocity[2] < 45) {
+        if (trace->plane.normal[2] > 0 && p->cgd.velocity[2] < 45) {
             p->cgd.velocity  = Vector(0, 0, 0);
             p->cgd.avelocity = Vector(0, 0, 0);
             p->cgd.flags &= ~T_WAVE;
@@ -804,6 +834,66 @@ qboolean ClientGameCommandManager::TempModelPhysics(ctempmodel_t *p, float ftime
     return true;
 }
 
+qboolean ClientGameCommandManager::TempModelPhysics(ctempmodel_t *p, float ftime, float scale)
+{
+    Vector  parentOrigin;
+    trace_t trace;
+
+    TempModelPhysicsStart(p);
+
+    // Update based on swarm
+    if (p->cgd.flags & T_SWARM) {
+        p->cgd.origin += p->cgd.velocity * ftime * scale;
+    }
+    // Update the orign and the angles based on velocities first
+    else if (p->cgd.flags2 & (T2_MOVE | T2_ACCEL)) {
+        p->cgd.origin += p->cgd.velocity * ftime * scale;
+    }
+
+    if (!TempModelPhysicsLink(p, ftime, scale, parentOrigin)) {
+        return false;
+    }
+
+    // Only do real collision if necessary
+    if (p->cgd.flags & T_COLLISION) {
+        // trace a line from previous position to new position
+        CG_Trace(
+            &trace,
+            p->cgd.oldorigin,
+            vec3_origin,
+            vec3_origin,
+            p->cgd.origin,
+            -1,
+            p->cgd.collisionmask,
+            qfalse,
+            qfalse,
+            "Collision"
+        );
+    } else {
+        // Fake it out so it never collides
+        trace.fraction = 1.0;
+    }
+
+    if (trace.fraction == 1.0) {
+        // Acceleration of velocity
+        if (p->cgd.flags2 & T2_ACCEL) {
+            p->cgd.velocity = p->cgd.velocity + ftime * p->cgd.accel;
+        }
+
+        if (p->cgd.flags2 & T2_FRICTION) {
+            float fFriction = 1.0f - ftime * p->cgd.friction;
+            if (fFriction > 0.0f) {
+                p->cgd.velocity *= fFriction;
+            } else {
+                p->cgd.velocity = vec_zero;
+            }
+        }
+
+    }
+
+    return TempModelPhysicsFinish(p, ftime, &trace, parentOrigin);
+}
+
 qboolean ClientGameCommandManager::LerpTempModel(refEntity_t *newEnt, ctempmodel_t *p, float frac)
 {
     int i, j;
@@ -863,6 +953,433 @@ qboolean ClientGameCommandManager::LerpTempModel(refEntity_t *newEnt, ctempmodel
     return true;
 }
 
+//=============
+// tempModelPhysics_t
+//=============
+tempModelPhysics_t::tempModelPhysics_t()
+{
+    int i;
+
+    count        = 0;
+    allocated    = 0;
+    scale        = 1.0f;
+    models       = NULL;
+    ftime        = NULL;
+    moveTime     = NULL;
+    accelTime    = NULL;
+    friction     = NULL;
+    parentOrigin = NULL;
+    alive        = NULL;
+    traces       = NULL;
+    numTraces    = 0;
+    traceModels  = NULL;
+    traceStarts  = NULL;
+    traceEnds    = NULL;
+    traceResults = NULL;
+
+    for (i = 0; i < 3; i++) {
+        origin[i]   = NULL;
+        velocity[i] = NULL;
+        accel[i]    = NULL;
+    }
+}
+
+tempModelPhysics_t::~tempModelPhysics_t()
+{
+    Free();
+}
+
+void tempModelPhysics_t::Allocate(int size)
+{
+    int i;
+
+    Free();
+
+    if (!size) {
+        return;
+    }
+
+    allocated    = size;
+    models       = new ctempmodel_t *[size];
+    ftime        = new float[size];
+    moveTime     = new float[size];
+    accelTime    = new float[size];
+    friction     = new float[size];
+    parentOrigin = new Vector[size];
+    alive        = new qboolean[size];
+    traces       = new trace_t[size];
+    traceModels  = new int[size];
+    traceStarts  = new vec3_t[size];
+    traceEnds    = new vec3_t[size];
+    traceResults = new trace_t[size];
+
+    for (i = 0; i < 3; i++) {
+        origin[i]   = new float[size];
+        velocity[i] = new float[size];
+        accel[i]    = new float[size];
+    }
+}
+
+void tempModelPhysics_t::Free(void)
+{
+    int i;
+
+    if (!allocated) {
+        return;
+    }
+
+    delete[] models;
+    delete[] ftime;
+    delete[] moveTime;
+    delete[] accelTime;
+    delete[] friction;
+    delete[] parentOrigin;
+    delete[] alive;
+    delete[] traces;
+    delete[] traceModels;
+    delete[] traceStarts;
+    delete[] traceEnds;
+    delete[] traceResults;
+
+    for (i = 0; i < 3; i++) {
+        delete[] origin[i];
+        delete[] velocity[i];
+        delete[] accel[i];
+        origin[i]   = NULL;
+        velocity[i] = NULL;
+        accel[i]    = NULL;
+    }
+
+    models       = NULL;
+    ftime        = NULL;
+    moveTime     = NULL;
+    accelTime    = NULL;
+    friction     = NULL;
+    parentOrigin = NULL;
+    alive        = NULL;
+    traces       = NULL;
+    traceModels  = NULL;
+    traceStarts  = NULL;
+    traceEnds    = NULL;
+    traceResults = NULL;
+    allocated    = 0;
+    count        = 0;
+    numTraces    = 0;
+}
+
+#define TEMPMODEL_JOB_SIZE 256
+
+//===============
+// CG_TempModelMoveJob
+//
+// Moves the origins of a chunk of the batch
+//===============
+static void CG_TempModelMoveJob(void *data, int index)
+{
+    tempModelPhysics_t *work = (tempModelPhysics_t *)data;
+    int                 i, j, start, end;
+
+    start = index * TEMPMODEL_JOB_SIZE;
+    end   = Q_min(start + TEMPMODEL_JOB_SIZE, work->count);
+
+    for (j = 0; j < 3; j++) {
+        float       *origin   = work->origin[j];
+        const float *velocity = work->velocity[j];
+
+        for (i = start; i < end; i++) {
+            origin[i] += velocity[i] * work->moveTime[i] * work->scale;
+        }
+    }
+}
+
+//===============
+// CG_TempModelAccelJob
+//
+// Accelerates the velocities of a chunk of the batch and applies the friction
+//===============
+static void CG_TempModelAccelJob(void *data, int index)
+{
+    tempModelPhysics_t *work = (tempModelPhysics_t *)data;
+    int                 i, j, start, end;
+
+    start = index * TEMPMODEL_JOB_SIZE;
+    end   = Q_min(start + TEMPMODEL_JOB_SIZE, work->count);
+
+    for (j = 0; j < 3; j++) {
+        float       *velocity = work->velocity[j];
+        const float *accel    = work->accel[j];
+
+        for (i = start; i < end; i++) {
+            velocity[i] = (velocity[i] + work->accelTime[i] * accel[i]) * work->friction[i];
+        }
+    }
+}
+
+//===============
+// CG_RunTempModelJobs
+//===============
+static void CG_RunTempModelJobs(void (*func)(void *data, int index), tempModelPhysics_t *work)
+{
+    cgi.RunJobs(func, work, (work->count + TEMPMODEL_JOB_SIZE - 1) / TEMPMODEL_JOB_SIZE, cg_tempmodelthreads->integer);
+}
+
+static const tempModelPhysics_t *sortPhysics;
+
+//===============
+// CG_CompareTempModelTraces
+//
+// Sorts the traces by mask, and keeps the order of the temp models for the same mask
+//===============
+static int CG_CompareTempModelTraces(const void *a, const void *b)
+{
+    int modelA = *(const int *)a;
+    int modelB = *(const int *)b;
+    int maskA  = sortPhysics->models[modelA]->cgd.collisionmask;
+    int maskB  = sortPhysics->models[modelB]->cgd.collisionmask;
+
+    if (maskA != maskB) {
+        return maskA < maskB ? -1 : 1;
+    }
+
+    return modelA - modelB;
+}
+
+//===============
+// TraceTempModels
+//
+// Added in OPM
+// Same as a CG_Trace of each queued temp model through the world, but the traces
+// with the same mask are sent together and spread on the job threads
+//===============
+void ClientGameCommandManager::TraceTempModels(void)
+{
+    tempModelPhysics_t *work = &m_tempmodelphysics;
+    int                 i, first, mask;
+
+    if (!work->numTraces) {
+        return;
+    }
+
+    sortPhysics = work;
+    qsort(work->traceModels, work->numTraces, sizeof(work->traceModels[0]), CG_CompareTempModelTraces);
+
+    for (i = 0; i < work->numTraces; i++) {
+        ctempmodel_t *p = work->models[work->traceModels[i]];
+
+        VectorCopy(p->cgd.oldorigin, work->traceStarts[i]);
+        VectorCopy(p->cgd.origin, work->traceEnds[i]);
+    }
+
+    for (first = 0; first < work->numTraces; first = i) {
+        mask = work->models[work->traceModels[first]]->cgd.collisionmask;
+        for (i = first + 1; i < work->numTraces; i++) {
+            if (work->models[work->traceModels[i]]->cgd.collisionmask != mask) {
+                break;
+            }
+        }
+
+        cgi.CM_BoxTraceBatch(
+            &work->traceResults[first],
+            &work->traceStarts[first],
+            &work->traceEnds[first],
+            i - first,
+            vec3_origin,
+            vec3_origin,
+            mask,
+            qfalse,
+            cg_tempmodelthreads->integer
+        );
+    }
+
+    for (i = 0; i < work->numTraces; i++) {
+        trace_t *trace = &work->traces[work->traceModels[i]];
+
+        *trace           = work->traceResults[i];
+        trace->entityNum = trace->fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+
+        // If starting in a solid make sure the world is set as the entitynum
+        if (trace->startsolid) {
+            trace->entityNum = ENTITYNUM_WORLD;
+        }
+
+        if (cg_traceinfo->integer) {
+            CG_ShowTrace(trace, -1, "Collision");
+        }
+    }
+}
+
+//===============
+// RunTempModelPhysics
+//
+// Added in OPM
+// Runs the physics of the temp models that need it this frame in one batch.
+// The origins and the velocities are integrated as structure of arrays, and
+// the collision traces are sent to the engine together, both spread on
+// cg_tempmodelthreads threads. The temp models spawned while adding the
+// others to the scene run their physics in AddTempModels
+//===============
+void ClientGameCommandManager::RunTempModelPhysics(int frameTime, float effectTime, float scale)
+{
+    tempModelPhysics_t *work = &m_tempmodelphysics;
+    ctempmodel_t       *p, *next;
+    int                 mstime;
+    int                 physics_rate;
+    float               ftime;
+    int                 i;
+
+    m_iTempmodelphysicsframe++;
+    work->count     = 0;
+    work->numTraces = 0;
+    work->scale     = scale;
+
+    p = m_active_tempmodels.prev;
+    for (; p != &m_active_tempmodels; p = next) {
+        // grab next now, so if the local entity is freed we still have it
+        next = p->prev;
+
+        if ((p->cgd.flags & T_DETAIL) && !cg_detail->integer) {
+            FreeTempModel(p);
+            continue;
+        }
+
+        p->ent.tiki           = p->cgd.tiki;
+        current_entity        = &p->ent;
+        current_tiki          = p->cgd.tiki;
+        current_entity_number = p->number;
+
+        TempModelRealtimeEffects(p, effectTime, scale);
+
+        p->physicsFrame   = m_iTempmodelphysicsframe;
+        p->physicsInitial = false;
+
+        physics_rate = 1000 / p->cgd.physicsRate; // Physics rate in milliseconds
+        ftime        = -1;
+
+        if (p->lastPhysicsTime) {
+            mstime = cg.time - p->lastPhysicsTime;
+
+            // Avoid large jumps in time
+            if (mstime > physics_rate * 2) {
+                mstime = physics_rate;
+            }
+
+            if ((mstime >= physics_rate) || (p->cgd.flags2 & T2_PHYSICS_EVERYFRAME)) {
+                ftime = mstime / 1000.0f;
+            }
+        }
+
+        if (ftime < 0 && !p->lastEntValid && (p->aliveTime + frameTime < p->cgd.life || !p->addedOnce)) {
+            // Run physics if the lastEnt is not valid to get a valid lerp
+            ftime             = physics_rate / 1000.0f;
+            p->physicsInitial = true;
+        }
+
+        if (ftime < 0) {
+            continue;
+        }
+
+        TempModelPhysicsStart(p);
+
+        i                  = work->count++;
+        work->models[i]    = p;
+        work->ftime[i]     = ftime;
+        work->origin[0][i] = p->cgd.origin.x;
+        work->origin[1][i] = p->cgd.origin.y;
+        work->origin[2][i] = p->cgd.origin.z;
+        work->velocity[0][i] = p->cgd.velocity.x;
+        work->velocity[1][i] = p->cgd.velocity.y;
+        work->velocity[2][i] = p->cgd.velocity.z;
+
+        if ((p->cgd.flags & T_SWARM) || (p->cgd.flags2 & (T2_MOVE | T2_ACCEL))) {
+            work->moveTime[i] = ftime;
+        } else {
+            work->moveTime[i] = 0;
+        }
+    }
+
+    if (!work->count) {
+        return;
+    }
+
+    CG_RunTempModelJobs(CG_TempModelMoveJob, work);
+
+    for (i = 0; i < work->count; i++) {
+        p = work->models[i];
+
+        p->cgd.origin.x = work->origin[0][i];
+        p->cgd.origin.y = work->origin[1][i];
+        p->cgd.origin.z = work->origin[2][i];
+
+        current_entity        = &p->ent;
+        current_tiki          = p->cgd.tiki;
+        current_entity_number = p->number;
+
+        work->alive[i] = TempModelPhysicsLink(p, work->ftime[i], scale, work->parentOrigin[i]);
+
+        // Only do real collision if necessary
+        if (work->alive[i] && (p->cgd.flags & T_COLLISION)) {
+            work->traceModels[work->numTraces++] = i;
+        } else {
+            // Fake it out so it never collides
+            work->traces[i].fraction = 1.0;
+        }
+    }
+
+    TraceTempModels();
+
+    for (i = 0; i < work->count; i++) {
+        p = work->models[i];
+
+        work->velocity[0][i] = p->cgd.velocity.x;
+        work->velocity[1][i] = p->cgd.velocity.y;
+        work->velocity[2][i] = p->cgd.velocity.z;
+        work->accel[0][i]    = p->cgd.accel.x;
+        work->accel[1][i]    = p->cgd.accel.y;
+        work->accel[2][i]    = p->cgd.accel.z;
+        work->accelTime[i]   = 0;
+        work->friction[i]    = 1.0f;
+
+        if (!work->alive[i] || work->traces[i].fraction != 1.0) {
+            continue;
+        }
+
+        // Acceleration of velocity
+        if (p->cgd.flags2 & T2_ACCEL) {
+            work->accelTime[i] = work->ftime[i];
+        }
+
+        if (p->cgd.flags2 & T2_FRICTION) {
+            work->friction[i] = Q_max(1.0f - work->ftime[i] * p->cgd.friction, 0.0f);
+        }
+    }
+
+    CG_RunTempModelJobs(CG_TempModelAccelJob, work);
+
+    for (i = 0; i < work->count; i++) {
+        p = work->models[i];
+
+        if (!work->alive[i]) {
+            FreeTempModel(p);
+            continue;
+        }
+
+        p->cgd.velocity.x = work->velocity[0][i];
+        p->cgd.velocity.y = work->velocity[1][i];
+        p->cgd.velocity.z = work->velocity[2][i];
+
+        current_entity        = &p->ent;
+        current_tiki          = p->cgd.tiki;
+        current_entity_number = p->number;
+
+        if (!TempModelPhysicsFinish(p, work->ftime[i], &work->traces[i], work->parentOrigin[i])) {
+            FreeTempModel(p);
+            continue;
+        }
+
+        p->lastPhysicsTime = cg.time;
+    }
+}
+
 //===============
 // CG_AddTempModels
 //===============
@@ -935,44 +1452,57 @@ void ClientGameCommandManager::AddTempModels(void)
     old_tiki = current_tiki;
     old_num  = current_entity_number;
 
+    // Added in OPM
+    //  the physics of the temp models run in a batch first
+    RunTempModelPhysics(frameTime, effectTime, scale);
+
     p = m_active_tempmodels.prev;
     for (; p != &m_active_tempmodels; p = next) {
         // grab next now, so if the local entity is freed we still have it
         next = p->prev;
 
-        if ((p->cgd.flags & T_DETAIL) && !cg_detail->integer) {
-            FreeTempModel(p);
-            continue;
-        }
-
-        p->ent.tiki           = p->cgd.tiki;
-        current_entity        = &p->ent;
-        current_tiki          = p->cgd.tiki;
-        current_entity_number = p->number;
+        physics_rate = 1000 / p->cgd.physicsRate; // Physics rate in milliseconds
 
-        TempModelRealtimeEffects(p, effectTime, scale);
+        if (p->physicsFrame == m_iTempmodelphysicsframe) {
+            // Added in OPM
+            //  the effects and the physics already ran in RunTempModelPhysics
+            current_entity        = &p->ent;
+            current_tiki          = p->cgd.tiki;
+            current_entity_number = p->number;
+        } else {
+            // spawned by another temp model of this frame
 
-        if (p->lastPhysicsTime) {
-            mstime = cg.time - p->lastPhysicsTime;
+            if ((p->cgd.flags & T_DETAIL) && !cg_detail->integer) {
+                FreeTempModel(p);
+                continue;
+            }
 
-            // Check for physics
-            physics_rate = 1000 / p->cgd.physicsRate; // Physics rate in milliseconds
+            p->ent.tiki           = p->cgd.tiki;
+            current_entity        = &p->ent;
+            current_tiki          = p->cgd.tiki;
+            current_entity_number = p->number;
 
-            // Avoid large jumps in time
-            if (mstime > physics_rate * 2) {
-                mstime = physics_rate;
-            }
+            TempModelRealtimeEffects(p, effectTime, scale);
 
-            if ((mstime >= physics_rate) || (p->cgd.flags2 & T2_PHYSICS_EVERYFRAME)) {
-                ftime = mstime / 1000.0f;
-                ret   = TempModelPhysics(p, ftime, scale);
+            if (p->lastPhysicsTime) {
+                mstime = cg.time - p->lastPhysicsTime;
 
-                if (!ret) {
-                    FreeTempModel(p);
-                    continue;
+                // Avoid large jumps in time
+                if (mstime > physics_rate * 2) {
+                    mstime = physics_rate;
                 }
 
-                p->lastPhysicsTime = cg.time;
+                if ((mstime >= physics_rate) || (p->cgd.flags2 & T2_PHYSICS_EVERYFRAME)) {
+                    ftime = mstime / 1000.0f;
+                    ret   = TempModelPhysics(p, ftime, scale);
+
+                    if (!ret) {
+                        FreeTempModel(p);
+                        continue;
+                    }
+
+                    p->lastPhysicsTime = cg.time;
+                }
             }
         }
 
@@ -1009,6 +1539,10 @@ void ClientGameCommandManager::AddTempModels(void)
 
             lerpfrac           = 0;
             p->lastPhysicsTime = cg.time;
+        } else if (p->physicsInitial) {
+            // Added in OPM
+            //  the first physics ran in the batch
+            lerpfrac = 0;
         }
 
         // clear out the new entity and initialize it
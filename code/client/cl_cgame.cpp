@@ -484,7 +484,22 @@ CL_CG_Malloc
 */
 void *CL_CG_Malloc(int size )
 {
-	return Z_TagMalloc( size, TAG_CGAME );
+	// Added in OPM
+	//  count the allocation for the cgame code calling it
+	return Z_TagMallocCaller( size, TAG_CGAME, Z_RETURN_ADDRESS() );
+}
+
+/*
+====================
+CL_CG_MallocCaller
+
+Added in OPM
+For the cgame wrappers that know who they allocate for
+====================
+*/
+void *CL_CG_MallocCaller(int size, const void *caller)
+{
+	return Z_TagMallocCaller( size, TAG_CGAME, caller );
 }
 
 /*
@@ -620,6 +635,8 @@ void CL_InitCGameDLL( clientGameImport_t *cgi, clientGameExport_t **cge ) {
 
 	cgi->Malloc							= CL_CG_Malloc;
 	cgi->Free							= CL_CG_Free;
+	cgi->MallocCaller					= CL_CG_MallocCaller;
+	cgi->RunJobs						= Com_RunJobs;
 
 	cgi->Error							= Com_Error;
 	cgi->Milliseconds					= Sys_Milliseconds;
@@ -671,6 +688,7 @@ void CL_InitCGameDLL( clientGameImport_t *cgi, clientGameExport_t **cge ) {
 	cgi->CM_PointContents				= CM_PointContents;
 	cgi->CM_TransformedPointContents	= CM_TransformedPointContents;
 	cgi->CM_BoxTrace					= CM_BoxTrace;
+	cgi->CM_BoxTraceBatch				= CM_BoxTraceBatchJobs;
 	cgi->CM_TransformedBoxTrace			= CM_TransformedBoxTrace;
 	cgi->CM_TempBoxModel				= CM_TempBoxModel;
 	cgi->CM_InlineModel					= CM_InlineModel;
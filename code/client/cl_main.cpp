@@ -2874,7 +2874,9 @@ CL_RefMalloc
 ============
 */
 void *CL_RefMalloc(int size) {
-	return Z_TagMalloc( size, TAG_RENDERER );
+	// Added in OPM
+	//  count the allocation for the renderer code calling it
+	return Z_TagMallocCaller( size, TAG_RENDERER, Z_RETURN_ADDRESS() );
 }
 
 /*
@@ -3255,6 +3257,8 @@ void CL_InitRef( void ) {
 
 	ri.SKEL_GetBoneParent = CL_RefSKEL_GetBoneParent;
 	ri.SKEL_GetMorphWeightFrame = CL_RefSKEL_GetMorphWeightFrame;
+	// Added in OPM
+	ri.RunJobs = Com_RunJobs;
 
 	ret = GetRefAPI( REF_API_VERSION, &ri );
 
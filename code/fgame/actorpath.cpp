@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 // actor.cpp:
 
 #include "actor.h"
+#include "pathplanner.h"
 
 ActorPath::ActorPath()
 {
@@ -31,12 +32,15 @@ ActorPath::ActorPath()
     m_pathlen          = 0;
     m_fLookAhead       = 4096;
     m_bChangeLookAhead = true;
+    m_pPlannerRequest  = NULL;
 
     Clear();
 }
 
 ActorPath::~ActorPath()
 {
+    CancelAsyncPath();
+
     if (m_path) {
         delete[] m_path;
     }
@@ -44,6 +48,8 @@ ActorPath::~ActorPath()
 
 void ActorPath::Clear(void)
 {
+    CancelAsyncPath();
+
     m_startpathpos = NULL;
     m_pathpos      = NULL;
     m_Side         = false;
@@ -127,6 +133,8 @@ void ActorPath::FindPath(
 {
     int depth;
 
+    CancelAsyncPath();
+
     depth = PathManager.FindPath(start, end, ent, maxPath, vLeashHome, fLeashDistSquared, m_FallHeight);
 
     if (!depth) {
@@ -163,6 +171,8 @@ void ActorPath::FindPathAway(
 {
     int depth;
 
+    CancelAsyncPath();
+
     depth = PathManager.FindPathAway(
         start, avoid, vPreferredDir, ent, fMinSafeDist, vLeashHome, fLeashDistSquared, m_FallHeight
     );
@@ -201,6 +211,8 @@ void ActorPath::FindPathNear(
 {
     int depth;
 
+    CancelAsyncPath();
+
     depth = PathManager.FindPathNear(
         start, nearby, ent, maxPath, fRadiusSquared, vLeashHome, fLeashDistSquared, m_FallHeight
     );
@@ -229,14 +241,42 @@ void ActorPath::FindPathNear(
 
 void ActorPath::ReFindPath(float *start, Entity *ent)
 {
-    int    depth;
     vec3_t point;
     // this is a critical bug in all versions of mohaa, it passes directly m_path->point
     // but m_path can be deleted afterwards, leaving a dangling pointer to the path_end
     // global variable
     VectorCopy(m_path->point, point);
 
-    depth = PathManager.FindPath(start, point, ent, 0, NULL, 0, m_FallHeight);
+    //
+    // Added in OPM
+    //  Keep following the current path while the new one
+    //  is searched for on the path planner threads
+    //
+    if (m_pPlannerRequest) {
+        return;
+    }
+
+    m_pPlannerRequest = pathPlanner.Submit(this, start, point, ent, m_FallHeight);
+    if (m_pPlannerRequest) {
+        return;
+    }
+
+    ReFindPathNow(start, point, ent);
+}
+
+/*
+============
+ActorPath::ReFindPathNow
+
+Added in OPM
+Searches the path on this thread
+============
+*/
+void ActorPath::ReFindPathNow(float *start, float *end, Entity *ent)
+{
+    int depth;
+
+    depth = PathManager.FindPath(start, end, ent, 0, NULL, 0, m_FallHeight);
 
     if (!depth) {
         Clear();
@@ -260,6 +300,100 @@ void ActorPath::ReFindPath(float *start, Entity *ent)
     UpdatePos(start);
 }
 
+/*
+============
+ActorPath::ApplyAsyncPath
+
+Added in OPM
+Uses the route found by the path planner, starting from where the entity
+is now as it kept moving during the search.
+Returns false if the route doesn't match the current pathways anymore
+============
+*/
+bool ActorPath::ApplyAsyncPath(PathRequest *request)
+{
+    float *start;
+    int    depth;
+
+    if (request->resultNodes.empty()) {
+        m_pPlannerRequest      = NULL;
+        PathSearch::last_error = request->error;
+        Clear();
+        return true;
+    }
+
+    if (request->ent) {
+        start = request->ent->origin;
+    } else {
+        start = request->start;
+    }
+
+    depth = PathSearch::RestorePath(
+        request->resultNodes.data(),
+        request->resultPathways.data(),
+        request->resultNodes.size(),
+        start,
+        request->end,
+        request->maxPath
+    );
+
+    if (depth == -1) {
+        return false;
+    }
+
+    m_pPlannerRequest = NULL;
+
+    if (depth <= 0) {
+        Clear();
+        return true;
+    }
+
+    if (depth > m_pathlen) {
+        if (m_path) {
+            delete[] m_path;
+        }
+
+        m_pathlen = 10 * ((depth - 1) / 10) + 10;
+        m_path    = new PathInfo[m_pathlen];
+    }
+
+    m_startpathpos = PathManager.GeneratePath(m_path);
+    m_pathpos      = m_startpathpos;
+    m_TotalDist    = PathManager.total_dist;
+    m_Side         = false;
+    m_Time         = level.inttime;
+    UpdatePos(start);
+
+    return true;
+}
+
+/*
+============
+ActorPath::ApplySyncPath
+
+Added in OPM
+Searches the path of the request on this thread, from where the entity is now
+============
+*/
+void ActorPath::ApplySyncPath(PathRequest *request)
+{
+    m_pPlannerRequest = NULL;
+
+    if (request->ent) {
+        ReFindPathNow(request->ent->origin, request->end, request->ent);
+    } else {
+        ReFindPathNow(request->start, request->end, NULL);
+    }
+}
+
+void ActorPath::CancelAsyncPath(void)
+{
+    if (m_pPlannerRequest) {
+        pathPlanner.Cancel(m_pPlannerRequest);
+        m_pPlannerRequest = NULL;
+    }
+}
+
 void ActorPath::UpdatePos(float *origin, float fNodeRadius)
 {
     Vector    end;
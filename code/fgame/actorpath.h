@@ -27,8 +27,12 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define MIN_FALLHEIGHT 18
 #define MAX_FALLHEIGHT 1024
 
+class PathRequest;
+
 class ActorPath
 {
+    friend class PathPlanner;
+
     // path list
     PathInfo *m_path;
     int       m_pathlen;
@@ -47,8 +51,14 @@ class ActorPath
     float     m_fLookAhead;
     bool      m_bChangeLookAhead;
 
+    // Added in OPM
+    //  Path being searched for by the path planner
+    PathRequest *m_pPlannerRequest;
+
 private:
     float PathLookAhead(float total_area, Vector& end, float *origin);
+    void  CancelAsyncPath(void);
+    void  ReFindPathNow(float *start, float *end, Entity *ent);
 
 public:
     ActorPath();
@@ -78,6 +88,8 @@ public:
         float   fLeashDistSquared
     );
     void         ReFindPath(float *start, Entity *ent);
+    bool         ApplyAsyncPath(PathRequest *request);
+    void         ApplySyncPath(PathRequest *request);
     void         UpdatePos(float *origin, float fNodeRadius = 0.0f);
     bool         Complete(const float *origin) const;
     PathInfo    *StartNode(void) const;
@@ -38,6 +38,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "smokesprite.h"
 #include "playerbot.h"
 #include "g_bot.h"
+#include "pathplanner.h"
+#include "g_profile.h"
 #include <tiki.h>
 
 #ifdef WIN32
@@ -68,7 +70,6 @@ target_game_e g_target_game = target_game_e::TG_INVALID;
 gentity_t    *g_entities;
 qboolean      g_iInThinks     = 0;
 qboolean      g_bBeforeThinks = qfalse;
-static float  g_fMsecPerClock = 0;
 
 usercmd_t  *current_ucmd;
 usereyes_t *current_eyeinfo;
@@ -326,6 +327,9 @@ void G_ShutdownGame()
 
     level.CleanUp();
 
+    // Added in OPM
+    pathPlanner.Shutdown();
+
     L_ShutdownEvents();
 
     G_DeAllocGameData();
@@ -396,22 +400,28 @@ G_AddGEntity
 */
 void G_AddGEntity(gentity_t *edict, qboolean showentnums)
 {
-    unsigned long long start, end;
-    Entity            *ent = edict->entity;
+    long long start, end;
+    Entity   *ent = edict->entity;
 
-    if (g_timeents->integer) {
-        start = clock();
+    if (g_timeents->integer || g_profile->integer) {
+        // Added in OPM
+        //  Use the profiler's high resolution timer instead of clock()
+        start = G_ProfileTime();
         G_RunEntity(ent);
-        end = clock();
-
-        gi.DebugPrintf(
-            "%d: <%s> '%s'(%d) : %d clocks, %.1f msec\n",
-            level.framenum,
-            ent->getClassname(),
-            ent->targetname.c_str(),
-            end - start,
-            g_fMsecPerClock
-        );
+        end = G_ProfileTime();
+
+        if (g_timeents->integer) {
+            gi.DebugPrintf(
+                "%d: <%s> '%s'(%d) : %.3f msec\n",
+                level.framenum,
+                ent->getClassname(),
+                ent->targetname.c_str(),
+                ent->entnum,
+                (end - start) / 1000000.0f
+            );
+        }
+
+        G_ProfileEntity(ent, end - start);
     } else {
         G_RunEntity(ent);
     }
@@ -445,13 +455,13 @@ Advances the non-player objects in the world
 */
 void G_RunFrame(int levelTime, int frameTime)
 {
-    gentity_t         *edict;
-    int                num;
-    qboolean           showentnums;
-    unsigned long long start;
-    unsigned long long end;
-    static int         processed[MAX_GENTITIES] = {0};
-    static int         processedFrameID         = 0;
+    gentity_t *edict;
+    int        num;
+    qboolean   showentnums;
+    long long  start;
+    long long  end;
+    static int processed[MAX_GENTITIES] = {0};
+    static int processedFrameID         = 0;
 
     try {
         g_iInThinks = 0;
@@ -494,12 +504,17 @@ void G_RunFrame(int levelTime, int frameTime)
             gi.DPrintf2("====SERVER FRAME==========================================================================\n");
         }
 
+        // Added in OPM
+        G_ProfileBeginFrame();
+
         g_bBeforeThinks = true;
         Director.AllowPause(false);
 
         // Process most of the events before the physics are run
         // so that we can affect the physics immediately
+        G_ProfileBegin(PROFILE_EVENTS);
         L_ProcessPendingEvents();
+        G_ProfileEnd(PROFILE_EVENTS);
 
         Director.AllowPause(true);
         Director.Pause();
@@ -523,14 +538,24 @@ void G_RunFrame(int levelTime, int frameTime)
         }
 
         g_iInThinks++;
+        G_ProfileBegin(PROFILE_SCRIPTS);
         Director.Unpause();
+        G_ProfileEnd(PROFILE_SCRIPTS);
         g_iInThinks--;
 
         // Process any pending events that got posted during the script code
+        G_ProfileBegin(PROFILE_EVENTS);
         L_ProcessPendingEvents();
+        G_ProfileEnd(PROFILE_EVENTS);
 
         path_checksthisframe = 0;
 
+        // Added in OPM
+        //  Hand the paths found by the path planner to their actors
+        G_ProfileBegin(PROFILE_PATHPLANNER);
+        pathPlanner.Frame();
+        G_ProfileEnd(PROFILE_PATHPLANNER);
+
         // Reset debug lines
         G_InitDebugLines();
         G_InitDebugStrings();
@@ -541,8 +566,10 @@ void G_RunFrame(int levelTime, int frameTime)
 
         g_iInThinks++;
 
+        G_ProfileBegin(PROFILE_BADPLACES);
         G_UpdateSmokeSprites();
         level.UpdateBadPlaces();
+        G_ProfileEnd(PROFILE_BADPLACES);
 
         processedFrameID++;
 
@@ -558,11 +585,14 @@ void G_RunFrame(int levelTime, int frameTime)
         }
 
         if (g_timeents->integer) {
-            g_fMsecPerClock = 1.0f / gi.Cvar_Get("CPS", "1", 0)->value;
-            start           = clock();
+            start = G_ProfileTime();
         }
 
+        G_ProfileBegin(PROFILE_BOTS);
         G_BotFrame();
+        G_ProfileEnd(PROFILE_BOTS);
+
+        G_ProfileBegin(PROFILE_ENTITIES);
 
         for (edict = active_edicts.next; edict != &active_edicts; edict = edict->next) {
             for (num = edict->s.parent; num != ENTITYNUM_NONE; num = g_entities[num].s.parent) {
@@ -580,15 +610,14 @@ void G_RunFrame(int levelTime, int frameTime)
             }
         }
 
+        G_ProfileEnd(PROFILE_ENTITIES);
+
         if (g_timeents->integer) {
             gi.cvar_set("g_timeents", va("%d", g_timeents->integer - 1));
-            end = clock();
+            end = G_ProfileTime();
 
             gi.DebugPrintf(
-                "\n%i total: %d (%.1f)\n-----------------------\n",
-                level.framenum,
-                end - start,
-                static_cast<float>(end - start) * g_fMsecPerClock
+                "\n%i total: %.3f msec\n-----------------------\n", level.framenum, (end - start) / 1000000.0f
             );
         }
 
@@ -596,16 +625,22 @@ void G_RunFrame(int levelTime, int frameTime)
         g_bBeforeThinks = qfalse;
 
         // Process any pending events that got posted during the physics code.
+        G_ProfileBegin(PROFILE_EVENTS);
         L_ProcessPendingEvents();
+        G_ProfileEnd(PROFILE_EVENTS);
         level.DoEarthquakes();
 
         // build the playerstate_t structures for all players
+        G_ProfileBegin(PROFILE_ENDFRAMES);
         G_ClientEndServerFrames();
+        G_ProfileEnd(PROFILE_ENDFRAMES);
 
         level.Unregister(STRING_POSTTHINK);
 
         // Process any pending events that got posted during the script code
+        G_ProfileBegin(PROFILE_EVENTS);
         L_ProcessPendingEvents();
+        G_ProfileEnd(PROFILE_EVENTS);
 
         // show how many traces the game code is doing
         if (sv_traceinfo->integer) {
@@ -707,6 +742,9 @@ void G_RunFrame(int levelTime, int frameTime)
             // Add or delete bots that were added using addbot/removebot
             G_SpawnBots();
         }
+
+        // Added in OPM
+        G_ProfileEndFrame();
     }
 
     catch (const char *error) {
@@ -1402,6 +1440,13 @@ qboolean G_ArchiveLevel(
             }
         } else {
             str sName, sValue;
+            int scriptOptimize;
+            int compiledOptimize;
+
+            // Added in OPM
+            //  Savegames without the cvar were made before the scripts were optimized
+            scriptOptimize   = 0;
+            compiledOptimize = g_scriptoptimize->integer;
 
             arc.ArchiveInteger(&num);
             for (int i = 0; i < num; i++) {
@@ -1414,6 +1459,18 @@ qboolean G_ArchiveLevel(
                 arc.ArchiveInteger(&cvar->modificationCount);
                 arc.ArchiveFloat(&cvar->value);
                 arc.ArchiveInteger(&cvar->integer);
+
+                if (!Q_stricmp(sName, "g_scriptoptimize")) {
+                    scriptOptimize = atoi(sValue);
+                }
+            }
+
+            // Added in OPM
+            //  The saved threads point into the code as it was compiled when saving,
+            //  the scripts must be compiled the same way
+            gi.cvar_set2("g_scriptoptimize", va("%i", scriptOptimize), qtrue);
+            if (scriptOptimize != compiledOptimize) {
+                Director.RecompileGameScripts();
             }
         }
 
@@ -0,0 +1,477 @@
+/*
+===========================================================================
+Copyright (C) 2025 the OpenMoHAA team
+
+This file is part of OpenMoHAA source code.
+
+OpenMoHAA source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+OpenMoHAA source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenMoHAA source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// g_profile.cpp: Server frame profiler.
+
+#include "g_local.h"
+#include "g_profile.h"
+#include "entity.h"
+
+#include <chrono>
+
+typedef struct {
+    float samples[PROFILE_HISTORY]; // microseconds
+    int   numSamples;
+    int   current;
+} profileHistory_t;
+
+typedef struct {
+    float avg;
+    float p50;
+    float p95;
+    float p99;
+    float max;
+} profileStats_t;
+
+typedef struct {
+    const char      *classname;
+    profileHistory_t history;
+    long long        frameTime;
+    int              lastFrame;
+} profileClass_t;
+
+typedef struct {
+    Entity     *ent;
+    const char *classname;
+    long long   totalTime;
+    long long   maxTime;
+    int         numFrames;
+} profileEntity_t;
+
+static const char *profileSectionNames[PROFILE_NUM_SECTIONS] = {
+    "events", "scripts", "pathplanner", "badplaces", "bots", "entities", "endframes", "frame"};
+
+static profileHistory_t                      profileSections[PROFILE_NUM_SECTIONS];
+static long long                             profileSectionStart[PROFILE_NUM_SECTIONS];
+static long long                             profileSectionTime[PROFILE_NUM_SECTIONS];
+static con_map<const void *, profileClass_t> profileClasses;
+static profileEntity_t                       profileEntities[MAX_GENTITIES];
+static int                                   profileFrame;
+static bool                                  profileRunning;
+
+/*
+===============
+G_ProfileTime
+
+Returns a high resolution time in nanoseconds
+===============
+*/
+long long G_ProfileTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+    )
+        .count();
+}
+
+static void G_ProfileAddSample(profileHistory_t *history, long long time)
+{
+    history->samples[history->current] = time / 1000.0f;
+    history->current                   = (history->current + 1) % PROFILE_HISTORY;
+    if (history->numSamples < PROFILE_HISTORY) {
+        history->numSamples++;
+    }
+}
+
+static int G_ProfileCompareSamples(const void *a, const void *b)
+{
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+
+    if (fa < fb) {
+        return -1;
+    } else if (fa > fb) {
+        return 1;
+    }
+
+    return 0;
+}
+
+static void G_ProfileGetStats(const profileHistory_t *history, profileStats_t *stats)
+{
+    float sorted[PROFILE_HISTORY];
+    float total;
+    int   last;
+    int   i;
+
+    if (!history->numSamples) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    memcpy(sorted, history->samples, history->numSamples * sizeof(float));
+    qsort(sorted, history->numSamples, sizeof(float), G_ProfileCompareSamples);
+
+    total = 0;
+    for (i = 0; i < history->numSamples; i++) {
+        total += sorted[i];
+    }
+
+    last       = history->numSamples - 1;
+    stats->avg = total / history->numSamples;
+    stats->p50 = sorted[last * 50 / 100];
+    stats->p95 = sorted[last * 95 / 100];
+    stats->p99 = sorted[last * 99 / 100];
+    stats->max = sorted[last];
+}
+
+void G_ProfileReset()
+{
+    profileClasses.clear();
+    memset(profileSections, 0, sizeof(profileSections));
+    memset(profileSectionTime, 0, sizeof(profileSectionTime));
+    memset(profileEntities, 0, sizeof(profileEntities));
+    profileFrame   = 0;
+    profileRunning = false;
+}
+
+void G_ProfileBeginFrame()
+{
+    if (!g_profile->integer) {
+        profileRunning = false;
+        return;
+    }
+
+    profileRunning = true;
+    profileFrame++;
+    memset(profileSectionTime, 0, sizeof(profileSectionTime));
+
+    G_ProfileBegin(PROFILE_FRAME);
+}
+
+void G_ProfileEndFrame()
+{
+    profileClass_t *profClass;
+    int             i;
+
+    if (!profileRunning) {
+        return;
+    }
+
+    G_ProfileEnd(PROFILE_FRAME);
+
+    for (i = 0; i < PROFILE_NUM_SECTIONS; i++) {
+        G_ProfileAddSample(&profileSections[i], profileSectionTime[i]);
+    }
+
+    con_map_enum<const void *, profileClass_t> en = profileClasses;
+
+    for (profClass = en.NextValue(); profClass != NULL; profClass = en.NextValue()) {
+        if (profClass->lastFrame == profileFrame) {
+            G_ProfileAddSample(&profClass->history, profClass->frameTime);
+            profClass->frameTime = 0;
+        }
+    }
+
+    profileRunning = false;
+}
+
+void G_ProfileBegin(profileSection_t section)
+{
+    if (!profileRunning) {
+        return;
+    }
+
+    profileSectionStart[section] = G_ProfileTime();
+}
+
+void G_ProfileEnd(profileSection_t section)
+{
+    if (!profileRunning) {
+        return;
+    }
+
+    // sections such as the events are run multiple times per frame
+    profileSectionTime[section] += G_ProfileTime() - profileSectionStart[section];
+}
+
+void G_ProfileEntity(Entity *ent, long long time)
+{
+    profileClass_t  *profClass;
+    profileEntity_t *profEnt;
+    ClassDef        *cls;
+
+    if (!profileRunning) {
+        return;
+    }
+
+    cls       = ent->classinfo();
+    profClass = &profileClasses[cls];
+    if (!profClass->classname) {
+        profClass->classname = cls->classname;
+    }
+
+    if (profClass->lastFrame != profileFrame) {
+        profClass->lastFrame = profileFrame;
+        profClass->frameTime = 0;
+    }
+    profClass->frameTime += time;
+
+    profEnt = &profileEntities[ent->entnum];
+    if (profEnt->ent != ent) {
+        // another entity is using the slot now
+        memset(profEnt, 0, sizeof(*profEnt));
+        profEnt->ent       = ent;
+        profEnt->classname = cls->classname;
+    }
+
+    profEnt->totalTime += time;
+    profEnt->numFrames++;
+    if (time > profEnt->maxTime) {
+        profEnt->maxTime = time;
+    }
+}
+
+static int G_ProfileCompareEntities(const void *a, const void *b)
+{
+    const profileEntity_t *ea = *(const profileEntity_t **)a;
+    const profileEntity_t *eb = *(const profileEntity_t **)b;
+    long long              avgA, avgB;
+
+    avgA = ea->totalTime / ea->numFrames;
+    avgB = eb->totalTime / eb->numFrames;
+
+    if (avgA > avgB) {
+        return -1;
+    } else if (avgA < avgB) {
+        return 1;
+    }
+
+    return 0;
+}
+
+static int G_ProfileSortedEntities(profileEntity_t **list)
+{
+    int count;
+    int i;
+
+    count = 0;
+    for (i = 0; i < MAX_GENTITIES; i++) {
+        if (profileEntities[i].numFrames) {
+            list[count++] = &profileEntities[i];
+        }
+    }
+
+    qsort(list, count, sizeof(profileEntity_t *), G_ProfileCompareEntities);
+    return count;
+}
+
+void G_ProfilePrint()
+{
+    profileStats_t    stats;
+    profileClass_t   *profClass;
+    profileEntity_t **list;
+    int               count;
+    int               i;
+
+    if (!profileSections[PROFILE_FRAME].numSamples) {
+        gi.Printf("No frame was profiled, set g_profile to 1 first\n");
+        return;
+    }
+
+    gi.Printf(
+        "Last %d frames, times in microseconds\n\n%-24s %9s %9s %9s %9s %9s\n",
+        profileSections[PROFILE_FRAME].numSamples,
+        "section",
+        "avg",
+        "p50",
+        "p95",
+        "p99",
+        "max"
+    );
+
+    for (i = 0; i < PROFILE_NUM_SECTIONS; i++) {
+        G_ProfileGetStats(&profileSections[i], &stats);
+        gi.Printf(
+            "%-24s %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+            profileSectionNames[i],
+            stats.avg,
+            stats.p50,
+            stats.p95,
+            stats.p99,
+            stats.max
+        );
+    }
+
+    gi.Printf("\n%-24s %9s %9s %9s %9s %9s\n", "class", "avg", "p50", "p95", "p99", "max");
+
+    con_map_enum<const void *, profileClass_t> en = profileClasses;
+
+    for (profClass = en.NextValue(); profClass != NULL; profClass = en.NextValue()) {
+        G_ProfileGetStats(&profClass->history, &stats);
+        gi.Printf(
+            "%-24s %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+            profClass->classname,
+            stats.avg,
+            stats.p50,
+            stats.p95,
+            stats.p99,
+            stats.max
+        );
+    }
+
+    list  = new profileEntity_t *[MAX_GENTITIES];
+    count = G_ProfileSortedEntities(list);
+
+    gi.Printf("\n%-6s %-24s %9s %9s %9s\n", "entnum", "class", "avg", "max", "frames");
+
+    for (i = 0; i < count && i < 10; i++) {
+        gi.Printf(
+            "%-6d %-24s %9.1f %9.1f %9d\n",
+            (int)(list[i] - profileEntities),
+            list[i]->classname,
+            list[i]->totalTime / list[i]->numFrames / 1000.0f,
+            list[i]->maxTime / 1000.0f,
+            list[i]->numFrames
+        );
+    }
+
+    delete[] list;
+}
+
+/*
+===============
+G_ProfileWrite
+
+Writes the profile to a CSV file, or to a JSON file
+if the filename has the .json extension
+===============
+*/
+bool G_ProfileWrite(const char *filename)
+{
+    profileStats_t    stats;
+    profileClass_t   *profClass;
+    profileEntity_t **list;
+    int               count;
+    int               i;
+    bool              json;
+    str               buf;
+
+    json = !Q_stricmp(COM_GetExtension(filename), "json");
+
+    if (json) {
+        buf = va("{\n  \"frames\": %d,\n  \"sections\": [\n", profileSections[PROFILE_FRAME].numSamples);
+    } else {
+        buf = "type,name,avg,p50,p95,p99,max,frames\n";
+    }
+
+    for (i = 0; i < PROFILE_NUM_SECTIONS; i++) {
+        G_ProfileGetStats(&profileSections[i], &stats);
+
+        if (json) {
+            buf += va(
+                "    {\"name\": \"%s\", \"avg\": %.1f, \"p50\": %.1f, \"p95\": %.1f, \"p99\": %.1f, \"max\": %.1f}%s\n",
+                profileSectionNames[i],
+                stats.avg,
+                stats.p50,
+                stats.p95,
+                stats.p99,
+                stats.max,
+                i < PROFILE_NUM_SECTIONS - 1 ? "," : ""
+            );
+        } else {
+            buf += va(
+                "section,%s,%.1f,%.1f,%.1f,%.1f,%.1f,%d\n",
+                profileSectionNames[i],
+                stats.avg,
+                stats.p50,
+                stats.p95,
+                stats.p99,
+                stats.max,
+                profileSections[i].numSamples
+            );
+        }
+    }
+
+    if (json) {
+        buf += "  ],\n  \"classes\": [\n";
+    }
+
+    con_map_enum<const void *, profileClass_t> en = profileClasses;
+
+    for (profClass = en.NextValue(), i = 0; profClass != NULL; profClass = en.NextValue(), i++) {
+        G_ProfileGetStats(&profClass->history, &stats);
+
+        if (json) {
+            buf += va(
+                "%s    {\"name\": \"%s\", \"avg\": %.1f, \"p50\": %.1f, \"p95\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+                i ? ",\n" : "",
+                profClass->classname,
+                stats.avg,
+                stats.p50,
+                stats.p95,
+                stats.p99,
+                stats.max
+            );
+        } else {
+            buf += va(
+                "class,%s,%.1f,%.1f,%.1f,%.1f,%.1f,%d\n",
+                profClass->classname,
+                stats.avg,
+                stats.p50,
+                stats.p95,
+                stats.p99,
+                stats.max,
+                profClass->history.numSamples
+            );
+        }
+    }
+
+    if (json) {
+        buf += "\n  ],\n  \"entities\": [\n";
+    }
+
+    list  = new profileEntity_t *[MAX_GENTITIES];
+    count = G_ProfileSortedEntities(list);
+
+    for (i = 0; i < count; i++) {
+        if (json) {
+            buf += va(
+                "%s    {\"entnum\": %d, \"class\": \"%s\", \"avg\": %.1f, \"max\": %.1f, \"frames\": %d}",
+                i ? ",\n" : "",
+                (int)(list[i] - profileEntities),
+                list[i]->classname,
+                list[i]->totalTime / list[i]->numFrames / 1000.0f,
+                list[i]->maxTime / 1000.0f,
+                list[i]->numFrames
+            );
+        } else {
+            // entities only keep their average and maximum time
+            buf += va(
+                "entity,%d:%s,%.1f,,,,%.1f,%d\n",
+                (int)(list[i] - profileEntities),
+                list[i]->classname,
+                list[i]->totalTime / list[i]->numFrames / 1000.0f,
+                list[i]->maxTime / 1000.0f,
+                list[i]->numFrames
+            );
+        }
+    }
+
+    delete[] list;
+
+    if (json) {
+        buf += "\n  ]\n}\n";
+    }
+
+    return gi.FS_WriteFile(filename, buf.c_str(), buf.length()) > 0;
+}
@@ -0,0 +1,56 @@
+/*
+===========================================================================
+Copyright (C) 2025 the OpenMoHAA team
+
+This file is part of OpenMoHAA source code.
+
+OpenMoHAA source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+OpenMoHAA source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenMoHAA source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// g_profile.h: Server frame profiler.
+//
+// When g_profile is set, the time spent in each part of G_RunFrame is
+// measured along with the time of each entity and each entity class.
+// The last PROFILE_HISTORY frames are kept to get the percentiles.
+//
+
+#pragma once
+
+class Entity;
+
+#define PROFILE_HISTORY 256
+
+typedef enum {
+    PROFILE_EVENTS,      // L_ProcessPendingEvents
+    PROFILE_SCRIPTS,     // Director.Unpause
+    PROFILE_PATHPLANNER, // pathPlanner.Frame
+    PROFILE_BADPLACES,   // Smoke sprites and bad places
+    PROFILE_BOTS,        // G_BotFrame
+    PROFILE_ENTITIES,    // Think and physics of all entities
+    PROFILE_ENDFRAMES,   // G_ClientEndServerFrames
+    PROFILE_FRAME,       // The whole frame
+    PROFILE_NUM_SECTIONS
+} profileSection_t;
+
+long long G_ProfileTime();
+void      G_ProfileBeginFrame();
+void      G_ProfileEndFrame();
+void      G_ProfileBegin(profileSection_t section);
+void      G_ProfileEnd(profileSection_t section);
+void      G_ProfileEntity(Entity *ent, long long time);
+void      G_ProfileReset();
+void      G_ProfilePrint();
+bool      G_ProfileWrite(const char *filename);
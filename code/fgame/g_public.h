@@ -495,6 +495,22 @@ typedef struct gameImport_s {
     // New functions will start from here
     //
 
+    void (*traceBatch)(
+        trace_t     *results,
+        const vec3_t *starts,
+        const vec3_t mins,
+        const vec3_t maxs,
+        const vec3_t *ends,
+        int          count,
+        int          passEntityNum,
+        int          contentMask,
+        qboolean     cylinder,
+        qboolean     traceDeep
+    );
+
+    // same as Malloc, but the allocation is counted for caller in the zone statistics
+    void *(*MallocCaller)(size_t size, const void *caller);
+
 } game_import_t;
 
 typedef struct gameExport_s {
@@ -451,6 +451,63 @@ trace_t G_Trace(
     return trace;
 }
 
+/*
+================
+G_TraceBatch
+
+Added in OPM
+Same as calling G_Trace for each pair of start and end points.
+Faster when the traces are close to each other
+================
+*/
+void G_TraceBatch(
+    trace_t         *results,
+    const vec3_t    *starts,
+    const vec3_t    *ends,
+    int              count,
+    const Vector   & mins,
+    const Vector   & maxs,
+    const gentity_t *passent,
+    int              contentmask,
+    qboolean         cylinder,
+    const char      *reason,
+    qboolean         tracedeep
+)
+{
+    int entnum;
+    int i;
+
+    assert(reason);
+
+    if (passent) {
+        entnum = passent->s.number;
+    } else {
+        entnum = ENTITYNUM_NONE;
+    }
+
+    gi.traceBatch(results, starts, mins, maxs, ends, count, entnum, contentmask, cylinder, tracedeep);
+
+    for (i = 0; i < count; i++) {
+        trace_t *trace = &results[i];
+
+        if (trace->entityNum == ENTITYNUM_NONE) {
+            trace->ent = NULL;
+        } else {
+            trace->ent = &g_entities[trace->entityNum];
+        }
+
+        if (sv_traceinfo->integer > 1) {
+            G_ShowTrace(trace, passent, reason);
+        }
+
+        if (sv_drawtrace->integer) {
+            G_DebugLine(Vector(starts[i]), Vector(ends[i]), 1, 1, 0, 1);
+        }
+    }
+
+    sv_numtraces += count;
+}
+
 void G_TraceEntities(
     Vector             & start,
     Vector             & mins,
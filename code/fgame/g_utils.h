@@ -106,6 +106,19 @@ trace_t G_Trace(
     const char      *reason,
     qboolean         tracedeep = qfalse
 );
+void G_TraceBatch(
+    trace_t         *results,
+    const vec3_t    *starts,
+    const vec3_t    *ends,
+    int              count,
+    const Vector   & mins,
+    const Vector   & maxs,
+    const gentity_t *passent,
+    int              contentmask,
+    qboolean         cylindrical,
+    const char      *reason,
+    qboolean         tracedeep = qfalse
+);
 void G_TraceEntities(
     Vector             & start,
     Vector             & mins,
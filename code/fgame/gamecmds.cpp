@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "playerbot.h"
 #include "consoleevent.h"
 #include "g_bot.h"
+#include "g_profile.h"
 
 typedef struct {
     const char *command;
@@ -72,6 +73,10 @@ consolecmd_t G_ConsoleCmds[] = {
     {"compilescript",   G_CompileScript,      qfalse},
     {"addbot",          G_AddBotCommand,      qfalse},
     {"removebot",       G_RemoveBotCommand,   qfalse},
+    {"pathbenchmark",   G_PathBenchmarkCmd,   qfalse},
+    {"pathcache",       G_PathCacheCmd,       qfalse},
+    {"profile",         G_ProfileCmd,         qfalse},
+    {"gamestrstats",    G_StrStatsCmd,        qfalse},
 #ifdef _DEBUG
     {"bot",             G_BotCommand,         qfalse},
 #endif
@@ -673,6 +678,91 @@ qboolean G_RemoveBotCommand(gentity_t *ent)
     return qtrue;
 }
 
+qboolean G_PathBenchmarkCmd(gentity_t *ent)
+{
+    int msec;
+
+    msec = 1000;
+    if (gi.Argc() > 1) {
+        msec = atoi(gi.Argv(1));
+    }
+
+    if (msec <= 0) {
+        gi.Printf("Usage: pathbenchmark [milliseconds]\n");
+        return qfalse;
+    }
+
+    PathSearch::Benchmark(msec);
+    return qtrue;
+}
+
+qboolean G_PathCacheCmd(gentity_t *ent)
+{
+    if (gi.Argc() > 1) {
+        if (Q_stricmp(gi.Argv(1), "flush")) {
+            gi.Printf("Usage: pathcache [flush]\n");
+            return qfalse;
+        }
+
+        PathSearch::FlushPathCache();
+    }
+
+    PathSearch::PathCacheInfo();
+    return qtrue;
+}
+
+qboolean G_StrStatsCmd(gentity_t *ent)
+{
+    if (gi.Argc() > 1) {
+        if (Q_stricmp(gi.Argv(1), "reset")) {
+            gi.Printf("Usage: gamestrstats [reset]\n");
+            return qfalse;
+        }
+
+        str::numDataAllocs   = 0;
+        str::numSmallStrings = 0;
+        return qtrue;
+    }
+
+    gi.Printf(
+        "%zu strdata allocations, %zu strings kept inline (%zu bytes per str)\n",
+        str::numDataAllocs,
+        str::numSmallStrings,
+        sizeof(str)
+    );
+    return qtrue;
+}
+
+qboolean G_ProfileCmd(gentity_t *ent)
+{
+    const char *cmd;
+
+    if (gi.Argc() <= 1) {
+        G_ProfilePrint();
+        return qtrue;
+    }
+
+    cmd = gi.Argv(1);
+
+    if (!Q_stricmp(cmd, "reset")) {
+        G_ProfileReset();
+        return qtrue;
+    }
+
+    if (!Q_stricmp(cmd, "write") && gi.Argc() > 2) {
+        if (!G_ProfileWrite(gi.Argv(2))) {
+            gi.Printf("Couldn't write %s\n", gi.Argv(2));
+            return qfalse;
+        }
+
+        gi.Printf("Wrote %s\n", gi.Argv(2));
+        return qtrue;
+    }
+
+    gi.Printf("Usage: profile [reset | write <filename.csv | filename.json>]\n");
+    return qfalse;
+}
+
 #ifdef _DEBUG
 
 qboolean G_BotCommand(gentity_t *ent)
@@ -58,6 +58,10 @@ qboolean G_ReloadMap(gentity_t* ent);
 qboolean G_CompileScript(gentity_t *ent);
 qboolean G_AddBotCommand(gentity_t *ent);
 qboolean G_RemoveBotCommand(gentity_t *ent);
+qboolean G_PathBenchmarkCmd(gentity_t *ent);
+qboolean G_PathCacheCmd(gentity_t *ent);
+qboolean G_ProfileCmd(gentity_t *ent);
+qboolean G_StrStatsCmd(gentity_t *ent);
 #ifdef _DEBUG
 qboolean G_BotCommand(gentity_t *ent);
 #endif
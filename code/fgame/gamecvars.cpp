@@ -99,6 +99,7 @@ cvar_t *sv_team_spawn_interval;
 cvar_t *g_showmem;
 cvar_t *g_timeents;
 cvar_t *g_timescripts;
+cvar_t *g_profile;
 
 cvar_t *g_showaxis;
 cvar_t *g_showplayerstate;
@@ -131,6 +132,8 @@ cvar_t *g_scriptcheck;
 cvar_t *g_nodecheck;
 cvar_t *g_scriptdebug;
 cvar_t *g_scripttrace;
+cvar_t *g_scriptdispatch;
+cvar_t *g_scriptoptimize;
 
 cvar_t *g_ai;
 cvar_t *g_vehicle;
@@ -401,6 +404,7 @@ void CVAR_Init(void)
     g_showmem         = gi.Cvar_Get("g_showmem", "0", 0);
     g_timeents        = gi.Cvar_Get("g_timeents", "0", 0);
     g_timescripts     = gi.Cvar_Get("g_timescripts", "0", 0);
+    g_profile         = gi.Cvar_Get("g_profile", "0", 0);
     g_showaxis        = gi.Cvar_Get("g_showaxis", "0", 0);
     g_showplayerstate = gi.Cvar_Get("g_showplayerstate", "0", 0);
     g_showplayeranim  = gi.Cvar_Get("g_showplayeranim", "0", 0);
@@ -431,6 +435,14 @@ void CVAR_Init(void)
     g_nodecheck    = gi.Cvar_Get("g_nodecheck", "0", 0);
     g_scriptdebug  = gi.Cvar_Get("g_scriptdebug", "0", 0);
     g_scripttrace  = gi.Cvar_Get("g_scripttrace", "0", 0);
+    // Added in OPM
+    //  1 = use the threaded script VM loop
+    g_scriptdispatch = gi.Cvar_Get("g_scriptdispatch", "0", 0);
+    // Added in OPM
+    //  0 = compile scripts without constant folding, fused opcodes and jump threading.
+    //  Threads are saved as offsets in the compiled code, so the setting is kept
+    //  for the whole level and saved with the game
+    g_scriptoptimize = gi.Cvar_Get("g_scriptoptimize", "1", CVAR_LATCH | CVAR_SAVEGAME);
 
     g_ai      = gi.Cvar_Get("g_ai", "1", 0);
     g_vehicle = gi.Cvar_Get("g_vehicle", "1", 0);
@@ -104,6 +104,7 @@ extern cvar_t *sv_team_spawn_interval;
 extern cvar_t *g_showmem;
 extern cvar_t *g_timeents;
 extern cvar_t *g_timescripts;
+extern cvar_t *g_profile;
 
 extern cvar_t *g_showaxis;
 extern cvar_t *g_showplayerstate;
@@ -136,6 +137,8 @@ extern cvar_t *g_scriptcheck;
 extern cvar_t *g_nodecheck;
 extern cvar_t *g_scriptdebug;
 extern cvar_t *g_scripttrace;
+extern cvar_t *g_scriptdispatch;
+extern cvar_t *g_scriptoptimize;
 
 extern cvar_t *g_ai;
 extern cvar_t *g_vehicle;
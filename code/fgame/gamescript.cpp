@@ -321,6 +321,7 @@ GameScript::GameScript()
     m_ProgBuffer   = NULL;
     m_ProgLength   = 0;
     m_bPrecompiled = false;
+    m_CacheIndex   = NULL;
 
     requiredStackSize = 0;
 
@@ -336,6 +337,7 @@ GameScript::GameScript(const char *filename)
     m_ProgLength   = 0;
     m_ProgToSource = NULL;
     m_bPrecompiled = false;
+    m_CacheIndex   = NULL;
 
     m_SourceBuffer = NULL;
     m_SourceLength = 0;
@@ -692,6 +694,17 @@ void GameScript::Close(void)
 
     m_CatchBlocks.FreeObjectList();
 
+    for (int i = m_Caches.NumObjects(); i > 0; i--) {
+        delete m_Caches.ObjectAt(i);
+    }
+
+    m_Caches.FreeObjectList();
+
+    if (m_CacheIndex) {
+        gi.Free(m_CacheIndex);
+        m_CacheIndex = NULL;
+    }
+
     if (m_ProgToSource) {
         delete m_ProgToSource;
         m_ProgToSource = NULL;
@@ -841,6 +854,49 @@ StateScript *GameScript::GetCatchStateScript(unsigned char *in, unsigned char *&
     }
 }
 
+/*
+====================
+GetCache
+
+Returns the inline cache of the instruction
+whose operand is at the specified code position
+====================
+*/
+ScriptCache *GameScript::GetCache(const unsigned char *codePos)
+{
+    ScriptCache *cache;
+    size_t       offset;
+
+    if (codePos < m_ProgBuffer || codePos >= m_ProgBuffer + m_ProgLength) {
+        return NULL;
+    }
+
+    if (!m_CacheIndex) {
+        m_CacheIndex = (unsigned int *)gi.Malloc(m_ProgLength * sizeof(unsigned int));
+        memset(m_CacheIndex, 0, m_ProgLength * sizeof(unsigned int));
+    }
+
+    offset = codePos - m_ProgBuffer;
+
+    if (!m_CacheIndex[offset]) {
+        cache                = new ScriptCache;
+        m_CacheIndex[offset] = m_Caches.AddObject(cache);
+        return cache;
+    }
+
+    return m_Caches.ObjectAt(m_CacheIndex[offset]);
+}
+
+ScriptCache::ScriptCache()
+{
+    for (int i = 0; i < SCRIPT_CACHE_WAYS; i++) {
+        classDef[i]       = NULL;
+        value[i].response = NULL;
+    }
+
+    next = 0;
+}
+
 bool GameScript::ScriptCheck(void)
 {
     if (g_scriptcheck->integer == 1) {
@@ -114,12 +114,64 @@ public:
     unsigned char *m_TryEndCodePos;
 };
 
+//
+// Added in OPM
+//  Inline cache of an instruction that accesses a field
+//  or executes a command on a listener.
+//  It remembers what the instruction resolved to for the last
+//  classes it was executed on, so the lookups are only done once per class
+//
+#define SCRIPT_CACHE_WAYS 4
+
+class ScriptCache
+{
+public:
+    ClassDef *classDef[SCRIPT_CACHE_WAYS];
+
+    union {
+        ResponseDef<Class> *response; // response of a command
+        unsigned int        eventNum; // getter or setter event of a field, 0 for a variable
+    } value[SCRIPT_CACHE_WAYS];
+
+    // way to replace when all of them are used
+    unsigned int next;
+
+public:
+    ScriptCache();
+
+    int Find(ClassDef *c) const
+    {
+        for (int i = 0; i < SCRIPT_CACHE_WAYS; i++) {
+            if (classDef[i] == c) {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    int Add(ClassDef *c)
+    {
+        const int way = next;
+
+        next          = (next + 1) % SCRIPT_CACHE_WAYS;
+        classDef[way] = c;
+
+        return way;
+    }
+};
+
 class GameScript : public AbstractScript
 {
 protected:
     // try/throw variable
     Container<CatchBlock *> m_CatchBlocks;
 
+    // Added in OPM
+    //  inline caches, indexed by the code offset of the instruction operand
+    unsigned int            *m_CacheIndex;
+    Container<ScriptCache *> m_Caches;
+
 public:
     // program variables
     StateScript    m_State;
@@ -157,6 +209,8 @@ public:
 
     StateScript *GetCatchStateScript(unsigned char *in, unsigned char *& out);
 
+    ScriptCache *GetCache(const unsigned char *codePos);
+
     bool ScriptCheck(void);
 };
 
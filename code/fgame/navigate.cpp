@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "debuglines.h"
 #include "scriptexception.h"
 #include "gamecmds.h"
+#include "pathplanner.h"
 
 #define PATHFILE_VERSION 103
 
@@ -47,6 +48,7 @@ cvar_t *ai_debugpath;
 cvar_t *ai_pathchecktime;
 cvar_t *ai_pathcheckdist;
 cvar_t *ai_editmode; // Added in OPM
+cvar_t *ai_pathcache; // Added in OPM
 
 static const vec_t *path_start;
 static const vec_t *path_end;
@@ -63,12 +65,17 @@ static qboolean loadingarchive       = false;
 static qboolean pathnodescalculated  = false;
 int             ai_maxnode;
 
-MapCell   PathSearch::PathMap[PATHMAP_GRIDSIZE][PATHMAP_GRIDSIZE];
-PathNode *PathSearch::open;
-int       PathSearch::findFrame;
-qboolean  PathSearch::m_bNodesloaded;
-qboolean  PathSearch::m_NodeCheckFailed;
-int       PathSearch::m_LoadIndex;
+MapCell         PathSearch::PathMap[PATHMAP_GRIDSIZE][PATHMAP_GRIDSIZE];
+PathSearchState PathSearch::searchState;
+int             PathSearch::findFrame;
+pathcache_t     PathSearch::pathCache[PATH_CACHE_SIZE];
+int             PathSearch::pathCacheHits;
+int             PathSearch::pathCacheMisses;
+int             PathSearch::pathCacheFlushes;
+int             PathSearch::graphGeneration;
+qboolean        PathSearch::m_bNodesloaded;
+qboolean        PathSearch::m_NodeCheckFailed;
+int             PathSearch::m_LoadIndex;
 
 PathNode   *PathSearch::pathnodes[MAX_PATHNODES];
 int         PathSearch::nodecount;
@@ -115,6 +122,382 @@ PathSearch PathManager;
 
 int path_checksthisframe;
 
+PathSearchState::PathSearchState()
+{
+    int i;
+
+    for (i = 0; i < MAX_PATHNODES; i++) {
+        ResetNode(i);
+    }
+
+    numOpen = 0;
+    stamp   = 0;
+}
+
+void PathSearchState::ResetNode(int node)
+{
+    findCount[node] = 0;
+    g[node]         = 0;
+    h[node]         = 0;
+    parent[node]    = -1;
+    openF[node]     = 0;
+    openStamp[node] = 0;
+    openIndex[node] = -1;
+}
+
+void PathSearchState::ClearOpen(void)
+{
+    int i;
+
+    // Nodes left over from a search that returned early
+    for (i = 0; i < numOpen; i++) {
+        openIndex[openHeap[i]] = -1;
+    }
+
+    numOpen = 0;
+    stamp   = 0;
+}
+
+bool PathSearchState::OpenLess(int a, int b) const
+{
+    if (openF[a] != openF[b]) {
+        return openF[a] < openF[b];
+    }
+
+    // Last pushed first
+    return openStamp[a] > openStamp[b];
+}
+
+void PathSearchState::SwapOpen(int a, int b)
+{
+    short node;
+
+    node        = openHeap[a];
+    openHeap[a] = openHeap[b];
+    openHeap[b] = node;
+
+    openIndex[openHeap[a]] = a;
+    openIndex[openHeap[b]] = b;
+}
+
+void PathSearchState::SiftUp(int pos)
+{
+    int up;
+
+    while (pos > 0) {
+        up = (pos - 1) >> 1;
+        if (!OpenLess(openHeap[pos], openHeap[up])) {
+            break;
+        }
+
+        SwapOpen(pos, up);
+        pos = up;
+    }
+}
+
+void PathSearchState::SiftDown(int pos)
+{
+    int child;
+
+    for (;;) {
+        child = pos * 2 + 1;
+        if (child >= numOpen) {
+            break;
+        }
+
+        if (child + 1 < numOpen && OpenLess(openHeap[child + 1], openHeap[child])) {
+            child++;
+        }
+
+        if (!OpenLess(openHeap[child], openHeap[pos])) {
+            break;
+        }
+
+        SwapOpen(pos, child);
+        pos = child;
+    }
+}
+
+void PathSearchState::PushOpen(int node, int f)
+{
+    assert(!IsOpen(node));
+    assert(numOpen < MAX_PATHNODES);
+
+    openF[node]       = f;
+    openStamp[node]   = ++stamp;
+    openIndex[node]   = numOpen;
+    openHeap[numOpen] = node;
+    numOpen++;
+
+    SiftUp(numOpen - 1);
+}
+
+int PathSearchState::PopOpen(void)
+{
+    int node;
+
+    assert(numOpen > 0);
+
+    node = openHeap[0];
+    numOpen--;
+
+    if (numOpen) {
+        openHeap[0]            = openHeap[numOpen];
+        openIndex[openHeap[0]] = 0;
+        SiftDown(0);
+    }
+
+    openIndex[node] = -1;
+    return node;
+}
+
+void PathSearchState::RemoveOpen(int node)
+{
+    int pos;
+
+    pos = openIndex[node];
+    assert(pos != -1);
+
+    numOpen--;
+    openIndex[node] = -1;
+
+    if (pos == numOpen) {
+        return;
+    }
+
+    openHeap[pos]            = openHeap[numOpen];
+    openIndex[openHeap[pos]] = pos;
+
+    SiftDown(pos);
+    SiftUp(pos);
+}
+
+PathNode *PathSearch::GetParentNode(const PathNode *node)
+{
+    int parent;
+
+    parent = searchState.parent[node->nodenum];
+    if (parent == -1) {
+        return NULL;
+    }
+
+    return pathnodes[parent];
+}
+
+void PathSearch::SetupPathCacheKey(
+    pathcache_t *key,
+    PathNode    *from,
+    PathNode    *to,
+    Entity      *ent,
+    float        maxPath,
+    const vec3_t vLeashHome,
+    float        fLeashDistSquared,
+    int          fallheight
+)
+{
+    key->startNode  = from->nodenum;
+    key->endNode    = to->nodenum;
+    key->fallheight = fallheight;
+    key->maxPath    = maxPath;
+
+    // Bad places are per team
+    if (ent && ent->IsSubclassOfSentient()) {
+        key->team = static_cast<Sentient *>(ent)->m_Team;
+    } else {
+        key->team = -1;
+    }
+
+    if (vLeashHome) {
+        key->bHasLeash = true;
+        VectorCopy(vLeashHome, key->vLeashHome);
+        key->fLeashDistSquared = fLeashDistSquared;
+    } else {
+        key->bHasLeash = false;
+        VectorClear(key->vLeashHome);
+        key->fLeashDistSquared = 0;
+    }
+}
+
+pathcache_t *PathSearch::GetPathCacheSlot(const pathcache_t& key)
+{
+    unsigned int hash;
+
+    hash = key.startNode * 31 + key.endNode;
+    hash = hash * 31 + key.fallheight;
+    hash = hash * 31 + key.team;
+    hash ^= hash >> 8;
+
+    return &pathCache[hash & (PATH_CACHE_SIZE - 1)];
+}
+
+bool PathSearch::PathCacheMatches(const pathcache_t& slot, const pathcache_t& key)
+{
+    if (slot.startNode == -1) {
+        return false;
+    }
+
+    if (slot.startNode != key.startNode || slot.endNode != key.endNode || slot.fallheight != key.fallheight
+        || slot.team != key.team || slot.maxPath != key.maxPath || slot.bHasLeash != key.bHasLeash) {
+        return false;
+    }
+
+    if (key.bHasLeash
+        && (!VectorCompare(slot.vLeashHome, key.vLeashHome) || slot.fLeashDistSquared != key.fLeashDistSquared)) {
+        return false;
+    }
+
+    return true;
+}
+
+void PathSearch::StorePathCache(pathcache_t& slot, const pathcache_t& key, PathNode *pathEnd)
+{
+    PathNode *node;
+    int       numNodes;
+
+    numNodes = 0;
+    for (node = pathEnd; node; node = GetParentNode(node)) {
+        numNodes++;
+    }
+
+    if (numNodes > PATH_CACHE_MAX_NODES) {
+        // Too long to be stored
+        return;
+    }
+
+    slot          = key;
+    slot.numNodes = 0;
+
+    for (node = pathEnd; node; node = GetParentNode(node)) {
+        slot.nodes[slot.numNodes]    = node->nodenum;
+        slot.pathways[slot.numNodes] = node->pathway;
+        slot.numNodes++;
+    }
+}
+
+int PathSearch::RestorePath(
+    const short *nodes, const short *pathways, int numNodes, const vec3_t start, const vec3_t end, float maxPath
+)
+{
+    PathNode  *ParentNode;
+    PathNode  *NewNode;
+    pathway_t *pathway;
+    vec2_t     delta;
+    int        i;
+    int        g;
+    int        f;
+
+    if (!numNodes) {
+        last_error = "unreachable path";
+        return 0;
+    }
+
+    //
+    // Don't trust a route that doesn't match the graph anymore
+    //
+    for (i = numNodes - 1; i > 0; i--) {
+        ParentNode = pathnodes[nodes[i]];
+        if (!ParentNode || pathways[i - 1] >= ParentNode->numChildren
+            || ParentNode->Child[pathways[i - 1]].node != nodes[i - 1]) {
+            return -1;
+        }
+    }
+
+    //
+    // Walk the route again from the start node so that the search state
+    // is the same as the one FindPath() leaves
+    //
+    findFrame++;
+    searchState.ClearOpen();
+
+    Node = pathnodes[nodes[numNodes - 1]];
+
+    VectorSub2D(Node->origin, start, path_startdir);
+    searchState.g[Node->nodenum] = VectorNormalize2D(path_startdir);
+
+    VectorSub2D(end, start, path_totaldir);
+    searchState.h[Node->nodenum] = VectorNormalize2D(path_totaldir);
+
+    searchState.parent[Node->nodenum]    = -1;
+    searchState.findCount[Node->nodenum] = findFrame;
+    Node->m_Depth                        = 3;
+    Node->m_PathPos                      = start;
+
+    for (i = numNodes - 2; i >= 0; i--) {
+        pathway = &Node->Child[pathways[i]];
+        NewNode = pathnodes[pathway->node];
+
+        g = (int)(pathway->dist + searchState.g[Node->nodenum] + 1.0f);
+
+        VectorSub2D(end, pathway->pos2, delta);
+        searchState.h[pathway->node] = VectorLength2D(delta);
+
+        f = (int)((float)g + searchState.h[pathway->node]);
+
+        if (f >= maxPath) {
+            last_error = "specified path distance exceeded";
+            return 0;
+        }
+
+        NewNode->m_Depth   = Node->m_Depth + 1;
+        NewNode->pathway   = pathways[i];
+        NewNode->m_PathPos = pathway->pos2;
+
+        searchState.parent[pathway->node]    = Node->nodenum;
+        searchState.g[pathway->node]         = (float)g;
+        searchState.findCount[pathway->node] = findFrame;
+
+        Node = NewNode;
+    }
+
+    path_start = start;
+    path_end   = end;
+
+    return Node->m_Depth;
+}
+
+void PathSearch::FlushPathCache(void)
+{
+    int i;
+
+    for (i = 0; i < PATH_CACHE_SIZE; i++) {
+        pathCache[i].startNode = -1;
+    }
+
+    pathCacheFlushes++;
+    graphGeneration++;
+}
+
+int PathSearch::GetGraphGeneration(void)
+{
+    return graphGeneration;
+}
+
+void PathSearch::PathCacheInfo(void)
+{
+    int i;
+    int numUsed;
+    int numLookups;
+
+    numUsed = 0;
+    for (i = 0; i < PATH_CACHE_SIZE; i++) {
+        if (pathCache[i].startNode != -1) {
+            numUsed++;
+        }
+    }
+
+    numLookups = pathCacheHits + pathCacheMisses;
+
+    gi.Printf(
+        "path cache: %d/%d slots used, %d hits, %d misses (%.1f%% hit rate), %d flushes\n",
+        numUsed,
+        PATH_CACHE_SIZE,
+        pathCacheHits,
+        pathCacheMisses,
+        numLookups ? pathCacheHits * 100.0f / numLookups : 0.0f,
+        pathCacheFlushes
+    );
+}
+
 PathInfo *PathSearch::GeneratePath(PathInfo *path)
 {
     PathNode  *ParentNode;
@@ -130,11 +513,11 @@ PathInfo *PathSearch::GeneratePath(PathInfo *path)
 
     dist = VectorNormalize2D(dir);
 
-    total_dist = dist + Node->g;
+    total_dist = dist + searchState.g[Node->nodenum];
 
     VectorCopy(path_end, current_path->point);
 
-    ParentNode = Node->Parent;
+    ParentNode = GetParentNode(Node);
     if (ParentNode) {
         pathway = &ParentNode->Child[Node->pathway];
         VectorSub2D(path_end, pathway->pos2, current_path->dir);
@@ -154,8 +537,8 @@ PathInfo *PathSearch::GeneratePath(PathInfo *path)
             current_path++;
         }
 
-        for (Node = ParentNode, ParentNode = ParentNode->Parent; ParentNode != NULL;
-             Node = ParentNode, ParentNode = ParentNode->Parent) {
+        for (Node = ParentNode, ParentNode = GetParentNode(ParentNode); ParentNode != NULL;
+             Node = ParentNode, ParentNode = GetParentNode(ParentNode)) {
             pathway = &ParentNode->Child[Node->pathway];
             if (pathway->dist) {
                 VectorCopy(pathway->pos2, current_path->point);
@@ -169,11 +552,11 @@ PathInfo *PathSearch::GeneratePath(PathInfo *path)
 
         VectorCopy(pathway->pos1, current_path->point);
         VectorCopy2D(path_startdir, current_path->dir);
-        current_path->dist = Node->g;
+        current_path->dist = searchState.g[Node->nodenum];
         assert(current_path->dist > -1e+07 && current_path->dist < 1e+07);
     } else {
         VectorCopy2D(path_totaldir, current_path->dir);
-        path->dist = Node->h;
+        path->dist = searchState.h[Node->nodenum];
     }
 
     if (current_path->dist) {
@@ -195,10 +578,10 @@ PathInfo *PathSearch::GeneratePathNear(PathInfo *path)
     pathway_t *pathway;
     PathNode  *ParentNode;
 
-    total_dist = Node->g;
+    total_dist = searchState.g[Node->nodenum];
     VectorCopy(Node->m_PathPos, path->point);
 
-    ParentNode = Node->Parent;
+    ParentNode = GetParentNode(Node);
     if (ParentNode) {
         pathway = &ParentNode->Child[Node->pathway];
 
@@ -211,8 +594,8 @@ PathInfo *PathSearch::GeneratePathNear(PathInfo *path)
             current_path++;
         }
 
-        for (Node = ParentNode, ParentNode = ParentNode->Parent; ParentNode != NULL;
-             Node = ParentNode, ParentNode = ParentNode->Parent) {
+        for (Node = ParentNode, ParentNode = GetParentNode(ParentNode); ParentNode != NULL;
+             Node = ParentNode, ParentNode = GetParentNode(ParentNode)) {
             pathway = &ParentNode->Child[Node->pathway];
             if (pathway->dist) {
                 VectorCopy(pathway->pos2, current_path->point);
@@ -226,10 +609,10 @@ PathInfo *PathSearch::GeneratePathNear(PathInfo *path)
 
         VectorCopy(pathway->pos1, current_path->point);
         VectorCopy2D(path_startdir, current_path->dir);
-        current_path->dist = Node->g;
+        current_path->dist = searchState.g[Node->nodenum];
     } else {
         VectorCopy2D(path_totaldir, current_path->dir);
-        path->dist = Node->h;
+        path->dist = searchState.h[Node->nodenum];
     }
 
     if (current_path->dist) {
@@ -253,7 +636,7 @@ PathInfo *PathSearch::GeneratePathAway(PathInfo *path)
 
     VectorCopy(Node->m_PathPos, path->point);
 
-    ParentNode = Node->Parent;
+    ParentNode = GetParentNode(Node);
     if (ParentNode) {
         pathway = &ParentNode->Child[Node->pathway];
 
@@ -267,8 +650,8 @@ PathInfo *PathSearch::GeneratePathAway(PathInfo *path)
             current_path++;
         }
 
-        for (Node = ParentNode, ParentNode = ParentNode->Parent; ParentNode != NULL;
-             Node = ParentNode, ParentNode = ParentNode->Parent) {
+        for (Node = ParentNode, ParentNode = GetParentNode(ParentNode); ParentNode != NULL;
+             Node = ParentNode, ParentNode = GetParentNode(ParentNode)) {
             pathway = &ParentNode->Child[Node->pathway];
             if (pathway->dist) {
                 VectorCopy(pathway->pos2, current_path->point);
@@ -283,9 +666,9 @@ PathInfo *PathSearch::GeneratePathAway(PathInfo *path)
         VectorCopy(pathway->pos1, current_path->point);
         VectorCopy2D(pathway->pos1, current_path->point);
 
-        current_path->dist = Node->g;
+        current_path->dist = searchState.g[Node->nodenum];
 
-        if (Node->g) {
+        if (searchState.g[Node->nodenum]) {
             current_path->bAccurate = false;
             current_path++;
             VectorCopy(path_start, current_path->point);
@@ -311,15 +694,15 @@ int PathSearch::FindPath(
     int          fallheight
 )
 {
-    int        i;
-    int        g;
-    PathNode  *NewNode;
-    pathway_t *pathway;
-    PathNode  *prev;
-    PathNode  *next;
-    int        f;
-    vec2_t     delta;
-    PathNode  *to;
+    int          i;
+    int          g;
+    PathNode    *NewNode;
+    pathway_t   *pathway;
+    int          f;
+    vec2_t       delta;
+    PathNode    *to;
+    pathcache_t  cacheKey;
+    pathcache_t *cacheSlot;
 
     if (ent) {
         // Added in OPM
@@ -350,37 +733,52 @@ int PathSearch::FindPath(
         maxPath = 1e+12f;
     }
 
+    //
+    // Added in OPM
+    //  Reuse the route of a previous search made with the same parameters
+    //
+    cacheSlot = NULL;
+    if (ai_pathcache->integer) {
+        SetupPathCacheKey(&cacheKey, Node, to, ent, maxPath, vLeashHome, fLeashDistSquared, fallheight);
+        cacheSlot = GetPathCacheSlot(cacheKey);
+
+        if (PathCacheMatches(*cacheSlot, cacheKey)) {
+            int depth = RestorePath(cacheSlot->nodes, cacheSlot->pathways, cacheSlot->numNodes, start, end, maxPath);
+            if (depth != -1) {
+                pathCacheHits++;
+                return depth;
+            }
+        }
+
+        pathCacheMisses++;
+    }
+
     findFrame++;
-    open = NULL;
+    searchState.ClearOpen();
 
     VectorSub2D(Node->origin, start, path_startdir);
-    Node->g = VectorNormalize2D(path_startdir);
+    searchState.g[Node->nodenum] = VectorNormalize2D(path_startdir);
 
     VectorSub2D(end, start, path_totaldir);
-    Node->h = VectorNormalize2D(path_totaldir);
+    searchState.h[Node->nodenum] = VectorNormalize2D(path_totaldir);
 
-    Node->Parent    = NULL;
-    Node->m_Depth   = 3;
-    Node->findCount = findFrame;
-    Node->inopen    = true;
-    Node->PrevNode  = NULL;
-    Node->NextNode  = NULL;
-    Node->m_PathPos = start;
+    searchState.parent[Node->nodenum]    = -1;
+    searchState.findCount[Node->nodenum] = findFrame;
+    Node->m_Depth                        = 3;
+    Node->m_PathPos                      = start;
 
-    open = Node;
+    searchState.PushOpen(Node->nodenum, 0);
 
-    while (open) {
-        Node         = open;
-        open->inopen = false;
-        open         = Node->NextNode;
-
-        if (open) {
-            open->PrevNode = NULL;
-        }
+    while (!searchState.OpenEmpty()) {
+        Node = pathnodes[searchState.PopOpen()];
 
         if (Node == to) {
             path_start = start;
             path_end   = end;
+
+            if (cacheSlot) {
+                StorePathCache(*cacheSlot, cacheKey, Node);
+            }
             return Node->m_Depth;
         }
 
@@ -401,34 +799,22 @@ int PathSearch::FindPath(
                 }
             }
 
-            g = (int)(pathway->dist + Node->g + 1.0f);
+            g = (int)(pathway->dist + searchState.g[Node->nodenum] + 1.0f);
 
-            if (NewNode->findCount == findFrame) {
-                if (NewNode->g <= g) {
+            if (searchState.findCount[pathway->node] == findFrame) {
+                if (searchState.g[pathway->node] <= g) {
                     continue;
                 }
 
-                if (NewNode->inopen) {
-                    NewNode->inopen = false;
-                    next            = NewNode->NextNode;
-                    prev            = NewNode->PrevNode;
-
-                    if (next) {
-                        next->PrevNode = prev;
-                    }
-
-                    if (prev) {
-                        prev->NextNode = next;
-                    } else {
-                        open = next;
-                    }
+                if (searchState.IsOpen(pathway->node)) {
+                    searchState.RemoveOpen(pathway->node);
                 }
             }
 
             VectorSub2D(end, pathway->pos2, delta);
-            NewNode->h = VectorLength2D(delta);
+            searchState.h[pathway->node] = VectorLength2D(delta);
 
-            f = (int)((float)g + NewNode->h);
+            f = (int)((float)g + searchState.h[pathway->node]);
 
             if (f >= maxPath) {
                 last_error = "specified path distance exceeded";
@@ -439,48 +825,21 @@ int PathSearch::FindPath(
                 && (!ent || !ent->IsSubclassOfSentient() || !pathway->badPlaceTeam[static_cast<Sentient *>(ent)->m_Team]
                 )) {
                 NewNode->m_Depth   = Node->m_Depth + 1;
-                NewNode->Parent    = Node;
                 NewNode->pathway   = i;
-                NewNode->g         = (float)g;
-                NewNode->f         = (float)f;
                 NewNode->m_PathPos = pathway->pos2;
-                NewNode->findCount = findFrame;
-                NewNode->inopen    = true;
-
-                if (!open) {
-                    NewNode->NextNode = NULL;
-                    NewNode->PrevNode = NULL;
-                    open              = NewNode;
-                    continue;
-                }
-
-                if (open->f >= f) {
-                    NewNode->NextNode = open;
-                    NewNode->PrevNode = NULL;
 
-                    open->PrevNode = NewNode;
-                    open           = NewNode;
-                    continue;
-                }
-
-                prev = open;
-                for (next = open->NextNode; next; next = next->NextNode) {
-                    if (next->f >= f) {
-                        break;
-                    }
-                    prev = next;
-                }
-
-                NewNode->NextNode = next;
-                if (next) {
-                    next->PrevNode = NewNode;
-                }
-                prev->NextNode    = NewNode;
-                NewNode->PrevNode = prev;
+                searchState.parent[pathway->node]    = Node->nodenum;
+                searchState.g[pathway->node]         = (float)g;
+                searchState.findCount[pathway->node] = findFrame;
+                searchState.PushOpen(pathway->node, f);
             }
         }
     }
 
+    if (cacheSlot) {
+        StorePathCache(*cacheSlot, cacheKey, NULL);
+    }
+
     last_error = "unreachable path";
     return 0;
 }
@@ -500,8 +859,6 @@ int PathSearch::FindPathNear(
     int        g;
     PathNode  *NewNode;
     pathway_t *pathway;
-    PathNode  *prev;
-    PathNode  *next;
     int        f;
     vec2_t     dir;
     vec2_t     delta;
@@ -530,32 +887,23 @@ int PathSearch::FindPathNear(
     }
 
     findFrame++;
-    open = NULL;
+    searchState.ClearOpen();
 
     VectorSub2D(Node->origin, start, path_startdir);
     VectorSub2D(end, start, delta);
     VectorCopy2D(delta, dir);
 
-    Node->inopen    = true;
-    Node->g         = VectorNormalize2D(path_startdir);
-    Node->h         = VectorNormalize2D(dir);
-    Node->Parent    = NULL;
-    Node->m_Depth   = 3;
-    Node->findCount = findFrame;
-    Node->PrevNode  = NULL;
-    Node->NextNode  = NULL;
-    Node->m_PathPos = start;
+    searchState.g[Node->nodenum]         = VectorNormalize2D(path_startdir);
+    searchState.h[Node->nodenum]         = VectorNormalize2D(dir);
+    searchState.parent[Node->nodenum]    = -1;
+    searchState.findCount[Node->nodenum] = findFrame;
+    Node->m_Depth                        = 3;
+    Node->m_PathPos                      = start;
 
-    open = Node;
+    searchState.PushOpen(Node->nodenum, 0);
 
-    while (open) {
-        Node         = open;
-        open->inopen = false;
-        open         = Node->NextNode;
-
-        if (open) {
-            open->PrevNode = NULL;
-        }
+    while (!searchState.OpenEmpty()) {
+        Node = pathnodes[searchState.PopOpen()];
 
         VectorSub2D(end, Node->m_PathPos, delta);
 
@@ -573,34 +921,22 @@ int PathSearch::FindPathNear(
                 continue;
             }
 
-            g = (int)(pathway->dist + Node->g + 1.0f);
+            g = (int)(pathway->dist + searchState.g[Node->nodenum] + 1.0f);
 
-            if (NewNode->findCount == findFrame) {
-                if (NewNode->g <= g) {
+            if (searchState.findCount[pathway->node] == findFrame) {
+                if (searchState.g[pathway->node] <= g) {
                     continue;
                 }
 
-                if (NewNode->inopen) {
-                    NewNode->inopen = false;
-                    next            = NewNode->NextNode;
-                    prev            = NewNode->PrevNode;
-
-                    if (next) {
-                        next->PrevNode = prev;
-                    }
-
-                    if (prev) {
-                        prev->NextNode = next;
-                    } else {
-                        open = next;
-                    }
+                if (searchState.IsOpen(pathway->node)) {
+                    searchState.RemoveOpen(pathway->node);
                 }
             }
 
             VectorSub2D(end, pathway->pos2, delta);
-            NewNode->h = VectorLength2D(delta);
+            searchState.h[pathway->node] = VectorLength2D(delta);
 
-            f = (int)((float)g + NewNode->h);
+            f = (int)((float)g + searchState.h[pathway->node]);
 
             if (f >= maxPath) {
                 last_error = "specified path distance exceeded";
@@ -611,44 +947,13 @@ int PathSearch::FindPathNear(
                 && (!ent || !ent->IsSubclassOfSentient() || !pathway->badPlaceTeam[static_cast<Sentient *>(ent)->m_Team]
                 )) {
                 NewNode->m_Depth   = Node->m_Depth + 1;
-                NewNode->Parent    = Node;
                 NewNode->pathway   = i;
-                NewNode->g         = (float)g;
-                NewNode->f         = (float)f;
                 NewNode->m_PathPos = pathway->pos2;
-                NewNode->findCount = findFrame;
-                NewNode->inopen    = true;
-
-                if (!open) {
-                    NewNode->NextNode = NULL;
-                    NewNode->PrevNode = NULL;
-                    open              = NewNode;
-                    continue;
-                }
-
-                if (open->f >= f) {
-                    NewNode->NextNode = open;
-                    NewNode->PrevNode = NULL;
 
-                    open->PrevNode = NewNode;
-                    open           = NewNode;
-                    continue;
-                }
-
-                prev = open;
-                for (next = open->NextNode; next; next = next->NextNode) {
-                    if (next->f >= f) {
-                        break;
-                    }
-                    prev = next;
-                }
-
-                NewNode->NextNode = next;
-                if (next) {
-                    next->PrevNode = NewNode;
-                }
-                prev->NextNode    = NewNode;
-                NewNode->PrevNode = prev;
+                searchState.parent[pathway->node]    = Node->nodenum;
+                searchState.g[pathway->node]         = (float)g;
+                searchState.findCount[pathway->node] = findFrame;
+                searchState.PushOpen(pathway->node, f);
             }
         }
     }
@@ -672,8 +977,6 @@ int PathSearch::FindPathAway(
     int        g;
     PathNode  *NewNode;
     pathway_t *pathway;
-    PathNode  *prev;
-    PathNode  *next;
     int        f;
     float      fBias;
     vec2_t     delta;
@@ -699,34 +1002,25 @@ int PathSearch::FindPathAway(
     }
 
     findFrame++;
-    open = NULL;
+    searchState.ClearOpen();
 
     VectorSub2D(Node->origin, start, path_startdir);
     VectorSub2D(start, avoid, delta);
 
     fBias = VectorLength2D(vPreferredDir);
 
-    Node->inopen = true;
-    Node->g      = VectorNormalize2D(path_startdir);
-    Node->h      = fMinSafeDist - VectorNormalize2D(delta);
-    Node->h += fBias - DotProduct2D(vPreferredDir, delta);
-    Node->Parent    = NULL;
-    Node->m_Depth   = 2;
-    Node->findCount = findFrame;
-    Node->PrevNode  = NULL;
-    Node->NextNode  = NULL;
-    Node->m_PathPos = start;
+    searchState.g[Node->nodenum] = VectorNormalize2D(path_startdir);
+    searchState.h[Node->nodenum] = fMinSafeDist - VectorNormalize2D(delta);
+    searchState.h[Node->nodenum] += fBias - DotProduct2D(vPreferredDir, delta);
+    searchState.parent[Node->nodenum]    = -1;
+    searchState.findCount[Node->nodenum] = findFrame;
+    Node->m_Depth                        = 2;
+    Node->m_PathPos                      = start;
 
-    open = Node;
+    searchState.PushOpen(Node->nodenum, 0);
 
-    while (open) {
-        Node         = open;
-        open->inopen = false;
-        open         = Node->NextNode;
-
-        if (open) {
-            open->PrevNode = NULL;
-        }
+    while (!searchState.OpenEmpty()) {
+        Node = pathnodes[searchState.PopOpen()];
 
         VectorSub2D(Node->m_PathPos, avoid, delta);
 
@@ -752,76 +1046,33 @@ int PathSearch::FindPathAway(
                 }
             }
 
-            g = (int)(pathway->dist + Node->g + 1.0f);
+            g = (int)(pathway->dist + searchState.g[Node->nodenum] + 1.0f);
 
-            if (NewNode->findCount == findFrame) {
-                if (NewNode->g <= g) {
+            if (searchState.findCount[pathway->node] == findFrame) {
+                if (searchState.g[pathway->node] <= g) {
                     continue;
                 }
 
-                if (NewNode->inopen) {
-                    NewNode->inopen = false;
-                    next            = NewNode->NextNode;
-                    prev            = NewNode->PrevNode;
-
-                    if (next) {
-                        next->PrevNode = prev;
-                    }
-
-                    if (prev) {
-                        prev->NextNode = next;
-                    } else {
-                        open = next;
-                    }
+                if (searchState.IsOpen(pathway->node)) {
+                    searchState.RemoveOpen(pathway->node);
                 }
             }
 
             VectorSub2D(pathway->pos2, avoid, delta);
-            NewNode->h = VectorNormalize2D(delta);
-            NewNode->h += fBias - DotProduct2D(delta, vPreferredDir);
+            searchState.h[pathway->node] = VectorNormalize2D(delta);
+            searchState.h[pathway->node] += fBias - DotProduct2D(delta, vPreferredDir);
 
-            f = (int)((float)g + NewNode->h);
+            f = (int)((float)g + searchState.h[pathway->node]);
 
             if (pathway->fallheight <= fallheight) {
                 NewNode->m_Depth   = Node->m_Depth + 1;
-                NewNode->Parent    = Node;
                 NewNode->pathway   = i;
-                NewNode->g         = (float)g;
-                NewNode->f         = (float)f;
                 NewNode->m_PathPos = pathway->pos2;
-                NewNode->findCount = findFrame;
-                NewNode->inopen    = true;
-
-                if (!open) {
-                    NewNode->NextNode = NULL;
-                    NewNode->PrevNode = NULL;
-                    open              = NewNode;
-                    continue;
-                }
-
-                if (open->f >= f) {
-                    NewNode->NextNode = open;
-                    NewNode->PrevNode = NULL;
-
-                    open->PrevNode = NewNode;
-                    open           = NewNode;
-                    continue;
-                }
 
-                prev = open;
-                for (next = open->NextNode; next; next = next->NextNode) {
-                    if (next->f >= f) {
-                        break;
-                    }
-                    prev = next;
-                }
-
-                NewNode->NextNode = next;
-                if (next) {
-                    next->PrevNode = NewNode;
-                }
-                prev->NextNode    = NewNode;
-                NewNode->PrevNode = prev;
+                searchState.parent[pathway->node]    = Node->nodenum;
+                searchState.g[pathway->node]         = (float)g;
+                searchState.findCount[pathway->node] = findFrame;
+                searchState.PushOpen(pathway->node, f);
             }
         }
     }
@@ -837,7 +1088,6 @@ PathNode *PathSearch::FindCornerNodeForWall(
     int        i, g;
     PathNode  *NewNode;
     pathway_t *pathway;
-    PathNode  *prev, *next;
     int        f;
     vec2_t     delta;
     vec2_t     dir;
@@ -876,37 +1126,28 @@ PathNode *PathSearch::FindCornerNodeForWall(
     }
 
     findFrame++;
-    open = NULL;
+    searchState.ClearOpen();
 
     VectorSub2D(Node->origin, start, path_startdir);
-    Node->g = VectorNormalize2D(path_startdir);
+    searchState.g[Node->nodenum] = VectorNormalize2D(path_startdir);
 
     VectorSub2D(end, start, path_totaldir);
-    Node->h         = VectorNormalize2D(path_totaldir);
-    Node->inopen    = true;
-    Node->Parent    = NULL;
-    Node->m_Depth   = 3;
-    Node->findCount = findFrame;
-    Node->PrevNode  = 0;
-    Node->NextNode  = 0;
-    Node->m_PathPos = start;
+    searchState.h[Node->nodenum]         = VectorNormalize2D(path_totaldir);
+    searchState.parent[Node->nodenum]    = -1;
+    searchState.findCount[Node->nodenum] = findFrame;
+    Node->m_Depth                        = 3;
+    Node->m_PathPos                      = start;
 
-    open = Node;
+    searchState.PushOpen(Node->nodenum, 0);
 
-    while (open) {
-        Node         = open;
-        open->inopen = false;
-        open         = Node->NextNode;
+    while (!searchState.OpenEmpty()) {
+        Node = pathnodes[searchState.PopOpen()];
 
-        if (open) {
-            open->PrevNode = NULL;
-        }
-
-        if (Node->Parent && DotProduct(Node->m_PathPos, plane) - plane[3] < 0) {
+        if (searchState.parent[Node->nodenum] != -1 && DotProduct(Node->m_PathPos, plane) - plane[3] < 0) {
             VectorSub2D(Node->m_PathPos, start, delta);
 
             if (VectorLength2DSquared(delta) >= 256) {
-                return Node->Parent;
+                return GetParentNode(Node);
             }
             return Node;
         }
@@ -919,34 +1160,22 @@ PathNode *PathSearch::FindCornerNodeForWall(
                 continue;
             }
 
-            g = (int)(pathway->dist + Node->g + 1.0f);
+            g = (int)(pathway->dist + searchState.g[Node->nodenum] + 1.0f);
 
-            if (NewNode->findCount == findFrame) {
-                if (NewNode->g <= g) {
+            if (searchState.findCount[pathway->node] == findFrame) {
+                if (searchState.g[pathway->node] <= g) {
                     continue;
                 }
 
-                if (NewNode->inopen) {
-                    NewNode->inopen = false;
-                    next            = NewNode->NextNode;
-                    prev            = NewNode->PrevNode;
-
-                    if (next) {
-                        next->PrevNode = prev;
-                    }
-
-                    if (prev) {
-                        prev->NextNode = next;
-                    } else {
-                        open = next;
-                    }
+                if (searchState.IsOpen(pathway->node)) {
+                    searchState.RemoveOpen(pathway->node);
                 }
             }
 
             VectorSub2D(end, pathway->pos2, dir);
-            NewNode->h = VectorNormalize2D(dir);
+            searchState.h[pathway->node] = VectorNormalize2D(dir);
 
-            f = (int)((float)g + NewNode->h);
+            f = (int)((float)g + searchState.h[pathway->node]);
 
             if (f >= maxPath) {
                 last_error = "specified path distance exceeded";
@@ -954,44 +1183,13 @@ PathNode *PathSearch::FindCornerNodeForWall(
             }
 
             NewNode->m_Depth   = Node->m_Depth + 1;
-            NewNode->Parent    = Node;
             NewNode->pathway   = i;
-            NewNode->g         = (float)g;
-            NewNode->f         = (float)f;
             NewNode->m_PathPos = pathway->pos2;
-            NewNode->findCount = findFrame;
-            NewNode->inopen    = true;
-
-            if (!open) {
-                NewNode->NextNode = NULL;
-                NewNode->PrevNode = NULL;
-                open              = NewNode;
-                continue;
-            }
-
-            if (open->f >= f) {
-                NewNode->NextNode = open;
-                NewNode->PrevNode = NULL;
-
-                open->PrevNode = NewNode;
-                open           = NewNode;
-                continue;
-            }
-
-            prev = open;
-            for (next = open->NextNode; next; next = next->NextNode) {
-                if (next->f >= f) {
-                    break;
-                }
-                prev = next;
-            }
 
-            NewNode->NextNode = next;
-            if (next) {
-                next->PrevNode = NewNode;
-            }
-            prev->NextNode    = NewNode;
-            NewNode->PrevNode = prev;
+            searchState.parent[pathway->node]    = Node->nodenum;
+            searchState.g[pathway->node]         = (float)g;
+            searchState.findCount[pathway->node] = findFrame;
+            searchState.PushOpen(pathway->node, f);
         }
     }
 
@@ -1021,7 +1219,7 @@ PathNode *PathSearch::FindCornerNodeForExactPath(Entity *pSelf, Sentient *enemy,
 
     vEyeDelta = vEyePos - pSelf->origin;
 
-    for (pParentNode = Node->Parent, i = 0; pParentNode; pParentNode = pParentNode->Parent, i++) {
+    for (pParentNode = GetParentNode(Node), i = 0; pParentNode; pParentNode = GetParentNode(pParentNode), i++) {
         Node         = pParentNode;
         pPathNode[i] = pParentNode;
     }
@@ -1069,6 +1267,8 @@ void PathSearch::ResetNodes(void)
     m_bNodesloaded = false;
     m_LoadIndex    = -1;
 
+    FlushPathCache();
+
     if (!startBulkNavMemory && nodecount) {
         for (x = 0; x < PATHMAP_GRIDSIZE; x++) {
             for (y = 0; y < PATHMAP_GRIDSIZE; y++) {
@@ -1117,6 +1317,8 @@ void PathSearch::ClearNodes(void)
     m_bNodesloaded = false;
     m_LoadIndex    = -1;
 
+    FlushPathCache();
+
     if (!startBulkNavMemory && nodecount) {
         for (x = 0; x < PATHMAP_GRIDSIZE; x++) {
             for (y = 0; y < PATHMAP_GRIDSIZE; y++) {
@@ -1144,7 +1346,7 @@ void PathSearch::ClearNodes(void)
             pathnodes[i]->Child              = NULL;
             pathnodes[i]->virtualNumChildren = 0;
             pathnodes[i]->numChildren        = 0;
-            pathnodes[i]->findCount          = 0;
+            searchState.ResetNode(i);
         }
     }
 
@@ -1185,6 +1387,9 @@ void PathSearch::UpdatePathwaysForBadPlace(const Vector& origin, float radius, i
 
     radiusSqr = radius * radius;
 
+    // Routes that go through the bad place may not be valid anymore
+    FlushPathCache();
+
     for (i = 0; i < nodecount; i++) {
         PathNode *node = pathnodes[i];
         if (!node) {
@@ -1243,6 +1448,8 @@ void AI_RemoveNode(PathNode *node)
     num = node->nodenum;
     delete node;
 
+    PathSearch::FlushPathCache();
+
     PathSearch::pathnodes[num] = NULL;
     if (num == PathSearch::nodecount) {
         PathSearch::nodecount--;
@@ -1312,7 +1519,6 @@ void PathNode::operator delete(void *ptr)
 PathNode::PathNode()
 {
     entflags |= ECF_PATHNODE;
-    findCount      = 0;
     pLastClaimer   = NULL;
     numChildren    = 0;
     iAvailableTime = -1;
@@ -1369,6 +1575,8 @@ void PathNode::ConnectTo(PathNode *node)
     Child[virtualNumChildren].badPlaceTeam[1] = 0;
     virtualNumChildren++;
     numChildren++;
+
+    PathSearch::FlushPathCache();
 }
 
 void PathNode::ConnectChild(int i)
@@ -1382,6 +1590,9 @@ void PathNode::ConnectChild(int i)
 
     Child[numChildren] = child;
     numChildren++;
+
+    // Pathway indices have changed
+    PathSearch::FlushPathCache();
 }
 
 void PathNode::DisconnectChild(int i)
@@ -1395,6 +1606,9 @@ void PathNode::DisconnectChild(int i)
 
     numChildren--;
     Child[numChildren] = child;
+
+    // Pathway indices have changed
+    PathSearch::FlushPathCache();
 }
 
 qboolean PathNode::IsTouching(Entity *e1)
@@ -1810,8 +2024,10 @@ CLASS_DECLARATION(Class, PathSearch, NULL) {
 PathSearch::PathSearch()
 {
     memset(pathnodes, 0, sizeof(pathnodes));
-    open      = 0;
     findFrame = 0;
+
+    FlushPathCache();
+    pathCacheFlushes = 0;
 }
 
 PathSearch::~PathSearch()
@@ -2292,9 +2508,11 @@ void PathSearch::Init(void)
     //
     // Added in OPM
     //
-    ai_editmode = gi.Cvar_Get("ai_editmode", "0", CVAR_LATCH);
+    ai_editmode  = gi.Cvar_Get("ai_editmode", "0", CVAR_LATCH);
+    ai_pathcache = gi.Cvar_Get("ai_pathcache", "1", 0);
 
     navMaster.Init();
+    pathPlanner.Init();
 }
 
 void *PathSearch::AllocPathNode(void)
@@ -2498,6 +2716,72 @@ PathNode *PathSearch::FindNearestSniperNode(Entity*pEnt, Vector& vPos, Entity *p
     return NULL;
 }
 
+void PathSearch::Benchmark(int iMilliseconds)
+{
+    PathNode *nodes[MAX_PATHNODES];
+    int       numNodes;
+    int       numSearches;
+    int       numFound;
+    int       startTime;
+    int       elapsed;
+    int       i;
+    unsigned  seed;
+    str       pathCacheValue;
+
+    numNodes = 0;
+    for (i = 0; i < nodecount; i++) {
+        if (pathnodes[i] && pathnodes[i]->numChildren) {
+            nodes[numNodes++] = pathnodes[i];
+        }
+    }
+
+    if (numNodes < 2) {
+        gi.Printf("No connected path nodes to benchmark.\n");
+        return;
+    }
+
+    // Use a fixed seed so runs on the same map can be compared.
+    // A local generator leaves the game's rand() sequence alone
+    seed = numNodes;
+
+    // Time the search itself, the random pairs would otherwise be
+    // answered from the routes cached by earlier searches
+    pathCacheValue = ai_pathcache->string;
+    gi.cvar_set("ai_pathcache", "0");
+
+    numSearches = 0;
+    numFound    = 0;
+    startTime   = gi.Milliseconds();
+
+    do {
+        PathNode *from;
+        PathNode *to;
+
+        seed = seed * 1103515245 + 12345;
+        from = nodes[(seed >> 16) % numNodes];
+        seed = seed * 1103515245 + 12345;
+        to   = nodes[(seed >> 16) % numNodes];
+
+        if (FindPath(from->origin, to->origin, NULL, 0, NULL, 0, 1024)) {
+            numFound++;
+        }
+
+        numSearches++;
+        elapsed = gi.Milliseconds() - startTime;
+    } while (elapsed < iMilliseconds);
+
+    gi.cvar_set("ai_pathcache", pathCacheValue.c_str());
+
+    gi.Printf(
+        "%d searches (%d found) over %d nodes in %d ms: %.1f searches per second\n",
+        numSearches,
+        numFound,
+        numNodes,
+        elapsed,
+        numSearches * 1000.0f / Q_max(elapsed, 1)
+    );
+}
+
 PathNode *PathSearch::GetSpawnNode(ClassDef *cls)
 {
     if (m_bNodesloaded
@@ -2673,6 +2957,8 @@ void PathSearch::ArchiveStaticLoad(Archiver& arc)
 
     loadingarchive = true;
 
+    FlushPathCache();
+
     arc.ArchiveInteger(&nodecount);
     arc.ArchiveInteger(&total_nodes);
     arc.ArchiveInteger(&total_children);
@@ -2788,6 +3074,10 @@ bool PathSearch::ArchiveDynamic(Archiver& arc)
         node->ArchiveDynamic(arc);
     }
 
+    if (arc.Loading()) {
+        FlushPathCache();
+    }
+
     return true;
 }
 
@@ -2827,8 +3117,8 @@ bool PathSearch::Connect(PathNode *node, int x, int y)
             continue;
         }
 
-        if (node2->findCount != findFrame) {
-            node2->findCount = findFrame;
+        if (searchState.findCount[node2->nodenum] != findFrame) {
+            searchState.findCount[node2->nodenum] = findFrame;
 
             if (!node->CheckPathTo(node2)) {
                 return false;
@@ -3039,7 +3329,7 @@ void PathSearch::Connect(PathNode *node)
     int y;
 
     findFrame++;
-    node->findCount = findFrame;
+    searchState.findCount[node->nodenum] = findFrame;
 
     x = GridCoordinate(node->origin[0]);
     y = GridCoordinate(node->origin[1]);
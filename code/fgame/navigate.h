@@ -54,6 +54,7 @@ extern cvar_t *ai_fallheight;
 extern cvar_t *ai_debugpath;
 extern cvar_t *ai_pathchecktime;
 extern cvar_t *ai_pathcheckdist;
+extern cvar_t *ai_pathcache;
 
 extern int ai_maxnode;
 
@@ -152,17 +153,9 @@ void DrawAllConnections(void);
 class PathNode : public SimpleEntity
 {
 public:
-    int             findCount;
     pathway_t      *Child;
     int             numChildren;
     int             virtualNumChildren;
-    float           f;
-    float           h;
-    float           g;
-    class PathNode *Parent;
-    bool            inopen;
-    PathNode       *PrevNode;
-    PathNode       *NextNode;
     short int       pathway;
     const vec_t    *m_PathPos;
     float           dist;
@@ -239,17 +232,99 @@ public:
     int  NumNodes(void);
 };
 
+//
+// Added in OPM
+//  Per-search node state, indexed by node number.
+//  Kept apart from PathNode so the search loop only walks small arrays
+//  instead of pulling whole entities into the cache.
+//
+class PathSearchState
+{
+public:
+    int   findCount[MAX_PATHNODES];
+    float g[MAX_PATHNODES];
+    float h[MAX_PATHNODES];
+    short parent[MAX_PATHNODES];
+
+private:
+    //
+    // Open set: indexed binary min-heap ordered by f.
+    // On equal f, the most recently pushed node comes first,
+    // like the sorted list that was used before
+    //
+    int   openF[MAX_PATHNODES];
+    int   openStamp[MAX_PATHNODES];
+    int   openIndex[MAX_PATHNODES];
+    short openHeap[MAX_PATHNODES];
+    int   numOpen;
+    int   stamp;
+
+public:
+    PathSearchState();
+
+    void ResetNode(int node);
+    void ClearOpen(void);
+    bool OpenEmpty(void) const;
+    bool IsOpen(int node) const;
+    void PushOpen(int node, int f);
+    int  PopOpen(void);
+    void RemoveOpen(int node);
+
+private:
+    bool OpenLess(int a, int b) const;
+    void SwapOpen(int a, int b);
+    void SiftUp(int pos);
+    void SiftDown(int pos);
+};
+
+inline bool PathSearchState::OpenEmpty(void) const
+{
+    return numOpen == 0;
+}
+
+inline bool PathSearchState::IsOpen(int node) const
+{
+    return openIndex[node] != -1;
+}
+
+#define PATH_CACHE_SIZE      256 // must be a power of two
+#define PATH_CACHE_MAX_NODES 64
+
+//
+// Added in OPM
+//  Route found by FindPath() for a given set of parameters.
+//  Nodes are stored from the end node back to the start node
+//
+typedef struct {
+    short  startNode; // -1 if the slot is unused
+    short  endNode;
+    short  fallheight;
+    short  team;
+    bool   bHasLeash;
+    vec3_t vLeashHome;
+    float  fLeashDistSquared;
+    float  maxPath;
+    short  numNodes; // 0 if the end node is unreachable
+    short  nodes[PATH_CACHE_MAX_NODES];
+    short  pathways[PATH_CACHE_MAX_NODES];
+} pathcache_t;
+
 class PathSearch : public Listener
 {
     friend class PathNode;
 
 private:
-    static MapCell   PathMap[PATHMAP_GRIDSIZE][PATHMAP_GRIDSIZE];
-    static PathNode *open;
-    static int       findFrame;
-    static qboolean  m_bNodesloaded;
-    static qboolean  m_NodeCheckFailed;
-    static int       m_LoadIndex;
+    static MapCell         PathMap[PATHMAP_GRIDSIZE][PATHMAP_GRIDSIZE];
+    static PathSearchState searchState;
+    static int             findFrame;
+    static pathcache_t     pathCache[PATH_CACHE_SIZE];
+    static int             pathCacheHits;
+    static int             pathCacheMisses;
+    static int             pathCacheFlushes;
+    static int             graphGeneration;
+    static qboolean        m_bNodesloaded;
+    static qboolean        m_NodeCheckFailed;
+    static int             m_LoadIndex;
 
 public:
     static PathNode   *pathnodes[MAX_PATHNODES];
@@ -268,6 +343,20 @@ private:
     static void     ArchiveLoadNodes(void);
     static void     Init(void);
 
+    static void SetupPathCacheKey(
+        pathcache_t *key,
+        PathNode    *from,
+        PathNode    *to,
+        Entity      *ent,
+        float        maxPath,
+        const vec3_t vLeashHome,
+        float        fLeashDistSquared,
+        int          fallheight
+    );
+    static pathcache_t *GetPathCacheSlot(const pathcache_t& key);
+    static bool         PathCacheMatches(const pathcache_t& slot, const pathcache_t& key);
+    static void         StorePathCache(pathcache_t& slot, const pathcache_t& key, PathNode *pathEnd);
+
 public:
     CLASS_PROTOTYPE(PathSearch);
 
@@ -306,6 +395,23 @@ public:
 
     static class PathNode *GetSpawnNode(ClassDef *cls);
 
+    //
+    // Added in OPM
+    //
+    static class PathNode *GetParentNode(const PathNode *node);
+    static void            Benchmark(int iMilliseconds);
+    static void            FlushPathCache(void);
+    static void            PathCacheInfo(void);
+    static int             GetGraphGeneration(void);
+    static int             RestorePath(
+                    const short *nodes,
+                    const short *pathways,
+                    int          numNodes,
+                    const vec3_t start,
+                    const vec3_t end,
+                    float        maxPath
+                );
+
     static int FindPath(
         const vec3_t start,
         const vec3_t end,
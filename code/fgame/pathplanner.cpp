@@ -0,0 +1,483 @@
+/*
+===========================================================================
+Copyright (C) 2025 the OpenMoHAA team
+
+This file is part of OpenMoHAA source code.
+
+OpenMoHAA source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+OpenMoHAA source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenMoHAA source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// pathplanner.cpp: Asynchronous path planning.
+
+#include "pathplanner.h"
+#include "actor.h"
+
+cvar_t *ai_pathasync;
+cvar_t *ai_paththreads;
+
+PathPlanner pathPlanner;
+
+void PathGraphSnapshot::Build(int graphGeneration)
+{
+    int        i;
+    int        j;
+    PathNode  *node;
+    pathway_t *pathway;
+
+    generation = graphGeneration;
+
+    nodes.resize(PathSearch::nodecount);
+    pathways.clear();
+
+    for (i = 0; i < PathSearch::nodecount; i++) {
+        plannernode_t& snapNode = nodes[i];
+
+        node = PathSearch::pathnodes[i];
+        if (!node) {
+            VectorClear2D(snapNode.origin);
+            snapNode.firstChild  = 0;
+            snapNode.numChildren = 0;
+            continue;
+        }
+
+        VectorCopy2D(node->origin, snapNode.origin);
+        snapNode.firstChild  = pathways.size();
+        snapNode.numChildren = node->numChildren;
+
+        // Only the connected children are copied, in the same order
+        for (j = 0; j < node->numChildren; j++) {
+            plannerpathway_t snapPathway;
+
+            pathway = &node->Child[j];
+
+            snapPathway.node            = PathSearch::pathnodes[pathway->node] ? pathway->node : -1;
+            snapPathway.fallheight      = pathway->fallheight;
+            snapPathway.badPlaceTeam[0] = pathway->badPlaceTeam[0];
+            snapPathway.badPlaceTeam[1] = pathway->badPlaceTeam[1];
+            snapPathway.dist            = pathway->dist;
+            VectorCopy2D(pathway->pos2, snapPathway.pos2);
+
+            pathways.push_back(snapPathway);
+        }
+    }
+}
+
+PathPlanner::PathPlanner()
+{
+    bQuit = false;
+}
+
+PathPlanner::~PathPlanner()
+{
+    Shutdown();
+}
+
+void PathPlanner::Init(void)
+{
+    ai_pathasync   = gi.Cvar_Get("ai_pathasync", "0", 0);
+    ai_paththreads = gi.Cvar_Get("ai_paththreads", "2", CVAR_LATCH);
+}
+
+void PathPlanner::StartWorkers(void)
+{
+    int i;
+    int numThreads;
+
+    numThreads = Q_bound(1, ai_paththreads->integer, MAX_PATHPLANNER_THREADS);
+    bQuit      = false;
+
+    for (i = 0; i < numThreads; i++) {
+        worker_t *worker = new worker_t;
+
+        worker->findFrame = 0;
+        worker->thread    = std::thread(&PathPlanner::WorkerLoop, this, worker);
+        workers.push_back(worker);
+    }
+}
+
+void PathPlanner::UpdateGraph(void)
+{
+    int generation;
+
+    generation = PathSearch::GetGraphGeneration();
+    if (graph && graph->generation == generation) {
+        return;
+    }
+
+    // Requests still being searched keep a reference to the previous copy
+    std::shared_ptr<PathGraphSnapshot> newGraph = std::make_shared<PathGraphSnapshot>();
+    newGraph->Build(generation);
+    graph = newGraph;
+}
+
+PathRequest *PathPlanner::Submit(ActorPath *owner, const vec3_t start, const vec3_t end, Entity *ent, int fallheight)
+{
+    PathNode    *from;
+    PathNode    *to;
+    PathRequest *request;
+
+    if (!ai_pathasync->integer) {
+        return NULL;
+    }
+
+    //
+    // Finding the nearest nodes requires traces,
+    // so it's done here like FindPath() does
+    //
+    if (ent) {
+        if (ent->IsSubclassOfActor()) {
+            from = PathSearch::NearestStartNode(start, static_cast<SimpleActor *>(ent));
+        } else {
+            from = PathSearch::DebugNearestStartNode(start, ent);
+        }
+    } else {
+        from = PathSearch::DebugNearestStartNode(start);
+    }
+
+    if (!from) {
+        // Let the synchronous search report the error
+        return NULL;
+    }
+
+    to = PathSearch::NearestEndNode(end);
+    if (!to) {
+        return NULL;
+    }
+
+    if (workers.empty()) {
+        StartWorkers();
+    }
+
+    UpdateGraph();
+
+    request          = new PathRequest;
+    request->owner   = owner;
+    request->ent     = ent;
+    request->retries = 0;
+    request->graph = graph;
+    VectorCopy(start, request->start);
+    VectorCopy(end, request->end);
+    request->startNode  = from->nodenum;
+    request->endNode    = to->nodenum;
+    request->fallheight = fallheight;
+    request->maxPath    = 1e+12f;
+    request->bHasLeash  = false;
+    VectorClear(request->vLeashHome);
+    request->fLeashDistSquared = 0;
+    request->error             = NULL;
+
+    if (ent && ent->IsSubclassOfSentient()) {
+        request->team = static_cast<Sentient *>(ent)->m_Team;
+    } else {
+        request->team = -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(request);
+    }
+
+    wakeup.notify_one();
+
+    return request;
+}
+
+void PathPlanner::Cancel(PathRequest *request)
+{
+    // The worker may still be searching, the request is freed on delivery
+    request->owner = NULL;
+}
+
+void PathPlanner::Frame(void)
+{
+    std::vector<PathRequest *> results;
+    size_t                     i;
+
+    if (workers.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        results.swap(completed);
+    }
+
+    for (i = 0; i < results.size(); i++) {
+        PathRequest *request = results[i];
+
+        if (!request->owner) {
+            delete request;
+            continue;
+        }
+
+        if (request->graph->generation == PathSearch::GetGraphGeneration() || RouteMatchesPathways(request)) {
+            //
+            // A route found with older pathways is still used
+            // if it's still allowed on the current ones
+            //
+            if (request->owner->ApplyAsyncPath(request)) {
+                delete request;
+                continue;
+            }
+        }
+
+        if (request->retries >= MAX_PATHPLANNER_RETRIES) {
+            //
+            // Pathways keep changing while searching,
+            // don't let the actor wait any longer
+            //
+            request->owner->ApplySyncPath(request);
+            delete request;
+            continue;
+        }
+
+        //
+        // Pathways have changed while searching,
+        // search again with the current ones
+        //
+        UpdateGraph();
+
+        request->retries++;
+        request->graph = graph;
+        request->resultNodes.clear();
+        request->resultPathways.clear();
+        request->error = NULL;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(request);
+        }
+
+        wakeup.notify_one();
+    }
+}
+
+/*
+============
+PathPlanner::RouteMatchesPathways
+
+Checks the route of a request searched on older pathways
+against the current ones. Bad places and fall heights may have
+changed without the pathways being reconnected
+============
+*/
+bool PathPlanner::RouteMatchesPathways(const PathRequest *request)
+{
+    const std::vector<short>& nodes    = request->resultNodes;
+    const std::vector<short>& pathways = request->resultPathways;
+    PathNode                 *node;
+    pathway_t                *pathway;
+    size_t                    i;
+
+    if (nodes.empty()) {
+        // An unreachable end may be reachable now
+        return false;
+    }
+
+    for (i = nodes.size() - 1; i > 0; i--) {
+        node = PathSearch::pathnodes[nodes[i]];
+        if (!node || pathways[i - 1] >= node->numChildren) {
+            return false;
+        }
+
+        pathway = &node->Child[pathways[i - 1]];
+        if (pathway->node != nodes[i - 1] || pathway->fallheight > request->fallheight) {
+            return false;
+        }
+
+        if (request->team != -1 && pathway->badPlaceTeam[request->team]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void PathPlanner::Shutdown(void)
+{
+    size_t i;
+
+    if (workers.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bQuit = true;
+    }
+
+    wakeup.notify_all();
+
+    for (i = 0; i < workers.size(); i++) {
+        workers[i]->thread.join();
+        delete workers[i];
+    }
+
+    workers.clear();
+
+    // Every request is back in one of the lists now
+    for (i = 0; i < pending.size(); i++) {
+        if (pending[i]->owner) {
+            pending[i]->owner->m_pPlannerRequest = NULL;
+        }
+        delete pending[i];
+    }
+
+    for (i = 0; i < completed.size(); i++) {
+        if (completed[i]->owner) {
+            completed[i]->owner->m_pPlannerRequest = NULL;
+        }
+        delete completed[i];
+    }
+
+    pending.clear();
+    completed.clear();
+    graph.reset();
+}
+
+void PathPlanner::WorkerLoop(worker_t *worker)
+{
+    PathRequest *request;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait(lock, [this] { return bQuit || !pending.empty(); });
+
+            if (bQuit) {
+                return;
+            }
+
+            request = pending.front();
+            pending.erase(pending.begin());
+        }
+
+        Search(worker, request);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            completed.push_back(request);
+        }
+    }
+}
+
+/*
+============
+PathPlanner::Search
+
+Same search as PathSearch::FindPath(), but it only reads the graph copy
+and its own search state
+============
+*/
+void PathPlanner::Search(worker_t *worker, PathRequest *request)
+{
+    const PathGraphSnapshot& snapshot = *request->graph;
+    PathSearchState&         state    = worker->state;
+    const plannernode_t     *snapNode;
+    const plannerpathway_t  *pathway;
+    vec2_t                   startdir;
+    vec2_t                   totaldir;
+    vec2_t                   delta;
+    vec2_t                   vDist;
+    int                      node;
+    int                      i;
+    int                      g;
+    int                      f;
+
+    if (request->startNode >= (int)snapshot.nodes.size() || request->endNode >= (int)snapshot.nodes.size()) {
+        request->error = "couldn't find start node";
+        return;
+    }
+
+    worker->findFrame++;
+    state.ClearOpen();
+
+    node     = request->startNode;
+    snapNode = &snapshot.nodes[node];
+
+    VectorSub2D(snapNode->origin, request->start, startdir);
+    state.g[node] = VectorNormalize2D(startdir);
+
+    VectorSub2D(request->end, request->start, totaldir);
+    state.h[node] = VectorNormalize2D(totaldir);
+
+    state.parent[node]    = -1;
+    state.findCount[node] = worker->findFrame;
+    worker->pathway[node] = 0;
+
+    state.PushOpen(node, 0);
+
+    while (!state.OpenEmpty()) {
+        node     = state.PopOpen();
+        snapNode = &snapshot.nodes[node];
+
+        if (node == request->endNode) {
+            for (; node != -1; node = state.parent[node]) {
+                request->resultNodes.push_back(node);
+                request->resultPathways.push_back(worker->pathway[node]);
+            }
+            return;
+        }
+
+        for (i = snapNode->numChildren - 1; i >= 0; i--) {
+            pathway = &snapshot.pathways[snapNode->firstChild + i];
+            if (pathway->node == -1) {
+                continue;
+            }
+
+            if (request->bHasLeash) {
+                VectorSub2D(pathway->pos2, request->vLeashHome, vDist);
+                if (VectorLength2DSquared(vDist) > request->fLeashDistSquared) {
+                    continue;
+                }
+            }
+
+            g = (int)(pathway->dist + state.g[node] + 1.0f);
+
+            if (state.findCount[pathway->node] == worker->findFrame) {
+                if (state.g[pathway->node] <= g) {
+                    continue;
+                }
+
+                if (state.IsOpen(pathway->node)) {
+                    state.RemoveOpen(pathway->node);
+                }
+            }
+
+            VectorSub2D(request->end, pathway->pos2, delta);
+            state.h[pathway->node] = VectorLength2D(delta);
+
+            f = (int)((float)g + state.h[pathway->node]);
+
+            if (f >= request->maxPath) {
+                request->error = "specified path distance exceeded";
+                return;
+            }
+
+            if (pathway->fallheight <= request->fallheight
+                && (request->team == -1 || !pathway->badPlaceTeam[request->team])) {
+                worker->pathway[pathway->node] = i;
+
+                state.parent[pathway->node]    = node;
+                state.g[pathway->node]         = (float)g;
+                state.findCount[pathway->node] = worker->findFrame;
+                state.PushOpen(pathway->node, f);
+            }
+        }
+    }
+
+    request->error = "unreachable path";
+}
@@ -0,0 +1,144 @@
+/*
+===========================================================================
+Copyright (C) 2025 the OpenMoHAA team
+
+This file is part of OpenMoHAA source code.
+
+OpenMoHAA source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+OpenMoHAA source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenMoHAA source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// pathplanner.h: Asynchronous path planning.
+//
+// Path requests are searched on worker threads against a read-only copy
+// of the path node graph. Results are handed back to their ActorPath at
+// the start of a later server frame.
+//
+
+#pragma once
+
+#include "navigate.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ActorPath;
+
+extern cvar_t *ai_pathasync;
+extern cvar_t *ai_paththreads;
+
+#define MAX_PATHPLANNER_THREADS 8
+
+// Times a request is searched again when the pathways changed under it,
+// before it's searched on the main thread
+#define MAX_PATHPLANNER_RETRIES 2
+
+typedef struct {
+    short  node;
+    short  fallheight;
+    byte   badPlaceTeam[2];
+    float  dist;
+    vec2_t pos2;
+} plannerpathway_t;
+
+typedef struct {
+    vec2_t origin;
+    int    firstChild;
+    int    numChildren;
+} plannernode_t;
+
+//
+// Copy of the pathways that are connected at the time it was made
+//
+class PathGraphSnapshot
+{
+public:
+    int                           generation;
+    std::vector<plannernode_t>    nodes;
+    std::vector<plannerpathway_t> pathways;
+
+public:
+    void Build(int generation);
+};
+
+class PathRequest
+{
+public:
+    // Only used by the main thread
+    ActorPath      *owner;
+    SafePtr<Entity> ent;
+    int             retries;
+
+    std::shared_ptr<const PathGraphSnapshot> graph;
+
+    vec3_t start;
+    vec3_t end;
+    short  startNode;
+    short  endNode;
+    int    fallheight;
+    int    team;
+    float  maxPath;
+    bool   bHasLeash;
+    vec3_t vLeashHome;
+    float  fLeashDistSquared;
+
+    // Filled by the worker, from the end node back to the start node
+    std::vector<short> resultNodes;
+    std::vector<short> resultPathways;
+    const char        *error;
+};
+
+class PathPlanner
+{
+private:
+    struct worker_t {
+        std::thread     thread;
+        PathSearchState state;
+        short           pathway[MAX_PATHNODES];
+        int             findFrame;
+    };
+
+    std::shared_ptr<const PathGraphSnapshot> graph;
+
+    std::mutex                 mutex;
+    std::condition_variable    wakeup;
+    std::vector<PathRequest *> pending;
+    std::vector<PathRequest *> completed;
+    bool                       bQuit;
+
+    std::vector<worker_t *> workers;
+
+private:
+    void StartWorkers(void);
+    void UpdateGraph(void);
+    void WorkerLoop(worker_t *worker);
+    void Search(worker_t *worker, PathRequest *request);
+    bool RouteMatchesPathways(const PathRequest *request);
+
+public:
+    PathPlanner();
+    ~PathPlanner();
+
+    PathRequest *Submit(ActorPath *owner, const vec3_t start, const vec3_t end, Entity *ent, int fallheight);
+    void         Cancel(PathRequest *request);
+    void         Init(void);
+    void         Frame(void);
+    void         Shutdown(void);
+};
+
+extern PathPlanner pathPlanner;
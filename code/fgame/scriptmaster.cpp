@@ -949,6 +949,33 @@ GameScript *ScriptMaster::GetGameScript(str filename, qboolean recompile)
     }
 }
 
+/*
+============
+ScriptMaster::RecompileGameScripts
+
+Added in OPM
+Compiles again all the loaded scripts, like after changing
+the compiler settings
+============
+*/
+void ScriptMaster::RecompileGameScripts(void)
+{
+    con_map_enum<const_str, GameScript *> en(m_GameScripts);
+    GameScript                          **g;
+    Container<const_str>                  filenames;
+    int                                   i;
+
+    for (g = en.NextValue(); g != NULL; g = en.NextValue()) {
+        if (*g) {
+            filenames.AddObject(*en.CurrentKey());
+        }
+    }
+
+    for (i = 1; i <= filenames.NumObjects(); i++) {
+        GetScript(filenames.ObjectAt(i), true);
+    }
+}
+
 GameScript *ScriptMaster::GetScript(const_str filename, qboolean recompile)
 {
     try {
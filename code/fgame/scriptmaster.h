@@ -113,6 +113,7 @@ public:
     GameScript *GetGameScript(str filename, qboolean recompile = false);
     GameScript *GetScript(const_str filename, qboolean recompile = false);
     GameScript *GetScript(str filename, qboolean recompile = false);
+    void        RecompileGameScripts(void);
 
     void SetTime(int time);
 
@@ -5771,7 +5771,10 @@ Vehicle::UpdateTires
 void Vehicle::UpdateTires(void)
 {
     int     index;
-    trace_t trace;
+    trace_t traces[MAX_CORNERS];
+    vec3_t  starts[MAX_CORNERS];
+    vec3_t  ends[MAX_CORNERS];
+    trace_t *trace;
     Vector  a;
     Vector  b;
     Vector  c;
@@ -5799,44 +5802,61 @@ void Vehicle::UpdateTires(void)
     vTmp.y = angles.y + m_fSkidAngle;
     AngleVectors(vTmp, a, b, c);
 
+    for (index = 0; index < MAX_CORNERS; index++) {
+        boxoffset = Corners[index];
+        start     = origin + a * boxoffset[0] + b * boxoffset[1] + c * boxoffset[2];
+        end       = start + Vector(0, 0, -400);
+
+        start.copyTo(starts[index]);
+        end.copyTo(ends[index]);
+    }
+
     // Temporary make slots non-solid for G_Trace
     SetSlotsNonSolid();
 
     do {
         iNumSkippedEntities = 0;
 
-        for (index = 0; index < MAX_CORNERS; index++) {
-            boxoffset = Corners[index];
-            start     = origin + a * boxoffset[0] + b * boxoffset[1] + c * boxoffset[2];
-            end       = start + Vector(0, 0, -400);
+        //
+        // Added in OPM
+        //  The corners are traced together, they are close to each other
+        //
+        G_TraceBatch(
+            traces, starts, ends, MAX_CORNERS, t_mins, t_maxs, edict, MASK_VEHICLE_TIRES, false, "Vehicle::PostThink Corners"
+        );
 
-            trace = G_Trace(start, t_mins, t_maxs, end, this, MASK_VEHICLE_TIRES, false, "Vehicle::PostThink Corners");
+        for (index = 0; index < MAX_CORNERS; index++) {
+            trace = &traces[index];
 
             if (g_showvehiclemovedebug->integer) {
-                G_DebugLine(start, end, 1, 1, 1, 1);
-                G_DebugLine(start, trace.endpos, 1, 0, 0, 1);
+                G_DebugLine(Vector(starts[index]), Vector(ends[index]), 1, 1, 1, 1);
+                G_DebugLine(Vector(starts[index]), Vector(trace->endpos), 1, 0, 0, 1);
             }
 
-            if (trace.ent && trace.ent->entity && trace.ent->entity->isSubclassOf(VehicleCollisionEntity)) {
-                // save the entity
-                pSkippedEntities[iNumSkipped]  = trace.ent->entity;
-                iContentsEntities[iNumSkipped] = trace.ent->r.contents;
-                solidEntities[iNumSkipped]     = trace.ent->solid;
-                iNumSkipped++;
+            if (trace->ent && trace->ent->entity && trace->ent->entity->isSubclassOf(VehicleCollisionEntity)) {
+                iNumSkippedEntities++;
 
-                if (iNumSkipped >= MAX_SKIPPED_ENTITIES) {
-                    gi.Error(ERR_DROP, "MAX_SKIPPED_ENTITIES hit in VehicleMove.\n");
-                    return;
-                }
+                // another corner may have hit it in this pass
+                if (trace->ent->solid != SOLID_NOT) {
+                    // save the entity
+                    pSkippedEntities[iNumSkipped]  = trace->ent->entity;
+                    iContentsEntities[iNumSkipped] = trace->ent->r.contents;
+                    solidEntities[iNumSkipped]     = trace->ent->solid;
+                    iNumSkipped++;
 
-                trace.ent->entity->setSolidType(SOLID_NOT);
-                iNumSkippedEntities++;
+                    if (iNumSkipped >= MAX_SKIPPED_ENTITIES) {
+                        gi.Error(ERR_DROP, "MAX_SKIPPED_ENTITIES hit in VehicleMove.\n");
+                        return;
+                    }
+
+                    trace->ent->entity->setSolidType(SOLID_NOT);
+                }
             }
 
-            if (trace.fraction == 1.0) {
+            if (trace->fraction == 1.0) {
                 m_bTireHit[index] = false;
             } else {
-                m_vTireEnd[index] = trace.endpos;
+                m_vTireEnd[index] = trace->endpos;
                 m_bTireHit[index] = true;
             }
         }
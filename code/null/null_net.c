@@ -70,6 +70,9 @@ void NET_Init( void ) {
 void NET_FlushPacketQueue( void ) {
 }
 
+void NET_FlushSends( void ) {
+}
+
 qboolean NET_GetLoopPacket( netsrc_t sock, netadr_t *net_from, msg_t *net_message ) {
 	return qfalse;
 }
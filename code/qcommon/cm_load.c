@@ -1129,40 +1129,54 @@ can just be stored out and get a proper clipping hull structure.
 */
 void CM_InitBoxHull (void)
 {
-	int			i;
-	int			side;
-	cplane_t	*p;
-	cbrushside_t	*s;
-
 	box_planes = &cm.planes[cm.numPlanes];
 
 	box_brush = &cm.brushes[cm.numBrushes];
-	box_brush->numsides = 6;
-	box_brush->sides = cm.brushsides + cm.numBrushSides;
-	box_brush->contents = CONTENTS_BBOX;
+	CM_InitBoxBrush( box_brush, cm.brushsides + cm.numBrushSides, box_planes );
 
 	box_model.leaf.numLeafBrushes = 1;
 //	box_model.leaf.firstLeafBrush = cm.numBrushes;
 	box_model.leaf.firstLeafBrush = cm.numLeafBrushes;
 	cm.leafbrushes[cm.numLeafBrushes] = cm.numBrushes;
+}
+
+/*
+===================
+CM_InitBoxBrush
+
+Added in OPM
+Sets up a brush with six sides, for the bounds
+set by CM_SetBoxBrushBounds
+===================
+*/
+void CM_InitBoxBrush( cbrush_t *brush, cbrushside_t *sides, cplane_t *planes )
+{
+	int			i;
+	int			side;
+	cplane_t	*p;
+	cbrushside_t	*s;
+
+	brush->numsides = 6;
+	brush->sides = sides;
+	brush->contents = CONTENTS_BBOX;
 
 	for (i=0 ; i<6 ; i++)
 	{
 		side = i&1;
 
 		// brush sides
-		s = &cm.brushsides[cm.numBrushSides+i];
-		s->plane = 	cm.planes + (cm.numPlanes+i*2+side);
+		s = &sides[i];
+		s->plane = 	planes + (i*2+side);
 		s->surfaceFlags = 0;
 
 		// planes
-		p = &box_planes[i*2];
+		p = &planes[i*2];
 		p->type = i>>1;
 		p->signbits = 0;
 		VectorClear (p->normal);
 		p->normal[i>>1] = 1;
 
-		p = &box_planes[i*2+1];
+		p = &planes[i*2+1];
 		p->type = 3 + (i>>1);
 		p->signbits = 0;
 		VectorClear (p->normal);
@@ -1182,26 +1196,37 @@ Capsules are handled differently though.
 ===================
 */
 clipHandle_t CM_TempBoxModel( const vec3_t mins, const vec3_t maxs, int contents ) {
-	box_planes[0].dist = maxs[0];
-	box_planes[1].dist = -maxs[0];
-	box_planes[2].dist = mins[0];
-	box_planes[3].dist = -mins[0];
-	box_planes[4].dist = maxs[1];
-	box_planes[5].dist = -maxs[1];
-	box_planes[6].dist = mins[1];
-	box_planes[7].dist = -mins[1];
-	box_planes[8].dist = maxs[2];
-	box_planes[9].dist = -maxs[2];
-	box_planes[10].dist = mins[2];
-	box_planes[11].dist = -mins[2];
-
-	VectorCopy( mins, box_brush->bounds[0] );
-	VectorCopy( maxs, box_brush->bounds[1] );
-	box_brush->contents = contents;
+	CM_SetBoxBrushBounds( box_brush, box_planes, mins, maxs, contents );
 
 	return BOX_MODEL_HANDLE;
 }
 
+/*
+===================
+CM_SetBoxBrushBounds
+
+Added in OPM
+===================
+*/
+void CM_SetBoxBrushBounds( cbrush_t *brush, cplane_t *planes, const vec3_t mins, const vec3_t maxs, int contents ) {
+	planes[0].dist = maxs[0];
+	planes[1].dist = -maxs[0];
+	planes[2].dist = mins[0];
+	planes[3].dist = -mins[0];
+	planes[4].dist = maxs[1];
+	planes[5].dist = -maxs[1];
+	planes[6].dist = mins[1];
+	planes[7].dist = -mins[1];
+	planes[8].dist = maxs[2];
+	planes[9].dist = -maxs[2];
+	planes[10].dist = mins[2];
+	planes[11].dist = -mins[2];
+
+	VectorCopy( mins, brush->bounds[0] );
+	VectorCopy( maxs, brush->bounds[1] );
+	brush->contents = contents;
+}
+
 /*
 ===================
 CM_ModelBounds
@@ -95,7 +95,6 @@ typedef struct {
 
 
 typedef struct {
-	int			checkcount;				// to avoid repeated testings
 	int			surfaceFlags;
 	int			contents;
 
@@ -106,7 +105,6 @@ typedef struct {
 } cPatch_t;
 
 typedef struct {
-	int checkcount;
 	int surfaceFlags;
 	int contents;
 	int shaderNum;
@@ -182,7 +180,7 @@ typedef struct {
 	cTerrain_t		*terrain;
 
 	int				floodvalid;
-	int				checkcount;					// incremented on each trace
+	int				checkcount;					// incremented on each brush query
 } clipMap_t;
 
 
@@ -200,7 +198,43 @@ typedef struct
 	vec3_t		offset;
 } sphere_t;
 
+// Added in OPM
+// batches that touch more than this are traced one by one
+#define MAX_BATCH_BRUSHES	1024
+#define MAX_BATCH_PATCHES	256
+#define MAX_BATCH_TERRAIN	256
+
+// Added in OPM
+//  Scratch state of the traces, so traces using different
+//  contexts can run at the same time on different threads
+struct traceContext_s {
+	int				checkcount;		// incremented on each trace
+	int				numBrushes;
+	int				*brushChecks;	// checkcount of the last trace that tested the brush
+	int				numSurfaces;
+	int				*surfaceChecks;
+	int				numTerrain;
+	int				*terrainChecks;
+	sphere_t		sphere;
+
+	// the box model of CM_TempBoxModelContext,
+	// NULL to use the shared one
+	cbrush_t		*boxBrush;
+	cbrush_t		box;
+	cbrushside_t	boxSides[6];
+	cplane_t		boxPlanes[12];
+
+	// what the traces of a batch can hit, gathered once for all of them
+	int				numBatchBrushes;
+	cbrush_t		*batchBrushes[MAX_BATCH_BRUSHES];
+	int				numBatchPatches;
+	cPatch_t		*batchPatches[MAX_BATCH_PATCHES];
+	int				numBatchTerrain;
+	cTerrain_t		*batchTerrain[MAX_BATCH_TERRAIN];
+};
+
 typedef struct {
+	traceContext_t	*ctx;
 	vec3_t		start;
 	vec3_t		end;
 	vec3_t		size[2];	// size of the box being swept through the model
@@ -240,7 +274,6 @@ extern	cvar_t		*cm_playerCurveClip;
 extern	cvar_t		*cm_FCMcacheall;
 extern	cvar_t		*cm_FCMdebug;
 extern	cvar_t		*cm_ter_usesphere;
-extern	sphere_t	sphere;
 
 
 int CM_BoxBrushes( const vec3_t mins, const vec3_t maxs, cbrush_t **list, int listsize );
@@ -251,6 +284,8 @@ void CM_StoreBrushes( leafList_t *ll, int nodenum );
 void CM_BoxLeafnums_r( leafList_t *ll, int nodenum );
 
 cmodel_t	*CM_ClipHandleToModel( clipHandle_t handle );
+void		CM_InitBoxBrush( cbrush_t *brush, cbrushside_t *sides, cplane_t *planes );
+void		CM_SetBoxBrushBounds( cbrush_t *brush, cplane_t *planes, const vec3_t mins, const vec3_t maxs, int contents );
 qboolean CM_BoundsIntersect( const vec3_t mins, const vec3_t maxs, const vec3_t mins2, const vec3_t maxs2 );
 qboolean CM_BoundsIntersectPoint( const vec3_t mins, const vec3_t maxs, const vec3_t point );
 
@@ -266,7 +301,6 @@ void CM_ClearLevelPatches( void );
 struct terPatchCollide_s *CM_GenerateTerPatchCollide(vec3_t origin, byte heightmap[9][9], baseshader_t *shader);
 void CM_TraceThroughTerrainCollide(traceWork_t *tw, terrainCollide_t *tc);
 qboolean CM_PositionTestInTerrainCollide( traceWork_t *tw, terrainCollide_t *tc );
-qboolean CM_SightTracePointThroughTerrainCollide( void );
 qboolean CM_SightTraceThroughTerrainCollide( traceWork_t *tw, terrainCollide_t *tc );
 
 // cm_fencemask.c
@@ -63,6 +63,42 @@ void		CM_TransformedBoxTrace( trace_t *results, const vec3_t start, const vec3_t
 						  clipHandle_t model, int brushmask,
 						  const vec3_t origin, const vec3_t angles, int cylinder );
 
+// Added in OPM
+//  Traces with their own scratch state. Traces can run at the same time
+//  on several threads as long as each thread uses its own context
+typedef struct traceContext_s traceContext_t;
+
+traceContext_t *CM_CreateTraceContext( void );
+void		CM_FreeTraceContext( traceContext_t *ctx );
+clipHandle_t CM_TempBoxModelContext( traceContext_t *ctx, const vec3_t mins, const vec3_t maxs, int contents );
+qboolean	CM_BoxSightTraceContext( traceContext_t *ctx, const vec3_t start, const vec3_t end,
+									 const vec3_t mins, const vec3_t maxs,
+									 clipHandle_t model, int brushmask, qboolean cylinder );
+qboolean	CM_TransformedBoxSightTraceContext( traceContext_t *ctx, const vec3_t start, const vec3_t end,
+												const vec3_t mins, const vec3_t maxs,
+												clipHandle_t model, int brushmask, const vec3_t origin, const vec3_t angles, qboolean cylinder );
+void		CM_BoxTraceContext( traceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t end,
+								const vec3_t mins, const vec3_t maxs,
+								clipHandle_t model, int brushmask, int cylinder );
+void		CM_TransformedBoxTraceContext( traceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t end,
+										   const vec3_t mins, const vec3_t maxs,
+										   clipHandle_t model, int brushmask,
+										   const vec3_t origin, const vec3_t angles, int cylinder );
+// traces through the world from each start to its end
+void		CM_BoxTraceBatch( trace_t *results, const vec3_t *starts, const vec3_t *ends, int count,
+							  const vec3_t mins, const vec3_t maxs, int brushmask, int cylinder );
+void		CM_BoxTraceBatchContext( traceContext_t *ctx, trace_t *results, const vec3_t *starts, const vec3_t *ends, int count,
+									 const vec3_t mins, const vec3_t maxs, int brushmask, int cylinder );
+// same as CM_BoxTraceBatch, the traces are spread on the job threads
+void		CM_BoxTraceBatchJobs( trace_t *results, const vec3_t *starts, const vec3_t *ends, int count,
+								  const vec3_t mins, const vec3_t maxs, int brushmask, int cylinder, int numThreads );
+// compares traces run on several threads against the same traces run serially
+void		CM_TraceStress_f( void );
+// records the world traces of a map, and times them again
+void		CM_TraceRecord_f( void );
+void		CM_TraceReplay_f( void );
+qboolean	CM_BenchmarkLoadMap( const char *mapname );
+
 byte		*CM_ClusterPVS (int cluster);
 
 int			CM_PointLeafnum( const vec3_t p );
@@ -28,7 +28,43 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 //#define CAPSULE_DEBUG
 
-sphere_t sphere;
+// Added in OPM
+//  used by the traces without a context
+static traceContext_t cm_traceContext;
+
+static void CM_TestInModel( traceWork_t *tw, clipHandle_t model, cmodel_t *cmod );
+static void CM_TraceToModel( traceWork_t *tw, clipHandle_t model, cmodel_t *cmod );
+
+// Added in OPM
+//  world traces written by cm_traceRecord and traced again by cm_traceReplay,
+//  in the byte order of the machine that recorded them
+#define TRACERECORD_IDENT	( ( 'R' << 24 ) + ( 'T' << 16 ) + ( 'M' << 8 ) + 'C' )
+#define TRACERECORD_VERSION	1
+
+typedef struct {
+	vec3_t		start;
+	vec3_t		end;
+	vec3_t		mins;
+	vec3_t		maxs;
+	int			brushmask;
+	int			cylinder;
+} traceRecord_t;
+
+typedef struct {
+	int			ident;
+	int			version;
+	int			numTraces;
+	char		mapname[ MAX_QPATH ];
+} traceRecordHeader_t;
+
+static struct {
+	traceRecord_t	*traces;
+	int				numTraces;
+	int				maxTraces;
+	char			filename[ MAX_QPATH ];
+} cm_record;
+
+static void CM_RecordTrace( const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, int brushmask, int cylinder );
 
 /*
 ===============================================================================
@@ -144,6 +180,125 @@ POSITION TESTING
 ===============================================================================
 */
 
+/*
+===============================================================================
+
+BRUSH PLANE TESTS
+
+Added in OPM
+Distances of a trace to the planes of a brush, four planes at a time.
+The lanes do the same float operations in the same order as DotProduct,
+so the SSE and the scalar tests find the same traces
+
+===============================================================================
+*/
+
+// set by cm_traceReplay to time the scalar tests
+static qboolean cm_scalarPlanes;
+
+/*
+================
+CM_BrushPlaneDistancesScalar
+================
+*/
+static void CM_BrushPlaneDistancesScalar( const traceWork_t *tw, const cbrushside_t *sides, int numSides, float *d1, float *d2 ) {
+	const cplane_t	*plane;
+	float			dist;
+	int				i;
+
+	if( numSides > 4 ) {
+		numSides = 4;
+	}
+
+	for( i = 0; i < numSides; i++ ) {
+		plane = sides[i].plane;
+
+		// adjust the plane distance apropriately for mins/maxs
+		dist = plane->dist - DotProduct( tw->offsets[ plane->signbits ], plane->normal );
+
+		d1[i] = DotProduct( tw->start, plane->normal ) - dist;
+		if( d2 ) {
+			d2[i] = DotProduct( tw->end, plane->normal ) - dist;
+		}
+	}
+}
+
+// only where the scalar code also uses SSE for floats, x87 rounds differently
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE_MATH__)
+#include <xmmintrin.h>
+
+/*
+================
+CM_Dot4
+
+The dot products of the vector with four planes,
+as ( x * nx + y * ny ) + z * nz like DotProduct
+================
+*/
+static ID_INLINE __m128 CM_Dot4( float x, float y, float z, __m128 nx, __m128 ny, __m128 nz ) {
+	return _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( x ), nx ), _mm_mul_ps( _mm_set1_ps( y ), ny ) ), _mm_mul_ps( _mm_set1_ps( z ), nz ) );
+}
+
+/*
+================
+CM_BrushPlaneDistances
+
+Fills d1 with the distances of the start of the trace to the next four
+planes of the brush, and d2 with the distances of the end if not NULL.
+Only the first numSides are valid
+================
+*/
+static void CM_BrushPlaneDistances( const traceWork_t *tw, const cbrushside_t *sides, int numSides, float *d1, float *d2 ) {
+	const cplane_t	*planes[4];
+	const float		*offsets[4];
+	__m128			nx, ny, nz, dist;
+	__m128			ox, oy, oz;
+	int				i;
+
+	if( cm_scalarPlanes ) {
+		CM_BrushPlaneDistancesScalar( tw, sides, numSides, d1, d2 );
+		return;
+	}
+
+	for( i = 0; i < 4; i++ ) {
+		// the unused lanes test the last plane again
+		planes[i] = sides[ i < numSides ? i : numSides - 1 ].plane;
+		offsets[i] = tw->offsets[ planes[i]->signbits ];
+	}
+
+	// the normal and the distance of a plane are next to each other
+	nx = _mm_loadu_ps( planes[0]->normal );
+	ny = _mm_loadu_ps( planes[1]->normal );
+	nz = _mm_loadu_ps( planes[2]->normal );
+	dist = _mm_loadu_ps( planes[3]->normal );
+	_MM_TRANSPOSE4_PS( nx, ny, nz, dist );
+
+	ox = _mm_setr_ps( offsets[0][0], offsets[1][0], offsets[2][0], offsets[3][0] );
+	oy = _mm_setr_ps( offsets[0][1], offsets[1][1], offsets[2][1], offsets[3][1] );
+	oz = _mm_setr_ps( offsets[0][2], offsets[1][2], offsets[2][2], offsets[3][2] );
+
+	// adjust the plane distance apropriately for mins/maxs
+	dist = _mm_sub_ps( dist, _mm_add_ps( _mm_add_ps( _mm_mul_ps( ox, nx ), _mm_mul_ps( oy, ny ) ), _mm_mul_ps( oz, nz ) ) );
+
+	_mm_storeu_ps( d1, _mm_sub_ps( CM_Dot4( tw->start[0], tw->start[1], tw->start[2], nx, ny, nz ), dist ) );
+	if( d2 ) {
+		_mm_storeu_ps( d2, _mm_sub_ps( CM_Dot4( tw->end[0], tw->end[1], tw->end[2], nx, ny, nz ), dist ) );
+	}
+}
+
+#else
+
+/*
+================
+CM_BrushPlaneDistances
+================
+*/
+static void CM_BrushPlaneDistances( const traceWork_t *tw, const cbrushside_t *sides, int numSides, float *d1, float *d2 ) {
+	CM_BrushPlaneDistancesScalar( tw, sides, numSides, d1, d2 );
+}
+
+#endif
+
 /*
 ================
 CM_TestBoxInBrush
@@ -154,6 +309,7 @@ void CM_TestBoxInBrush( traceWork_t *tw, cbrush_t *brush ) {
 	cplane_t	*plane;
 	float		dist;
 	float		d1;
+	float		planeDist1[4];
 	cbrushside_t	*side;
 	float		t;
 
@@ -172,7 +328,7 @@ void CM_TestBoxInBrush( traceWork_t *tw, cbrush_t *brush ) {
 		return;
 	}
 
-   if ( sphere.use ) {
+   if ( tw->ctx->sphere.use ) {
 		// the first six planes are the axial planes, so we only
 		// need to test the remainder
 		for ( i = 6 ; i < brush->numsides ; i++ ) {
@@ -180,14 +336,14 @@ void CM_TestBoxInBrush( traceWork_t *tw, cbrush_t *brush ) {
 			plane = side->plane;
 
 			// find the closest point on the capsule to the plane
-			t = DotProduct( plane->normal, sphere.offset );
+			t = DotProduct( plane->normal, tw->ctx->sphere.offset );
 			if( t < 0 )
 			{
 				t = -t;
 			}
 
 			// adjust the plane distance apropriately for radius
-			dist = t + plane->dist + sphere.radius;
+			dist = t + plane->dist + tw->ctx->sphere.radius;
 
 			d1 = DotProduct( tw->start, plane->normal ) - dist;
 			// if completely in front of face, no intersection
@@ -200,12 +356,12 @@ void CM_TestBoxInBrush( traceWork_t *tw, cbrush_t *brush ) {
 		// need to test the remainder
 		for ( i = 6 ; i < brush->numsides ; i++ ) {
 			side = brush->sides + i;
-			plane = side->plane;
 
-			// adjust the plane distance apropriately for mins/maxs
-			dist = plane->dist - DotProduct( tw->offsets[ plane->signbits ], plane->normal );
+			if( !( ( i - 6 ) & 3 ) ) {
+				CM_BrushPlaneDistances( tw, side, brush->numsides - i, planeDist1, NULL );
+			}
 
-			d1 = DotProduct( tw->start, plane->normal ) - dist;
+			d1 = planeDist1[ ( i - 6 ) & 3 ];
 
 			// if completely in front of face, no intersection
 			if ( d1 > 0 ) {
@@ -222,6 +378,61 @@ void CM_TestBoxInBrush( traceWork_t *tw, cbrush_t *brush ) {
 
 
 
+/*
+================
+CM_FirstBrushTest
+
+Added in OPM
+Returns qtrue if the brush wasn't tested yet by the trace
+================
+*/
+static ID_INLINE qboolean CM_FirstBrushTest( traceWork_t *tw, const cbrush_t *b ) {
+	int *check = &tw->ctx->brushChecks[ b - cm.brushes ];
+
+	if( *check == tw->ctx->checkcount ) {
+		return qfalse;
+	}
+
+	*check = tw->ctx->checkcount;
+	return qtrue;
+}
+
+/*
+================
+CM_FirstSurfaceTest
+
+Added in OPM
+================
+*/
+static ID_INLINE qboolean CM_FirstSurfaceTest( traceWork_t *tw, int surfaceNum ) {
+	int *check = &tw->ctx->surfaceChecks[ surfaceNum ];
+
+	if( *check == tw->ctx->checkcount ) {
+		return qfalse;
+	}
+
+	*check = tw->ctx->checkcount;
+	return qtrue;
+}
+
+/*
+================
+CM_FirstTerrainTest
+
+Added in OPM
+================
+*/
+static ID_INLINE qboolean CM_FirstTerrainTest( traceWork_t *tw, int terrainNum ) {
+	int *check = &tw->ctx->terrainChecks[ terrainNum ];
+
+	if( *check == tw->ctx->checkcount ) {
+		return qfalse;
+	}
+
+	*check = tw->ctx->checkcount;
+	return qtrue;
+}
+
 /*
 ================
 CM_TestInLeaf
@@ -238,10 +449,9 @@ void CM_TestInLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 	for (k=0 ; k<leaf->numLeafBrushes ; k++) {
 		brushnum = cm.leafbrushes[leaf->firstLeafBrush+k];
 		b = &cm.brushes[brushnum];
-		if (b->checkcount == cm.checkcount) {
+		if (!CM_FirstBrushTest( tw, b )) {
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = cm.checkcount;
 
 		if ( !(b->contents & tw->contents)) {
 			continue;
@@ -264,10 +474,9 @@ void CM_TestInLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 			if ( !patch ) {
 				continue;
 			}
-			if ( patch->checkcount == cm.checkcount ) {
+			if ( !CM_FirstSurfaceTest( tw, cm.leafsurfaces[ leaf->firstLeafSurface + k ] ) ) {
 				continue;	// already checked this brush in another leaf
 			}
-			patch->checkcount = cm.checkcount;
 
 			if ( !(patch->contents & tw->contents)) {
 				continue;
@@ -286,10 +495,9 @@ void CM_TestInLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 		if( !terrain ) {
 			continue;
 		}
-		if( terrain->checkcount == cm.checkcount ) {
+		if( !CM_FirstTerrainTest( tw, terrain - cm.terrain ) ) {
 			continue;
 		}
-		terrain->checkcount = cm.checkcount;
 
 		if( CM_PositionTestInTerrainCollide( tw, &terrain->tc ) ) {
 			tw->trace.fraction = 0;
@@ -316,8 +524,8 @@ void CM_TestCapsuleInCapsule( traceWork_t *tw, clipHandle_t model ) {
 
 	CM_ModelBounds(model, mins, maxs);
 
-	VectorAdd(tw->start, sphere.offset, top);
-	VectorSubtract(tw->start, sphere.offset, bottom);
+	VectorAdd(tw->start, tw->ctx->sphere.offset, top);
+	VectorSubtract(tw->start, tw->ctx->sphere.offset, bottom);
 	for ( i = 0 ; i < 3 ; i++ ) {
 		offset[i] = ( mins[i] + maxs[i] ) * 0.5;
 		symetricSize[0][i] = mins[i] - offset[i];
@@ -328,7 +536,7 @@ void CM_TestCapsuleInCapsule( traceWork_t *tw, clipHandle_t model ) {
 	radius = ( halfwidth > halfheight ) ? halfheight : halfwidth;
 	offs = halfheight - radius;
 
-	r = Square(sphere.radius + radius);
+	r = Square(tw->ctx->sphere.radius + radius);
 	// check if any of the spheres overlap
 	VectorCopy(offset, p1);
 	p1[2] += offs;
@@ -380,6 +588,9 @@ void CM_TestBoundingBoxInCapsule( traceWork_t *tw, clipHandle_t model ) {
 	clipHandle_t h;
 	cmodel_t *cmod;
 	int i;
+	cbrush_t *prevBoxBrush;
+	cbrush_t prevBox;
+	cplane_t prevBoxPlanes[12];
 
 	// mins maxs of the capsule
 	CM_ModelBounds(model, mins, maxs);
@@ -394,15 +605,26 @@ void CM_TestBoundingBoxInCapsule( traceWork_t *tw, clipHandle_t model ) {
 	}
 
 	// replace the bounding box with the capsule
-	sphere.use = qtrue;
-	sphere.radius = ( size[1][0] > size[1][2] ) ? size[1][2]: size[1][0];
-	VectorSet( sphere.offset, 0, 0, size[1][2] - sphere.radius );
+	tw->ctx->sphere.use = qtrue;
+	tw->ctx->sphere.radius = ( size[1][0] > size[1][2] ) ? size[1][2]: size[1][0];
+	VectorSet( tw->ctx->sphere.offset, 0, 0, size[1][2] - tw->ctx->sphere.radius );
 
 	// replace the capsule with the bounding box
-	h = CM_TempBoxModel(tw->size[0], tw->size[1], qfalse);
+	// Added in OPM
+	//  use the box of the trace context so other threads can trace at the same time,
+	//  and put back the box the caller of the trace may have set on it
+	prevBoxBrush = tw->ctx->boxBrush;
+	prevBox = tw->ctx->box;
+	memcpy( prevBoxPlanes, tw->ctx->boxPlanes, sizeof( prevBoxPlanes ) );
+
+	h = CM_TempBoxModelContext( tw->ctx, tw->size[0], tw->size[1], qfalse );
 	// calculate collision
 	cmod = CM_ClipHandleToModel( h );
-	CM_TestInLeaf( tw, &cmod->leaf );
+	CM_TestInModel( tw, h, cmod );
+
+	tw->ctx->boxBrush = prevBoxBrush;
+	tw->ctx->box = prevBox;
+	memcpy( tw->ctx->boxPlanes, prevBoxPlanes, sizeof( prevBoxPlanes ) );
 }
 
 /*
@@ -432,12 +654,9 @@ void CM_PositionTest( traceWork_t *tw ) {
 	ll.lastLeaf = 0;
 	ll.overflowed = qfalse;
 
-	cm.checkcount++;
-
 	CM_BoxLeafnums_r( &ll, 0 );
 
-
-	cm.checkcount++;
+	tw->ctx->checkcount++;
 
 	// test the contents of the leafs
 	for (i=0 ; i < ll.count ; i++) {
@@ -510,6 +729,7 @@ void CM_TraceThroughBrush( traceWork_t *tw, cbrush_t *brush ) {
 	float		dist;
 	float		enterFrac, leaveFrac, leaveFrac2;
 	float		d1, d2;
+	float		planeDist1[4], planeDist2[4];
 	qboolean	getout, startout;
 	float		f;
 	cbrushside_t	*side, *leadside, *leadside2;
@@ -530,7 +750,7 @@ void CM_TraceThroughBrush( traceWork_t *tw, cbrush_t *brush ) {
 
 	leadside = NULL;
 	if( !( brush->contents & CONTENTS_FENCE ) || !tw->isPoint ) {
-		if( sphere.use ) {
+		if( tw->ctx->sphere.use ) {
 			//
 			// compare the trace against all planes of the brush
 			// find the latest time the trace crosses a plane towards the interior
@@ -541,14 +761,14 @@ void CM_TraceThroughBrush( traceWork_t *tw, cbrush_t *brush ) {
 				plane = side->plane;
 
 				// find the closest point on the capsule to the plane
-				t = DotProduct( plane->normal, sphere.offset );
+				t = DotProduct( plane->normal, tw->ctx->sphere.offset );
 				if( t < 0 )
 				{
 					t = -t;
 				}
 
 				// adjust the plane distance apropriately for radius
-				dist = t + plane->dist + sphere.radius;
+				dist = t + plane->dist + tw->ctx->sphere.radius;
 
 				d1 = DotProduct( tw->start, plane->normal ) - dist;
 				d2 = DotProduct( tw->end, plane->normal ) - dist;
@@ -602,11 +822,12 @@ void CM_TraceThroughBrush( traceWork_t *tw, cbrush_t *brush ) {
 				side = brush->sides + i;
 				plane = side->plane;
 
-				// adjust the plane distance apropriately for mins/maxs
-				dist = plane->dist - DotProduct( tw->offsets[ plane->signbits ], plane->normal );
+				if( !( i & 3 ) ) {
+					CM_BrushPlaneDistances( tw, side, brush->numsides - i, planeDist1, planeDist2 );
+				}
 
-				d1 = DotProduct( tw->start, plane->normal ) - dist;
-				d2 = DotProduct( tw->end, plane->normal ) - dist;
+				d1 = planeDist1[ i & 3 ];
+				d2 = planeDist2[ i & 3 ];
 
 				// if it doesn't cross the plane, the plane isn't relevent
 				if( d1 <= 0 && d2 <= 0 ) {
@@ -691,11 +912,12 @@ void CM_TraceThroughBrush( traceWork_t *tw, cbrush_t *brush ) {
 			side = brush->sides + i;
 			plane = side->plane;
 
-			// adjust the plane distance apropriately for mins/maxs
-			dist = plane->dist - DotProduct( tw->offsets[ plane->signbits ], plane->normal );
+			if( !( i & 3 ) ) {
+				CM_BrushPlaneDistances( tw, side, brush->numsides - i, planeDist1, planeDist2 );
+			}
 
-			d1 = DotProduct( tw->start, plane->normal ) - dist;
-			d2 = DotProduct( tw->end, plane->normal ) - dist;
+			d1 = planeDist1[ i & 3 ];
+			d2 = planeDist2[ i & 3 ];
 
 			// if it doesn't cross the plane, the plane isn't relevent
 			if( d1 <= 0 && d2 <= 0 ) {
@@ -784,10 +1006,9 @@ void CM_TraceToLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 	// test box position against all brushes in the leaf
 	for( k = 0; k<leaf->numLeafBrushes; k++ ) {
 		b = &cm.brushes[ cm.leafbrushes[ leaf->firstLeafBrush + k ] ];
-		if( b->checkcount == cm.checkcount ) {
+		if( !CM_FirstBrushTest( tw, b ) ) {
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = cm.checkcount;
 
 		if( !( b->contents & tw->contents ) ) {
 			continue;
@@ -810,10 +1031,9 @@ void CM_TraceToLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 			if( !patch ) {
 				continue;
 			}
-			if( patch->checkcount == cm.checkcount ) {
+			if( !CM_FirstSurfaceTest( tw, cm.leafsurfaces[ leaf->firstLeafSurface + k ] ) ) {
 				continue;	// already checked this brush in another leaf
 			}
-			patch->checkcount = cm.checkcount;
 
 			if( !( patch->contents & tw->contents ) ) {
 				continue;
@@ -832,10 +1052,9 @@ void CM_TraceToLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 		if( !terrain ) {
 			continue;
 		}
-		if( terrain->checkcount == cm.checkcount ) {
+		if( !CM_FirstTerrainTest( tw, terrain - cm.terrain ) ) {
 			continue;
 		}
-		terrain->checkcount = cm.checkcount;
 
 		CM_TraceThroughTerrain( tw, terrain );
 		if( !tw->trace.fraction ) {
@@ -1061,10 +1280,10 @@ void CM_TraceCapsuleThroughCapsule( traceWork_t *tw, clipHandle_t model ) {
 		return;
 	}
 	// top origin and bottom origin of each sphere at start and end of trace
-	VectorAdd(tw->start, sphere.offset, starttop);
-	VectorSubtract(tw->start, sphere.offset, startbottom);
-	VectorAdd(tw->end, sphere.offset, endtop);
-	VectorSubtract(tw->end, sphere.offset, endbottom);
+	VectorAdd(tw->start, tw->ctx->sphere.offset, starttop);
+	VectorSubtract(tw->start, tw->ctx->sphere.offset, startbottom);
+	VectorAdd(tw->end, tw->ctx->sphere.offset, endtop);
+	VectorSubtract(tw->end, tw->ctx->sphere.offset, endbottom);
 
 	// calculate top and bottom of the capsule spheres to collide with
 	for ( i = 0 ; i < 3 ; i++ ) {
@@ -1081,7 +1300,7 @@ void CM_TraceCapsuleThroughCapsule( traceWork_t *tw, clipHandle_t model ) {
 	VectorCopy(offset, bottom);
 	bottom[2] -= offs;
 	// expand radius of spheres
-	radius += sphere.radius;
+	radius += tw->ctx->sphere.radius;
 	// if there is horizontal movement
 	if ( tw->start[0] != tw->end[0] || tw->start[1] != tw->end[1] ) {
 		// height of the expanded cylinder is the height of both cylinders minus the radius of both spheres
@@ -1109,6 +1328,9 @@ void CM_TraceBoundingBoxThroughCapsule( traceWork_t *tw, clipHandle_t model ) {
 	clipHandle_t h;
 	cmodel_t *cmod;
 	int i;
+	cbrush_t *prevBoxBrush;
+	cbrush_t prevBox;
+	cplane_t prevBoxPlanes[12];
 
 	// mins maxs of the capsule
 	CM_ModelBounds(model, mins, maxs);
@@ -1123,15 +1345,26 @@ void CM_TraceBoundingBoxThroughCapsule( traceWork_t *tw, clipHandle_t model ) {
 	}
 
 	// replace the bounding box with the capsule
-	sphere.use = qtrue;
-	sphere.radius = ( size[1][0] > size[1][2] ) ? size[1][2]: size[1][0];
-	VectorSet( sphere.offset, 0, 0, size[1][2] - sphere.radius );
+	tw->ctx->sphere.use = qtrue;
+	tw->ctx->sphere.radius = ( size[1][0] > size[1][2] ) ? size[1][2]: size[1][0];
+	VectorSet( tw->ctx->sphere.offset, 0, 0, size[1][2] - tw->ctx->sphere.radius );
 
 	// replace the capsule with the bounding box
-	h = CM_TempBoxModel(tw->size[0], tw->size[1], qfalse);
+	// Added in OPM
+	//  use the box of the trace context so other threads can trace at the same time,
+	//  and put back the box the caller of the trace may have set on it
+	prevBoxBrush = tw->ctx->boxBrush;
+	prevBox = tw->ctx->box;
+	memcpy( prevBoxPlanes, tw->ctx->boxPlanes, sizeof( prevBoxPlanes ) );
+
+	h = CM_TempBoxModelContext( tw->ctx, tw->size[0], tw->size[1], qfalse );
 	// calculate collision
 	cmod = CM_ClipHandleToModel( h );
-	CM_TraceToLeaf( tw, &cmod->leaf );
+	CM_TraceToModel( tw, h, cmod );
+
+	tw->ctx->boxBrush = prevBoxBrush;
+	tw->ctx->box = prevBox;
+	memcpy( tw->ctx->boxPlanes, prevBoxPlanes, sizeof( prevBoxPlanes ) );
 }
 
 //=========================================================================================
@@ -1252,6 +1485,134 @@ void CM_TraceThroughTree( traceWork_t *tw, int num, float p1f, float p2f, vec3_t
 
 //======================================================================
 
+/*
+==================
+CM_CreateTraceContext
+
+Added in OPM
+The context is allocated with malloc, as the zone isn't thread-safe
+==================
+*/
+traceContext_t *CM_CreateTraceContext( void ) {
+	traceContext_t	*ctx;
+
+	ctx = calloc( 1, sizeof( *ctx ) );
+	if( !ctx ) {
+		Com_Error( ERR_FATAL, "CM_CreateTraceContext: out of memory" );
+	}
+
+	CM_InitBoxBrush( &ctx->box, ctx->boxSides, ctx->boxPlanes );
+
+	return ctx;
+}
+
+/*
+==================
+CM_FreeTraceContext
+
+Added in OPM
+==================
+*/
+void CM_FreeTraceContext( traceContext_t *ctx ) {
+	free( ctx->brushChecks );
+	free( ctx->surfaceChecks );
+	free( ctx->terrainChecks );
+	free( ctx );
+}
+
+/*
+==================
+CM_TempBoxModelContext
+
+Added in OPM
+Same as CM_TempBoxModel, the box is only used by the traces of the context
+==================
+*/
+clipHandle_t CM_TempBoxModelContext( traceContext_t *ctx, const vec3_t mins, const vec3_t maxs, int contents ) {
+	CM_SetBoxBrushBounds( &ctx->box, ctx->boxPlanes, mins, maxs, contents );
+	ctx->boxBrush = &ctx->box;
+
+	return BOX_MODEL_HANDLE;
+}
+
+/*
+==================
+CM_AllocTraceChecks
+
+Added in OPM
+==================
+*/
+static void CM_AllocTraceChecks( int **checks, int *size, int count ) {
+	if( *size >= count ) {
+		return;
+	}
+
+	free( *checks );
+
+	// the new checks are cleared, they will never match the
+	// checkcount of a trace as it only increases
+	*checks = calloc( count, sizeof( **checks ) );
+	if( !*checks ) {
+		Com_Error( ERR_FATAL, "CM_AllocTraceChecks: out of memory" );
+	}
+	*size = count;
+}
+
+/*
+==================
+CM_BeginTrace
+
+Added in OPM
+Makes sure the context can be used with the current map
+and starts a new multi-check avoidance
+==================
+*/
+static void CM_BeginTrace( traceContext_t *ctx ) {
+	// one more brush for the box model
+	CM_AllocTraceChecks( &ctx->brushChecks, &ctx->numBrushes, cm.numBrushes + 1 );
+	CM_AllocTraceChecks( &ctx->surfaceChecks, &ctx->numSurfaces, cm.numSurfaces + 1 );
+	CM_AllocTraceChecks( &ctx->terrainChecks, &ctx->numTerrain, cm.numTerrain + 1 );
+
+	ctx->checkcount++;
+}
+
+/*
+==================
+CM_TestInModel
+
+Added in OPM
+==================
+*/
+static void CM_TestInModel( traceWork_t *tw, clipHandle_t model, cmodel_t *cmod ) {
+	if( model == BOX_MODEL_HANDLE && tw->ctx->boxBrush ) {
+		// the box of the context isn't in any leaf
+		if( tw->ctx->boxBrush->contents & tw->contents ) {
+			CM_TestBoxInBrush( tw, tw->ctx->boxBrush );
+		}
+		return;
+	}
+
+	CM_TestInLeaf( tw, &cmod->leaf );
+}
+
+/*
+==================
+CM_TraceToModel
+
+Added in OPM
+==================
+*/
+static void CM_TraceToModel( traceWork_t *tw, clipHandle_t model, cmodel_t *cmod ) {
+	if( model == BOX_MODEL_HANDLE && tw->ctx->boxBrush ) {
+		if( tw->ctx->boxBrush->contents & tw->contents ) {
+			CM_TraceThroughBrush( tw, tw->ctx->boxBrush );
+		}
+		return;
+	}
+
+	CM_TraceToLeaf( tw, &cmod->leaf );
+}
+
 /*
 ==================
 CM_BoxTrace
@@ -1260,147 +1621,512 @@ CM_BoxTrace
 void CM_BoxTrace( trace_t *results, const vec3_t start, const vec3_t end,
 						  const vec3_t mins, const vec3_t maxs,
 						  clipHandle_t model, int brushmask, int cylinder ) {
-	int			i;
-	traceWork_t	tw;
-	vec3_t		offset;
-	cmodel_t	*cmod;
+	// Added in OPM
+	if( cm_record.traces && !model ) {
+		CM_RecordTrace( start, end, mins, maxs, brushmask, cylinder );
+	}
 
-	cmod = CM_ClipHandleToModel( model );
+	CM_BoxTraceContext( &cm_traceContext, results, start, end, mins, maxs, model, brushmask, cylinder );
+}
+
+/*
+==================
+CM_InitTraceWork
 
-	cm.checkcount++;		// for multi-check avoidance
+Added in OPM
+Sets up the trace work for a sweep from start to end
+==================
+*/
+static void CM_InitTraceWork( traceContext_t *ctx, traceWork_t *tw, const vec3_t start, const vec3_t end,
+						  const vec3_t mins, const vec3_t maxs, int brushmask, int cylinder ) {
+	int			i;
+	vec3_t		offset;
 
 	c_traces++;				// for statistics, may be zeroed
 
 	// fill in a default trace
-	Com_Memset( &tw, 0, sizeof( tw ) );
-	tw.trace.fraction = 1;	// assume it goes the entire distance until shown otherwise
+	Com_Memset( tw, 0, sizeof( *tw ) );
+	tw->ctx = ctx;
+	tw->trace.fraction = 1;	// assume it goes the entire distance until shown otherwise
 
 	// set basic parms
-	tw.trace.location = -1; // clear out unneeded location
-	tw.contents = brushmask;
+	tw->trace.location = -1; // clear out unneeded location
+	tw->contents = brushmask;
 
 	// adjust so that mins and maxs are always symetric, which
 	// avoids some complications with plane expanding of rotated
 	// bmodels
 	for( i = 0; i < 3; i++ ) {
 		offset[ i ] = ( mins[ i ] + maxs[ i ] ) * 0.5;
-		tw.size[ 0 ][ i ] = mins[ i ] - offset[ i ];
-		tw.size[ 1 ][ i ] = maxs[ i ] - offset[ i ];
-		tw.start[ i ] = start[ i ] + offset[ i ];
-		tw.end[ i ] = end[ i ] + offset[ i ];
+		tw->size[ 0 ][ i ] = mins[ i ] - offset[ i ];
+		tw->size[ 1 ][ i ] = maxs[ i ] - offset[ i ];
+		tw->start[ i ] = start[ i ] + offset[ i ];
+		tw->end[ i ] = end[ i ] + offset[ i ];
 	}
 
-	tw.height = tw.size[ 1 ][ 2 ];
-	tw.radius = tw.size[ 1 ][ 0 ];
+	tw->height = tw->size[ 1 ][ 2 ];
+	tw->radius = tw->size[ 1 ][ 0 ];
 
-	if( cylinder && !sphere.use )
+	if( cylinder && !ctx->sphere.use )
 	{
-		sphere.use = qtrue;
-		sphere.radius = ( tw.size[ 1 ][ 0 ] > tw.size[ 1 ][ 2 ] ) ? tw.size[ 1 ][ 2 ] : tw.size[ 1 ][ 0 ];
-		VectorSet( sphere.offset, 0, 0, tw.size[ 1 ][ 2 ] - sphere.radius );
+		ctx->sphere.use = qtrue;
+		ctx->sphere.radius = ( tw->size[ 1 ][ 0 ] > tw->size[ 1 ][ 2 ] ) ? tw->size[ 1 ][ 2 ] : tw->size[ 1 ][ 0 ];
+		VectorSet( ctx->sphere.offset, 0, 0, tw->size[ 1 ][ 2 ] - ctx->sphere.radius );
 	}
-	tw.maxOffset = tw.size[ 1 ][ 0 ] + tw.size[ 1 ][ 1 ] + tw.size[ 1 ][ 2 ];
+	tw->maxOffset = tw->size[ 1 ][ 0 ] + tw->size[ 1 ][ 1 ] + tw->size[ 1 ][ 2 ];
 
-	// tw.offsets[signbits] = vector to apropriate corner from origin
-	tw.offsets[ 0 ][ 0 ] = tw.size[ 0 ][ 0 ];
-	tw.offsets[ 0 ][ 1 ] = tw.size[ 0 ][ 1 ];
-	tw.offsets[ 0 ][ 2 ] = tw.size[ 0 ][ 2 ];
+	// tw->offsets[signbits] = vector to apropriate corner from origin
+	tw->offsets[ 0 ][ 0 ] = tw->size[ 0 ][ 0 ];
+	tw->offsets[ 0 ][ 1 ] = tw->size[ 0 ][ 1 ];
+	tw->offsets[ 0 ][ 2 ] = tw->size[ 0 ][ 2 ];
 
-	tw.offsets[ 1 ][ 0 ] = tw.size[ 1 ][ 0 ];
-	tw.offsets[ 1 ][ 1 ] = tw.size[ 0 ][ 1 ];
-	tw.offsets[ 1 ][ 2 ] = tw.size[ 0 ][ 2 ];
+	tw->offsets[ 1 ][ 0 ] = tw->size[ 1 ][ 0 ];
+	tw->offsets[ 1 ][ 1 ] = tw->size[ 0 ][ 1 ];
+	tw->offsets[ 1 ][ 2 ] = tw->size[ 0 ][ 2 ];
 
-	tw.offsets[ 2 ][ 0 ] = tw.size[ 0 ][ 0 ];
-	tw.offsets[ 2 ][ 1 ] = tw.size[ 1 ][ 1 ];
-	tw.offsets[ 2 ][ 2 ] = tw.size[ 0 ][ 2 ];
+	tw->offsets[ 2 ][ 0 ] = tw->size[ 0 ][ 0 ];
+	tw->offsets[ 2 ][ 1 ] = tw->size[ 1 ][ 1 ];
+	tw->offsets[ 2 ][ 2 ] = tw->size[ 0 ][ 2 ];
 
-	tw.offsets[ 3 ][ 0 ] = tw.size[ 1 ][ 0 ];
-	tw.offsets[ 3 ][ 1 ] = tw.size[ 1 ][ 1 ];
-	tw.offsets[ 3 ][ 2 ] = tw.size[ 0 ][ 2 ];
+	tw->offsets[ 3 ][ 0 ] = tw->size[ 1 ][ 0 ];
+	tw->offsets[ 3 ][ 1 ] = tw->size[ 1 ][ 1 ];
+	tw->offsets[ 3 ][ 2 ] = tw->size[ 0 ][ 2 ];
 
-	tw.offsets[ 4 ][ 0 ] = tw.size[ 0 ][ 0 ];
-	tw.offsets[ 4 ][ 1 ] = tw.size[ 0 ][ 1 ];
-	tw.offsets[ 4 ][ 2 ] = tw.size[ 1 ][ 2 ];
+	tw->offsets[ 4 ][ 0 ] = tw->size[ 0 ][ 0 ];
+	tw->offsets[ 4 ][ 1 ] = tw->size[ 0 ][ 1 ];
+	tw->offsets[ 4 ][ 2 ] = tw->size[ 1 ][ 2 ];
 
-	tw.offsets[ 5 ][ 0 ] = tw.size[ 1 ][ 0 ];
-	tw.offsets[ 5 ][ 1 ] = tw.size[ 0 ][ 1 ];
-	tw.offsets[ 5 ][ 2 ] = tw.size[ 1 ][ 2 ];
+	tw->offsets[ 5 ][ 0 ] = tw->size[ 1 ][ 0 ];
+	tw->offsets[ 5 ][ 1 ] = tw->size[ 0 ][ 1 ];
+	tw->offsets[ 5 ][ 2 ] = tw->size[ 1 ][ 2 ];
 
-	tw.offsets[ 6 ][ 0 ] = tw.size[ 0 ][ 0 ];
-	tw.offsets[ 6 ][ 1 ] = tw.size[ 1 ][ 1 ];
-	tw.offsets[ 6 ][ 2 ] = tw.size[ 1 ][ 2 ];
+	tw->offsets[ 6 ][ 0 ] = tw->size[ 0 ][ 0 ];
+	tw->offsets[ 6 ][ 1 ] = tw->size[ 1 ][ 1 ];
+	tw->offsets[ 6 ][ 2 ] = tw->size[ 1 ][ 2 ];
 
-	tw.offsets[ 7 ][ 0 ] = tw.size[ 1 ][ 0 ];
-	tw.offsets[ 7 ][ 1 ] = tw.size[ 1 ][ 1 ];
-	tw.offsets[ 7 ][ 2 ] = tw.size[ 1 ][ 2 ];
+	tw->offsets[ 7 ][ 0 ] = tw->size[ 1 ][ 0 ];
+	tw->offsets[ 7 ][ 1 ] = tw->size[ 1 ][ 1 ];
+	tw->offsets[ 7 ][ 2 ] = tw->size[ 1 ][ 2 ];
 
 	//
 	// calculate bounds
 	//
 	for( i = 0; i < 3; i++ ) {
-		if( tw.start[ i ] < tw.end[ i ] ) {
-			tw.bounds[ 0 ][ i ] = tw.start[ i ] + tw.size[ 0 ][ i ];
-			tw.bounds[ 1 ][ i ] = tw.end[ i ] + tw.size[ 1 ][ i ];
+		if( tw->start[ i ] < tw->end[ i ] ) {
+			tw->bounds[ 0 ][ i ] = tw->start[ i ] + tw->size[ 0 ][ i ];
+			tw->bounds[ 1 ][ i ] = tw->end[ i ] + tw->size[ 1 ][ i ];
 		}
 		else {
-			tw.bounds[ 0 ][ i ] = tw.end[ i ] + tw.size[ 0 ][ i ];
-			tw.bounds[ 1 ][ i ] = tw.start[ i ] + tw.size[ 1 ][ i ];
+			tw->bounds[ 0 ][ i ] = tw->end[ i ] + tw->size[ 0 ][ i ];
+			tw->bounds[ 1 ][ i ] = tw->start[ i ] + tw->size[ 1 ][ i ];
 		}
 	}
+}
+
+/*
+==================
+CM_InitSweepExtents
 
+Added in OPM
+==================
+*/
+static void CM_InitSweepExtents( traceWork_t *tw ) {
 	//
-	// check for position test special case
+	// check for point special case
 	//
-	if( start[ 0 ] == end[ 0 ] && start[ 1 ] == end[ 1 ] && start[ 2 ] == end[ 2 ] ) {
-		if( model ) {
-			CM_TestInLeaf( &tw, &cmod->leaf );
-		} else {
-			CM_PositionTest( &tw );
-		}
+	if( tw->size[ 0 ][ 0 ] == 0 && tw->size[ 0 ][ 1 ] == 0 && tw->size[ 0 ][ 2 ] == 0 ) {
+		tw->isPoint = qtrue;
+		VectorClear( tw->extents );
 	}
 	else {
-		//
-		// check for point special case
-		//
-		if( tw.size[ 0 ][ 0 ] == 0 && tw.size[ 0 ][ 1 ] == 0 && tw.size[ 0 ][ 2 ] == 0 ) {
-			tw.isPoint = qtrue;
-			VectorClear( tw.extents );
-		}
-		else {
-			tw.isPoint = qfalse;
-			tw.extents[ 0 ] = tw.size[ 1 ][ 0 ];
-			tw.extents[ 1 ] = tw.size[ 1 ][ 1 ];
-			tw.extents[ 2 ] = tw.size[ 1 ][ 2 ];
+		tw->isPoint = qfalse;
+		tw->extents[ 0 ] = tw->size[ 1 ][ 0 ];
+		tw->extents[ 1 ] = tw->size[ 1 ][ 1 ];
+		tw->extents[ 2 ] = tw->size[ 1 ][ 2 ];
+	}
+}
+
+/*
+==================
+CM_FinishTraceWork
+
+Added in OPM
+==================
+*/
+static void CM_FinishTraceWork( traceWork_t *tw, trace_t *results, const vec3_t start, const vec3_t end ) {
+	int			i;
+
+	// generate endpos from the original, unmodified start/end
+	if( tw->trace.fraction == 1 ) {
+		VectorCopy( end, tw->trace.endpos );
+	}
+	else {
+		for( i = 0; i<3; i++ ) {
+			tw->trace.endpos[ i ] = start[ i ] + tw->trace.fraction * ( end[ i ] - start[ i ] );
+		}
+	}
+
+	// If allsolid is set (was entirely inside something solid), the plane is not valid.
+	// If fraction == 1.0, we never hit anything, and thus the plane is not valid.
+	// Otherwise, the normal on the plane should have unit length
+	assert( tw->trace.allsolid ||
+		tw->trace.fraction == 1.0 ||
+		VectorLengthSquared( tw->trace.plane.normal ) > 0.9999 );
+	*results = tw->trace;
+	tw->ctx->sphere.use = qfalse;
+}
+
+/*
+==================
+CM_BoxTraceContext
+==================
+*/
+void CM_BoxTraceContext( traceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t end,
+						  const vec3_t mins, const vec3_t maxs,
+						  clipHandle_t model, int brushmask, int cylinder ) {
+	traceWork_t	tw;
+	cmodel_t	*cmod;
+
+	cmod = CM_ClipHandleToModel( model );
+
+	CM_BeginTrace( ctx );	// for multi-check avoidance
+
+	CM_InitTraceWork( ctx, &tw, start, end, mins, maxs, brushmask, cylinder );
+
+	//
+	// check for position test special case
+	//
+	if( start[ 0 ] == end[ 0 ] && start[ 1 ] == end[ 1 ] && start[ 2 ] == end[ 2 ] ) {
+		if( model ) {
+			CM_TestInModel( &tw, model, cmod );
+		} else {
+			CM_PositionTest( &tw );
 		}
+	}
+	else {
+		CM_InitSweepExtents( &tw );
 
 		//
 		// general sweeping through world
 		//
 		if( model ) {
-			CM_TraceToLeaf( &tw, &cmod->leaf );
+			CM_TraceToModel( &tw, model, cmod );
 		} else {
 			CM_TraceThroughTree( &tw, 0, 0, 1, tw.start, tw.end );
 		}
 	}
 
-	// generate endpos from the original, unmodified start/end
-	if( tw.trace.fraction == 1 ) {
-		VectorCopy( end, tw.trace.endpos );
+	CM_FinishTraceWork( &tw, results, start, end );
+}
+
+typedef struct {
+	leafList_t	ll;
+	traceWork_t	*tw;	// for the contents and the multi-check avoidance
+} batchList_t;
+
+/*
+================
+CM_StoreBatchLeaf
+
+Added in OPM
+Adds what can be hit in the leaf to the batch of the context
+================
+*/
+static void CM_StoreBatchLeaf( leafList_t *ll, int nodenum ) {
+	traceWork_t		*tw;
+	traceContext_t	*ctx;
+	cLeaf_t			*leaf;
+	cbrush_t		*b;
+	cPatch_t		*patch;
+	cTerrain_t		*terrain;
+	int				surfaceNum;
+	int				k;
+
+	if( ll->overflowed ) {
+		return;
 	}
-	else {
-		for( i = 0; i<3; i++ ) {
-			tw.trace.endpos[ i ] = start[ i ] + tw.trace.fraction * ( end[ i ] - start[ i ] );
+
+	tw = ( ( batchList_t * )ll )->tw;
+	ctx = tw->ctx;
+	leaf = &cm.leafs[ -1 - nodenum ];
+
+	for( k = 0; k < leaf->numLeafBrushes; k++ ) {
+		b = &cm.brushes[ cm.leafbrushes[ leaf->firstLeafBrush + k ] ];
+		if( !CM_FirstBrushTest( tw, b ) ) {
+			continue;	// already stored from another leaf
 		}
+
+		if( !( b->contents & tw->contents ) ) {
+			continue;
+		}
+
+		if( !CM_BoundsIntersect( b->bounds[ 0 ], b->bounds[ 1 ], ll->bounds[ 0 ], ll->bounds[ 1 ] ) ) {
+			continue;
+		}
+
+		if( ctx->numBatchBrushes >= MAX_BATCH_BRUSHES ) {
+			ll->overflowed = qtrue;
+			return;
+		}
+		ctx->batchBrushes[ ctx->numBatchBrushes++ ] = b;
 	}
 
-	// If allsolid is set (was entirely inside something solid), the plane is not valid.
-	// If fraction == 1.0, we never hit anything, and thus the plane is not valid.
-	// Otherwise, the normal on the plane should have unit length
-	assert( tw.trace.allsolid ||
-		tw.trace.fraction == 1.0 ||
-		VectorLengthSquared( tw.trace.plane.normal ) > 0.9999 );
-	*results = tw.trace;
-	sphere.use = qfalse;
+#ifdef BSPC
+	if( 1 ) {
+#else
+	if( !cm_noCurves->integer ) {
+#endif //BSPC
+		for( k = 0; k < leaf->numLeafSurfaces; k++ ) {
+			surfaceNum = cm.leafsurfaces[ leaf->firstLeafSurface + k ];
+			patch = cm.surfaces[ surfaceNum ];
+			if( !patch ) {
+				continue;
+			}
+			if( !CM_FirstSurfaceTest( tw, surfaceNum ) ) {
+				continue;
+			}
+
+			if( !( patch->contents & tw->contents ) ) {
+				continue;
+			}
+
+			if( ctx->numBatchPatches >= MAX_BATCH_PATCHES ) {
+				ll->overflowed = qtrue;
+				return;
+			}
+			ctx->batchPatches[ ctx->numBatchPatches++ ] = patch;
+		}
+	}
+
+	for( k = 0; k < leaf->numLeafTerrains; k++ ) {
+		terrain = cm.leafterrains[ leaf->firstLeafTerrain + k ];
+		if( !terrain ) {
+			continue;
+		}
+		if( !CM_FirstTerrainTest( tw, terrain - cm.terrain ) ) {
+			continue;
+		}
+
+		if( ctx->numBatchTerrain >= MAX_BATCH_TERRAIN ) {
+			ll->overflowed = qtrue;
+			return;
+		}
+		ctx->batchTerrain[ ctx->numBatchTerrain++ ] = terrain;
+	}
+}
+
+/*
+================
+CM_TraceThroughBatch
+
+Added in OPM
+Same as CM_TraceToLeaf, with everything the batch can hit
+================
+*/
+static void CM_TraceThroughBatch( traceWork_t *tw ) {
+	traceContext_t	*ctx;
+	cbrush_t		*b;
+	int				k;
+
+	ctx = tw->ctx;
+
+	for( k = 0; k < ctx->numBatchBrushes; k++ ) {
+		b = ctx->batchBrushes[ k ];
+
+		// skip the brushes that are only around the other traces
+		if( !CM_BoundsIntersect( tw->bounds[ 0 ], tw->bounds[ 1 ], b->bounds[ 0 ], b->bounds[ 1 ] ) ) {
+			continue;
+		}
+
+		CM_TraceThroughBrush( tw, b );
+		if( !tw->trace.fraction ) {
+			return;
+		}
+	}
+
+	for( k = 0; k < ctx->numBatchPatches; k++ ) {
+		CM_TraceThroughPatch( tw, ctx->batchPatches[ k ] );
+		if( !tw->trace.fraction ) {
+			return;
+		}
+	}
+
+	for( k = 0; k < ctx->numBatchTerrain; k++ ) {
+		CM_TraceThroughTerrain( tw, ctx->batchTerrain[ k ] );
+		if( !tw->trace.fraction ) {
+			return;
+		}
+	}
+}
+
+/*
+==================
+CM_BoxTraceBatch
+==================
+*/
+void CM_BoxTraceBatch( trace_t *results, const vec3_t *starts, const vec3_t *ends, int count,
+						  const vec3_t mins, const vec3_t maxs, int brushmask, int cylinder ) {
+	CM_BoxTraceBatchContext( &cm_traceContext, results, starts, ends, count, mins, maxs, brushmask, cylinder );
+}
+
+/*
+==================
+CM_BoxTraceBatchContext
+
+Added in OPM
+Traces a box through the world for each pair of start and end points,
+same as calling CM_BoxTrace for each of them.
+The tree is walked once for the bounds of all the traces, so it's
+faster when the traces are close to each other, like the traces
+of a weapon spread or the probes around an entity
+==================
+*/
+void CM_BoxTraceBatchContext( traceContext_t *ctx, trace_t *results, const vec3_t *starts, const vec3_t *ends, int count,
+						  const vec3_t mins, const vec3_t maxs, int brushmask, int cylinder ) {
+	batchList_t	bl;
+	traceWork_t	tw;
+	int			i;
+
+	if( count < 2 ) {
+		for( i = 0; i < count; i++ ) {
+			CM_BoxTraceContext( ctx, &results[ i ], starts[ i ], ends[ i ], mins, maxs, 0, brushmask, cylinder );
+		}
+		return;
+	}
+
+	// the bounds of all the traces
+	ClearBounds( bl.ll.bounds[ 0 ], bl.ll.bounds[ 1 ] );
+	for( i = 0; i < count; i++ ) {
+		AddPointToBounds( starts[ i ], bl.ll.bounds[ 0 ], bl.ll.bounds[ 1 ] );
+		AddPointToBounds( ends[ i ], bl.ll.bounds[ 0 ], bl.ll.bounds[ 1 ] );
+	}
+
+	for( i = 0; i < 3; i++ ) {
+		bl.ll.bounds[ 0 ][ i ] += mins[ i ] - 1;
+		bl.ll.bounds[ 1 ][ i ] += maxs[ i ] + 1;
+	}
+
+	CM_BeginTrace( ctx );	// for multi-check avoidance
+
+	ctx->numBatchBrushes = 0;
+	ctx->numBatchPatches = 0;
+	ctx->numBatchTerrain = 0;
+
+	Com_Memset( &tw, 0, sizeof( tw ) );
+	tw.ctx = ctx;
+	tw.contents = brushmask;
+
+	bl.tw = &tw;
+	bl.ll.count = 0;
+	bl.ll.maxcount = 0;
+	bl.ll.list = NULL;
+	bl.ll.storeLeafs = CM_StoreBatchLeaf;
+	bl.ll.lastLeaf = 0;
+	bl.ll.overflowed = qfalse;
+
+	CM_BoxLeafnums_r( &bl.ll, 0 );
+
+	if( bl.ll.overflowed ) {
+		// the traces are too far apart to share the walk
+		for( i = 0; i < count; i++ ) {
+			CM_BoxTraceContext( ctx, &results[ i ], starts[ i ], ends[ i ], mins, maxs, 0, brushmask, cylinder );
+		}
+		return;
+	}
+
+	for( i = 0; i < count; i++ ) {
+		CM_InitTraceWork( ctx, &tw, starts[ i ], ends[ i ], mins, maxs, brushmask, cylinder );
+
+		if( VectorCompare( starts[ i ], ends[ i ] ) ) {
+			CM_PositionTest( &tw );
+		} else {
+			CM_InitSweepExtents( &tw );
+			CM_TraceThroughBatch( &tw );
+		}
+
+		CM_FinishTraceWork( &tw, &results[ i ], starts[ i ], ends[ i ] );
+	}
+}
+
+#define TRACEBATCH_CHUNKS		64
+#define TRACEBATCH_MIN_CHUNK	32
+
+typedef struct {
+	trace_t			*results;
+	const vec3_t	*starts;
+	const vec3_t	*ends;
+	int				count;
+	int				numChunks;
+	const float		*mins;
+	const float		*maxs;
+	int				brushmask;
+	int				cylinder;
+} traceBatchJob_t;
+
+// Added in OPM
+//  one context for each chunk of CM_BoxTraceBatchJobs, kept like cm_traceContext
+static traceContext_t *cm_batchContexts[ TRACEBATCH_CHUNKS ];
+
+/*
+==================
+CM_BoxTraceBatchJob
+
+Traces a chunk of the batch with the context of the chunk
+==================
+*/
+static void CM_BoxTraceBatchJob( void *data, int index ) {
+	const traceBatchJob_t	*job = ( const traceBatchJob_t * )data;
+	int						start, end;
+
+	start = index * job->count / job->numChunks;
+	end = ( index + 1 ) * job->count / job->numChunks;
+
+	CM_BoxTraceBatchContext( cm_batchContexts[ index ], &job->results[ start ], &job->starts[ start ], &job->ends[ start ],
+		end - start, job->mins, job->maxs, job->brushmask, job->cylinder );
+}
+
+/*
+==================
+CM_BoxTraceBatchJobs
+
+Added in OPM
+Same as CM_BoxTraceBatch, but the traces are split in contiguous chunks
+that are traced at the same time on up to numThreads threads, each chunk
+with its own context. Neighbour traces should be next to each other so
+the chunks can share their tree walk.
+Must be called from the main thread, the contexts are shared by the calls
+==================
+*/
+void CM_BoxTraceBatchJobs( trace_t *results, const vec3_t *starts, const vec3_t *ends, int count,
+						  const vec3_t mins, const vec3_t maxs, int brushmask, int cylinder, int numThreads ) {
+	traceBatchJob_t	job;
+	int				i;
+
+	if( numThreads <= 1 || count < TRACEBATCH_MIN_CHUNK * 2 ) {
+		CM_BoxTraceBatchContext( &cm_traceContext, results, starts, ends, count, mins, maxs, brushmask, cylinder );
+		return;
+	}
+
+	job.results = results;
+	job.starts = starts;
+	job.ends = ends;
+	job.count = count;
+	job.numChunks = count / TRACEBATCH_MIN_CHUNK;
+	if( job.numChunks > TRACEBATCH_CHUNKS ) {
+		job.numChunks = TRACEBATCH_CHUNKS;
+	}
+	job.mins = mins;
+	job.maxs = maxs;
+	job.brushmask = brushmask;
+	job.cylinder = cylinder;
+
+	for( i = 0; i < job.numChunks; i++ ) {
+		if( !cm_batchContexts[ i ] ) {
+			cm_batchContexts[ i ] = CM_CreateTraceContext();
+		}
+	}
+
+	Com_RunJobs( CM_BoxTraceBatchJob, &job, job.numChunks, numThreads );
 }
 
 /*
@@ -1415,6 +2141,18 @@ void CM_TransformedBoxTrace( trace_t *results, const vec3_t start, const vec3_t
 						  const vec3_t mins, const vec3_t maxs,
 						  clipHandle_t model, int brushmask,
 						  const vec3_t origin, const vec3_t angles, int cylinder ) {
+	CM_TransformedBoxTraceContext( &cm_traceContext, results, start, end, mins, maxs, model, brushmask, origin, angles, cylinder );
+}
+
+/*
+==================
+CM_TransformedBoxTraceContext
+==================
+*/
+void CM_TransformedBoxTraceContext( traceContext_t *ctx, trace_t *results, const vec3_t start, const vec3_t end,
+						  const vec3_t mins, const vec3_t maxs,
+						  clipHandle_t model, int brushmask,
+						  const vec3_t origin, const vec3_t angles, int cylinder ) {
 	trace_t		trace;
 	vec3_t		start_l, end_l;
 	vec3_t		a;
@@ -1453,9 +2191,9 @@ void CM_TransformedBoxTrace( trace_t *results, const vec3_t start, const vec3_t
 	halfwidth = symetricSize[ 1 ][ 0 ];
 	halfheight = symetricSize[ 1 ][ 2 ];
 
-	sphere.use = cylinder;
-	sphere.radius = ( halfwidth > halfheight ) ? halfheight : halfwidth;
-	t = halfheight - sphere.radius;
+	ctx->sphere.use = cylinder;
+	ctx->sphere.radius = ( halfwidth > halfheight ) ? halfheight : halfwidth;
+	t = halfheight - ctx->sphere.radius;
 
 	if( rotated ) {
 		AngleVectorsLeft( angles, forward, left, up );
@@ -1470,18 +2208,18 @@ void CM_TransformedBoxTrace( trace_t *results, const vec3_t start, const vec3_t
 		end_l[ 1 ] = DotProduct( temp, left );
 		end_l[ 2 ] = DotProduct( temp, up );
 
-		sphere.offset[ 0 ] = forward[ 2 ] * t;
-		sphere.offset[ 1 ] = left[ 2 ] * t;
-		sphere.offset[ 2 ] = up[ 2 ] * t;
+		ctx->sphere.offset[ 0 ] = forward[ 2 ] * t;
+		ctx->sphere.offset[ 1 ] = left[ 2 ] * t;
+		ctx->sphere.offset[ 2 ] = up[ 2 ] * t;
 	}
 	else {
-		VectorSet( sphere.offset, 0, 0, t );
+		VectorSet( ctx->sphere.offset, 0, 0, t );
 	}
 
 	// sweep the box through the model
-	CM_BoxTrace( &trace, start_l, end_l, symetricSize[0], symetricSize[1], model, brushmask, cylinder );
+	CM_BoxTraceContext( ctx, &trace, start_l, end_l, symetricSize[0], symetricSize[1], model, brushmask, cylinder );
 
-	sphere.use = qfalse;
+	ctx->sphere.use = qfalse;
 
 	// if the bmodel was rotated and there was a collision
 	if ( rotated && trace.fraction != 1.0 ) {
@@ -1546,6 +2284,7 @@ qboolean CM_SightTraceThroughBrush( traceWork_t *tw, cbrush_t *brush )
 	float			dist;
 	float			enterFrac, leaveFrac, leaveFrac2;
 	float			d1, d2;
+	float			planeDist1[4], planeDist2[4];
 	qboolean		startout;
 	float			f;
 	cbrushside_t	*side, *leadside, *leadside2;
@@ -1564,7 +2303,7 @@ qboolean CM_SightTraceThroughBrush( traceWork_t *tw, cbrush_t *brush )
 
 	leadside = NULL;
 	if( !( brush->contents & CONTENTS_FENCE ) || !tw->isPoint ) {
-		if( sphere.use ) {
+		if( tw->ctx->sphere.use ) {
 			//
 			// compare the trace against all planes of the brush
 			// find the latest time the trace crosses a plane towards the interior
@@ -1575,14 +2314,14 @@ qboolean CM_SightTraceThroughBrush( traceWork_t *tw, cbrush_t *brush )
 				plane = side->plane;
 
 				// find the closest point on the capsule to the plane
-				t = DotProduct( plane->normal, sphere.offset );
+				t = DotProduct( plane->normal, tw->ctx->sphere.offset );
 				if( t < 0 )
 				{
 					t = -t;
 				}
 
 				// adjust the plane distance apropriately for radius
-				dist = t + plane->dist + sphere.radius;
+				dist = t + plane->dist + tw->ctx->sphere.radius;
 
 				d1 = DotProduct( tw->start, plane->normal ) - dist;
 				d2 = DotProduct( tw->end, plane->normal ) - dist;
@@ -1632,11 +2371,12 @@ qboolean CM_SightTraceThroughBrush( traceWork_t *tw, cbrush_t *brush )
 				side = brush->sides + i;
 				plane = side->plane;
 
-				// adjust the plane distance apropriately for mins/maxs
-				dist = plane->dist - DotProduct( tw->offsets[ plane->signbits ], plane->normal );
+				if( !( i & 3 ) ) {
+					CM_BrushPlaneDistances( tw, side, brush->numsides - i, planeDist1, planeDist2 );
+				}
 
-				d1 = DotProduct( tw->start, plane->normal ) - dist;
-				d2 = DotProduct( tw->end, plane->normal ) - dist;
+				d1 = planeDist1[ i & 3 ];
+				d2 = planeDist2[ i & 3 ];
 
 				// if it doesn't cross the plane, the plane isn't relevent
 				if( d1 <= 0 && d2 <= 0 ) {
@@ -1698,11 +2438,12 @@ qboolean CM_SightTraceThroughBrush( traceWork_t *tw, cbrush_t *brush )
 			side = brush->sides + i;
 			plane = side->plane;
 
-			// adjust the plane distance apropriately for mins/maxs
-			dist = plane->dist - DotProduct( tw->offsets[ plane->signbits ], plane->normal );
+			if( !( i & 3 ) ) {
+				CM_BrushPlaneDistances( tw, side, brush->numsides - i, planeDist1, planeDist2 );
+			}
 
-			d1 = DotProduct( tw->start, plane->normal ) - dist;
-			d2 = DotProduct( tw->end, plane->normal ) - dist;
+			d1 = planeDist1[ i & 3 ];
+			d2 = planeDist2[ i & 3 ];
 
 			// if it doesn't cross the plane, the plane isn't relevent
 			if( d1 <= 0 && d2 <= 0 ) {
@@ -1781,10 +2522,9 @@ qboolean CM_SightTraceToLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 	// test box position against all brushes in the leaf
 	for( k = 0; k<leaf->numLeafBrushes; k++ ) {
 		b = &cm.brushes[ cm.leafbrushes[ leaf->firstLeafBrush + k ] ];
-		if( b->checkcount == cm.checkcount ) {
+		if( !CM_FirstBrushTest( tw, b ) ) {
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = cm.checkcount;
 
 		if( !( b->contents & tw->contents ) ) {
 			continue;
@@ -1806,10 +2546,9 @@ qboolean CM_SightTraceToLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 			if( !patch ) {
 				continue;
 			}
-			if( patch->checkcount == cm.checkcount ) {
+			if( !CM_FirstSurfaceTest( tw, cm.leafsurfaces[ leaf->firstLeafSurface + k ] ) ) {
 				continue;	// already checked this brush in another leaf
 			}
-			patch->checkcount = cm.checkcount;
 
 			if( !( patch->contents & tw->contents ) ) {
 				continue;
@@ -1827,10 +2566,9 @@ qboolean CM_SightTraceToLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 		if( !terrain ) {
 			continue;
 		}
-		if( terrain->checkcount == cm.checkcount ) {
+		if( !CM_FirstTerrainTest( tw, terrain - cm.terrain ) ) {
 			continue;
 		}
-		terrain->checkcount = cm.checkcount;
 
 		if( !CM_SightTraceThroughTerrain( tw, terrain ) ) {
 			return qfalse;
@@ -1953,12 +2691,40 @@ qboolean CM_SightTraceThroughTree( traceWork_t *tw, int num, float p1f, float p2
 	return CM_SightTraceThroughTree( tw, node->children[ side ^ 1 ], midf, p2f, mid, p2 );
 }
 
+/*
+==================
+CM_SightTraceToModel
+
+Added in OPM
+==================
+*/
+static qboolean CM_SightTraceToModel( traceWork_t *tw, clipHandle_t model, cmodel_t *cmod ) {
+	if( model == BOX_MODEL_HANDLE && tw->ctx->boxBrush ) {
+		if( tw->ctx->boxBrush->contents & tw->contents ) {
+			return CM_SightTraceThroughBrush( tw, tw->ctx->boxBrush );
+		}
+		return qtrue;
+	}
+
+	return CM_SightTraceToLeaf( tw, &cmod->leaf );
+}
+
 /*
 ==================
 CM_BoxSightTrace
 ==================
 */
 qboolean CM_BoxSightTrace( const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, clipHandle_t model, int brushmask, qboolean cylinder )
+{
+	return CM_BoxSightTraceContext( &cm_traceContext, start, end, mins, maxs, model, brushmask, cylinder );
+}
+
+/*
+==================
+CM_BoxSightTraceContext
+==================
+*/
+qboolean CM_BoxSightTraceContext( traceContext_t *ctx, const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, clipHandle_t model, int brushmask, qboolean cylinder )
 {
 	int			i;
 	traceWork_t	tw;
@@ -1968,7 +2734,7 @@ qboolean CM_BoxSightTrace( const vec3_t start, const vec3_t end, const vec3_t mi
 
 	cmod = CM_ClipHandleToModel( model );
 
-	cm.checkcount++;		// for multi-check avoidance
+	CM_BeginTrace( ctx );	// for multi-check avoidance
 
 	c_traces++;				// for statistics, may be zeroed
 
@@ -1978,6 +2744,7 @@ qboolean CM_BoxSightTrace( const vec3_t start, const vec3_t end, const vec3_t mi
 
 	// fill in a default trace
 	Com_Memset( &tw, 0, sizeof( tw ) );
+	tw.ctx = ctx;
 	tw.trace.fraction = 1;	// assume it goes the entire distance until shown otherwise
 
 	// set basic parms
@@ -1997,11 +2764,11 @@ qboolean CM_BoxSightTrace( const vec3_t start, const vec3_t end, const vec3_t mi
 	tw.height = tw.size[ 1 ][ 2 ];
 	tw.radius = tw.size[ 1 ][ 0 ];
 
-	if( cylinder && !sphere.use )
+	if( cylinder && !ctx->sphere.use )
 	{
-		sphere.use = qtrue;
-		sphere.radius = ( tw.size[ 1 ][ 0 ] > tw.size[ 1 ][ 2 ] ) ? tw.size[ 1 ][ 2 ] : tw.size[ 1 ][ 0 ];
-		VectorSet( sphere.offset, 0, 0, tw.size[ 1 ][ 2 ] - sphere.radius );
+		ctx->sphere.use = qtrue;
+		ctx->sphere.radius = ( tw.size[ 1 ][ 0 ] > tw.size[ 1 ][ 2 ] ) ? tw.size[ 1 ][ 2 ] : tw.size[ 1 ][ 0 ];
+		VectorSet( ctx->sphere.offset, 0, 0, tw.size[ 1 ][ 2 ] - ctx->sphere.radius );
 	}
 	tw.maxOffset = tw.size[ 1 ][ 0 ] + tw.size[ 1 ][ 1 ] + tw.size[ 1 ][ 2 ];
 
@@ -2057,7 +2824,7 @@ qboolean CM_BoxSightTrace( const vec3_t start, const vec3_t end, const vec3_t mi
 	//
 	if( start[ 0 ] == end[ 0 ] && start[ 1 ] == end[ 1 ] && start[ 2 ] == end[ 2 ] ) {
 		if( model ) {
-			CM_TestInLeaf( &tw, &cmod->leaf );
+			CM_TestInModel( &tw, model, cmod );
 		}
 		else {
 			CM_PositionTest( &tw );
@@ -2083,14 +2850,14 @@ qboolean CM_BoxSightTrace( const vec3_t start, const vec3_t end, const vec3_t mi
 		// general sweeping through world
 		//
 		if( model ) {
-			bPassed = CM_SightTraceToLeaf( &tw, &cmod->leaf );
+			bPassed = CM_SightTraceToModel( &tw, model, cmod );
 		}
 		else {
 			bPassed = CM_SightTraceThroughTree( &tw, 0, 0, 1, tw.start, tw.end );
 		}
 	}
 
-	sphere.use = qfalse;
+	ctx->sphere.use = qfalse;
 
 	return bPassed;
 }
@@ -2101,6 +2868,16 @@ CM_TransformedBoxSightTrace
 ==================
 */
 qboolean CM_TransformedBoxSightTrace( const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, clipHandle_t model, int brushmask, const vec3_t origin, const vec3_t angles, qboolean cylinder )
+{
+	return CM_TransformedBoxSightTraceContext( &cm_traceContext, start, end, mins, maxs, model, brushmask, origin, angles, cylinder );
+}
+
+/*
+==================
+CM_TransformedBoxSightTraceContext
+==================
+*/
+qboolean CM_TransformedBoxSightTraceContext( traceContext_t *ctx, const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, clipHandle_t model, int brushmask, const vec3_t origin, const vec3_t angles, qboolean cylinder )
 {
 	vec3_t		start_l, end_l;
 	vec3_t		forward, left, up;
@@ -2139,9 +2916,9 @@ qboolean CM_TransformedBoxSightTrace( const vec3_t start, const vec3_t end, cons
 	halfwidth = symetricSize[ 1 ][ 0 ];
 	halfheight = symetricSize[ 1 ][ 2 ];
 
-	sphere.use = cylinder;
-	sphere.radius = ( halfwidth > halfheight ) ? halfheight : halfwidth;
-	t = halfheight - sphere.radius;
+	ctx->sphere.use = cylinder;
+	ctx->sphere.radius = ( halfwidth > halfheight ) ? halfheight : halfwidth;
+	t = halfheight - ctx->sphere.radius;
 
 	if( rotated ) {
 		AngleVectorsLeft( angles, forward, left, up );
@@ -2156,14 +2933,461 @@ qboolean CM_TransformedBoxSightTrace( const vec3_t start, const vec3_t end, cons
 		end_l[ 1 ] = DotProduct( temp, left );
 		end_l[ 2 ] = DotProduct( temp, up );
 
-		sphere.offset[ 0 ] = forward[ 2 ] * t;
-		sphere.offset[ 1 ] = left[ 2 ] * t;
-		sphere.offset[ 2 ] = up[ 2 ] * t;
+		ctx->sphere.offset[ 0 ] = forward[ 2 ] * t;
+		ctx->sphere.offset[ 1 ] = left[ 2 ] * t;
+		ctx->sphere.offset[ 2 ] = up[ 2 ] * t;
 	}
 	else {
-		VectorSet( sphere.offset, 0, 0, t );
+		VectorSet( ctx->sphere.offset, 0, 0, t );
 	}
 
 	// sweep the box through the model
-	return CM_BoxSightTrace( start_l, end_l, symetricSize[ 0 ], symetricSize[ 1 ], model, brushmask, cylinder );
+	return CM_BoxSightTraceContext( ctx, start_l, end_l, symetricSize[ 0 ], symetricSize[ 1 ], model, brushmask, cylinder );
+}
+
+/*
+===============================================================================
+
+TRACE STRESS TEST
+
+Added in OPM
+Checks that traces running at the same time on several threads,
+each with its own context, give the same results as the serial traces
+
+===============================================================================
+*/
+
+#define TRACESTRESS_CHUNKS	64
+
+typedef struct {
+	vec3_t		start;
+	vec3_t		end;
+	vec3_t		mins;
+	vec3_t		maxs;
+	vec3_t		boxMins;	// box model to trace against, empty to trace through the world
+	vec3_t		boxMaxs;
+	int			cylinder;
+} traceStressItem_t;
+
+typedef struct {
+	traceStressItem_t	*items;
+	trace_t				*results;
+	int					count;
+	traceContext_t		*contexts[TRACESTRESS_CHUNKS];
+} traceStress_t;
+
+/*
+==================
+CM_TraceStressItem
+==================
+*/
+static void CM_TraceStressItem( traceContext_t *ctx, const traceStressItem_t *item, trace_t *result ) {
+	clipHandle_t	model;
+
+	if( VectorCompare( item->boxMins, item->boxMaxs ) ) {
+		CM_BoxTraceContext( ctx, result, item->start, item->end, item->mins, item->maxs, 0, CONTENTS_SOLID | MASK_CLIP, item->cylinder );
+		return;
+	}
+
+	model = CM_TempBoxModelContext( ctx, item->boxMins, item->boxMaxs, CONTENTS_SOLID );
+	CM_BoxTraceContext( ctx, result, item->start, item->end, item->mins, item->maxs, model, CONTENTS_SOLID | MASK_CLIP, item->cylinder );
+}
+
+/*
+==================
+CM_TraceStressJob
+
+Traces a chunk of the items with the context of the chunk
+==================
+*/
+static void CM_TraceStressJob( void *data, int index ) {
+	traceStress_t	*stress = ( traceStress_t * )data;
+	int				i, end;
+
+	end = ( index + 1 ) * stress->count / TRACESTRESS_CHUNKS;
+	for( i = index * stress->count / TRACESTRESS_CHUNKS; i < end; i++ ) {
+		CM_TraceStressItem( stress->contexts[index], &stress->items[i], &stress->results[i] );
+	}
+}
+
+/*
+==================
+CM_TraceStressRandom
+==================
+*/
+static float CM_TraceStressRandom( unsigned int *seed, float min, float max ) {
+	*seed = *seed * 1103515245 + 12345;
+	return min + ( max - min ) * ( ( *seed >> 16 ) & 0x7fff ) / 32767.0f;
+}
+
+/*
+==================
+CM_TraceStress_f
+
+cm_traceStress [traces] [threads] [rounds] [map]
+Traces against random boxes, and through the world when a map is loaded.
+World traces are spread over the bounds of the world model
+==================
+*/
+void CM_TraceStress_f( void ) {
+	traceStress_t		stress;
+	traceStressItem_t	*item;
+	trace_t				*serial;
+	unsigned int		seed;
+	int					numThreads;
+	int					numRounds;
+	int					hits;
+	int					mismatches;
+	int					serialTime, parallelTime;
+	int					startTime;
+	int					round;
+	int					i, j;
+
+	stress.count = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 20000;
+	numThreads = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 4;
+	numRounds = Cmd_Argc() > 3 ? atoi( Cmd_Argv( 3 ) ) : 10;
+	if( stress.count < 1 || numRounds < 1 ) {
+		Com_Printf( "usage: cm_traceStress [traces] [threads] [rounds] [map]\n" );
+		return;
+	}
+
+	if( Cmd_Argc() > 4 && !CM_BenchmarkLoadMap( Cmd_Argv( 4 ) ) ) {
+		return;
+	}
+
+	stress.items = Z_Malloc( stress.count * sizeof( *stress.items ) );
+	stress.results = Z_Malloc( stress.count * sizeof( *stress.results ) );
+	serial = Z_Malloc( stress.count * sizeof( *serial ) );
+
+	seed = 1;
+	for( i = 0; i < stress.count; i++ ) {
+		item = &stress.items[i];
+
+		for( j = 0; j < 3; j++ ) {
+			item->start[j] = CM_TraceStressRandom( &seed, -256, 256 );
+			item->end[j] = CM_TraceStressRandom( &seed, -256, 256 );
+			item->maxs[j] = CM_TraceStressRandom( &seed, 0, 32 );
+			item->mins[j] = -item->maxs[j];
+		}
+
+		// some position tests and point traces
+		if( !( i % 7 ) ) {
+			VectorCopy( item->start, item->end );
+		}
+		if( !( i % 5 ) ) {
+			VectorClear( item->mins );
+			VectorClear( item->maxs );
+		}
+		item->cylinder = !( i % 3 );
+
+		if( cm.numSubModels && !( i & 1 ) ) {
+			VectorClear( item->boxMins );
+			VectorClear( item->boxMaxs );
+
+			for( j = 0; j < 3; j++ ) {
+				item->start[j] = CM_TraceStressRandom( &seed, cm.cmodels[0].mins[j], cm.cmodels[0].maxs[j] );
+				if( i % 7 ) {
+					item->end[j] = CM_TraceStressRandom( &seed, cm.cmodels[0].mins[j], cm.cmodels[0].maxs[j] );
+				} else {
+					item->end[j] = item->start[j];
+				}
+			}
+		} else {
+			for( j = 0; j < 3; j++ ) {
+				item->boxMins[j] = CM_TraceStressRandom( &seed, -128, 0 );
+				item->boxMaxs[j] = CM_TraceStressRandom( &seed, 1, 128 );
+			}
+		}
+	}
+
+	for( i = 0; i < TRACESTRESS_CHUNKS; i++ ) {
+		stress.contexts[i] = CM_CreateTraceContext();
+	}
+
+	// serial traces, all with the same context
+	startTime = Sys_Milliseconds();
+	for( round = 0; round < numRounds; round++ ) {
+		for( i = 0; i < stress.count; i++ ) {
+			CM_TraceStressItem( stress.contexts[0], &stress.items[i], &serial[i] );
+		}
+	}
+	serialTime = Sys_Milliseconds() - startTime;
+
+	hits = 0;
+	for( i = 0; i < stress.count; i++ ) {
+		if( serial[i].fraction < 1 || serial[i].startsolid ) {
+			hits++;
+		}
+	}
+
+	mismatches = 0;
+	parallelTime = 0;
+	for( round = 0; round < numRounds; round++ ) {
+		startTime = Sys_Milliseconds();
+		Com_RunJobs( CM_TraceStressJob, &stress, TRACESTRESS_CHUNKS, numThreads );
+		parallelTime += Sys_Milliseconds() - startTime;
+
+		for( i = 0; i < stress.count; i++ ) {
+			if( stress.results[i].fraction != serial[i].fraction
+				|| stress.results[i].startsolid != serial[i].startsolid
+				|| stress.results[i].allsolid != serial[i].allsolid
+				|| !VectorCompare( stress.results[i].endpos, serial[i].endpos )
+				|| !VectorCompare( stress.results[i].plane.normal, serial[i].plane.normal ) ) {
+				mismatches++;
+			}
+		}
+	}
+
+	for( i = 0; i < TRACESTRESS_CHUNKS; i++ ) {
+		CM_FreeTraceContext( stress.contexts[i] );
+	}
+
+	Z_Free( serial );
+	Z_Free( stress.results );
+	Z_Free( stress.items );
+
+	Com_Printf( "%i traces x %i rounds (%s), %i hit: %i mismatches / serial %i ms, %i threads %i ms\n",
+		stress.count, numRounds, cm.numSubModels ? cm.name : "boxes only, no map loaded",
+		hits, mismatches, serialTime, numThreads, parallelTime );
+}
+
+/*
+===============================================================================
+
+TRACE RECORDING AND REPLAY
+
+Added in OPM
+cm_traceRecord keeps the world traces made through CM_BoxTrace,
+cm_traceReplay traces them again to time the brush plane tests
+
+===============================================================================
+*/
+
+/*
+==================
+CM_BenchmarkLoadMap
+
+Loads the map for the benchmark commands, unless it's the loaded one.
+The map of a running server isn't replaced
+==================
+*/
+qboolean CM_BenchmarkLoadMap( const char *mapname ) {
+	char	name[ MAX_QPATH ];
+	int		checksum;
+
+	if( !Q_stricmpn( mapname, "maps/", 5 ) ) {
+		Q_strncpyz( name, mapname, sizeof( name ) );
+	} else {
+		Com_sprintf( name, sizeof( name ), "maps/%s.bsp", mapname );
+	}
+
+	if( !Q_stricmp( cm.name, name ) ) {
+		return qtrue;
+	}
+
+	if( com_sv_running && com_sv_running->integer ) {
+		Com_Printf( "%s isn't the map of the running server\n", name );
+		return qfalse;
+	}
+
+	if( FS_ReadFile( name, NULL ) <= 0 ) {
+		Com_Printf( "Couldn't find %s\n", name );
+		return qfalse;
+	}
+
+	CM_LoadMap( name, qfalse, &checksum );
+	return qtrue;
+}
+
+/*
+==================
+CM_WriteTraceRecord
+==================
+*/
+static void CM_WriteTraceRecord( void ) {
+	traceRecordHeader_t	*header;
+	int					size;
+
+	size = sizeof( *header ) + cm_record.numTraces * sizeof( traceRecord_t );
+	header = Z_Malloc( size );
+
+	header->ident = TRACERECORD_IDENT;
+	header->version = TRACERECORD_VERSION;
+	header->numTraces = cm_record.numTraces;
+	Q_strncpyz( header->mapname, cm.name, sizeof( header->mapname ) );
+	Com_Memcpy( header + 1, cm_record.traces, cm_record.numTraces * sizeof( traceRecord_t ) );
+
+	FS_WriteFile( cm_record.filename, header, size );
+	Com_Printf( "Wrote %i traces of %s to %s\n", cm_record.numTraces, cm.name, cm_record.filename );
+
+	Z_Free( header );
+	Z_Free( cm_record.traces );
+	cm_record.traces = NULL;
+}
+
+/*
+==================
+CM_RecordTrace
+==================
+*/
+static void CM_RecordTrace( const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, int brushmask, int cylinder ) {
+	traceRecord_t	*record;
+
+	record = &cm_record.traces[ cm_record.numTraces++ ];
+	VectorCopy( start, record->start );
+	VectorCopy( end, record->end );
+	VectorCopy( mins, record->mins );
+	VectorCopy( maxs, record->maxs );
+	record->brushmask = brushmask;
+	record->cylinder = cylinder;
+
+	if( cm_record.numTraces >= cm_record.maxTraces ) {
+		CM_WriteTraceRecord();
+	}
+}
+
+/*
+==================
+CM_TraceRecord_f
+
+cm_traceRecord <filename> [traces]
+Writes the next world traces to the file, on the current map
+==================
+*/
+void CM_TraceRecord_f( void ) {
+	if( Cmd_Argc() < 2 ) {
+		Com_Printf( "usage: cm_traceRecord <filename> [traces]\n" );
+		return;
+	}
+
+	if( cm_record.traces ) {
+		Com_Printf( "Already recording to %s\n", cm_record.filename );
+		return;
+	}
+
+	if( !cm.numSubModels ) {
+		Com_Printf( "No map loaded\n" );
+		return;
+	}
+
+	cm_record.maxTraces = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 100000;
+	if( cm_record.maxTraces < 1 ) {
+		Com_Printf( "usage: cm_traceRecord <filename> [traces]\n" );
+		return;
+	}
+
+	Q_strncpyz( cm_record.filename, Cmd_Argv( 1 ), sizeof( cm_record.filename ) );
+	COM_DefaultExtension( cm_record.filename, sizeof( cm_record.filename ), ".trc" );
+
+	cm_record.numTraces = 0;
+	cm_record.traces = Z_Malloc( cm_record.maxTraces * sizeof( traceRecord_t ) );
+
+	Com_Printf( "Recording %i traces to %s\n", cm_record.maxTraces, cm_record.filename );
+}
+
+/*
+==================
+CM_ReplayTraces
+==================
+*/
+static int CM_ReplayTraces( const traceRecord_t *records, int numTraces, int numRounds, trace_t *results ) {
+	int		startTime;
+	int		round;
+	int		i;
+
+	startTime = Sys_Milliseconds();
+	for( round = 0; round < numRounds; round++ ) {
+		for( i = 0; i < numTraces; i++ ) {
+			CM_BoxTraceContext( &cm_traceContext, &results[i], records[i].start, records[i].end,
+				records[i].mins, records[i].maxs, 0, records[i].brushmask, records[i].cylinder );
+		}
+	}
+
+	return Sys_Milliseconds() - startTime;
+}
+
+/*
+==================
+CM_TraceReplay_f
+
+cm_traceReplay <filename> [rounds]
+Traces the recorded traces again, with the four-wide and with the scalar
+brush plane tests. The map they were recorded on is loaded if needed
+==================
+*/
+void CM_TraceReplay_f( void ) {
+	char				filename[ MAX_QPATH ];
+	traceRecordHeader_t	*header;
+	traceRecord_t		*records;
+	trace_t				*results, *scalarResults;
+	long				size;
+	int					numTraces;
+	int					numRounds;
+	int					simdTime, scalarTime;
+	int					mismatches;
+	int					i;
+
+	if( Cmd_Argc() < 2 ) {
+		Com_Printf( "usage: cm_traceReplay <filename> [rounds]\n" );
+		return;
+	}
+
+	numRounds = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 10;
+	if( numRounds < 1 ) {
+		Com_Printf( "usage: cm_traceReplay <filename> [rounds]\n" );
+		return;
+	}
+
+	Q_strncpyz( filename, Cmd_Argv( 1 ), sizeof( filename ) );
+	COM_DefaultExtension( filename, sizeof( filename ), ".trc" );
+
+	size = FS_ReadFile( filename, ( void ** )&header );
+	if( size < ( long )sizeof( *header ) ) {
+		Com_Printf( "Couldn't read %s\n", filename );
+		if( size >= 0 ) {
+			FS_FreeFile( header );
+		}
+		return;
+	}
+
+	numTraces = header->numTraces;
+	if( header->ident != TRACERECORD_IDENT || header->version != TRACERECORD_VERSION
+		|| numTraces < 1 || size != ( long )( sizeof( *header ) + numTraces * sizeof( traceRecord_t ) ) ) {
+		Com_Printf( "%s isn't a trace record\n", filename );
+		FS_FreeFile( header );
+		return;
+	}
+
+	header->mapname[ sizeof( header->mapname ) - 1 ] = 0;
+	if( !CM_BenchmarkLoadMap( header->mapname ) ) {
+		FS_FreeFile( header );
+		return;
+	}
+
+	records = ( traceRecord_t * )( header + 1 );
+	results = Z_Malloc( numTraces * sizeof( *results ) );
+	scalarResults = Z_Malloc( numTraces * sizeof( *scalarResults ) );
+
+	cm_scalarPlanes = qtrue;
+	scalarTime = CM_ReplayTraces( records, numTraces, numRounds, scalarResults );
+	cm_scalarPlanes = qfalse;
+	simdTime = CM_ReplayTraces( records, numTraces, numRounds, results );
+
+	mismatches = 0;
+	for( i = 0; i < numTraces; i++ ) {
+		if( results[i].fraction != scalarResults[i].fraction
+			|| results[i].startsolid != scalarResults[i].startsolid
+			|| results[i].allsolid != scalarResults[i].allsolid
+			|| !VectorCompare( results[i].endpos, scalarResults[i].endpos )
+			|| !VectorCompare( results[i].plane.normal, scalarResults[i].plane.normal ) ) {
+			mismatches++;
+		}
+	}
+
+	Z_Free( scalarResults );
+	Z_Free( results );
+	FS_FreeFile( header );
+
+	Com_Printf( "%i traces of %s x %i rounds: %i mismatches / scalar planes %i ms, four-wide planes %i ms\n",
+		numTraces, cm.name, numRounds, mismatches, scalarTime, simdTime );
 }
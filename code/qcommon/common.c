@@ -1845,6 +1845,13 @@ void Com_Init( char *commandLine ) {
 	Cmd_SetCommandCompletionFunc( "writeconfig", Cmd_CompleteCfgName );
 	Cmd_AddCommand("pause", Com_Pause_f);
 	Cmd_AddCommand("game_restart", Com_GameRestart_f);
+	// Added in OPM
+	Cmd_AddCommand("skelrlecheck", SkeletorRLECheck_f);
+	Cmd_AddCommand("cm_traceStress", CM_TraceStress_f);
+	Cmd_AddCommand("cm_traceRecord", CM_TraceRecord_f);
+	Cmd_AddCommand("cm_traceReplay", CM_TraceReplay_f);
+	Cmd_AddCommand("strstats", Com_StrStats_f);
+	Cmd_AddCommand("strbenchmark", Com_StrBenchmark_f);
 
 	// override anything from the config files with command line args
 	Com_StartupVariable( NULL );
@@ -2386,6 +2393,8 @@ void Com_Frame( void ) {
 
 
 	NET_FlushPacketQueue();
+	NET_FlushSends();
+	Z_StatsFrame();
 
 	//
 	// report timing information
@@ -2464,6 +2473,8 @@ Com_Shutdown
 =================
 */
 void Com_Shutdown (void) {
+	Com_ShutdownJobs();
+
 	if (logfile) {
 		FS_FCloseFile (logfile);
 		logfile = 0;
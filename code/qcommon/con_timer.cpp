@@ -4,20 +4,159 @@
 #    include "../fgame/archive.h"
 #endif
 
+template<>
+int HashCode<Class *>(Class *const& key)
+{
+    return (int)(size_t)key;
+}
+
 con_timer::con_timer(void)
 {
-    m_inttime = 0;
-    m_bDirty  = false;
+    m_inttime     = 0;
+    m_bDirty      = false;
+    m_NextOrder   = 0;
+    m_bSlotsValid = true;
+}
+
+bool con_timer::Less(const Element& a, const Element& b)
+{
+    if (a.inttime != b.inttime) {
+        return a.inttime < b.inttime;
+    }
+
+    // elements with the same time are returned in the order they were added
+    return (int)(a.order - b.order) < 0;
+}
+
+int con_timer::CompareElements(const void *elem1, const void *elem2)
+{
+    if (Less(*(const Element *)elem1, *(const Element *)elem2)) {
+        return -1;
+    } else if (Less(*(const Element *)elem2, *(const Element *)elem1)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+void con_timer::Place(const Element& e, int slot)
+{
+    m_Elements.ObjectAt(slot) = e;
+    m_Slots[e.obj]            = slot;
+}
+
+void con_timer::SiftUp(int slot)
+{
+    Element e;
+    int     parent;
+
+    e = m_Elements.ObjectAt(slot);
+    while (slot > 1) {
+        parent = slot >> 1;
+        if (!Less(e, m_Elements.ObjectAt(parent))) {
+            break;
+        }
+
+        Place(m_Elements.ObjectAt(parent), slot);
+        slot = parent;
+    }
+
+    Place(e, slot);
+}
+
+void con_timer::SiftDown(int slot)
+{
+    Element e;
+    int     num;
+    int     child;
+
+    e   = m_Elements.ObjectAt(slot);
+    num = m_Elements.NumObjects();
+    for (;;) {
+        child = slot * 2;
+        if (child > num) {
+            break;
+        }
+
+        if (child < num && Less(m_Elements.ObjectAt(child + 1), m_Elements.ObjectAt(child))) {
+            child++;
+        }
+
+        if (!Less(m_Elements.ObjectAt(child), e)) {
+            break;
+        }
+
+        Place(m_Elements.ObjectAt(child), slot);
+        slot = child;
+    }
+
+    Place(e, slot);
+}
+
+void con_timer::RemoveSlot(int slot)
+{
+    int last;
+
+    last = m_Elements.NumObjects();
+
+    m_Slots.remove(m_Elements.ObjectAt(slot).obj);
+
+    if (slot == last) {
+        m_Elements.RemoveObjectAt(last);
+        return;
+    }
+
+    // move the last element into the hole
+    m_Elements.ObjectAt(slot) = m_Elements.ObjectAt(last);
+    m_Elements.RemoveObjectAt(last);
+
+    if (slot > 1 && Less(m_Elements.ObjectAt(slot), m_Elements.ObjectAt(slot >> 1))) {
+        SiftUp(slot);
+    } else {
+        SiftDown(slot);
+    }
+}
+
+void con_timer::BuildSlots(void)
+{
+    int i;
+
+    if (m_bSlotsValid) {
+        return;
+    }
+
+    // the loaded elements may be in any order, baseline saves store them
+    // in insertion order. They are only moved now that the object pointers
+    // are resolved, and an array sorted by time then load index is a valid heap
+    m_Elements.Sort(con_timer::CompareElements);
+
+    m_Slots.clear();
+
+    for (i = 1; i <= m_Elements.NumObjects(); i++) {
+        m_Slots[m_Elements.ObjectAt(i).obj] = i;
+    }
+
+    m_bSlotsValid = true;
 }
 
 void con_timer::AddElement(Class *e, int inttime)
 {
     Element element;
+    int    *slot;
+
+    BuildSlots();
+
+    slot = m_Slots.find(e);
+    if (slot) {
+        // an object only waits once, reschedule it
+        RemoveSlot(*slot);
+    }
 
     element.obj     = e;
     element.inttime = inttime;
+    element.order   = m_NextOrder++;
 
-    m_Elements.AddObject(element);
+    SiftUp(m_Elements.AddObject(element));
 
     if (inttime <= m_inttime) {
         SetDirty();
@@ -26,37 +165,26 @@ void con_timer::AddElement(Class *e, int inttime)
 
 void con_timer::RemoveElement(Class *e)
 {
-    for (int i = m_Elements.NumObjects(); i > 0; i--) {
-        Element *index = &m_Elements.ObjectAt(i);
+    int *slot;
 
-        if (index->obj == e) {
-            m_Elements.RemoveObjectAt(i);
-            return;
-        }
+    BuildSlots();
+
+    slot = m_Slots.find(e);
+    if (slot) {
+        RemoveSlot(*slot);
     }
 }
 
 Class *con_timer::GetNextElement(int& foundtime)
 {
-    int    best_inttime;
-    int    i;
-    int    foundIndex;
     Class *result;
 
-    foundIndex   = 0;
-    best_inttime = m_inttime;
+    BuildSlots();
 
-    for (i = m_Elements.NumObjects(); i > 0; i--) {
-        if (m_Elements.ObjectAt(i).inttime <= best_inttime) {
-            best_inttime = m_Elements.ObjectAt(i).inttime;
-            foundIndex   = i;
-        }
-    }
-
-    if (foundIndex) {
-        result = m_Elements.ObjectAt(foundIndex).obj;
-        m_Elements.RemoveObjectAt(foundIndex);
-        foundtime = best_inttime;
+    if (m_Elements.NumObjects() && m_Elements.ObjectAt(1).inttime <= m_inttime) {
+        result    = m_Elements.ObjectAt(1).obj;
+        foundtime = m_Elements.ObjectAt(1).inttime;
+        RemoveSlot(1);
     } else {
         result   = NULL;
         m_bDirty = false;
@@ -75,9 +203,28 @@ void con_timer::ArchiveElement(Archiver& arc, Element *e)
 
 void con_timer::Archive(Archiver& arc)
 {
+    Container<Element> sorted;
+    int                i;
+
     arc.ArchiveBool(&m_bDirty);
     arc.ArchiveInteger(&m_inttime);
 
-    m_Elements.Archive(arc, con_timer::ArchiveElement);
+    if (arc.Loading()) {
+        m_Elements.Archive(arc, con_timer::ArchiveElement);
+
+        // elements with the same time keep their saved order,
+        // the heap is rebuilt by BuildSlots
+        for (i = 1; i <= m_Elements.NumObjects(); i++) {
+            m_Elements.ObjectAt(i).order = i - 1;
+        }
+        m_NextOrder = m_Elements.NumObjects();
+
+        // object pointers are resolved at the end of the load
+        m_bSlotsValid = false;
+    } else {
+        sorted = m_Elements;
+        sorted.Sort(con_timer::CompareElements);
+        sorted.Archive(arc, con_timer::ArchiveElement);
+    }
 }
 #endif
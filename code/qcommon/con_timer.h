@@ -6,15 +6,32 @@ public:
     class Element
     {
     public:
-        Class *obj;
-        int    inttime;
+        Class       *obj;
+        int          inttime;
+        unsigned int order; // Added in OPM: insertion order, for elements with the same time
     };
 
 private:
+    // Added in OPM
+    //  binary heap ordered by time then by insertion order,
+    //  with the heap slot of each object
     Container<con_timer::Element> m_Elements;
+    con_map<Class *, int>         m_Slots;
+    unsigned int                  m_NextOrder;
+    bool                          m_bSlotsValid;
     bool                          m_bDirty;
     int                           m_inttime;
 
+private:
+    static bool Less(const Element& a, const Element& b);
+    static int  CompareElements(const void *elem1, const void *elem2);
+
+    void Place(const Element& e, int slot);
+    void SiftUp(int slot);
+    void SiftDown(int slot);
+    void RemoveSlot(int slot);
+    void BuildSlots(void);
+
 public:
     con_timer();
 
@@ -0,0 +1,282 @@
+/*
+===========================================================================
+Copyright (C) 2025 the OpenMoHAA team
+
+This file is part of OpenMoHAA source code.
+
+OpenMoHAA source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+OpenMoHAA source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenMoHAA source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// jobs.cpp: Worker threads running independent items of work in parallel.
+//
+// Com_RunJobs calls a function for each item of a range and returns
+// once all of them are done. The calling thread runs items too.
+//
+// Several threads may call it at once, like the server building
+// snapshots while the render thread skins models. Only one of them
+// gets the workers, the others run their items by themselves.
+//
+
+#include "q_shared.h"
+#include "qcommon.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+typedef struct jobPool_s {
+    std::thread            *threads[MAX_JOB_THREADS];
+    int                     numThreads;
+    std::mutex              mutex;
+    std::condition_variable wakeup;
+    std::condition_variable done;
+
+    // The current job, only changed while no worker is running
+    jobFunc_t        func;
+    void            *data;
+    int              count;
+    std::atomic<int> next;
+    int              finished;
+    int              active;
+    int              joined;
+    int              maxWorkers;
+    unsigned int     generation;
+    bool             quit;
+} jobPool_t;
+
+// Allocated on first use so that no destructor runs at exit
+// while workers may still be waiting
+static jobPool_t *jobPool;
+
+// Held by the thread that currently runs a job on the pool
+static std::mutex *jobPoolOwner = new std::mutex();
+
+// For callers that need to serialize part of their work
+static std::mutex *jobLock = new std::mutex();
+
+/*
+=================
+Com_RunJobItems
+
+Runs items of the current job until there is none left.
+=================
+*/
+static void Com_RunJobItems(jobFunc_t func, void *data, int count)
+{
+    int index;
+    int numDone;
+
+    numDone = 0;
+    while ((index = jobPool->next++) < count) {
+        func(data, index);
+        numDone++;
+    }
+
+    std::lock_guard<std::mutex> lock(jobPool->mutex);
+    jobPool->finished += numDone;
+}
+
+/*
+=================
+Com_JobWorker
+=================
+*/
+static void Com_JobWorker(void)
+{
+    unsigned int generation;
+    jobFunc_t    func;
+    void        *data;
+    int          count;
+
+    generation = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(jobPool->mutex);
+
+            jobPool->wakeup.wait(lock, [generation] { return jobPool->quit || jobPool->generation != generation; });
+            if (jobPool->quit) {
+                return;
+            }
+
+            generation = jobPool->generation;
+            if (jobPool->joined >= jobPool->maxWorkers) {
+                // the job asked for fewer threads than the pool has
+                continue;
+            }
+
+            func       = jobPool->func;
+            data       = jobPool->data;
+            count      = jobPool->count;
+            jobPool->joined++;
+            jobPool->active++;
+        }
+
+        Com_RunJobItems(func, data, count);
+
+        {
+            std::lock_guard<std::mutex> lock(jobPool->mutex);
+
+            jobPool->active--;
+        }
+        jobPool->done.notify_all();
+    }
+}
+
+/*
+=================
+Com_StopJobThreads
+=================
+*/
+static void Com_StopJobThreads(void)
+{
+    int i;
+
+    if (!jobPool) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobPool->mutex);
+
+        jobPool->quit = true;
+    }
+    jobPool->wakeup.notify_all();
+
+    for (i = 0; i < jobPool->numThreads; i++) {
+        jobPool->threads[i]->join();
+        delete jobPool->threads[i];
+    }
+
+    delete jobPool;
+    jobPool = NULL;
+}
+
+/*
+=================
+Com_StartJobThreads
+
+The pool only grows, so callers asking for different
+numbers of threads don't keep recreating it.
+=================
+*/
+static void Com_StartJobThreads(int numThreads)
+{
+    int i;
+
+    if (jobPool && jobPool->numThreads >= numThreads) {
+        return;
+    }
+
+    Com_StopJobThreads();
+
+    jobPool             = new jobPool_t();
+    jobPool->numThreads = numThreads;
+
+    for (i = 0; i < numThreads; i++) {
+        jobPool->threads[i] = new std::thread(Com_JobWorker);
+    }
+}
+
+/*
+=================
+Com_ShutdownJobs
+=================
+*/
+void Com_ShutdownJobs(void)
+{
+    std::lock_guard<std::mutex> owner(*jobPoolOwner);
+
+    Com_StopJobThreads();
+}
+
+/*
+=================
+Com_RunJobs
+
+Calls func for each index from 0 to count - 1, using up to numThreads
+threads including the calling one. The items must not depend on each other.
+Errors can't be raised from the items, they must be reported afterwards.
+=================
+*/
+void Com_RunJobs(jobFunc_t func, void *data, int count, int numThreads)
+{
+    int i;
+
+    if (numThreads > MAX_JOB_THREADS + 1) {
+        numThreads = MAX_JOB_THREADS + 1;
+    }
+
+    std::unique_lock<std::mutex> owner(*jobPoolOwner, std::defer_lock);
+
+    if (numThreads <= 1 || count <= 1 || !owner.try_lock()) {
+        // nothing to share, or another thread is using the workers
+        for (i = 0; i < count; i++) {
+            func(data, i);
+        }
+        return;
+    }
+
+    Com_StartJobThreads(numThreads - 1);
+
+    {
+        std::unique_lock<std::mutex> lock(jobPool->mutex);
+
+        // a worker that woke up late for the previous job
+        // must be done with it before the counters are reset
+        jobPool->done.wait(lock, [] { return !jobPool->active; });
+
+        jobPool->func     = func;
+        jobPool->data     = data;
+        jobPool->count    = count;
+        jobPool->next       = 0;
+        jobPool->finished   = 0;
+        jobPool->joined     = 0;
+        jobPool->maxWorkers = numThreads - 1;
+        jobPool->generation++;
+    }
+    jobPool->wakeup.notify_all();
+
+    Com_RunJobItems(func, data, count);
+
+    // wait for the last items, and for all workers to leave this job
+    // so none of them can pick up items of the next one
+    std::unique_lock<std::mutex> lock(jobPool->mutex);
+    jobPool->done.wait(lock, [count] { return jobPool->finished == count && !jobPool->active; });
+}
+
+/*
+=================
+Com_LockJobs
+
+Serializes the parts of the items that use code which isn't thread-safe.
+=================
+*/
+void Com_LockJobs(void)
+{
+    jobLock->lock();
+}
+
+/*
+=================
+Com_UnlockJobs
+=================
+*/
+void Com_UnlockJobs(void)
+{
+    jobLock->unlock();
+}
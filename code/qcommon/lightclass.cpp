@@ -21,6 +21,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
 #include "lightclass.h"
+#include "mem_blockalloc.h"
 
 #if defined(GAME_DLL)
 
@@ -67,13 +68,9 @@ void *LightClass::operator new(size_t s)
 
     s += sizeof(size_t);
 
-#    ifdef GAME_DLL
-    p = (size_t *)gi.Malloc(s);
-#    elif defined(CGAME_DLL)
-    p = (size_t *)cgi.Malloc(s);
-#    else
-    p = (size_t *)Z_Malloc(s);
-#    endif
+    // Added in OPM
+    //  count the allocation for the code creating the object
+    p = (size_t *)MEM_AllocCaller(s, Z_RETURN_ADDRESS());
 
     totalmemallocated += s;
     numclassesallocated++;
@@ -69,7 +69,7 @@ con_map<const_str, unsigned int> Event::setterCommandList;
 
 #endif
 
-EventQueueNode Event::EventQueue;
+EventQueueHeap Event::EventQueue;
 
 int DisableListenerNotify = 0;
 
@@ -411,6 +411,317 @@ int HashCode<command_t>(const command_t& key)
     return hash;
 }
 
+/*
+=======================
+LinkOwner
+
+Added in OPM
+Adds the node to the pending event list of the listener
+=======================
+*/
+void EventQueueNode::LinkOwner(Listener *obj)
+{
+    owner     = obj;
+    prevOwned = NULL;
+    nextOwned = obj->m_PendingEvents;
+
+    if (nextOwned) {
+        nextOwned->prevOwned = this;
+    }
+
+    obj->m_PendingEvents = this;
+}
+
+/*
+=======================
+UnlinkOwner
+
+Added in OPM
+=======================
+*/
+void EventQueueNode::UnlinkOwner(void)
+{
+    if (!owner) {
+        return;
+    }
+
+    if (prevOwned) {
+        prevOwned->nextOwned = nextOwned;
+    } else {
+        owner->m_PendingEvents = nextOwned;
+    }
+
+    if (nextOwned) {
+        nextOwned->prevOwned = prevOwned;
+    }
+
+    owner     = NULL;
+    prevOwned = NULL;
+    nextOwned = NULL;
+}
+
+EventQueueHeap::EventQueueHeap()
+{
+    nodes          = NULL;
+    numNodes       = 0;
+    maxNodes       = 0;
+    postOrder      = 0;
+    appendOrder    = 0;
+    bUnlinkedNodes = false;
+}
+
+EventQueueHeap::~EventQueueHeap()
+{
+    if (nodes) {
+        delete[] nodes;
+    }
+}
+
+bool EventQueueHeap::Less(const EventQueueNode *a, const EventQueueNode *b)
+{
+    if (a->inttime != b->inttime) {
+        return a->inttime < b->inttime;
+    }
+
+    return a->order < b->order;
+}
+
+void EventQueueHeap::Place(EventQueueNode *node, int index)
+{
+    nodes[index]    = node;
+    node->heapIndex = index;
+}
+
+void EventQueueHeap::SiftUp(int index)
+{
+    EventQueueNode *node;
+    int             parent;
+
+    node = nodes[index];
+    while (index > 0) {
+        parent = (index - 1) >> 1;
+        if (!Less(node, nodes[parent])) {
+            break;
+        }
+
+        Place(nodes[parent], index);
+        index = parent;
+    }
+
+    Place(node, index);
+}
+
+void EventQueueHeap::SiftDown(int index)
+{
+    EventQueueNode *node;
+    int             child;
+
+    node = nodes[index];
+    for (;;) {
+        child = index * 2 + 1;
+        if (child >= numNodes) {
+            break;
+        }
+
+        if (child + 1 < numNodes && Less(nodes[child + 1], nodes[child])) {
+            child++;
+        }
+
+        if (!Less(nodes[child], node)) {
+            break;
+        }
+
+        Place(nodes[child], index);
+        index = child;
+    }
+
+    Place(node, index);
+}
+
+void EventQueueHeap::Insert(EventQueueNode *node)
+{
+    EventQueueNode **newNodes;
+
+    if (numNodes == maxNodes) {
+        maxNodes = maxNodes ? maxNodes * 2 : 256;
+        newNodes = new EventQueueNode *[maxNodes];
+
+        if (nodes) {
+            memcpy(newNodes, nodes, numNodes * sizeof(EventQueueNode *));
+            delete[] nodes;
+        }
+
+        nodes = newNodes;
+    }
+
+    Place(node, numNodes);
+    numNodes++;
+    SiftUp(node->heapIndex);
+}
+
+/*
+=======================
+Post
+
+The node will be processed before the nodes that have the same time
+=======================
+*/
+void EventQueueHeap::Post(EventQueueNode *node)
+{
+    node->order = --postOrder;
+    Insert(node);
+}
+
+/*
+=======================
+Append
+
+The node will be processed after the nodes that have the same time
+=======================
+*/
+void EventQueueHeap::Append(EventQueueNode *node)
+{
+    node->order = ++appendOrder;
+    Insert(node);
+}
+
+/*
+=======================
+Reschedule
+
+Moves the node after the nodes that have the new time
+=======================
+*/
+void EventQueueHeap::Reschedule(EventQueueNode *node, int inttime)
+{
+    node->inttime = inttime;
+    node->order   = ++appendOrder;
+
+    SiftUp(node->heapIndex);
+    SiftDown(node->heapIndex);
+}
+
+void EventQueueHeap::Remove(EventQueueNode *node)
+{
+    int index;
+
+    index = node->heapIndex;
+    assert(index >= 0 && index < numNodes && nodes[index] == node);
+
+    numNodes--;
+    node->heapIndex = -1;
+
+    if (index == numNodes) {
+        return;
+    }
+
+    Place(nodes[numNodes], index);
+    SiftUp(index);
+    SiftDown(nodes[index]->heapIndex);
+}
+
+/*
+=======================
+Reset
+
+Forgets all nodes, the caller must free them
+=======================
+*/
+void EventQueueHeap::Reset(void)
+{
+    numNodes       = 0;
+    postOrder      = 0;
+    appendOrder    = 0;
+    bUnlinkedNodes = false;
+}
+
+EventQueueNode *EventQueueHeap::First(void) const
+{
+    return numNodes ? nodes[0] : NULL;
+}
+
+bool EventQueueHeap::Empty(void) const
+{
+    return !numNodes;
+}
+
+int EventQueueHeap::NumNodes(void) const
+{
+    return numNodes;
+}
+
+EventQueueNode *EventQueueHeap::NodeAt(int index) const
+{
+    return nodes[index];
+}
+
+static int compareEventQueueNodes(const void *arg1, const void *arg2)
+{
+    const EventQueueNode *a = *(const EventQueueNode **)arg1;
+    const EventQueueNode *b = *(const EventQueueNode **)arg2;
+
+    if (a->inttime != b->inttime) {
+        return a->inttime < b->inttime ? -1 : 1;
+    }
+
+    if (a->order != b->order) {
+        return a->order < b->order ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/*
+=======================
+SortedNodes
+
+Fills the list with the nodes in the order they will be processed
+=======================
+*/
+void EventQueueHeap::SortedNodes(EventQueueNode **list) const
+{
+    if (!numNodes) {
+        return;
+    }
+
+    memcpy(list, nodes, numNodes * sizeof(EventQueueNode *));
+    qsort(list, numNodes, sizeof(EventQueueNode *), compareEventQueueNodes);
+}
+
+/*
+=======================
+LinkOwners
+
+Adds the nodes read from a savegame to the list of their listener,
+once the source objects are known
+=======================
+*/
+void EventQueueHeap::LinkOwners(void)
+{
+    Listener *obj;
+    int       i;
+
+    if (!bUnlinkedNodes) {
+        return;
+    }
+
+#if defined(GAME_DLL)
+    if (LoadingSavegame) {
+        // The source objects aren't set until the archive is closed
+        return;
+    }
+#endif
+
+    for (i = 0; i < numNodes; i++) {
+        obj = nodes[i]->GetSourceObject();
+        if (!nodes[i]->owner && obj) {
+            nodes[i]->LinkOwner(obj);
+        }
+    }
+
+    bUnlinkedNodes = false;
+}
+
 #if defined(ARCHIVE_SUPPORTED)
 
 void ArchiveListenerPtr(Archiver& arc, SafePtr<Listener> *obj)
@@ -458,13 +769,22 @@ void Event::Archive(Archiver& arc)
 
 void L_ArchiveEvents(Archiver& arc)
 {
-    EventQueueNode *event;
-    int             num;
+    EventQueueNode  *event;
+    EventQueueNode **list;
+    int              num;
+    int              i;
+
+    // Added in OPM
+    //  The events are written in the order they will be processed
+    list = new EventQueueNode *[Event::EventQueue.NumNodes() + 1];
+    Event::EventQueue.SortedNodes(list);
 
     num = 0;
-    for (event = Event::EventQueue.next; event != &Event::EventQueue; event = event->next) {
+    for (i = 0; i < Event::EventQueue.NumNodes(); i++) {
         Listener *obj;
 
+        event = list[i];
+
         assert(event);
 
         obj = event->GetSourceObject();
@@ -481,9 +801,11 @@ void L_ArchiveEvents(Archiver& arc)
     }
 
     arc.ArchiveInteger(&num);
-    for (event = Event::EventQueue.next; event != &Event::EventQueue; event = event->next) {
+    for (i = 0; i < Event::EventQueue.NumNodes(); i++) {
         Listener *obj;
 
+        event = list[i];
+
         assert(event);
 
         obj = event->GetSourceObject();
@@ -501,6 +823,8 @@ void L_ArchiveEvents(Archiver& arc)
         arc.ArchiveInteger(&event->flags);
         arc.ArchiveSafePointer(&event->m_sourceobject);
     }
+
+    delete[] list;
 }
 
 void L_UnarchiveEvents(Archiver& arc)
@@ -522,25 +846,28 @@ void L_UnarchiveEvents(Archiver& arc)
         arc.ArchiveInteger(&node->flags);
         arc.ArchiveSafePointer(&node->m_sourceobject);
 
-        LL_Add(&Event::EventQueue, node, next, prev);
+        // Added in OPM
+        //  The node is added to its listener's list after loading
+        Event::EventQueue.Append(node);
+        Event::EventQueue.bUnlinkedNodes = true;
     }
 }
 #endif
 
 void L_ClearEventList()
 {
-    EventQueueNode *node = Event::EventQueue.next, *tmp;
+    EventQueueNode *node;
+    int             i;
 
-    while (node != &Event::EventQueue) {
-        tmp = node->next;
+    for (i = 0; i < Event::EventQueue.NumNodes(); i++) {
+        node = Event::EventQueue.NodeAt(i);
+        node->UnlinkOwner();
 
         delete node->event;
         delete node;
-
-        node = tmp;
     }
 
-    LL_Reset(&Event::EventQueue, next, prev);
+    Event::EventQueue.Reset();
 
     Event_allocator.FreeAll();
 
@@ -566,8 +893,6 @@ void L_InitEvents(void)
     Event::LoadEvents();
     ClassDef::BuildEventResponses();
 
-    LL_Reset(&Event::EventQueue, next, prev);
-
     L_ClearEventList();
     Listener::EventSystemStarted = true;
 }
@@ -578,11 +903,13 @@ void L_ProcessPendingEvents()
 
     Listener::ProcessingEvents = true;
 
+    Event::EventQueue.LinkOwners();
+
     int t = EVENT_msec;
-    while (!LL_Empty(&Event::EventQueue, next, prev)) {
+    while (!Event::EventQueue.Empty()) {
         Listener *obj;
 
-        node = Event::EventQueue.next;
+        node = Event::EventQueue.First();
 
         assert(node);
 
@@ -595,7 +922,8 @@ void L_ProcessPendingEvents()
         }
 
         // the event is removed from its list
-        LL_Remove(node, next, prev);
+        Event::EventQueue.Remove(node);
+        node->UnlinkOwner();
         //gi.DPrintf2("Event: %s\n", node->event->getName().c_str());
 
         // ProcessEvent will dispose of this event when it is done
@@ -1315,15 +1643,17 @@ void Event::PendingEvents(const char *mask)
     EventQueueNode *event;
     size_t          l;
     int             num;
+    int             i;
 
     l = 0;
     if (mask) {
         l = strlen(mask);
     }
 
-    num   = 0;
-    event = EventQueue.next;
-    while (event != &EventQueue) {
+    num = 0;
+    for (i = 0; i < EventQueue.NumNodes(); i++) {
+        event = EventQueue.NodeAt(i);
+
         assert(event);
         assert(event->m_sourceobject);
 
@@ -1331,8 +1661,6 @@ void Event::PendingEvents(const char *mask)
             num++;
             //Event::PrintEvent( event );
         }
-
-        event = event->next;
     }
     EVENT_Printf("%d pending events as of %.2f\n", num, EVENT_time);
 }
@@ -2479,6 +2807,8 @@ Listener
 */
 Listener::Listener()
 {
+    m_PendingEvents = NULL;
+
 #ifdef WITH_SCRIPT_ENGINE
 
     m_EndList = NULL;
@@ -2500,6 +2830,12 @@ Listener::~Listener()
 {
     if (EventSystemStarted) {
         CancelPendingEvents();
+    } else {
+        // Added in OPM
+        //  The nodes must not keep a reference to this listener
+        while (m_PendingEvents) {
+            m_PendingEvents->UnlinkOwner();
+        }
     }
 
 #ifdef WITH_SCRIPT_ENGINE
@@ -2599,13 +2935,16 @@ void Listener::CancelEventsOfType(Event *ev)
     EventQueueNode *next;
     int             eventnum;
 
-    node = Event::EventQueue.next;
+    Event::EventQueue.LinkOwners();
+
+    node = m_PendingEvents;
 
     eventnum = ev->eventnum;
-    while (node != &Event::EventQueue) {
-        next = node->next;
-        if ((node->GetSourceObject() == this) && (node->event->eventnum == eventnum)) {
-            LL_Remove(node, next, prev);
+    while (node) {
+        next = node->nextOwned;
+        if (node->event->eventnum == eventnum) {
+            Event::EventQueue.Remove(node);
+            node->UnlinkOwner();
             delete node->event;
             delete node;
         }
@@ -2633,12 +2972,15 @@ void Listener::CancelFlaggedEvents(int flags)
     EventQueueNode *node;
     EventQueueNode *next;
 
-    node = Event::EventQueue.next;
+    Event::EventQueue.LinkOwners();
+
+    node = m_PendingEvents;
 
-    while (node != &Event::EventQueue) {
-        next = node->next;
-        if ((node->GetSourceObject() == this) && (node->flags & flags)) {
-            LL_Remove(node, next, prev);
+    while (node) {
+        next = node->nextOwned;
+        if (node->flags & flags) {
+            Event::EventQueue.Remove(node);
+            node->UnlinkOwner();
             // Added in OPM
             //  Original doesn't delete the posted Event
             //  which would cause a memory leak
@@ -2658,18 +3000,16 @@ CancelPendingEvents
 void Listener::CancelPendingEvents(void)
 {
     EventQueueNode *node;
-    EventQueueNode *next;
 
-    node = Event::EventQueue.next;
+    Event::EventQueue.LinkOwners();
 
-    while (node != &Event::EventQueue) {
-        next = node->next;
-        if (node->GetSourceObject() == this) {
-            LL_Remove(node, next, prev);
-            delete node->event;
-            delete node;
-        }
-        node = next;
+    while (m_PendingEvents) {
+        node = m_PendingEvents;
+
+        Event::EventQueue.Remove(node);
+        node->UnlinkOwner();
+        delete node->event;
+        delete node;
     }
 }
 
@@ -2683,16 +3023,14 @@ qboolean Listener::EventPending(Event& ev)
     EventQueueNode *event;
     int             eventnum;
 
-    event = Event::EventQueue.next;
+    Event::EventQueue.LinkOwners();
 
     eventnum = ev.eventnum;
 
-    while (event != &Event::EventQueue) {
-        if ((event->GetSourceObject() == this) && (event->event->eventnum == ev.eventnum)) {
+    for (event = m_PendingEvents; event; event = event->nextOwned) {
+        if (event->event->eventnum == eventnum) {
             return true;
         }
-
-        event = event->next;
     }
 
     return false;
@@ -2706,7 +3044,6 @@ PostEventInternal
 EventQueueNode *Listener::PostEventInternal(Event *ev, float delay, int flags)
 {
     EventQueueNode *node;
-    EventQueueNode *i;
     int             inttime;
 
 #if defined(GAME_DLL)
@@ -2730,13 +3067,8 @@ EventQueueNode *Listener::PostEventInternal(Event *ev, float delay, int flags)
 
     node = new EventQueueNode;
 
-    i       = Event::EventQueue.next;
     inttime = EVENT_msec + (delay * 1000.0f + 0.5f);
 
-    while (i != &Event::EventQueue && inttime > i->inttime) {
-        i = i->next;
-    }
-
     node->inttime = inttime;
     node->event   = ev;
     node->flags   = flags;
@@ -2746,7 +3078,10 @@ EventQueueNode *Listener::PostEventInternal(Event *ev, float delay, int flags)
     node->name = ev->name;
 #endif
 
-    LL_Add(i, node, next, prev);
+    // Added in OPM
+    //  Goes before the events that have the same time, like the sorted list did
+    Event::EventQueue.Post(node);
+    node->LinkOwner(this);
 
     return node;
 }
@@ -2781,27 +3116,24 @@ PostponeAllEvents
 qboolean Listener::PostponeAllEvents(float time)
 {
     EventQueueNode *event;
-    EventQueueNode *node;
-
-    event = Event::EventQueue.next;
-    while (event != &Event::EventQueue) {
-        if (event->GetSourceObject() == this) {
-            event->inttime += time * 1000.0f + 0.5f;
-
-            node = event->next;
-            while ((node != &Event::EventQueue) && (event->inttime >= node->inttime)) {
-                node = node->next;
-            }
+    EventQueueNode *first;
 
-            LL_Remove(event, next, prev);
-            LL_Add(node, event, next, prev);
+    Event::EventQueue.LinkOwners();
 
-            return true;
+    // only the first event to be processed is postponed
+    first = NULL;
+    for (event = m_PendingEvents; event; event = event->nextOwned) {
+        if (!first || compareEventQueueNodes(&event, &first) < 0) {
+            first = event;
         }
-        event = event->next;
     }
 
-    return false;
+    if (!first) {
+        return false;
+    }
+
+    Event::EventQueue.Reschedule(first, first->inttime + (int)(time * 1000.0f + 0.5f));
+    return true;
 }
 
 /*
@@ -2812,30 +3144,27 @@ PostponeEvent
 qboolean Listener::PostponeEvent(Event& ev, float time)
 {
     EventQueueNode *event;
-    EventQueueNode *node;
+    EventQueueNode *first;
     int             eventnum;
 
-    eventnum = ev.eventnum;
+    Event::EventQueue.LinkOwners();
 
-    event = Event::EventQueue.next;
-    while (event != &Event::EventQueue) {
-        if ((event->GetSourceObject() == this) && (event->event->eventnum == eventnum)) {
-            event->inttime += time * 1000.0f + 0.5f;
-
-            node = event->next;
-            while ((node != &Event::EventQueue) && (event->inttime >= node->inttime)) {
-                node = node->next;
-            }
-
-            LL_Remove(event, next, prev);
-            LL_Add(node, event, next, prev);
+    eventnum = ev.eventnum;
 
-            return true;
+    // only the first matching event to be processed is postponed
+    first = NULL;
+    for (event = m_PendingEvents; event; event = event->nextOwned) {
+        if (event->event->eventnum == eventnum && (!first || compareEventQueueNodes(&event, &first) < 0)) {
+            first = event;
         }
-        event = event->next;
     }
 
-    return false;
+    if (!first) {
+        return false;
+    }
+
+    Event::EventQueue.Reschedule(first, first->inttime + (int)(time * 1000.0f + 0.5f));
+    return true;
 }
 
 /*
@@ -3005,6 +3334,7 @@ ProcessPendingEvents
 qboolean Listener::ProcessPendingEvents(void)
 {
     EventQueueNode *event;
+    EventQueueNode *first;
     qboolean        processedEvents;
     float           t;
 
@@ -3014,36 +3344,33 @@ qboolean Listener::ProcessPendingEvents(void)
 
     Listener::ProcessingEvents = true;
 
-    event = Event::EventQueue.next;
-    while (event != &Event::EventQueue) {
-        Listener *obj;
+    Event::EventQueue.LinkOwners();
 
-        assert(event);
-
-        obj = event->GetSourceObject();
+    for (;;) {
+        // find the first event of this listener that is due
+        first = NULL;
+        for (event = m_PendingEvents; event; event = event->nextOwned) {
+            if (event->inttime <= t && (!first || compareEventQueueNodes(&event, &first) < 0)) {
+                first = event;
+            }
+        }
 
-        if (event->inttime > t) {
+        if (!first) {
             break;
         }
 
-        if (obj != this) {
-            // traverse normally
-            event = event->next;
-        } else {
-            // the event is removed from its list and temporarily added to the active list
-            LL_Remove(event, next, prev);
-
-            // ProcessEvent will dispose of this event when it is done
-            obj->ProcessEvent(event->event);
+        // the event is removed from its list
+        Event::EventQueue.Remove(first);
+        first->UnlinkOwner();
 
-            // free up the node
-            delete event;
+        // ProcessEvent will dispose of this event when it is done
+        ProcessEvent(first->event);
 
-            // start over, since can't guarantee that we didn't process any previous or following events
-            event = Event::EventQueue.next;
+        // free up the node
+        delete first;
 
-            processedEvents = true;
-        }
+        // start over, since can't guarantee that we didn't process any previous or following events
+        processedEvents = true;
     }
 
     Listener::ProcessingEvents = false;
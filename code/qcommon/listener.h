@@ -40,6 +40,7 @@ class ScriptVM;
 class SimpleEntity;
 class Archiver;
 class EventQueueNode;
+class EventQueueHeap;
 
 // entity subclass
 #define ECF_ENTITY        (1 << 0)
@@ -272,7 +273,7 @@ public:
 
     static void LoadEvents(void);
 
-    static EventQueueNode EventQueue;
+    static EventQueueHeap EventQueue;
 
     static int NumEventCommands();
 
@@ -416,8 +417,17 @@ public:
     int               flags;
     SafePtr<Listener> m_sourceobject;
 
-    EventQueueNode *prev;
-    EventQueueNode *next;
+    //
+    // Added in OPM
+    //
+    // Order of the node among the nodes with the same time
+    long long order;
+    // Position in the event queue heap
+    int heapIndex;
+    // Listener whose pending event list contains this node
+    Listener       *owner;
+    EventQueueNode *prevOwned;
+    EventQueueNode *nextOwned;
 
 #ifdef _DEBUG
     const char *name;
@@ -425,8 +435,11 @@ public:
 
     EventQueueNode()
     {
-        prev = this;
-        next = this;
+        order     = 0;
+        heapIndex = -1;
+        owner     = NULL;
+        prevOwned = NULL;
+        nextOwned = NULL;
 
 #ifdef _DEBUG
         name = NULL;
@@ -436,6 +449,55 @@ public:
     Listener *GetSourceObject(void) { return m_sourceobject; }
 
     void SetSourceObject(Listener *obj) { m_sourceobject = obj; }
+
+    void LinkOwner(Listener *obj);
+    void UnlinkOwner(void);
+};
+
+//
+// Added in OPM
+//
+// Pending events are kept in a binary heap ordered by time.
+// Events with the same time keep the order of the original sorted list:
+// a posted event goes before the ones already there,
+// an appended or postponed event goes after them
+//
+class EventQueueHeap
+{
+private:
+    EventQueueNode **nodes;
+    int              numNodes;
+    int              maxNodes;
+    long long        postOrder;
+    long long        appendOrder;
+
+private:
+    static bool Less(const EventQueueNode *a, const EventQueueNode *b);
+
+    void Place(EventQueueNode *node, int index);
+    void SiftUp(int index);
+    void SiftDown(int index);
+    void Insert(EventQueueNode *node);
+
+public:
+    // Nodes that were read from a savegame and aren't in their listener's list yet
+    bool bUnlinkedNodes;
+
+public:
+    EventQueueHeap();
+    ~EventQueueHeap();
+
+    void            Post(EventQueueNode *node);
+    void            Append(EventQueueNode *node);
+    void            Reschedule(EventQueueNode *node, int inttime);
+    void            Remove(EventQueueNode *node);
+    void            Reset(void);
+    EventQueueNode *First(void) const;
+    bool            Empty(void) const;
+    int             NumNodes(void) const;
+    EventQueueNode *NodeAt(int index) const;
+    void            SortedNodes(EventQueueNode **list) const;
+    void            LinkOwners(void);
 };
 
 template<class Type1, class Type2>
@@ -459,6 +521,10 @@ public:
     static bool EventSystemStarted;
     static bool ProcessingEvents;
 
+    // Added in OPM
+    //  Pending events posted to this listener, in no particular order
+    EventQueueNode *m_PendingEvents;
+
 private:
 #ifdef WITH_SCRIPT_ENGINE
     void ExecuteScriptInternal(Event *ev, ScriptVariable& scriptVariable);
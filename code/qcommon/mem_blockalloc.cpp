@@ -21,6 +21,10 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
 // mem_blockalloc.cpp: Fast block memory manager
+//
+// MEM_Alloc counts the allocation for its caller in the zone statistics,
+// MEM_AllocCaller for the given caller, as the return address of a wrapper
+// around it would only point into the wrapper
 
 #if defined(GAME_DLL)
 
@@ -28,7 +32,12 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 void *MEM_Alloc(int size)
 {
-    return gi.Malloc(size);
+    return gi.MallocCaller(size, Z_RETURN_ADDRESS());
+}
+
+void *MEM_AllocCaller(int size, const void *caller)
+{
+    return gi.MallocCaller(size, caller);
 }
 
 void MEM_Free(void *ptr)
@@ -42,7 +51,12 @@ void MEM_Free(void *ptr)
 
 void *MEM_Alloc(int size)
 {
-    return cgi.Malloc(size);
+    return cgi.MallocCaller(size, Z_RETURN_ADDRESS());
+}
+
+void *MEM_AllocCaller(int size, const void *caller)
+{
+    return cgi.MallocCaller(size, caller);
 }
 
 void MEM_Free(void *ptr)
@@ -54,9 +68,19 @@ void MEM_Free(void *ptr)
 
 #    include "qcommon.h"
 
+void *MEM_AllocCaller(int size, const void *caller)
+{
+    void *ptr;
+
+    ptr = Z_TagMallocCaller(size, TAG_GENERAL, caller);
+    Com_Memset(ptr, 0, size);
+
+    return ptr;
+}
+
 void *MEM_Alloc(int size)
 {
-    return Z_Malloc(size);
+    return MEM_AllocCaller(size, Z_RETURN_ADDRESS());
 }
 
 void MEM_Free(void *ptr)
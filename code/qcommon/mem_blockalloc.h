@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <new>
 
 void *MEM_Alloc(int size);
+void *MEM_AllocCaller(int size, const void *caller);
 void  MEM_Free(void *ptr);
 
 #ifdef _DEBUG_MEM
@@ -259,7 +260,7 @@ template<typename a, size_t b>
 void *MEM_BlockAlloc<a, b>::Alloc()
 {
 #if _DEBUG_MEMBLOCK
-    block_t *block = new (MEM_Alloc(sizeof(block_t))) block_t();
+    block_t *block = new (MEM_AllocCaller(sizeof(block_t), Z_RETURN_ADDRESS())) block_t();
 
     LL_SafeAddFirst(m_Block, block, next_block, prev_block);
 
@@ -297,7 +298,7 @@ void *MEM_BlockAlloc<a, b>::Alloc()
         } else {
             m_BlockCount++;
             // allocate and construct a new block
-            used_block = new (MEM_Alloc(sizeof(block_t))) block_t();
+            used_block = new (MEM_AllocCaller(sizeof(block_t), Z_RETURN_ADDRESS())) block_t();
 
             free_data = 0;
             next_data = 1;
@@ -45,6 +45,8 @@ typedef struct memblock_s {
 	size_t	size;			// including the header and possibly tiny fragments
 	struct memblock_s		*next, *prev;
 	int     id;				// should be ZONEID
+	short	tag;
+	short	site;			// index in zoneSites, -1 if not counted
 #ifdef ZONE_DEBUG
 	zonedebug_t d;
 #endif
@@ -72,6 +74,85 @@ memconstant_t numberstring[] =
 
 static memblock_t mem_blocks[ TAG_NUM_TOTAL_TAGS ];
 
+// Added in OPM
+//  Allocation statistics per tag, and per call site when com_zoneStats is set.
+//  A call site is the file and line in ZONE_DEBUG builds, the return address otherwise.
+//  The wrappers of the modules (gi/cgi/ri Malloc, MEM_Alloc) take the return address
+//  themselves and pass it down, so the site is the code that called them
+#define MAX_ZONE_SITES	4096	// must be a power of two
+
+typedef struct zoneStats_s {
+	int		allocs;
+	int		frees;
+	size_t	bytes;
+	int		liveBlocks;
+	size_t	liveBytes;
+	int		frameAllocs;
+	int		peakFrameAllocs;
+	int		secondAllocs;		// in the second being counted
+	int		allocsPerSecond;	// in the last complete second
+} zoneStats_t;
+
+typedef struct zoneSite_s {
+	const void	*key;			// file name, or return address when line is 0
+	int			line;
+	int			tag;
+	zoneStats_t	stats;
+} zoneSite_t;
+
+static const char *zoneTagNames[ TAG_NUM_TOTAL_TAGS ] =
+{
+	"free",
+	"const",
+	"general",
+	"botlib",
+	"renderer",
+	"game",
+	"cgame",
+	"client",
+	"tiki",
+	"strings",
+	"sound",
+	"static",
+	"static_renderer",
+	"skel",
+	"temp",
+	"exe"
+};
+
+static cvar_t		*com_zoneStats;
+static zoneStats_t	zoneTagStats[ TAG_NUM_TOTAL_TAGS ];
+static zoneSite_t	zoneSites[ MAX_ZONE_SITES ];
+static short		zoneSiteList[ MAX_ZONE_SITES ];
+static int			zoneNumSites;
+static int			zoneNumFrames;
+static int			zoneSecondStart;
+
+// Added in OPM
+//  The hunk is one large block. Permanent allocations are taken from
+//  the bottom, temporary ones from the top. When com_hunkmegs is 0,
+//  or when the block is full, every allocation is a separate zone block
+#define HUNK_MAGIC		0x89537892
+#define HUNK_FREE_MAGIC	0x89537893
+#define HUNK_ALIGN		16
+
+typedef struct hunkHeader_s {
+	int		magic;
+	size_t	size;			// including the header
+} hunkHeader_t;
+
+#define HUNK_HEADER_SIZE	PAD( sizeof( hunkHeader_t ), HUNK_ALIGN )
+
+static cvar_t *com_hunkmegs;
+
+static byte		*s_hunkData;
+static size_t	s_hunkTotal;
+static size_t	s_hunkLow;		// permanent bytes in use from the bottom
+static size_t	s_hunkLowMark;
+static size_t	s_hunkHigh;		// temporary bytes in use from the top
+static size_t	s_hunkPeak;		// highest s_hunkLow + s_hunkHigh
+static qboolean	s_hunkFullWarned;
+
 /*
 ========================
 Z_EmptyStringPointer
@@ -92,6 +173,78 @@ const char *Z_NumberStringPointer( int iNum )
 	return ( const char * )numberstring[ iNum - '0' ].mem;
 }
 
+/*
+========================
+Z_StatsAlloc
+========================
+*/
+static void Z_StatsAlloc( zoneStats_t *stats, size_t size )
+{
+	stats->allocs++;
+	stats->bytes += size;
+	stats->liveBlocks++;
+	stats->liveBytes += size;
+	stats->frameAllocs++;
+}
+
+/*
+========================
+Z_StatsFree
+========================
+*/
+static void Z_StatsFree( zoneStats_t *stats, size_t size )
+{
+	stats->frees++;
+	stats->liveBlocks--;
+	stats->liveBytes -= size;
+}
+
+/*
+========================
+Z_FindSite
+
+Returns the index of the call site, adding it if needed.
+Returns -1 when sites aren't counted
+========================
+*/
+static int Z_FindSite( const void *key, int line, int tag )
+{
+	zoneSite_t *site;
+	int hash;
+
+	if( !com_zoneStats || !com_zoneStats->integer || !key ) {
+		return -1;
+	}
+
+	hash = ( int )( ( ( uintptr_t )key >> 2 ) ^ ( line * 31 ) ^ ( tag * 7919 ) ) & ( MAX_ZONE_SITES - 1 );
+
+	for( ;; )
+	{
+		site = &zoneSites[ hash ];
+		if( !site->key ) {
+			break;
+		}
+
+		if( site->key == key && site->line == line && site->tag == tag ) {
+			return hash;
+		}
+
+		hash = ( hash + 1 ) & ( MAX_ZONE_SITES - 1 );
+	}
+
+	// keep some room so that probing stays short
+	if( zoneNumSites >= MAX_ZONE_SITES * 3 / 4 ) {
+		return -1;
+	}
+
+	site->key = key;
+	site->line = line;
+	site->tag = tag;
+	zoneSiteList[ zoneNumSites++ ] = hash;
+
+	return hash;
+}
+
 /*
 ========================
 Z_Free
@@ -122,6 +275,11 @@ void Z_Free( void *ptr )
 	block->prev = block;
 	block->next = block;
 
+	Z_StatsFree( &zoneTagStats[ block->tag ], block->size );
+	if( block->site >= 0 ) {
+		Z_StatsFree( &zoneSites[ block->site ].stats, block->size );
+	}
+
 	// free the block
 	free( block );
 }
@@ -148,14 +306,14 @@ void Z_FreeTags( int tag )
 
 /*
 ========================
-Z_TagMalloc
+Z_TagMallocSite
+
+The key and line identify the call site, see zoneSite_t
 ========================
 */
+static void *Z_TagMallocSite( int size, int tag, const char *label, const void *key, int line ) {
 #ifdef ZONE_DEBUG
-void *Z_TagMallocDebug( int size, int tag, const char *label, const char *file, int line ) {
 	int		allocSize;
-#else
-void *Z_TagMalloc( int size, int tag ) {
 #endif
 	memblock_t *block;
 
@@ -188,9 +346,17 @@ void *Z_TagMalloc( int size, int tag ) {
 	block->prev->next = block;
 	mem_blocks[ tag ].prev = block;
 
+	block->tag = tag;
+	block->site = Z_FindSite( key, line, tag );
+
+	Z_StatsAlloc( &zoneTagStats[ tag ], block->size );
+	if( block->site >= 0 ) {
+		Z_StatsAlloc( &zoneSites[ block->site ].stats, block->size );
+	}
+
 #ifdef ZONE_DEBUG
 	block->d.label = label;
-	block->d.file = file;
+	block->d.file = line ? ( const char * )key : "unknown";
 	block->d.line = line;
 	block->d.allocSize = allocSize;
 #endif
@@ -203,6 +369,30 @@ void *Z_TagMalloc( int size, int tag ) {
 	return ( void * )( ( byte * )block + sizeof( memblock_t ) );
 }
 
+/*
+========================
+Z_TagMalloc
+========================
+*/
+#ifdef ZONE_DEBUG
+void *Z_TagMallocDebug( int size, int tag, const char *label, const char *file, int line ) {
+	return Z_TagMallocSite( size, tag, label, file, line );
+}
+#else
+void *Z_TagMalloc( int size, int tag ) {
+	return Z_TagMallocSite( size, tag, NULL, Z_RETURN_ADDRESS(), 0 );
+}
+#endif
+
+/*
+========================
+Z_TagMallocCaller
+========================
+*/
+void *Z_TagMallocCaller( int size, int tag, const void *caller ) {
+	return Z_TagMallocSite( size, tag, NULL, caller, 0 );
+}
+
 /*
 ========================
 Z_CheckHeap
@@ -352,6 +542,13 @@ void Z_Meminfo_f( void )
 	}
 
 	Com_Printf( "\n%.2f Kbytes in %zu blocks in all memory pools\n", ( float )totalBytes / 1024.0f, totalBlocks );
+
+	// Added in OPM
+	if( s_hunkData ) {
+		Com_Printf( "\n%.2f Kbytes of %.2f Kbytes used in the hunk (%.2f Kbytes permanent, %.2f Kbytes temporary, %.2f Kbytes peak)\n",
+			( float )( s_hunkLow + s_hunkHigh ) / 1024.0f, ( float )s_hunkTotal / 1024.0f,
+			( float )s_hunkLow / 1024.0f, ( float )s_hunkHigh / 1024.0f, ( float )s_hunkPeak / 1024.0f );
+	}
 	Com_Printf( "\n%.2f megabytes in 'new' system memory\n", 1.024f );
 
 #ifndef DEDICATED
@@ -362,6 +559,232 @@ void Z_Meminfo_f( void )
 #endif
 }
 
+/*
+========================
+Z_StatsEndFrame
+========================
+*/
+static void Z_StatsEndFrame( zoneStats_t *stats, qboolean endSecond )
+{
+	if( stats->frameAllocs > stats->peakFrameAllocs ) {
+		stats->peakFrameAllocs = stats->frameAllocs;
+	}
+
+	stats->secondAllocs += stats->frameAllocs;
+	stats->frameAllocs = 0;
+
+	if( endSecond ) {
+		stats->allocsPerSecond = stats->secondAllocs;
+		stats->secondAllocs = 0;
+	}
+}
+
+/*
+========================
+Z_StatsFrame
+
+Called at the end of each frame
+========================
+*/
+void Z_StatsFrame( void )
+{
+	qboolean endSecond;
+	int time;
+	int i;
+
+	time = Sys_Milliseconds();
+	endSecond = ( time - zoneSecondStart >= 1000 );
+	if( endSecond ) {
+		zoneSecondStart = time;
+	}
+
+	zoneNumFrames++;
+
+	for( i = 0; i < TAG_NUM_TOTAL_TAGS; i++ ) {
+		Z_StatsEndFrame( &zoneTagStats[ i ], endSecond );
+	}
+
+	for( i = 0; i < zoneNumSites; i++ ) {
+		Z_StatsEndFrame( &zoneSites[ zoneSiteList[ i ] ].stats, endSecond );
+	}
+}
+
+/*
+========================
+Z_ResetStats
+
+Clears the totals, the live counts are kept
+========================
+*/
+static void Z_ResetStats( zoneStats_t *stats )
+{
+	stats->allocs = 0;
+	stats->frees = 0;
+	stats->bytes = 0;
+	stats->peakFrameAllocs = 0;
+}
+
+/*
+========================
+Z_SiteName
+========================
+*/
+static const char *Z_SiteName( const zoneSite_t *site )
+{
+	if( site->line ) {
+		return va( "%s:%i", ( const char * )site->key, site->line );
+	}
+
+	return va( "%p", site->key );
+}
+
+/*
+========================
+Z_CompareSites
+
+Sorts the hottest sites first
+========================
+*/
+static int Z_CompareSites( const void *a, const void *b )
+{
+	const zoneStats_t *sa = &zoneSites[ *( const short * )a ].stats;
+	const zoneStats_t *sb = &zoneSites[ *( const short * )b ].stats;
+
+	if( sa->allocsPerSecond != sb->allocsPerSecond ) {
+		return sb->allocsPerSecond - sa->allocsPerSecond;
+	}
+
+	return sb->allocs - sa->allocs;
+}
+
+/*
+========================
+Z_Stats_f
+
+z_stats [count]: prints the tag totals and the hottest call sites.
+Sites are shown as file:line for the engine's own zone calls in builds
+with ZONE_DEBUG defined, and as return addresses otherwise. Allocations
+made through the game, cgame and renderer imports are always return
+addresses of the module code, resolve them with addr2line or the debugger
+========================
+*/
+void Z_Stats_f( void )
+{
+	short sorted[ MAX_ZONE_SITES ];
+	const zoneStats_t *stats;
+	const zoneSite_t *site;
+	int frames;
+	int count;
+	int i;
+
+	count = 20;
+	if( Cmd_Argc() > 1 ) {
+		count = atoi( Cmd_Argv( 1 ) );
+	}
+
+	frames = zoneNumFrames ? zoneNumFrames : 1;
+
+	Com_Printf( "%-16s %10s %10s %12s %10s %12s %8s %8s %8s\n", "tag", "allocs", "frees", "bytes", "live", "live bytes", "/frame", "peak", "/sec" );
+	for( i = TAG_CONST + 1; i < TAG_NUM_TOTAL_TAGS; i++ )
+	{
+		stats = &zoneTagStats[ i ];
+		Com_Printf( "%-16s %10i %10i %12zu %10i %12zu %8.2f %8i %8i\n", zoneTagNames[ i ],
+			stats->allocs, stats->frees, stats->bytes, stats->liveBlocks, stats->liveBytes,
+			( float )stats->allocs / frames, stats->peakFrameAllocs, stats->allocsPerSecond );
+	}
+
+	if( !com_zoneStats || !com_zoneStats->integer ) {
+		Com_Printf( "\nSet com_zoneStats to 1 to count the allocation sites\n" );
+		return;
+	}
+
+	memcpy( sorted, zoneSiteList, zoneNumSites * sizeof( sorted[ 0 ] ) );
+	qsort( sorted, zoneNumSites, sizeof( sorted[ 0 ] ), Z_CompareSites );
+
+	if( count > zoneNumSites ) {
+		count = zoneNumSites;
+	}
+
+	Com_Printf( "\n%-40s %-16s %10s %12s %10s %8s %8s %8s\n", "site", "tag", "allocs", "bytes", "live", "/frame", "peak", "/sec" );
+	for( i = 0; i < count; i++ )
+	{
+		site = &zoneSites[ sorted[ i ] ];
+		stats = &site->stats;
+		Com_Printf( "%-40s %-16s %10i %12zu %10i %8.2f %8i %8i\n", Z_SiteName( site ), zoneTagNames[ site->tag ],
+			stats->allocs, stats->bytes, stats->liveBlocks,
+			( float )stats->allocs / frames, stats->peakFrameAllocs, stats->allocsPerSecond );
+	}
+
+	Com_Printf( "%i sites, %i frames\n", zoneNumSites, zoneNumFrames );
+#ifdef ZONE_DEBUG
+	Com_Printf( "Engine sites are file:line, module sites are return addresses\n" );
+#else
+	Com_Printf( "Sites are return addresses, build with ZONE_DEBUG for the file:line of engine sites\n" );
+#endif
+}
+
+/*
+========================
+Z_WriteStatsLine
+========================
+*/
+static void Z_WriteStatsLine( fileHandle_t f, const char *type, const char *name, int tag, const zoneStats_t *stats, int frames )
+{
+	FS_Printf( f, "%s,%s,%s,%i,%i,%zu,%i,%zu,%.2f,%i,%i\n", type, name, zoneTagNames[ tag ],
+		stats->allocs, stats->frees, stats->bytes, stats->liveBlocks, stats->liveBytes,
+		( float )stats->allocs / frames, stats->peakFrameAllocs, stats->allocsPerSecond );
+}
+
+/*
+========================
+Z_WriteStats
+
+Writes the statistics of the level to zstats/<name>.csv,
+then starts counting again for the next level
+========================
+*/
+void Z_WriteStats( const char *name )
+{
+	fileHandle_t f;
+	int frames;
+	int i;
+
+	if( !com_zoneStats || !com_zoneStats->integer ) {
+		return;
+	}
+
+	f = FS_FOpenFileWrite( va( "zstats/%s.csv", name ) );
+	if( !f ) {
+		Com_Printf( "Z_WriteStats: couldn't write zstats/%s.csv\n", name );
+		return;
+	}
+
+	frames = zoneNumFrames ? zoneNumFrames : 1;
+
+	FS_Printf( f, "type,name,tag,allocs,frees,bytes,live_blocks,live_bytes,allocs_per_frame,peak_frame_allocs,allocs_per_second\n" );
+
+	for( i = TAG_CONST + 1; i < TAG_NUM_TOTAL_TAGS; i++ ) {
+		Z_WriteStatsLine( f, "tag", zoneTagNames[ i ], i, &zoneTagStats[ i ], frames );
+	}
+
+	for( i = 0; i < zoneNumSites; i++ ) {
+		const zoneSite_t *site = &zoneSites[ zoneSiteList[ i ] ];
+		Z_WriteStatsLine( f, "site", Z_SiteName( site ), site->tag, &site->stats, frames );
+	}
+
+	FS_FCloseFile( f );
+
+	for( i = 0; i < TAG_NUM_TOTAL_TAGS; i++ ) {
+		Z_ResetStats( &zoneTagStats[ i ] );
+	}
+
+	for( i = 0; i < zoneNumSites; i++ ) {
+		Z_ResetStats( &zoneSites[ zoneSiteList[ i ] ].stats );
+	}
+
+	zoneNumFrames = 0;
+}
+
 /*
 ========================
 Z_InitMemory
@@ -379,6 +802,7 @@ void Z_InitMemory( void ) {
 	}
 
 	Cmd_AddCommand( "meminfo", Z_Meminfo_f );
+	Cmd_AddCommand( "z_stats", Z_Stats_f );
 }
 
 /*
@@ -396,6 +820,17 @@ void Z_Shutdown( void ) {
 	}
 }
 
+/*
+=================
+Hunk_UpdatePeak
+=================
+*/
+static void Hunk_UpdatePeak( void ) {
+	if( s_hunkLow + s_hunkHigh > s_hunkPeak ) {
+		s_hunkPeak = s_hunkLow + s_hunkHigh;
+	}
+}
+
 /*
 =================
 Hunk_Alloc
@@ -409,6 +844,25 @@ void *Hunk_AllocDebug( int size, ha_pref preference, const char *label, const ch
 void *Hunk_Alloc( int size, ha_pref preference ) {
 #endif
 	void *ptr;
+	size_t allocSize;
+
+	if( s_hunkData ) {
+		allocSize = PAD( ( size_t )size, HUNK_ALIGN );
+
+		if( s_hunkLow + allocSize <= s_hunkTotal - s_hunkHigh ) {
+			ptr = s_hunkData + s_hunkLow;
+			s_hunkLow += allocSize;
+			Hunk_UpdatePeak();
+
+			memset( ptr, 0, size );
+			return ptr;
+		}
+
+		if( !s_hunkFullWarned ) {
+			Com_Printf( "WARNING: Hunk_Alloc: out of hunk memory, using the zone for the rest of the level. Raise com_hunkmegs\n" );
+			s_hunkFullWarned = qtrue;
+		}
+	}
 
 	ptr = Z_TagMalloc( size, TAG_STATIC );
 	memset( ptr, 0, size );
@@ -424,6 +878,10 @@ The server calls this before shutting down or loading a new map
 =================
 */
 void Hunk_Clear( void ) {
+	s_hunkLow = 0;
+	s_hunkLowMark = 0;
+	s_hunkFullWarned = qfalse;
+
 	Z_FreeTags( TAG_STATIC );
 }
 
@@ -437,16 +895,58 @@ When the files-in-use count reaches zero, all temp memory will be deleted
 =================
 */
 void *Hunk_AllocateTempMemory(int size ) {
+	hunkHeader_t *hdr;
+	size_t allocSize;
+
+	if( s_hunkData ) {
+		allocSize = PAD( ( size_t )size, HUNK_ALIGN ) + HUNK_HEADER_SIZE;
+
+		if( s_hunkLow + s_hunkHigh + allocSize <= s_hunkTotal ) {
+			s_hunkHigh += allocSize;
+			Hunk_UpdatePeak();
+
+			hdr = ( hunkHeader_t * )( s_hunkData + s_hunkTotal - s_hunkHigh );
+			hdr->magic = HUNK_MAGIC;
+			hdr->size = allocSize;
+
+			return ( byte * )hdr + HUNK_HEADER_SIZE;
+		}
+	}
+
 	return Z_TagMalloc( size, TAG_TEMP );
 }
 
 /*
 ========================
 Hunk_FreeTempMemory
+
+Blocks can be freed in any order, the space is
+given back once all the blocks above it are freed too
 ========================
 */
 void Hunk_FreeTempMemory( void *ptr ) {
-	Z_Free( ptr );
+	hunkHeader_t *hdr;
+
+	if( !s_hunkData || ( byte * )ptr < s_hunkData || ( byte * )ptr >= s_hunkData + s_hunkTotal ) {
+		Z_Free( ptr );
+		return;
+	}
+
+	hdr = ( hunkHeader_t * )( ( byte * )ptr - HUNK_HEADER_SIZE );
+	if( hdr->magic != HUNK_MAGIC ) {
+		Com_Error( ERR_FATAL, "Hunk_FreeTempMemory: bad magic" );
+	}
+
+	hdr->magic = HUNK_FREE_MAGIC;
+
+	while( s_hunkHigh ) {
+		hdr = ( hunkHeader_t * )( s_hunkData + s_hunkTotal - s_hunkHigh );
+		if( hdr->magic != HUNK_FREE_MAGIC ) {
+			break;
+		}
+
+		s_hunkHigh -= hdr->size;
+	}
 }
 
 /*
@@ -459,6 +959,8 @@ permanent allocs use this side.
 =================
 */
 void Hunk_ClearTempMemory( void ) {
+	s_hunkHigh = 0;
+
 	Z_FreeTags( TAG_TEMP );
 }
 
@@ -470,7 +972,41 @@ The server calls this after the level and game VM have been loaded
 ===================
 */
 void Hunk_SetMark( void ) {
+	s_hunkLowMark = s_hunkLow;
+}
+
+/*
+===================
+Hunk_ClearToMark
+
+Frees the permanent memory allocated after the mark.
+Allocations that went to the zone stay until Hunk_Clear
+===================
+*/
+void Hunk_ClearToMark( void ) {
+	s_hunkLow = s_hunkLowMark;
+}
+
+/*
+===================
+Hunk_CheckMark
+===================
+*/
+qboolean Hunk_CheckMark( void ) {
+	return s_hunkLowMark ? qtrue : qfalse;
+}
+
+/*
+===================
+Hunk_MemoryRemaining
+===================
+*/
+int Hunk_MemoryRemaining( void ) {
+	if( !s_hunkData ) {
+		return 0;
+	}
 
+	return ( int )( s_hunkTotal - s_hunkLow - s_hunkHigh );
 }
 
 /*
@@ -490,6 +1026,25 @@ Com_InitHunkZoneMemory
 =================
 */
 void Com_InitHunkMemory( void ) {
+	com_hunkmegs = Cvar_Get( "com_hunkmegs", "256", CVAR_LATCH | CVAR_ARCHIVE );
+	Cvar_CheckRange( com_hunkmegs, 0, 2047, qtrue );
+
+	com_zoneStats = Cvar_Get( "com_zoneStats", "0", 0 );
+
+	if( s_hunkData || !com_hunkmegs->integer ) {
+		return;
+	}
+
+	s_hunkTotal = ( size_t )com_hunkmegs->integer * 1024 * 1024;
+	s_hunkData = malloc( s_hunkTotal + HUNK_ALIGN );
+	if( !s_hunkData ) {
+		Com_Printf( "WARNING: Com_InitHunkMemory: couldn't allocate %i megabytes, using the zone instead\n", com_hunkmegs->integer );
+		s_hunkTotal = 0;
+		return;
+	}
+
+	// keep the block aligned, the original pointer is never freed
+	s_hunkData = PADP( s_hunkData, HUNK_ALIGN );
 }
 
 /*
@@ -507,9 +1062,9 @@ void *Z_Malloc( int size ) {
   //Z_CheckHeap ();	// DEBUG
 
 #ifdef ZONE_DEBUG
-	buf = Z_TagMallocDebug( size, TAG_GENERAL, label, file, line );
+	buf = Z_TagMallocSite( size, TAG_GENERAL, label, file, line );
 #else
-	buf = Z_TagMalloc( size, TAG_GENERAL );
+	buf = Z_TagMallocSite( size, TAG_GENERAL, NULL, Z_RETURN_ADDRESS(), 0 );
 #endif
 	Com_Memset( buf, 0, size );
 
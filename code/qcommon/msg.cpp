@@ -317,6 +317,62 @@ void MSG_WriteBits( msg_t *msg, int value, int bits ) {
 	}
 }
 
+/*
+=================
+MSG_WriteEncodedBits
+
+Added in OPM
+Appends bits that were already written to another bitstream message,
+so a part of a message can be encoded once and copied to several ones.
+The huffman codes don't depend on the position in the message
+=================
+*/
+void MSG_WriteEncodedBits( msg_t *msg, const byte *data, int numBits ) {
+	int	i;
+	int	value;
+	int	count;
+	int	shift;
+	int	pos;
+
+	if ( msg->overflowed || !numBits ) {
+		return;
+	}
+
+	if ( msg->oob ) {
+		Com_Error( ERR_DROP, "MSG_WriteEncodedBits: out of band message" );
+	}
+
+	if ( (size_t)( msg->bit + numBits ) > msg->maxsize << 3 ) {
+		msg->overflowed = qtrue;
+		return;
+	}
+
+	for ( i = 0; i < numBits; i += 8 ) {
+		count = numBits - i;
+		if ( count > 8 ) {
+			count = 8;
+		}
+
+		value = data[i >> 3] & ( ( 1 << count ) - 1 );
+		shift = msg->bit & 7;
+		pos = msg->bit >> 3;
+
+		if ( !shift ) {
+			msg->data[pos] = value;
+		} else {
+			// the bits above the current one are always clear
+			msg->data[pos] |= value << shift;
+			if ( count > 8 - shift ) {
+				msg->data[pos + 1] = value >> ( 8 - shift );
+			}
+		}
+
+		msg->bit += count;
+	}
+
+	msg->cursize = ( msg->bit >> 3 ) + 1;
+}
+
 int MSG_ReadBits( msg_t *msg, int bits ) {
 	int			value;
 	int			get;
@@ -20,6 +20,12 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 ===========================================================================
 */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+// Added in OPM
+//  for recvmmsg and sendmmsg
+#	define _GNU_SOURCE
+#endif
+
 #include "../qcommon/q_shared.h"
 #include "../qcommon/qcommon.h"
 
@@ -89,6 +95,12 @@ typedef int SOCKET;
 typedef int	ioctlarg_t;
 #	define socketError			errno
 
+#	ifdef __linux__
+// Added in OPM
+//  datagrams are received and sent several at a time
+#		define USE_NET_BATCHIO
+#	endif
+
 #endif
 
 static qboolean usingSocks = qfalse;
@@ -111,6 +123,39 @@ static cvar_t	*net_mcast6iface;
 
 static cvar_t	*net_dropsim;
 
+#ifdef USE_NET_BATCHIO
+static cvar_t	*net_batchio;
+
+#define	NET_RECV_BATCH		16
+#define	NET_SEND_BATCH		64
+#define	NET_SEND_BATCH_LEN	1500	// larger datagrams are sent alone
+
+// Datagrams read by the last recvmmsg, not handled yet
+typedef struct {
+	SOCKET					sock;
+	int						count;
+	int						next;
+	struct mmsghdr			msgs[NET_RECV_BATCH];
+	struct iovec			iovecs[NET_RECV_BATCH];
+	struct sockaddr_storage	from[NET_RECV_BATCH];
+	byte					data[NET_RECV_BATCH][MAX_MSGLEN + 1];
+} netRecvBatch_t;
+
+// Datagrams waiting for the next sendmmsg
+typedef struct {
+	int						count;
+	SOCKET					socks[NET_SEND_BATCH];
+	netadrtype_t			types[NET_SEND_BATCH];
+	struct mmsghdr			msgs[NET_SEND_BATCH];
+	struct iovec			iovecs[NET_SEND_BATCH];
+	struct sockaddr_storage	to[NET_SEND_BATCH];
+	byte					data[NET_SEND_BATCH][NET_SEND_BATCH_LEN];
+} netSendBatch_t;
+
+static netRecvBatch_t	net_recvBatch;
+static netSendBatch_t	net_sendBatch;
+#endif
+
 static struct sockaddr	socksRelayAddr;
 
 static SOCKET	ip_socket = INVALID_SOCKET;
@@ -513,6 +558,65 @@ qboolean	NET_IsLocalAddress( netadr_t adr ) {
 
 //=============================================================================
 
+/*
+==================
+NET_RecvFrom
+
+Added in OPM
+Same as recvfrom. With batched I/O, the datagrams are read several
+at a time and kept until they are asked for
+==================
+*/
+static int NET_RecvFrom( SOCKET sock, msg_t *net_message, struct sockaddr_storage *from, socklen_t *fromlen )
+{
+#ifdef USE_NET_BATCHIO
+	netRecvBatch_t	*batch = &net_recvBatch;
+	struct mmsghdr	*msg;
+	int				ret;
+	int				i;
+
+	if( batch->next >= batch->count && net_batchio->integer )
+	{
+		for( i = 0; i < NET_RECV_BATCH; i++ )
+		{
+			batch->iovecs[i].iov_base = batch->data[i];
+			batch->iovecs[i].iov_len = sizeof( batch->data[i] );
+
+			Com_Memset( &batch->msgs[i], 0, sizeof( batch->msgs[i] ) );
+			batch->msgs[i].msg_hdr.msg_name = &batch->from[i];
+			batch->msgs[i].msg_hdr.msg_namelen = sizeof( batch->from[i] );
+			batch->msgs[i].msg_hdr.msg_iov = &batch->iovecs[i];
+			batch->msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		ret = recvmmsg( sock, batch->msgs, NET_RECV_BATCH, MSG_DONTWAIT, NULL );
+		if( ret <= 0 )
+			return SOCKET_ERROR;
+
+		batch->sock = sock;
+		batch->count = ret;
+		batch->next = 0;
+	}
+
+	// the datagrams of another socket are kept for later
+	if( batch->next < batch->count && batch->sock == sock )
+	{
+		msg = &batch->msgs[batch->next];
+
+		// truncated like recvfrom would do
+		ret = Q_min( (int)msg->msg_len, net_message->maxsize );
+		Com_Memcpy( net_message->data, batch->data[batch->next], ret );
+		Com_Memcpy( from, &batch->from[batch->next], msg->msg_hdr.msg_namelen );
+		*fromlen = msg->msg_hdr.msg_namelen;
+
+		batch->next++;
+		return ret;
+	}
+#endif
+
+	return recvfrom( sock, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) from, fromlen );
+}
+
 /*
 ==================
 NET_GetPacket
@@ -530,7 +634,7 @@ qboolean NET_GetPacket(netadr_t *net_from, msg_t *net_message, fd_set *fdr)
 	if(ip_socket != INVALID_SOCKET && FD_ISSET(ip_socket, fdr))
 	{
 		fromlen = sizeof(from);
-		ret = recvfrom( ip_socket, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen );
+		ret = NET_RecvFrom( ip_socket, net_message, &from, &fromlen );
 		
 		if (ret == SOCKET_ERROR)
 		{
@@ -574,7 +678,7 @@ qboolean NET_GetPacket(netadr_t *net_from, msg_t *net_message, fd_set *fdr)
 	if(ip6_socket != INVALID_SOCKET && FD_ISSET(ip6_socket, fdr))
 	{
 		fromlen = sizeof(from);
-		ret = recvfrom(ip6_socket, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen);
+		ret = NET_RecvFrom( ip6_socket, net_message, &from, &fromlen );
 		
 		if (ret == SOCKET_ERROR)
 		{
@@ -635,6 +739,107 @@ qboolean NET_GetPacket(netadr_t *net_from, msg_t *net_message, fd_set *fdr)
 
 static char socksBuf[4096];
 
+/*
+==================
+NET_SendError
+
+Added in OPM
+Reports the error of the last send
+==================
+*/
+static void NET_SendError( netadrtype_t type ) {
+	int err = socketError;
+
+	// wouldblock is silent
+	if( err == EAGAIN ) {
+		return;
+	}
+
+	// some PPP links do not allow broadcasts and return an error
+	if( ( err == EADDRNOTAVAIL ) && ( ( type == NA_BROADCAST ) ) ) {
+		return;
+	}
+
+	Com_Printf( "Sys_SendPacket: %s\n", NET_ErrorString() );
+}
+
+/*
+==================
+NET_FlushSends
+
+Added in OPM
+Sends the datagrams queued with batched I/O
+==================
+*/
+void NET_FlushSends( void ) {
+#ifdef USE_NET_BATCHIO
+	netSendBatch_t	*batch = &net_sendBatch;
+	int				first, last;
+	int				ret;
+
+	first = 0;
+	while( first < batch->count ) {
+		// the next datagrams of the same socket go together
+		for( last = first + 1; last < batch->count && batch->socks[last] == batch->socks[first]; last++ ) {
+		}
+
+		ret = sendmmsg( batch->socks[first], &batch->msgs[first], last - first, 0 );
+		if( ret <= 0 ) {
+			// the first datagram couldn't be sent, skip it
+			NET_SendError( batch->types[first] );
+			ret = 1;
+		}
+
+		first += ret;
+	}
+
+	batch->count = 0;
+#endif
+}
+
+/*
+==================
+NET_SendTo
+
+Added in OPM
+Same as sendto. With batched I/O, the datagram is queued
+until NET_FlushSends
+==================
+*/
+static int NET_SendTo( SOCKET sock, const void *data, int length, const struct sockaddr *addr, socklen_t addrlen, netadrtype_t type ) {
+#ifdef USE_NET_BATCHIO
+	netSendBatch_t	*batch = &net_sendBatch;
+	int				i;
+
+	if( net_batchio->integer && length <= NET_SEND_BATCH_LEN ) {
+		if( batch->count == NET_SEND_BATCH ) {
+			NET_FlushSends();
+		}
+
+		i = batch->count++;
+		Com_Memcpy( batch->data[i], data, length );
+		Com_Memcpy( &batch->to[i], addr, addrlen );
+		batch->socks[i] = sock;
+		batch->types[i] = type;
+
+		batch->iovecs[i].iov_base = batch->data[i];
+		batch->iovecs[i].iov_len = length;
+
+		Com_Memset( &batch->msgs[i], 0, sizeof( batch->msgs[i] ) );
+		batch->msgs[i].msg_hdr.msg_name = &batch->to[i];
+		batch->msgs[i].msg_hdr.msg_namelen = addrlen;
+		batch->msgs[i].msg_hdr.msg_iov = &batch->iovecs[i];
+		batch->msgs[i].msg_hdr.msg_iovlen = 1;
+		return length;
+	}
+
+	// keep the datagrams in order
+	NET_FlushSends();
+#endif
+
+	return sendto( sock, data, length, 0, addr, addrlen );
+}
+
 /*
 ==================
 Sys_SendPacket
@@ -670,28 +875,16 @@ void Sys_SendPacket( int length, const void *data, netadr_t to ) {
 		*(int *)&socksBuf[4] = ((struct sockaddr_in *)&addr)->sin_addr.s_addr;
 		*(short *)&socksBuf[8] = ((struct sockaddr_in *)&addr)->sin_port;
 		memcpy( &socksBuf[10], data, length );
-		ret = sendto( ip_socket, socksBuf, length+10, 0, &socksRelayAddr, sizeof(socksRelayAddr) );
+		ret = NET_SendTo( ip_socket, socksBuf, length+10, &socksRelayAddr, sizeof(socksRelayAddr), to.type );
 	}
 	else {
 		if(addr.ss_family == AF_INET)
-			ret = sendto( ip_socket, data, length, 0, (struct sockaddr *) &addr, sizeof(struct sockaddr_in) );
+			ret = NET_SendTo( ip_socket, data, length, (struct sockaddr *) &addr, sizeof(struct sockaddr_in), to.type );
 		else if(addr.ss_family == AF_INET6)
-			ret = sendto( ip6_socket, data, length, 0, (struct sockaddr *) &addr, sizeof(struct sockaddr_in6) );
+			ret = NET_SendTo( ip6_socket, data, length, (struct sockaddr *) &addr, sizeof(struct sockaddr_in6), to.type );
 	}
 	if( ret == SOCKET_ERROR ) {
-		int err = socketError;
-
-		// wouldblock is silent
-		if( err == EAGAIN ) {
-			return;
-		}
-
-		// some PPP links do not allow broadcasts and return an error
-		if( ( err == EADDRNOTAVAIL ) && ( ( to.type == NA_BROADCAST ) ) ) {
-			return;
-		}
-
-		Com_Printf( "Sys_SendPacket: %s\n", NET_ErrorString() );
+		NET_SendError( to.type );
 	}
 }
 
@@ -1480,6 +1673,11 @@ static qboolean NET_GetCvars( void ) {
 
 	net_dropsim = Cvar_Get("net_dropsim", "", CVAR_TEMP);
 
+#ifdef USE_NET_BATCHIO
+	// Added in OPM
+	net_batchio = Cvar_Get( "net_batchio", "0", CVAR_ARCHIVE );
+#endif
+
 	return modified ? qtrue : qfalse;
 }
 
@@ -1529,6 +1727,13 @@ void NET_Config( qboolean enableNetworking ) {
 	}
 
 	if( stop ) {
+		// Added in OPM
+		//  the queued datagrams still go out
+		NET_FlushSends();
+#ifdef USE_NET_BATCHIO
+		net_recvBatch.count = net_recvBatch.next = 0;
+#endif
+
 		if ( ip_socket != INVALID_SOCKET ) {
 			closesocket( ip_socket );
 			ip_socket = INVALID_SOCKET;
@@ -1587,6 +1792,7 @@ void NET_Init( void ) {
 	NET_Config( qtrue );
 	
 	Cmd_AddCommand ("net_restart", NET_Restart_f);
+	Cmd_AddCommand ("net_benchmark", NET_Benchmark_f);
 }
 
 
@@ -1659,6 +1865,21 @@ void NET_Sleep(int msec)
 	int retval;
 	SOCKET highestfd = INVALID_SOCKET;
 
+	// Added in OPM
+	//  send what was queued before waiting
+	NET_FlushSends();
+
+#ifdef USE_NET_BATCHIO
+	// don't wait with datagrams already read
+	if(net_recvBatch.next < net_recvBatch.count)
+	{
+		FD_ZERO(&fdr);
+		FD_SET(net_recvBatch.sock, &fdr);
+		NET_Event(&fdr);
+		return;
+	}
+#endif
+
 	if(msec < 0)
 		msec = 0;
 
@@ -1707,3 +1928,135 @@ void NET_Restart_f(void)
 {
 	NET_Config(qtrue);
 }
+
+#define	NET_BENCHMARK_BURST	32
+#define	NET_BENCHMARK_LEN	1400
+
+/*
+====================
+NET_BenchmarkRun
+
+Added in OPM
+Sends the datagrams to the IPv4 socket through the loopback interface,
+a burst at a time, and reads them back. Returns how many came back
+====================
+*/
+static int NET_BenchmarkRun( netadr_t adr, const byte *data, int size, int numPackets, int *msec )
+{
+	byte		bufData[MAX_MSGLEN + 1];
+	netadr_t	from;
+	msg_t		netmsg;
+	fd_set		fdr;
+	struct timeval timeout;
+	int			startTime;
+	int			sent, received, pending;
+	int			i;
+
+	startTime = Sys_Milliseconds();
+	sent = received = 0;
+
+	while( sent < numPackets ) {
+		pending = Q_min( NET_BENCHMARK_BURST, numPackets - sent );
+		for( i = 0; i < pending; i++ ) {
+			Sys_SendPacket( size, data, adr );
+		}
+		NET_FlushSends();
+		sent += pending;
+
+		while( pending > 0 ) {
+			FD_ZERO( &fdr );
+			FD_SET( ip_socket, &fdr );
+
+			MSG_Init( &netmsg, bufData, sizeof( bufData ) );
+			if( NET_GetPacket( &from, &netmsg, &fdr ) ) {
+				if( netmsg.cursize == size && NET_CompareAdr( from, adr ) ) {
+					received++;
+					pending--;
+				}
+				continue;
+			}
+
+			// the rest of the burst was lost if nothing comes in time
+			timeout.tv_sec = 0;
+			timeout.tv_usec = 100000;
+			if( select( ip_socket + 1, &fdr, NULL, NULL, &timeout ) <= 0 ) {
+				break;
+			}
+		}
+	}
+
+	*msec = Sys_Milliseconds() - startTime;
+	return received;
+}
+
+/*
+====================
+NET_Benchmark_f
+
+Added in OPM
+net_benchmark [packets] [size]
+Measures how many datagrams per second go through the loopback
+interface, with plain and with batched I/O
+====================
+*/
+void NET_Benchmark_f( void )
+{
+	byte				data[NET_BENCHMARK_LEN];
+	struct sockaddr_in	addr;
+	socklen_t			addrlen;
+	netadr_t			adr;
+	int					numPackets, size;
+	int					received, msec;
+	int					i;
+
+	numPackets = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 200000;
+	size = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 100;
+	if( numPackets < 1 || size < 1 || size > NET_BENCHMARK_LEN ) {
+		Com_Printf( "usage: net_benchmark [packets] [size, up to %i]\n", NET_BENCHMARK_LEN );
+		return;
+	}
+
+	// the datagrams of the clients would be taken
+	if( com_sv_running->integer ) {
+		Com_Printf( "net_benchmark can't run while a server is running\n" );
+		return;
+	}
+
+	addrlen = sizeof( addr );
+	if( ip_socket == INVALID_SOCKET || getsockname( ip_socket, (struct sockaddr *)&addr, &addrlen ) == SOCKET_ERROR ) {
+		Com_Printf( "net_benchmark needs the IPv4 socket\n" );
+		return;
+	}
+
+	Com_Memset( &adr, 0, sizeof( adr ) );
+	adr.type = NA_IP;
+	adr.ip[0] = 127;
+	adr.ip[3] = 1;
+	adr.port = addr.sin_port;
+
+	for( i = 0; i < size; i++ ) {
+		data[i] = (byte)i;
+	}
+
+#ifdef USE_NET_BATCHIO
+	{
+		int batchio = net_batchio->integer;
+
+		Cvar_Set( "net_batchio", "0" );
+		received = NET_BenchmarkRun( adr, data, size, numPackets, &msec );
+		Com_Printf( "plain:   %i of %i datagrams of %i bytes in %i ms, %.0f per second\n",
+			received, numPackets, size, msec, received * 1000.0 / Q_max( msec, 1 ) );
+
+		Cvar_Set( "net_batchio", "1" );
+		received = NET_BenchmarkRun( adr, data, size, numPackets, &msec );
+		Com_Printf( "batched: %i of %i datagrams of %i bytes in %i ms, %.0f per second\n",
+			received, numPackets, size, msec, received * 1000.0 / Q_max( msec, 1 ) );
+
+		Cvar_Set( "net_batchio", va( "%i", batchio ) );
+	}
+#else
+	received = NET_BenchmarkRun( adr, data, size, numPackets, &msec );
+	Com_Printf( "%i of %i datagrams of %i bytes in %i ms, %.0f per second\n",
+		received, numPackets, size, msec, received * 1000.0 / Q_max( msec, 1 ) );
+#endif
+}
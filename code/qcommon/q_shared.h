@@ -25,6 +25,12 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #pragma once
 
+// Added in OPM
+//  _ReturnAddress for Z_RETURN_ADDRESS, kept outside of the extern "C" block
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -137,6 +143,17 @@ extern "C" {
 #define Q_EXPORT
 #endif
 
+// Added in OPM
+//  Return address of the current function, the allocation wrappers
+//  take it to count the allocations for their caller
+#if defined(_MSC_VER)
+#define Z_RETURN_ADDRESS()				_ReturnAddress()
+#elif defined(__GNUC__)
+#define Z_RETURN_ADDRESS()				__builtin_return_address(0)
+#else
+#define Z_RETURN_ADDRESS()				NULL
+#endif
+
 /**********************************************************************
   VM Considerations
 
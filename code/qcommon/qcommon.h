@@ -73,6 +73,7 @@ struct entityState_s;
 struct playerState_s;
 
 void MSG_WriteBits( msg_t *msg, int value, int bits );
+void MSG_WriteEncodedBits( msg_t *msg, const byte *data, int numBits );
 
 void MSG_WriteChar (msg_t *sb, int c);
 void MSG_WriteByte (msg_t *sb, int c);
@@ -236,6 +237,7 @@ typedef struct {
 void		NET_Init( void );
 void		NET_Shutdown( void );
 void		NET_Restart_f( void );
+void		NET_Benchmark_f( void ); // Added in OPM
 void		NET_Config( qboolean enableNetworking );
 void		NET_FlushPacketQueue(void);
 void		NET_SendPacket (netsrc_t sock, size_t length, const void *data, netadr_t to);
@@ -253,6 +255,7 @@ qboolean	NET_GetLoopPacket (netsrc_t sock, netadr_t *net_from, msg_t *net_messag
 void		NET_JoinMulticast6(void);
 void		NET_LeaveMulticast6(void);
 void		NET_Sleep(int msec);
+void		NET_FlushSends(void);
 
 
 #define	MAX_MSGLEN				49152		// max length of a message, which may
@@ -916,6 +919,31 @@ void Field_CompleteFilename( const char *dir,
 void Field_CompleteCommand( char *cmd,
 		qboolean doCommands, qboolean doCvars );
 void Field_CompletePlayerName( const char **names, int count );
+
+/*
+==============================================================
+
+JOBS
+
+Added in OPM
+Runs independent items of work on worker threads
+
+==============================================================
+*/
+
+#define MAX_JOB_THREADS 32
+
+typedef void (*jobFunc_t)(void *data, int index);
+
+void Com_RunJobs( jobFunc_t func, void *data, int count, int numThreads );
+void Com_LockJobs( void );
+void Com_UnlockJobs( void );
+void Com_ShutdownJobs( void );
+
+// str_stats.cpp, added in OPM
+void Com_StrStats_f( void );
+void Com_StrBenchmark_f( void );
+
 /*
 ==============================================================
 
@@ -1134,6 +1162,12 @@ void *Z_TagMalloc( int size, int tag );	// NOT 0 filled memory
 void *Z_Malloc( int size );			// returns 0 filled memory
 void *S_Malloc( int size );			// NOT 0 filled memory only for small allocations
 #endif
+// Added in OPM
+//  Allocates like Z_TagMalloc, but counts the allocation for caller
+//  in the zone statistics. Used by wrappers around the zone
+void *Z_TagMallocCaller( int size, int tag, const void *caller );	// NOT 0 filled memory
+void Z_StatsFrame( void );
+void Z_WriteStats( const char *name );
 void Z_Free( void *ptr );
 void Z_FreeTags( int tag );
 int Z_AvailableMemory( void );
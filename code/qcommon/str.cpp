@@ -36,6 +36,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 static const int STR_ALLOC_GRAN = 20;
 
+size_t str::numDataAllocs   = 0;
+size_t str::numSmallStrings = 0;
+
 char *str::tolower(char *s1)
 {
     char *s;
@@ -280,23 +283,25 @@ str& str::operator+=(const unsigned a)
 
 str& str::operator-=(int c)
 {
-    if (!m_data) {
+    size_t len;
+
+    len = length();
+    if (!len) {
         return *this;
     }
 
-    if (!m_data->len) {
+    if (c < 0) {
         return *this;
     }
 
-    if (m_data->len >= c) {
-        m_data->len -= c;
+    if (len >= (size_t)c) {
+        len -= c;
     } else {
-        m_data->len = 0;
+        len = 0;
     }
 
-    EnsureDataWritable();
-
-    m_data->data[m_data->len] = 0;
+    WritableData();
+    SetLength(len);
 
     return *this;
 }
@@ -309,16 +314,12 @@ str& str::operator--(int)
 
 void str::CapLength(size_t newlen)
 {
-    assert(m_data);
-
     if (length() <= newlen) {
         return;
     }
 
-    EnsureDataWritable();
-
-    m_data->data[newlen] = 0;
-    m_data->len          = newlen;
+    WritableData();
+    SetLength(newlen);
 }
 
 void str::EnsureDataWritable(void)
@@ -338,6 +339,7 @@ void str::EnsureDataWritable(void)
     len     = length();
 
     m_data = new strdata;
+    numDataAllocs++;
 
     EnsureAlloced(len + 1, false);
     strncpy(m_data->data, olddata->data, len + 1);
@@ -346,23 +348,75 @@ void str::EnsureDataWritable(void)
     olddata->DelRef();
 }
 
-void str::EnsureAlloced(size_t amount, bool keepold)
+/*
+============
+Set
+
+Added in OPM
+Replaces the string with the given text, which can be a part of it
+============
+*/
+void str::Set(const char *text, size_t len)
 {
-    if (!m_data) {
-        if (amount > 1) {
-            m_data = new strdata;
+    strdata *olddata;
 
-            m_data->data    = new char[amount];
-            m_data->alloced = amount;
+    olddata = m_data;
 
-            m_data->data[0] = '\0';
+    if (len <= SMALL_LENGTH) {
+        memmove(m_small, text, len);
+        m_small[len] = 0;
+        m_smallLen   = (unsigned char)len;
+        m_data       = NULL;
 
-            return;
+        if (len) {
+            numSmallStrings++;
         }
+    } else {
+        m_data          = new strdata;
+        numDataAllocs++;
+        m_data->len     = len;
+        m_data->alloced = len + 1;
+        m_data->data    = new char[len + 1];
+        memcpy(m_data->data, text, len);
+        m_data->data[len] = 0;
+
+        m_smallLen = 0;
+        m_small[0] = 0;
+    }
 
-        if (!m_data) {
+    // after the copy, in case the text was in it
+    if (olddata) {
+        olddata->DelRef();
+    }
+}
+
+void str::EnsureAlloced(size_t amount, bool keepold)
+{
+    if (!m_data) {
+        if (amount <= SMALL_LENGTH + 1) {
+            // fits in the object
+            if (amount > 1 && !m_smallLen) {
+                numSmallStrings++;
+            }
             return;
         }
+
+        m_data = new strdata;
+        numDataAllocs++;
+
+        m_data->data    = new char[amount];
+        m_data->alloced = amount;
+
+        if (keepold) {
+            memcpy(m_data->data, m_small, m_smallLen + 1);
+            m_data->len = m_smallLen;
+        } else {
+            m_data->data[0] = '\0';
+        }
+
+        m_smallLen = 0;
+
+        return;
     }
 
     // Now, let's make sure it's writable
@@ -409,12 +463,13 @@ void str::EnsureAlloced(size_t amount, bool keepold)
 void str::BackSlashesToSlashes(void)
 {
     size_t i;
+    char  *data;
 
-    EnsureDataWritable();
+    data = WritableData();
 
-    for (i = 0; i < m_data->len; i++) {
-        if (m_data->data[i] == '\\') {
-            m_data->data[i] = '/';
+    for (i = 0; i < length(); i++) {
+        if (data[i] == '\\') {
+            data[i] = '/';
         }
     }
 }
@@ -422,23 +477,23 @@ void str::BackSlashesToSlashes(void)
 void str::SlashesToBackSlashes(void)
 {
     size_t i;
+    char  *data;
 
-    EnsureDataWritable();
+    data = WritableData();
 
-    for (i = 0; i < m_data->len; i++) {
-        if (m_data->data[i] == '/') {
-            m_data->data[i] = '\\';
+    for (i = 0; i < length(); i++) {
+        if (data[i] == '/') {
+            data[i] = '\\';
         }
     }
 }
 
 void str::DefaultExtension(const char *extension)
 {
-    EnsureDataWritable();
-
-    const char *src = m_data->data + m_data->len - 1;
+    const char *data = c_str();
+    const char *src  = data + length() - 1;
 
-    while (*src != '/' && src != m_data->data) {
+    while (length() && *src != '/' && src != data) {
         if (*src == '.') {
             // it has an extension
             return;
@@ -452,62 +507,63 @@ void str::DefaultExtension(const char *extension)
 
 const char *str::GetExtension() const
 {
-    size_t length, i;
+    const char *data;
+    size_t      length, i;
+
+    if (!this->length()) {
+        return "";
+    }
 
-    length = m_data->len - 1;
+    data   = c_str();
+    length = this->length() - 1;
     i      = length;
 
-    while (m_data->data[i] != '.') {
+    while (data[i] != '.') {
         i--;
-        if (m_data->data[i] == '/' || i == 0) {
+        if (data[i] == '/' || i == 0) {
             return ""; // no extension
         }
     }
 
-    return &m_data->data[i + 1];
+    return &data[i + 1];
 }
 
 void str::StripExtension()
 {
-    EnsureDataWritable();
+    char *data = WritableData();
 
-    size_t i = m_data->len;
-    while (i > 0 && m_data->data[i] != '.') {
+    size_t i = length();
+    while (i > 0 && data[i] != '.') {
         i--;
-        if (m_data->data[i] == '/') {
+        if (data[i] == '/') {
             return; // no extension
         }
     }
     if (i) {
-        m_data->len               = i;
-        m_data->data[m_data->len] = 0;
-
-        EnsureDataWritable();
+        SetLength(i);
     }
 }
 
 void str::SkipFile()
 {
-    EnsureDataWritable();
+    char *data = WritableData();
 
-    size_t i = m_data->len;
-    while (i > 0 && m_data->data[i] != '/' && m_data->data[i] != '\\') {
+    size_t i = length();
+    while (i > 0 && data[i] != '/' && data[i] != '\\') {
         i--;
     }
-    m_data->len               = i;
-    m_data->data[m_data->len] = 0;
 
-    EnsureDataWritable();
+    SetLength(i);
 }
 
 void str::SkipPath()
 {
-    EnsureDataWritable();
+    char *data = WritableData();
 
-    const char *pathname = m_data->data;
+    const char *pathname = data;
     const char *last;
 
-    last = m_data->data;
+    last = data;
     while (*pathname) {
         if (*pathname == '/' || *pathname == '\\') {
             last = pathname + 1;
@@ -515,17 +571,14 @@ void str::SkipPath()
         pathname++;
     }
 
-    size_t lastpos = last - m_data->data;
+    size_t lastpos = last - data;
     if (lastpos > 0) {
-        size_t length = m_data->len - lastpos;
+        size_t length = this->length() - lastpos;
         for (size_t i = 0; i < length; i++) {
-            m_data->data[i] = last[i];
+            data[i] = last[i];
         }
 
-        m_data->len          = length;
-        m_data->data[length] = 0;
-
-        EnsureDataWritable();
+        SetLength(length);
     }
 }
 
@@ -544,19 +597,23 @@ void str::snprintf(char *dst, int size, const char *fmt, ...)
 
 void str::strip(void)
 {
+    char  *data;
     char  *last;
     char  *s;
     size_t i;
+    size_t len;
 
-    if (m_data == NULL || m_data->data == NULL) {
+    if (!length()) {
         return;
     }
-    s = m_data->data;
+
+    data = WritableData();
+    s    = data;
     while (isspace((int)*s) && *s) {
         s++;
     }
 
-    last = s + m_data->len - (s - m_data->data);
+    last = s + length() - (s - data);
     while (last > s) {
         if (!isspace((int)*(last - 1))) {
             break;
@@ -564,14 +621,12 @@ void str::strip(void)
         last--;
     }
 
-    *last = '\0';
-
-    m_data->len = last - s;
-    for (i = 0; i < m_data->len + 1; i++) {
-        m_data->data[i] = s[i];
+    len = last - s;
+    for (i = 0; i < len; i++) {
+        data[i] = s[i];
     }
 
-    EnsureDataWritable();
+    SetLength(len);
 }
 
 char *strstrip(char *string)
@@ -731,6 +786,64 @@ void TestStringClass(void)
     a[1] = '1'; // a.data = "t1st", b.data = "test"
 }
 
+/*
+=================
+TestStringSpeed
+
+Added in OPM
+Builds, copies, joins and compares strings like the game code does with
+names, keys and event arguments. Returns the total length of the strings
+so the work can't be optimized away
+=================
+*/
+size_t TestStringSpeed(int iterations)
+{
+    static const char *names[] = {
+        "idle",
+        "targetname",
+        "$player",
+        "weapon_mp40",
+        "run_forward_rifle",
+        "models/weapons/m1_garand.tik",
+        "global/weapon.scr::reload_done",
+        "models/human/allied_airborne_soldier.tik",
+    };
+    static const size_t numNames = sizeof(names) / sizeof(names[0]);
+    size_t              total;
+    int                 i;
+
+    total = 0;
+    for (i = 0; i < iterations; i++) {
+        str name = names[i % numNames];
+        str copy = name;
+        str number(i);
+        str key;
+
+        key = name + "_" + number;
+        key.tolower();
+        total += key.length();
+
+        // the long names are shared with the copy until it is written
+        copy += ".";
+        copy += number;
+        total += copy.length();
+
+        str path = "models/" + key + ".tik";
+        path.StripExtension();
+        path.SkipPath();
+        if (!path.icmp(key)) {
+            total += path.length();
+        }
+
+        str part(path, 0, 8);
+        if (part != number) {
+            total += part.length();
+        }
+    }
+
+    return total;
+}
+
 #ifdef _WIN32
 #    pragma warning(default : 4189) // local variable is initialized but not referenced
 #    pragma warning(disable : 4514) // unreferenced inline function has been removed
@@ -35,7 +35,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #    pragma warning(disable : 4710) // function 'blah' not inlined
 #endif
 
-void TestStringClass();
+void   TestStringClass();
+size_t TestStringSpeed(int iterations); // Added in OPM
 
 class strdata
 {
@@ -77,9 +78,21 @@ class str
 {
 protected:
     friend class Archiver;
-    strdata *m_data;
-    void     EnsureAlloced(size_t, bool keepold = true);
-    void     EnsureDataWritable();
+
+    // Added in OPM
+    //  Short strings are kept inside the object, in m_small.
+    //  Longer strings are in m_data, shared between copies until written
+    static const size_t SMALL_LENGTH = 22;
+
+    strdata      *m_data;
+    unsigned char m_smallLen;
+    char          m_small[SMALL_LENGTH + 1];
+
+    void  EnsureAlloced(size_t, bool keepold = true);
+    void  EnsureDataWritable();
+    char *WritableData();
+    void  SetLength(size_t len);
+    void  Set(const char *text, size_t len);
 
 public:
     ~str();
@@ -175,6 +188,11 @@ public:
     void        StripExtension();
     void        SkipFile();
     void        SkipPath();
+
+    // Added in OPM
+    //  Counts for the strstats commands, kept by each module
+    static size_t numDataAllocs;   // strdata blocks allocated
+    static size_t numSmallStrings; // strings built in m_small, that each allocated a strdata before
 };
 
 char *strstrip(char *string);
@@ -182,27 +200,21 @@ char *strlwc(char *string);
 
 inline char str::operator[](intptr_t index) const
 {
-    assert(m_data);
-
-    if (!m_data) {
-        return 0;
-    }
-
     // don't include the '/0' in the test, because technically, it's out of bounds
-    assert((index >= 0) && (index < (int)m_data->len));
+    assert((index >= 0) && (index < (int)length()));
 
     // In release mode, give them a null character
     // don't include the '/0' in the test, because technically, it's out of bounds
-    if ((index < 0) || (index >= (int)m_data->len)) {
+    if ((index < 0) || (index >= (int)length())) {
         return 0;
     }
 
-    return m_data->data[index];
+    return c_str()[index];
 }
 
 inline size_t str::length(void) const
 {
-    return (m_data != NULL) ? m_data->len : 0;
+    return (m_data != NULL) ? m_data->len : m_smallLen;
 }
 
 inline str::~str()
@@ -215,45 +227,43 @@ inline str::~str()
 
 inline str::str()
     : m_data(NULL)
-{}
+    , m_smallLen(0)
+{
+    m_small[0] = 0;
+}
 
 inline str::str(const char *text)
     : m_data(NULL)
+    , m_smallLen(0)
 {
-    size_t len;
-
     assert(text);
-    if (*text) {
-        len = strlen(text);
 
-        if (len) {
-            EnsureAlloced(len + 1);
-            strcpy(m_data->data, text);
-            m_data->len = len;
-        }
+    m_small[0] = 0;
+    if (*text) {
+        Set(text, strlen(text));
     }
 }
 
 inline str::str(const str& text)
-    : m_data(NULL)
+    : m_data(text.m_data)
+    , m_smallLen(text.m_smallLen)
 {
-    if (text.m_data) {
-        text.m_data->AddRef();
-    }
-
     if (m_data) {
-        m_data->DelRef();
+        m_data->AddRef();
+        m_small[0] = 0;
+    } else {
+        memcpy(m_small, text.m_small, m_smallLen + 1);
     }
-
-    m_data = text.m_data;
 }
 
 inline str::str(const str& text, size_t start, size_t end)
     : m_data(NULL)
+    , m_smallLen(0)
 {
-    size_t i;
     size_t len;
 
+    m_small[0] = 0;
+
     if (end > text.length()) {
         end = text.length();
     }
@@ -269,116 +279,86 @@ inline str::str(const str& text, size_t start, size_t end)
     }
 
     if (len > 0) {
-        EnsureAlloced(len + 1);
-
-        for (i = 0; i < len; i++) {
-            m_data->data[i] = text[start + i];
-        }
-
-        m_data->data[len] = 0;
-        m_data->len       = len;
+        Set(text.c_str() + start, len);
     }
 }
 
 inline str::str(const char ch)
     : m_data(NULL)
+    , m_smallLen(1)
 {
-    EnsureAlloced(2);
-
-    m_data->data[0] = ch;
-    m_data->data[1] = 0;
-    m_data->len     = 1;
+    m_small[0] = ch;
+    m_small[1] = 0;
 }
 
 inline str::str(const float num)
     : m_data(NULL)
+    , m_smallLen(0)
 {
-    char   text[32];
-    size_t len;
+    char text[32];
 
     snprintf(text, sizeof(text), "%.3f", num);
-    len = strlen(text);
-    EnsureAlloced(len + 1);
-    strcpy(m_data->data, text);
-    m_data->len = len;
+    Set(text, strlen(text));
 }
 
 inline str::str(const int num)
     : m_data(NULL)
+    , m_smallLen(0)
 {
-    char   text[32];
-    size_t len;
+    char text[32];
 
     snprintf(text, sizeof(text), "%d", num);
-    len = strlen(text);
-    EnsureAlloced(len + 1);
-    strcpy(m_data->data, text);
-    m_data->len = len;
+    Set(text, strlen(text));
 }
 
 inline str::str(const unsigned int num)
     : m_data(NULL)
+    , m_smallLen(0)
 {
-    char   text[32];
-    size_t len;
+    char text[32];
 
     snprintf(text, sizeof(text), "%u", num);
-    len = strlen(text);
-    EnsureAlloced(len + 1);
-    strcpy(m_data->data, text);
-    m_data->len = len;
+    Set(text, strlen(text));
 }
 
 inline str::str(const long num)
     : m_data(NULL)
+    , m_smallLen(0)
 {
-    char   text[64];
-    size_t len;
+    char text[64];
 
     snprintf(text, sizeof(text), "%ld", num);
-    len = strlen(text);
-    EnsureAlloced(len + 1);
-    strcpy(m_data->data, text);
-    m_data->len = len;
+    Set(text, strlen(text));
 }
 
 inline str::str(const unsigned long num)
     : m_data(NULL)
+    , m_smallLen(0)
 {
-    char   text[64];
-    size_t len;
+    char text[64];
 
     snprintf(text, sizeof(text), "%lu", num);
-    len = strlen(text);
-    EnsureAlloced(len + 1);
-    strcpy(m_data->data, text);
-    m_data->len = len;
+    Set(text, strlen(text));
 }
 
 inline str::str(const long long num)
     : m_data(NULL)
+    , m_smallLen(0)
 {
-    char   text[64];
-    size_t len;
+    char text[64];
 
     snprintf(text, sizeof(text), "%lld", num);
-    len = strlen(text);
-    EnsureAlloced(len + 1);
-    strcpy(m_data->data, text);
-    m_data->len = len;
+    Set(text, strlen(text));
 }
 
 inline str::str(const unsigned long long num)
     : m_data(NULL)
+    , m_smallLen(0)
 {
-    char   text[64];
-    size_t len;
+    char text[64];
 
     snprintf(text, sizeof(text), "%llu", num);
-    len = strlen(text);
-    EnsureAlloced(len + 1);
-    strcpy(m_data->data, text);
-    m_data->len = len;
+    Set(text, strlen(text));
 }
 
 inline const char *str::c_str(void) const
@@ -386,41 +366,78 @@ inline const char *str::c_str(void) const
     if (m_data) {
         return m_data->data;
     } else {
-        return "";
+        return m_small;
     }
 }
 
 inline str::str(str&& string)
     : m_data(string.m_data)
+    , m_smallLen(string.m_smallLen)
 {
-    string.m_data = NULL;
+    memcpy(m_small, string.m_small, sizeof(m_small));
+
+    string.m_data     = NULL;
+    string.m_smallLen = 0;
+    string.m_small[0] = 0;
 }
 
 inline str& str::operator=(str&& string)
 {
+    if (this == &string) {
+        return *this;
+    }
+
     if (m_data) {
         m_data->DelRef();
     }
 
-    m_data        = string.m_data;
-    string.m_data = NULL;
+    m_data     = string.m_data;
+    m_smallLen = string.m_smallLen;
+    memcpy(m_small, string.m_small, sizeof(m_small));
+
+    string.m_data     = NULL;
+    string.m_smallLen = 0;
+    string.m_small[0] = 0;
 
     return *this;
 }
 
+inline char *str::WritableData()
+{
+    if (m_data) {
+        EnsureDataWritable();
+        return m_data->data;
+    }
+
+    return m_small;
+}
+
+inline void str::SetLength(size_t len)
+{
+    // the data must be writable
+    if (m_data) {
+        m_data->len       = len;
+        m_data->data[len] = 0;
+    } else {
+        m_smallLen  = (unsigned char)len;
+        m_small[len] = 0;
+    }
+}
+
 inline void str::append(const char *text)
 {
-    size_t len;
+    size_t oldlen;
+    size_t addlen;
 
     assert(text);
 
     if (*text) {
-        len = length();
-        len += strlen(text);
-        EnsureAlloced(len + 1);
+        oldlen = length();
+        addlen = strlen(text);
+        EnsureAlloced(oldlen + addlen + 1);
 
-        strcat(m_data->data, text);
-        m_data->len = len;
+        memcpy(WritableData() + oldlen, text, addlen);
+        SetLength(oldlen + addlen);
     }
 }
 
@@ -433,30 +450,30 @@ inline char& str::operator[](intptr_t index)
 {
     // Used for result for invalid indices
     static char dummy = 0;
-    assert(m_data);
+    char       *data;
 
     // We don't know if they'll write to it or not
     // if it's not a const object
-    EnsureDataWritable();
-
-    if (!m_data) {
-        return dummy;
-    }
+    data = WritableData();
 
     // don't include the '/0' in the test, because technically, it's out of bounds
-    assert((index >= 0) && (index < (int)m_data->len));
+    assert((index >= 0) && (index < (int)length()));
 
     // In release mode, let them change a safe variable
     // don't include the '/0' in the test, because technically, it's out of bounds
-    if ((index < 0) || (index >= (int)m_data->len)) {
+    if ((index < 0) || (index >= (int)length())) {
         return dummy;
     }
 
-    return m_data->data[index];
+    return data[index];
 }
 
 inline void str::operator=(const str& text)
 {
+    if (this == &text) {
+        return;
+    }
+
     // adding the reference before deleting our current reference prevents
     // us from deleting our string if we are copying from ourself
     if (text.m_data) {
@@ -467,33 +484,24 @@ inline void str::operator=(const str& text)
         m_data->DelRef();
     }
 
-    m_data = text.m_data;
+    m_data     = text.m_data;
+    m_smallLen = text.m_smallLen;
+    if (m_data) {
+        m_small[0] = 0;
+    } else {
+        memcpy(m_small, text.m_small, m_smallLen + 1);
+    }
 }
 
 inline void str::operator=(const char *text)
 {
-    size_t len;
-
     assert(text);
 
-    if (m_data) {
-        if (text == m_data->data) {
-            return; // Copying same thing.  Punt.
-        }
-
-        m_data->DelRef();
-        m_data = NULL;
+    if (text == c_str()) {
+        return; // Copying same thing.  Punt.
     }
 
-    if (*text) {
-        len = strlen(text);
-
-        m_data          = new strdata;
-        m_data->len     = len;
-        m_data->alloced = len + 1;
-        m_data->data    = new char[len + 1];
-        strcpy(m_data->data, text);
-    }
+    Set(text, strlen(text));
 }
 
 inline str operator+(const str& a, const str& b)
@@ -647,26 +655,17 @@ inline int str::cmpn(const str& text, size_t n) const
 
 inline void str::tolower(void)
 {
-    if (m_data) {
-        EnsureDataWritable();
-
-        str::tolower(m_data->data);
-    }
+    str::tolower(WritableData());
 }
 
 inline void str::toupper(void)
 {
-    if (m_data) {
-        EnsureDataWritable();
-
-        str::toupper(m_data->data);
-    }
+    str::toupper(WritableData());
 }
 
 inline bool str::isNumeric(void) const
 {
-    assert(m_data);
-    return str::isNumeric(m_data->data);
+    return str::isNumeric(c_str());
 }
 
 inline str::operator const char *(void) const
@@ -0,0 +1,96 @@
+/*
+===========================================================================
+Copyright (C) 2025 the OpenMoHAA team
+
+This file is part of OpenMoHAA source code.
+
+OpenMoHAA source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+OpenMoHAA source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with OpenMoHAA source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+// str_stats.cpp: Console commands measuring the strings of the engine.
+//
+// Each module has its own copy of the str class, the game module
+// prints its own counts with gamestrstats.
+//
+
+#include "q_shared.h"
+#include "qcommon.h"
+#include "str.h"
+
+/*
+==================
+Com_StrStats_f
+
+strstats [reset]
+==================
+*/
+void Com_StrStats_f(void)
+{
+    if (Cmd_Argc() > 1) {
+        if (Q_stricmp(Cmd_Argv(1), "reset")) {
+            Com_Printf("Usage: strstats [reset]\n");
+            return;
+        }
+
+        str::numDataAllocs   = 0;
+        str::numSmallStrings = 0;
+        return;
+    }
+
+    Com_Printf(
+        "%zu strdata allocations, %zu strings kept inline (%zu bytes per str)\n",
+        str::numDataAllocs,
+        str::numSmallStrings,
+        sizeof(str)
+    );
+}
+
+/*
+==================
+Com_StrBenchmark_f
+
+strbenchmark [iterations]
+==================
+*/
+void Com_StrBenchmark_f(void)
+{
+    size_t numDataAllocs, numSmallStrings;
+    size_t total;
+    int    iterations;
+    int    startTime, msec;
+
+    iterations = Cmd_Argc() > 1 ? atoi(Cmd_Argv(1)) : 1000000;
+    if (iterations < 1) {
+        Com_Printf("Usage: strbenchmark [iterations]\n");
+        return;
+    }
+
+    numDataAllocs   = str::numDataAllocs;
+    numSmallStrings = str::numSmallStrings;
+
+    startTime = Sys_Milliseconds();
+    total     = TestStringSpeed(iterations);
+    msec      = Sys_Milliseconds() - startTime;
+
+    Com_Printf(
+        "%i iterations in %i ms: %zu strdata allocations, %zu strings kept inline (%zu characters)\n",
+        iterations,
+        msec,
+        str::numDataAllocs - numDataAllocs,
+        str::numSmallStrings - numSmallStrings,
+        total
+    );
+}
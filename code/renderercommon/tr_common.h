@@ -175,6 +175,13 @@ void		GLimp_Init( qboolean fixedFunction );
 void		GLimp_Shutdown( void );
 void		GLimp_EndFrame( void );
 
+// Added in OPM
+qboolean	GLimp_SpawnRenderThread( void (*function)( void ) );
+void		*GLimp_RendererSleep( void );
+void		GLimp_FrontEndSleep( void );
+void		GLimp_WakeRenderer( void *data );
+qboolean	GLimp_InRenderThread( void );
+
 void		GLimp_LogComment( char *comment );
 void		GLimp_Minimize(void);
 
@@ -326,6 +326,12 @@ typedef struct {
     //
     int (*SKEL_GetMorphWeightFrame)(void *skeletor, int index, float time, int *data);
     int (*SKEL_GetBoneParent)(void *skeletor, int boneIndex);
+
+    //
+    // Job imports
+    //
+    // Added in OPM
+    void (*RunJobs)(void (*func)(void *data, int index), void *data, int count, int numThreads);
 } refimport_t;
 
 
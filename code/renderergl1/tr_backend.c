@@ -21,7 +21,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 #include "tr_local.h"
 
-backEndData_t	*backEndData;
+backEndData_t	*backEndData[SMP_FRAMES];
 backEndState_t	backEnd;
 
 
@@ -708,6 +708,10 @@ void RB_RenderDrawSurfList( drawSurf_t *drawSurfs, int numDrawSurfs ) {
 	// clear the z buffer, set the modelview, etc
 	RB_BeginDrawingView ();
 
+	// Added in OPM
+	//  skin the skeletal models of the view before drawing them
+	RB_PrepareSkinCache( drawSurfs, numDrawSurfs );
+
 	// draw everything
 	oldEntityNum = -1;
 	backEnd.currentEntity = &tr.worldEntity;
@@ -837,7 +841,7 @@ void RB_RenderDrawSurfList( drawSurf_t *drawSurfs, int numDrawSurfs ) {
 			}
 			else if (shader->needsLSpherical)
 			{
-				if (tr.refdef.rdflags & RDF_HUD)
+				if (backEnd.refdef.rdflags & RDF_HUD)
 				{
 					backEnd.currentSphere = &backEnd.hudSphere;
 					backEnd.hudSphere.TessFunction = 0;
@@ -1408,12 +1412,11 @@ const void	*RB_SwapBuffers( const void *data ) {
 
 	// we measure overdraw by reading back the stencil buffer and
 	// counting up the number of increments that have happened
-	if ( r_measureOverdraw->integer ) {
+	if ( cmd->stencilReadback ) {
 		int i;
 		long sum = 0;
-		unsigned char *stencilReadback;
+		unsigned char *stencilReadback = cmd->stencilReadback;
 
-		stencilReadback = ri.Hunk_AllocateTempMemory( glConfig.vidWidth * glConfig.vidHeight );
 		qglReadPixels( 0, 0, glConfig.vidWidth, glConfig.vidHeight, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, stencilReadback );
 
 		for ( i = 0; i < glConfig.vidWidth * glConfig.vidHeight; i++ ) {
@@ -1421,7 +1424,6 @@ const void	*RB_SwapBuffers( const void *data ) {
 		}
 
 		backEnd.pc.c_overDraw += sum;
-		ri.Hunk_FreeTempMemory( stencilReadback );
 	}
 
 
@@ -1433,6 +1435,9 @@ const void	*RB_SwapBuffers( const void *data ) {
 
 	GLimp_EndFrame();
 
+	// Added in OPM
+	RB_EndSkinFrame();
+
 	backEnd.in2D = qfalse;
 
 	return (const void *)(cmd + 1);
@@ -1451,6 +1456,25 @@ void RB_ExecuteRenderCommands( const void *data ) {
 
 	t1 = ri.Milliseconds ();
 
+	// Added in OPM
+	if ( !glConfig.smpActive || data == backEndData[0]->commands.cmds ) {
+		backEnd.smpFrame = 0;
+	} else {
+		backEnd.smpFrame = 1;
+	}
+
+	if ( glConfig.smpActive ) {
+		backEnd.skelBones = backEndData[backEnd.smpFrame]->skelBones;
+		backEnd.skelMorphs = backEndData[backEnd.smpFrame]->skelMorphs;
+		backEnd.terrainVerts = backEndData[backEnd.smpFrame]->terrainVerts;
+		backEnd.terrainTris = backEndData[backEnd.smpFrame]->terrainTris;
+	} else {
+		backEnd.skelBones = TIKI_Skel_Bones;
+		backEnd.skelMorphs = skeletorMorphCache;
+		backEnd.terrainVerts = g_pVert;
+		backEnd.terrainTris = g_pTris;
+	}
+
 	while ( 1 ) {
 		data = PADP(data, sizeof(void *));
 
@@ -1495,3 +1519,29 @@ void RB_ExecuteRenderCommands( const void *data ) {
 	}
 
 }
+
+
+/*
+================
+RB_RenderThread
+================
+*/
+void RB_RenderThread( void ) {
+	const void	*data;
+
+	// wait for either a rendering command or a quit command
+	while ( 1 ) {
+		// sleep until we have work to do
+		data = GLimp_RendererSleep();
+
+		if ( !data ) {
+			return;	// all done, renderer is shutting down
+		}
+
+		renderThreadActive = qtrue;
+
+		RB_ExecuteRenderCommands( data );
+
+		renderThreadActive = qfalse;
+	}
+}
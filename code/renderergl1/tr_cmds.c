@@ -21,8 +21,13 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 #include "tr_local.h"
 
+volatile qboolean	renderThreadActive;
+
 static backEndCounters_t pc_save;
 
+// Added in OPM
+static byte *overdrawReadback;
+
 /*
 =====================
 R_SavePerformanceCounters
@@ -91,15 +96,92 @@ void R_PerformanceCounters( void ) {
 }
 
 
+/*
+====================
+R_InitCommandBuffers
+====================
+*/
+void R_InitCommandBuffers( void ) {
+	glConfig.smpActive = qfalse;
+	if ( r_smp->integer ) {
+		ri.Printf( PRINT_ALL, "Trying SMP acceleration...\n" );
+		if ( GLimp_SpawnRenderThread( RB_RenderThread ) ) {
+			ri.Printf( PRINT_ALL, "...succeeded.\n" );
+			glConfig.smpActive = qtrue;
+		} else {
+			ri.Printf( PRINT_ALL, "...failed.\n" );
+		}
+	}
+}
+
+/*
+====================
+R_ShutdownCommandBuffers
+====================
+*/
+void R_ShutdownCommandBuffers( void ) {
+	// kill the rendering thread
+	if ( glConfig.smpActive ) {
+		GLimp_FrontEndSleep();
+		GLimp_WakeRenderer( NULL );
+		glConfig.smpActive = qfalse;
+	}
+
+	// Added in OPM
+	if ( overdrawReadback ) {
+		ri.Free( overdrawReadback );
+		overdrawReadback = NULL;
+	}
+}
+
+/*
+====================
+R_OverdrawReadback
+
+Added in OPM
+The stencil readback buffer of r_measureOverdraw, allocated once here
+as the temp hunk can't be used from the render thread.
+It lives until the renderer is shut down (the video size can't change before)
+====================
+*/
+static byte *R_OverdrawReadback( void ) {
+	if ( !r_measureOverdraw->integer ) {
+		return NULL;
+	}
+
+	if ( !overdrawReadback ) {
+		overdrawReadback = ri.Malloc( glConfig.vidWidth * glConfig.vidHeight );
+	}
+
+	return overdrawReadback;
+}
+
+/*
+====================
+R_CopySkeletorCaches
+
+Added in OPM
+The front end rebuilds the skeletor caches for the next frame
+while the render thread is still skinning from them
+====================
+*/
+static void R_CopySkeletorCaches( backEndData_t *data ) {
+	Com_Memcpy( data->skelBones, TIKI_Skel_Bones, TIKI_Skel_Bones_Index * sizeof( skelBoneCache_t ) );
+	Com_Memcpy( data->skelMorphs, skeletorMorphCache, skeletorMorphCacheIndex * sizeof( int ) );
+}
+
 /*
 ====================
 R_IssueRenderCommands
 ====================
 */
+int	c_blockedOnRender;
+int	c_blockedOnMain;
+
 void R_IssueRenderCommands( qboolean runPerformanceCounters ) {
 	renderCommandList_t	*cmdList;
 
-	cmdList = &backEndData->commands;
+	cmdList = &backEndData[tr.smpFrame]->commands;
 	assert(cmdList);
 	// add an end-of-list command
 	*(int *)(cmdList->cmds + cmdList->used) = RC_END_OF_LIST;
@@ -107,6 +189,31 @@ void R_IssueRenderCommands( qboolean runPerformanceCounters ) {
 	// clear it out, in case this is a sync and not a buffer flip
 	cmdList->used = 0;
 
+	if ( glConfig.smpActive ) {
+		// the render thread only works on the other frame's data,
+		// so this can be done before waiting for it
+		R_CopySkeletorCaches( backEndData[tr.smpFrame] );
+		R_CopyTerrain( backEndData[tr.smpFrame] );
+
+		// if the render thread is not idle, wait for it
+		if ( renderThreadActive ) {
+			c_blockedOnRender++;
+			if ( r_showSmp->integer ) {
+				ri.Printf( PRINT_ALL, "R" );
+			}
+		} else {
+			c_blockedOnMain++;
+			if ( r_showSmp->integer ) {
+				ri.Printf( PRINT_ALL, "." );
+			}
+		}
+
+		// sleep until the renderer has completed
+		GLimp_FrontEndSleep();
+	}
+
+	// at this point, the back end thread is idle, so it is ok
+	// to look at its performance counters
 	if ( runPerformanceCounters ) {
 		R_PerformanceCounters();
 	}
@@ -114,23 +221,51 @@ void R_IssueRenderCommands( qboolean runPerformanceCounters ) {
 	// actually start the commands going
 	if ( !r_skipBackEnd->integer ) {
 		// let it start on the new batch
-		RB_ExecuteRenderCommands( cmdList->cmds );
+		if ( !glConfig.smpActive ) {
+			RB_ExecuteRenderCommands( cmdList->cmds );
+		} else {
+			GLimp_WakeRenderer( cmdList->cmds );
+		}
 	}
 }
 
 
 /*
 ====================
-R_IssuePendingRenderCommands
+R_SyncRenderThread
 
 Issue any pending commands and wait for them to complete.
+After exiting, the render thread will have completed its work
+and will remain idle and the main thread is free to issue
+OpenGL calls until R_IssueRenderCommands is called.
 ====================
 */
-void R_IssuePendingRenderCommands( void ) {
+void R_SyncRenderThread( void ) {
 	if ( !tr.registered ) {
 		return;
 	}
+	if ( glConfig.smpActive && GLimp_InRenderThread() ) {
+		// the back end already owns the context,
+		// like when it registers the sun flare shader
+		return;
+	}
 	R_IssueRenderCommands( qfalse );
+
+	if ( !glConfig.smpActive ) {
+		return;
+	}
+	GLimp_FrontEndSleep();
+}
+
+/*
+====================
+R_IssuePendingRenderCommands
+
+Issue any pending commands and wait for them to complete.
+====================
+*/
+void R_IssuePendingRenderCommands( void ) {
+	R_SyncRenderThread();
 }
 
 /*
@@ -143,7 +278,7 @@ make sure there is enough command space
 void *R_GetCommandBufferReserved( int bytes, int reservedBytes ) {
 	renderCommandList_t	*cmdList;
 
-	cmdList = &backEndData->commands;
+	cmdList = &backEndData[tr.smpFrame]->commands;
 	bytes = PAD(bytes, sizeof(void *));
 
 	// always leave room for the end of list command
@@ -515,6 +650,7 @@ void RE_EndFrame( int *frontEndMsec, int *backEndMsec ) {
 		return;
 	}
 	cmd->commandId = RC_SWAP_BUFFERS;
+	cmd->stencilReadback = R_OverdrawReadback();
 
 	R_IssueRenderCommands( qtrue );
 
@@ -61,6 +61,11 @@ cvar_t	*r_lodscale;
 cvar_t	*r_norefresh;
 cvar_t	*r_drawentities;
 cvar_t	*r_drawentitypoly;
+cvar_t	*r_skinCache;
+cvar_t	*r_skinThreads;
+cvar_t	*r_skinSpeeds;
+cvar_t	*r_smp;
+cvar_t	*r_showSmp;
 cvar_t	*r_drawstaticmodels;
 cvar_t	*r_drawstaticmodelpoly;
 cvar_t	*r_drawbrushes;
@@ -324,6 +329,10 @@ static void InitOpenGL( void )
 		}
 	}
 
+	// Added in OPM
+	// init command buffers and SMP
+	R_InitCommandBuffers();
+
 	// print info
 	GfxInfo_f();
 
@@ -1467,6 +1476,12 @@ void R_Register( void )
 	r_norefresh = ri.Cvar_Get("r_norefresh", "0", CVAR_CHEAT);
 	r_drawentities = ri.Cvar_Get("r_drawentities", "1", CVAR_CHEAT);
 	r_drawentitypoly = ri.Cvar_Get("r_drawentitypoly", "1", CVAR_CHEAT);
+	// Added in OPM
+	r_skinCache = ri.Cvar_Get("r_skinCache", "1", 0);
+	r_skinThreads = ri.Cvar_Get("r_skinThreads", "0", CVAR_ARCHIVE);
+	r_skinSpeeds = ri.Cvar_Get("r_skinSpeeds", "0", 0);
+	r_smp = ri.Cvar_Get("r_smp", "0", CVAR_ARCHIVE | CVAR_LATCH);
+	r_showSmp = ri.Cvar_Get("r_showSmp", "0", 0);
 	r_drawstaticmodels = ri.Cvar_Get("r_drawstaticmodels", "1", CVAR_CHEAT);
 	r_drawstaticmodelpoly = ri.Cvar_Get("r_drawstaticmodelpoly", "1", CVAR_CHEAT);
 	r_drawbrushes = ri.Cvar_Get("r_drawbrushes", "1", CVAR_CHEAT);
@@ -1683,13 +1698,30 @@ void R_Init( void ) {
 	if (max_termarks < MAX_TERMARKS)
 		max_termarks = MAX_TERMARKS;
 
-	ptr = ri.Malloc(sizeof(*backEndData) + sizeof(srfPoly_t) * max_polys + sizeof(polyVert_t) * max_polyverts + sizeof(srfMarkFragment_t) * max_termarks);
-	backEndData = (backEndData_t*)ptr;
-	backEndData->polys = (srfPoly_t*)((char*)ptr + sizeof(*backEndData));
-	backEndData->polyVerts = (polyVert_t*)((char*)ptr + sizeof(*backEndData) + sizeof(srfPoly_t) * max_polys);
-	backEndData->terMarks = (srfMarkFragment_t*)((char*)ptr + sizeof(*backEndData) + sizeof(srfPoly_t) * max_polys + sizeof(polyVert_t) * max_polyverts);
-	backEndData->staticModels = NULL;
-	backEndData->staticModelData = NULL;
+	for (i = 0; i < SMP_FRAMES; i++) {
+		// Added in OPM
+		// the second frame is only needed by the render thread
+		if (i > 0 && !r_smp->integer) {
+			backEndData[i] = NULL;
+			continue;
+		}
+
+		ptr = ri.Malloc(sizeof(*backEndData[i]) + sizeof(srfPoly_t) * max_polys + sizeof(polyVert_t) * max_polyverts + sizeof(srfMarkFragment_t) * max_termarks);
+		backEndData[i] = (backEndData_t*)ptr;
+		backEndData[i]->polys = (srfPoly_t*)((char*)ptr + sizeof(*backEndData[i]));
+		backEndData[i]->polyVerts = (polyVert_t*)((char*)ptr + sizeof(*backEndData[i]) + sizeof(srfPoly_t) * max_polys);
+		backEndData[i]->terMarks = (srfMarkFragment_t*)((char*)ptr + sizeof(*backEndData[i]) + sizeof(srfPoly_t) * max_polys + sizeof(polyVert_t) * max_polyverts);
+		backEndData[i]->staticModels = NULL;
+		backEndData[i]->staticModelData = NULL;
+
+		if (r_smp->integer) {
+			backEndData[i]->skelBones = (skelBoneCache_t*)ri.Malloc(sizeof(skelBoneCache_t) * MAX_SKELBONES);
+			backEndData[i]->skelMorphs = (int*)ri.Malloc(sizeof(int) * MAX_SKELMORPH);
+		} else {
+			backEndData[i]->skelBones = NULL;
+			backEndData[i]->skelMorphs = NULL;
+		}
+	}
 	R_InitNextFrame();
 
 	InitOpenGL();
@@ -1739,6 +1771,9 @@ void RE_Shutdown( qboolean destroyWindow ) {
 		R_DeleteTextures();
 	}
 
+	// Added in OPM
+	R_ShutdownCommandBuffers();
+
 	// shut down platform specific OpenGL stuff
 	if ( destroyWindow ) {
 		GLimp_Shutdown();
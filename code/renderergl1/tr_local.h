@@ -187,6 +187,8 @@ typedef struct {
 	qboolean	bLightGridCalculated;
 	int			iGridLighting;
 	float		lodpercentage[2];
+	unsigned int	skinPoseKey;	// Added in OPM: hash of the pose, to find the skinned vertexes
+	int			skinNumMorphs;	// Added in OPM: morphs of the pose, from e.morphstart
 	qboolean	sphereCalculated;
 	int			lightingSphere;
 
@@ -746,6 +748,12 @@ typedef struct {
 	float		farplane_color[3];
     qboolean	farplane_cull;
     qboolean	renderTerrain; // added in 2.0
+	// Added in OPM
+	//  lens flare visibility, traced by the front end (R_TraceLensFlares)
+	//  so the back end never touches the collision model
+	qboolean	sunFlareVisible;
+	unsigned	dlightFlareVisible;
+	byte		entityFlareVisible[(MAX_REFENTITIES + 7) / 8];
 } viewParms_t;
 
 
@@ -1285,6 +1293,13 @@ typedef struct {
 	trRefEntity_t entity2D;	// currentEntity will point at this when doing 2D rendering
     int backEndMsec;
     float shaderStartTime;
+	// Added in OPM
+	// skeletor caches of the commands being executed
+	const skelBoneCache_t	*skelBones;
+	const int	*skelMorphs;
+	// tessellated terrain of the commands being executed
+	terrainVert_t	*terrainVerts;
+	const terraTri_t	*terrainTris;
 } backEndState_t;
 
 /*
@@ -1461,6 +1476,12 @@ extern cvar_t	*r_dlightBacks;			// dlight non-facing surfaces for continuity
 extern	cvar_t	*r_norefresh;			// bypasses the ref rendering
 extern	cvar_t	*r_drawentities;		// disable/enable entity rendering
 extern	cvar_t	*r_drawentitypoly;
+extern	cvar_t	*r_skinCache;			// Added in OPM: reuse the skinned vertexes within a frame
+extern	cvar_t	*r_skinThreads;			// Added in OPM: threads skinning the models
+extern	cvar_t	*r_skinSpeeds;			// Added in OPM: print the skinning times
+
+extern	cvar_t	*r_smp;					// Added in OPM: run the back end on its own thread
+extern	cvar_t	*r_showSmp;				// Added in OPM: print whether the front end waited on the back end
 extern	cvar_t	*r_drawstaticmodels;
 extern	cvar_t	*r_drawstaticmodelpoly;
 extern	cvar_t	*r_drawbrushes;
@@ -2157,6 +2178,7 @@ SUN FLARE
 =============================================================
 */
 void R_InitLensFlare();
+void R_TraceLensFlares();
 void R_DrawLensFlares();
 
 /*
@@ -2217,6 +2239,8 @@ void RE_ForceUpdatePose(refEntity_t* model);
 void RE_SetFrameNumber(int frameNumber);
 void R_UpdatePoseInternal(refEntity_t* model);
 void RB_SkelMesh(skelSurfaceGame_t* sf);
+void RB_PrepareSkinCache(drawSurf_t* drawSurfs, int numDrawSurfs);
+void RB_EndSkinFrame(void);
 void RB_StaticMesh(staticSurface_t* staticSurf);
 void RB_Static_BuildDLights();
 void R_InfoStaticModels_f(void);
@@ -2372,6 +2396,9 @@ typedef struct {
 
 typedef struct {
 	int		commandId;
+	// Added in OPM
+	//  stencil readback for r_measureOverdraw, allocated by the front end
+	byte	*stencilReadback;
 } swapBuffersCommand_t;
 
 typedef struct {
@@ -2464,6 +2491,17 @@ typedef struct {
 	refSprite_t sprites[2048];
 	cStaticModelUnpacked_t* staticModels;
 	byte* staticModelData;
+	// Added in OPM
+	// copies of the skeletor caches the back end skins from,
+	// only allocated when it runs on its own thread
+	skelBoneCache_t	*skelBones;
+	int			*skelMorphs;
+	// Added in OPM
+	// copies of the tessellated terrain the back end draws,
+	// only allocated when it runs on its own thread
+	srfTerrain_t	*terrainSurfs;
+	terrainVert_t	*terrainVerts;
+	terraTri_t	*terrainTris;
 	renderCommandList_t	commands;
 } backEndData_t;
 
@@ -2471,7 +2509,20 @@ extern	int		max_polys;
 extern	int		max_polyverts;
 extern	int		max_termarks;
 
-extern	backEndData_t	*backEndData;	// the second one may not be allocated
+extern	backEndData_t	*backEndData[SMP_FRAMES];	// the second one may not be allocated
+
+// Added in OPM
+//  skeletor caches filled by the front end (tiki_mesh.h),
+//  declared here as tiki.h can't be included from the C files
+#ifndef MAX_SKELBONES
+#define MAX_SKELBONES 20000
+#define MAX_SKELMORPH 12800
+#endif
+
+extern	int				TIKI_Skel_Bones_Index;
+extern	int				skeletorMorphCacheIndex;
+extern	skelBoneCache_t	TIKI_Skel_Bones[];
+extern	int				skeletorMorphCache[];
 
 extern	volatile renderCommandList_t	*renderCommandList;
 
@@ -2488,6 +2539,7 @@ void R_InitCommandBuffers( void );
 void R_ShutdownCommandBuffers( void );
 
 void R_SyncRenderThread( void );
+void R_CopyTerrain( backEndData_t *data ); // Added in OPM
 
 void R_AddDrawSurfCmd( drawSurf_t *drawSurfs, int numDrawSurfs );
 
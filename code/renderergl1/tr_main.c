@@ -1787,6 +1787,10 @@ void R_RenderView (viewParms_t *parms) {
 
 	R_SetupFrustum ();
 
+	// Added in OPM
+	//  flare visibility is traced here, as the back end may be on another thread
+	R_TraceLensFlares();
+
 	R_Sky_Reset();
 
 	R_DrawDebugStrings();
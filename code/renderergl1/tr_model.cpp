@@ -26,6 +26,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "tiki.h"
 #include <vector.h>
 
+#include <chrono>
+
 #define LL(x) x = LittleLong(x)
 
 qboolean   g_bInfoworldtris = qfalse;
@@ -712,6 +714,36 @@ void RB_DrawSkeletor(trRefEntity_t *ent)
 
 surfaceType_t skelSurface = SF_TIKI_SKEL;
 
+/*
+==============
+R_SkinPoseKey
+
+Added in OPM
+Hashes the bones and morphs of a pose, so that the views
+drawing the entity can share the skinned vertexes
+==============
+*/
+static unsigned int R_SkinPoseKey(const skelBoneCache_t *bones, int numBones, const int *morphs, int numMorphs)
+{
+    const unsigned int *data;
+    unsigned int        key;
+    size_t              i, count;
+
+    key = 2166136261u;
+
+    data  = (const unsigned int *)bones;
+    count = numBones * sizeof(skelBoneCache_t) / sizeof(unsigned int);
+    for (i = 0; i < count; i++) {
+        key = (key ^ data[i]) * 16777619u;
+    }
+
+    for (i = 0; i < (size_t)numMorphs; i++) {
+        key = (key ^ (unsigned int)morphs[i]) * 16777619u;
+    }
+
+    return key;
+}
+
 /*
 ==============
 R_AddSkelSurfaces
@@ -870,6 +902,12 @@ void R_AddSkelSurfaces(trRefEntity_t *ent)
         ent->e.hasMorph = qtrue;
     }
 
+    // Added in OPM
+    ent->skinNumMorphs = ent->e.hasMorph ? added : 0;
+    ent->skinPoseKey   = R_SkinPoseKey(
+        &TIKI_Skel_Bones[ent->e.bonestart], num_tags, &skeletorMorphCache[ent->e.morphstart], ent->skinNumMorphs
+    );
+
     //
     // draw all meshes
     //
@@ -940,78 +978,650 @@ void R_AddSkelSurfaces(trRefEntity_t *ent)
     // FIXME: setup LOD
 }
 
+//
+// Added in OPM
+//  Four-wide float helpers used to skin the vertexes.
+//  The bone rows are four floats, the last one is zero
+//
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    include <xmmintrin.h>
+
+typedef __m128 skinSimd4_t;
+
+static inline skinSimd4_t Skin4_Zero()
+{
+    return _mm_setzero_ps();
+}
+
+static inline skinSimd4_t Skin4_Load(const float *v)
+{
+    return _mm_loadu_ps(v);
+}
+
+static inline void Skin4_Store(skinSimd4_t v, float *out)
+{
+    _mm_storeu_ps(out, v);
+}
+
+static inline skinSimd4_t Skin4_Scale(skinSimd4_t v, float s)
+{
+    return _mm_mul_ps(v, _mm_set1_ps(s));
+}
+
+static inline skinSimd4_t Skin4_MulAdd(skinSimd4_t a, skinSimd4_t v, float s)
+{
+    return _mm_add_ps(a, _mm_mul_ps(v, _mm_set1_ps(s)));
+}
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+
+typedef float32x4_t skinSimd4_t;
+
+static inline skinSimd4_t Skin4_Zero()
+{
+    return vdupq_n_f32(0);
+}
+
+static inline skinSimd4_t Skin4_Load(const float *v)
+{
+    return vld1q_f32(v);
+}
+
+static inline void Skin4_Store(skinSimd4_t v, float *out)
+{
+    vst1q_f32(out, v);
+}
+
+static inline skinSimd4_t Skin4_Scale(skinSimd4_t v, float s)
+{
+    return vmulq_n_f32(v, s);
+}
+
+static inline skinSimd4_t Skin4_MulAdd(skinSimd4_t a, skinSimd4_t v, float s)
+{
+    return vaddq_f32(a, vmulq_n_f32(v, s));
+}
+
+#else
+
+typedef struct {
+    float v[4];
+} skinSimd4_t;
+
+static inline skinSimd4_t Skin4_Zero()
+{
+    skinSimd4_t r = {
+        {0, 0, 0, 0}
+    };
+    return r;
+}
+
+static inline skinSimd4_t Skin4_Load(const float *v)
+{
+    skinSimd4_t r = {
+        {v[0], v[1], v[2], v[3]}
+    };
+    return r;
+}
+
+static inline void Skin4_Store(skinSimd4_t v, float *out)
+{
+    out[0] = v.v[0];
+    out[1] = v.v[1];
+    out[2] = v.v[2];
+    out[3] = v.v[3];
+}
+
+static inline skinSimd4_t Skin4_Scale(skinSimd4_t v, float s)
+{
+    skinSimd4_t r = {
+        {v.v[0] * s, v.v[1] * s, v.v[2] * s, v.v[3] * s}
+    };
+    return r;
+}
+
+static inline skinSimd4_t Skin4_MulAdd(skinSimd4_t a, skinSimd4_t v, float s)
+{
+    skinSimd4_t r = {
+        {a.v[0] + v.v[0] * s, a.v[1] + v.v[1] * s, a.v[2] + v.v[2] * s, a.v[3] + v.v[3] * s}
+    };
+    return r;
+}
+
+#endif
+
+//
+// Added in OPM
+//  Skinned vertexes of the frame. Every view drawing the same surface
+//  with the same pose (portals, mirrors, sky portal, a surface drawn
+//  with two shaders) copies them instead of skinning it again
+//
+#define MAX_SKIN_CACHE_ENTRIES  2048 // must be a power of two
+#define MAX_SKIN_CACHE_VERTEXES 65536
+
+typedef struct skinCacheEntry_s {
+    int                      frame; // the entry is free unless it's skinCacheFrame
+    const skelSurfaceGame_t *surface;
+    dtiki_t                 *tiki;
+    unsigned int             poseKey;
+    float                    scale;
+    int                      numVerts;
+    int                      firstVert; // in skinCacheXyz and skinCacheNormal
+    qboolean                 skinned;
+
+    // what RB_SkinCacheJob skins
+    const trRefEntity_t *entity;
+    skelHeaderGame_t    *skelmodel;
+    int                  mesh;
+} skinCacheEntry_t;
+
+typedef struct skinStats_s {
+    int    surfaces;
+    int    cacheHits;
+    int    jobSurfaces;
+    int    jobVerts;
+    int    directVerts;
+    double prepareMsec;
+    double jobMsec;
+    double directMsec;
+} skinStats_t;
+
+static skinCacheEntry_t  skinCacheEntries[MAX_SKIN_CACHE_ENTRIES];
+static skinCacheEntry_t *skinCacheJobs[MAX_SKIN_CACHE_ENTRIES];
+static int               skinCacheNumEntries;
+static int               skinCacheFrame = 1;
+static vec4_t            skinCacheXyz[MAX_SKIN_CACHE_VERTEXES];
+static vec4_t            skinCacheNormal[MAX_SKIN_CACHE_VERTEXES];
+static int               skinCacheNumVerts;
+static skinStats_t       skinStats;
+
 /*
 =============
-SkelVertGetNormal
+RB_SkinMsec
 =============
 */
-inline static void SkelVertGetNormal(skeletorVertex_t *vert, skelBoneCache_t *bone, vec3_t out)
+static double RB_SkinMsec()
 {
-    out[0] = vert->normal[0] * bone->matrix[0][0] + vert->normal[1] * bone->matrix[1][0]
-           + vert->normal[2] * bone->matrix[2][0];
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-    out[1] = vert->normal[0] * bone->matrix[0][1] + vert->normal[1] * bone->matrix[1][1]
-           + vert->normal[2] * bone->matrix[2][1];
+/*
+=============
+SkelBoneForWeight
+=============
+*/
+inline static const skelBoneCache_t *SkelBoneForWeight(
+    const skelWeight_t *weight, const skelBoneCache_t *bones, dtiki_t *tiki, const skelHeaderGame_t *skelmodel, int mesh
+)
+{
+    if (mesh > 0) {
+        // the bones of the other meshes go through the channels of the tiki
+        return &bones[ri.TIKI_GetLocalChannel(tiki, skelmodel->pBones[weight->boneIndex].channel)];
+    }
 
-    out[2] = vert->normal[0] * bone->matrix[0][2] + vert->normal[1] * bone->matrix[1][2]
-           + vert->normal[2] * bone->matrix[2][2];
+    return &bones[weight->boneIndex];
 }
 
 /*
 =============
-SkelMorphGetXyz
+SkelVertGetNormal
 =============
 */
-inline static void SkelMorphGetXyz(skeletorMorph_t *morph, int *morphcache, vec3_t out)
+inline static void SkelVertGetNormal(const skeletorVertex_t *vert, const skelBoneCache_t *bone, float *out)
 {
-    VectorMA(out, *morphcache, morph->offset, out);
+    skinSimd4_t normal;
+
+    normal = Skin4_Scale(Skin4_Load(bone->matrix[0]), vert->normal[0]);
+    normal = Skin4_MulAdd(normal, Skin4_Load(bone->matrix[1]), vert->normal[1]);
+    normal = Skin4_MulAdd(normal, Skin4_Load(bone->matrix[2]), vert->normal[2]);
+
+    Skin4_Store(normal, out);
 }
 
 /*
 =============
 SkelWeightGetXyz
+
+Adds the point moved by the bone, scaled by the weight
+=============
+*/
+inline static skinSimd4_t
+SkelWeightGetXyz(const skelWeight_t *weight, const skelBoneCache_t *bone, const vec3_t point, skinSimd4_t out)
+{
+    skinSimd4_t xyz;
+
+    xyz = Skin4_MulAdd(Skin4_Load(bone->offset), Skin4_Load(bone->matrix[0]), point[0]);
+    xyz = Skin4_MulAdd(xyz, Skin4_Load(bone->matrix[1]), point[1]);
+    xyz = Skin4_MulAdd(xyz, Skin4_Load(bone->matrix[2]), point[2]);
+
+    return Skin4_MulAdd(out, xyz, weight->boneWeight);
+}
+
+/*
+=============
+RB_SkinSkelSurface
+
+Skins the first numVerts vertexes of the surface with the pose of the entity.
+Only reads the model and the pose, so surfaces can be skinned in parallel
+=============
+*/
+static void RB_SkinSkelSurface(
+    const trRefEntity_t     *ent,
+    const skelSurfaceGame_t *sf,
+    const skelHeaderGame_t  *skelmodel,
+    int                      mesh,
+    int                      numVerts,
+    float                    scale,
+    vec4_t                  *outXyz,
+    vec4_t                  *outNormal
+)
+{
+    const skeletorVertex_t *newVerts;
+    const skeletorMorph_t  *morph;
+    const skelWeight_t     *weight;
+    const skelBoneCache_t  *bones;
+    const int              *morphs;
+    dtiki_t                *tiki;
+    int                     vertNum;
+    int                     morphNum;
+    int                     weightNum;
+
+    tiki     = ent->e.tiki;
+    bones    = &backEnd.skelBones[ent->e.bonestart];
+    morphs   = &backEnd.skelMorphs[ent->e.morphstart];
+    newVerts = sf->pVerts;
+
+    for (vertNum = 0; vertNum < numVerts; vertNum++) {
+        skinSimd4_t out;
+        vec3_t      totalmorph;
+        vec3_t      point;
+
+        morph  = (const skeletorMorph_t *)((const byte *)newVerts + sizeof(skeletorVertex_t));
+        weight = (const skelWeight_t *)((const byte *)morph + sizeof(skeletorMorph_t) * newVerts->numMorphs);
+
+        VectorClear(totalmorph);
+
+        if (ent->e.hasMorph) {
+            for (morphNum = 0; morphNum < newVerts->numMorphs; morphNum++, morph++) {
+                if (morphs[morph->morphIndex]) {
+                    VectorMA(totalmorph, morphs[morph->morphIndex], morph->offset, totalmorph);
+                }
+            }
+        }
+
+        SkelVertGetNormal(newVerts, SkelBoneForWeight(weight, bones, tiki, skelmodel, mesh), outNormal[vertNum]);
+
+        out = Skin4_Zero();
+
+        for (weightNum = 0; weightNum < newVerts->numWeights; weightNum++, weight++) {
+            if (!weightNum) {
+                // the morphs only move the first weight
+                VectorAdd(totalmorph, weight->offset, point);
+                out = SkelWeightGetXyz(weight, SkelBoneForWeight(weight, bones, tiki, skelmodel, mesh), point, out);
+            } else {
+                out = SkelWeightGetXyz(
+                    weight, SkelBoneForWeight(weight, bones, tiki, skelmodel, mesh), weight->offset, out
+                );
+            }
+        }
+
+        Skin4_Store(Skin4_Scale(out, scale), outXyz[vertNum]);
+
+        newVerts = (const skeletorVertex_t *)((const byte *)newVerts + sizeof(skeletorVertex_t)
+                                              + sizeof(skeletorMorph_t) * newVerts->numMorphs
+                                              + sizeof(skelWeight_t) * newVerts->numWeights);
+    }
+}
+
+/*
+=============
+RB_FindSkelSurfaceMesh
+
+Returns the mesh of the tiki the surface belongs to
 =============
 */
-inline static void SkelWeightGetXyz(skelWeight_t *weight, skelBoneCache_t *bone, vec3_t out)
+static skelHeaderGame_t *RB_FindSkelSurfaceMesh(dtiki_t *tiki, const skelSurfaceGame_t *sf, int *outMesh)
 {
-    out[0] += ((weight->offset[0] * bone->matrix[0][0] + weight->offset[1] * bone->matrix[1][0]
-                + weight->offset[2] * bone->matrix[2][0])
-               + bone->offset[0])
-            * weight->boneWeight;
+    skelHeaderGame_t  *skelmodel;
+    skelSurfaceGame_t *psurface;
+    int                mesh;
+    int                surf;
 
-    out[1] += ((weight->offset[0] * bone->matrix[0][1] + weight->offset[1] * bone->matrix[1][1]
-                + weight->offset[2] * bone->matrix[2][1])
-               + bone->offset[1])
-            * weight->boneWeight;
+    for (mesh = 0; mesh < tiki->numMeshes; mesh++) {
+        skelmodel = ri.TIKI_GetSkel(tiki->mesh[mesh]);
+        psurface  = skelmodel->pSurfaces;
 
-    out[2] += ((weight->offset[0] * bone->matrix[0][2] + weight->offset[1] * bone->matrix[1][2]
-                + weight->offset[2] * bone->matrix[2][2])
-               + bone->offset[2])
-            * weight->boneWeight;
+        // find the surface
+        for (surf = 0; surf < skelmodel->numSurfaces; surf++) {
+            if (psurface == sf) {
+                *outMesh = mesh;
+                return skelmodel;
+            }
+            psurface = psurface->pNext;
+        }
+    }
+
+    return NULL;
 }
 
 /*
 =============
-SkelWeightMorphGetXyz
+RB_SkelSurfaceRenderCount
+
+Returns the number of vertexes to draw at the LOD of the entity
 =============
 */
-inline static void SkelWeightMorphGetXyz(skelWeight_t *weight, skelBoneCache_t *bone, vec3_t totalmorph, vec3_t out)
+static unsigned int
+RB_SkelSurfaceRenderCount(const trRefEntity_t *ent, const skelSurfaceGame_t *sf, skelHeaderGame_t *skelmodel, int mesh)
 {
-    vec3_t point;
+    unsigned int render_count;
+
+    if (!skelmodel->pLOD) {
+        return sf->numVerts;
+    }
+
+    if (sf->numVerts > 3) {
+        skelIndex_t *collapseIndex;
+        int          mid, low, high;
+        int          lod_cutoff;
 
-    VectorAdd(totalmorph, weight->offset, point);
+        if (lod_tool->integer && !strcmp(ent->e.tiki->a->name, lod_tikiname->string) && mesh == lod_mesh->integer) {
+            lod_cutoff = GetToolLodCutoff(skelmodel, ent->lodpercentage[0]);
+        } else {
+            lod_cutoff = GetLodCutoff(skelmodel, ent->lodpercentage[0], ent->e.renderfx);
+        }
 
-    out[0] += ((point[0] * bone->matrix[0][0] + point[1] * bone->matrix[1][0] + point[2] * bone->matrix[2][0])
-               + bone->offset[0])
-            * weight->boneWeight;
+        collapseIndex = sf->pCollapseIndex;
+        if (collapseIndex[2] < lod_cutoff) {
+            return 0;
+        }
 
-    out[1] += ((point[0] * bone->matrix[0][1] + point[1] * bone->matrix[1][1] + point[2] * bone->matrix[2][1])
-               + bone->offset[1])
-            * weight->boneWeight;
+        low = mid = 3;
+        high      = sf->numVerts;
+        while (high >= low) {
+            mid = (low + high) >> 1;
+            if (collapseIndex[mid] < lod_cutoff) {
+                high = mid - 1;
+                if (collapseIndex[mid - 1] >= lod_cutoff) {
+                    break;
+                }
+            } else {
+                mid++;
+                low = mid;
+                if (high == mid || collapseIndex[mid] < lod_cutoff) {
+                    break;
+                }
+            }
+        }
 
-    out[2] += ((point[0] * bone->matrix[0][2] + point[1] * bone->matrix[1][2] + point[2] * bone->matrix[2][2])
-               + bone->offset[2])
-            * weight->boneWeight;
+        render_count = mid;
+    } else {
+        render_count = sf->numVerts;
+    }
+
+    return render_count;
+}
+
+/*
+=============
+RB_SkinPoseMatches
+
+The pose key is only a hash, make sure that the bones and morphs
+of the two entities are really the same
+=============
+*/
+static qboolean RB_SkinPoseMatches(const trRefEntity_t *ent, const trRefEntity_t *other)
+{
+    if (ent == other) {
+        return qtrue;
+    }
+
+    if (ent->e.tiki != other->e.tiki || ent->skinNumMorphs != other->skinNumMorphs) {
+        return qfalse;
+    }
+
+    if (ent->e.bonestart != other->e.bonestart
+        && memcmp(
+            &backEnd.skelBones[ent->e.bonestart],
+            &backEnd.skelBones[other->e.bonestart],
+            ri.TIKI_GetNumChannels(ent->e.tiki) * sizeof(skelBoneCache_t)
+        )) {
+        return qfalse;
+    }
+
+    if (ent->skinNumMorphs && ent->e.morphstart != other->e.morphstart
+        && memcmp(
+            &backEnd.skelMorphs[ent->e.morphstart],
+            &backEnd.skelMorphs[other->e.morphstart],
+            ent->skinNumMorphs * sizeof(backEnd.skelMorphs[0])
+        )) {
+        return qfalse;
+    }
+
+    return qtrue;
+}
+
+/*
+=============
+RB_FindSkinCache
+
+Returns the cache entry of the surface for the pose of the entity
+=============
+*/
+static skinCacheEntry_t *
+RB_FindSkinCache(const trRefEntity_t *ent, const skelSurfaceGame_t *sf, float scale, qboolean create)
+{
+    skinCacheEntry_t *entry;
+    int               hash;
+
+    hash = (int)((((uintptr_t)sf >> 4) ^ ent->skinPoseKey) & (MAX_SKIN_CACHE_ENTRIES - 1));
+
+    for (;;) {
+        entry = &skinCacheEntries[hash];
+        if (entry->frame != skinCacheFrame) {
+            break;
+        }
+
+        if (entry->surface == sf && entry->tiki == ent->e.tiki && entry->poseKey == ent->skinPoseKey
+            && entry->scale == scale && RB_SkinPoseMatches(ent, entry->entity)) {
+            return entry;
+        }
+
+        hash = (hash + 1) & (MAX_SKIN_CACHE_ENTRIES - 1);
+    }
+
+    // keep some room so that probing stays short
+    if (!create || skinCacheNumEntries >= MAX_SKIN_CACHE_ENTRIES * 3 / 4) {
+        return NULL;
+    }
+
+    entry->frame     = skinCacheFrame;
+    entry->surface   = sf;
+    entry->tiki      = ent->e.tiki;
+    entry->poseKey   = ent->skinPoseKey;
+    entry->scale     = scale;
+    entry->numVerts  = 0;
+    entry->firstVert = -1;
+    entry->skinned   = qfalse;
+    entry->entity    = ent;
+    entry->skelmodel = NULL;
+    entry->mesh      = 0;
+    skinCacheNumEntries++;
+
+    return entry;
+}
+
+/*
+=============
+RB_AllocSkinCache
+=============
+*/
+static qboolean RB_AllocSkinCache(skinCacheEntry_t *entry, int numVerts)
+{
+    if (skinCacheNumVerts + numVerts > MAX_SKIN_CACHE_VERTEXES) {
+        return qfalse;
+    }
+
+    entry->firstVert = skinCacheNumVerts;
+    entry->numVerts  = numVerts;
+    skinCacheNumVerts += numVerts;
+
+    return qtrue;
+}
+
+/*
+=============
+RB_SkinCacheJob
+=============
+*/
+static void RB_SkinCacheJob(void *data, int index)
+{
+    skinCacheEntry_t *entry = ((skinCacheEntry_t **)data)[index];
+
+    RB_SkinSkelSurface(
+        entry->entity,
+        entry->surface,
+        entry->skelmodel,
+        entry->mesh,
+        entry->numVerts,
+        entry->scale,
+        &skinCacheXyz[entry->firstVert],
+        &skinCacheNormal[entry->firstVert]
+    );
+
+    entry->skinned = qtrue;
+}
+
+/*
+=============
+RB_PrepareSkinCache
+
+Skins all the skeletal surfaces of the view that aren't in the cache yet,
+split across r_skinThreads threads. RB_SkelMesh then copies them
+=============
+*/
+void RB_PrepareSkinCache(drawSurf_t *drawSurfs, int numDrawSurfs)
+{
+    skinCacheEntry_t  *entry;
+    trRefEntity_t     *ent;
+    skelSurfaceGame_t *sf;
+    skelHeaderGame_t  *skelmodel;
+    shader_t          *shader;
+    int                entityNum;
+    int                dlightMap;
+    qboolean           bStaticModel;
+    int                mesh;
+    int                numJobs;
+    int                numAlloced;
+    unsigned int       render_count;
+    double             start;
+    int                i;
+
+    if (!r_skinCache->integer || !r_drawentitypoly->integer) {
+        return;
+    }
+
+    start   = r_skinSpeeds->integer ? RB_SkinMsec() : 0;
+    numJobs = 0;
+
+    for (i = 0; i < numDrawSurfs; i++) {
+        if (*drawSurfs[i].surface != SF_TIKI_SKEL) {
+            continue;
+        }
+
+        R_DecomposeSort(drawSurfs[i].sort, &entityNum, &shader, &dlightMap, &bStaticModel);
+        if (bStaticModel || entityNum == ENTITYNUM_WORLD) {
+            continue;
+        }
+
+        ent       = &backEnd.refdef.entities[entityNum];
+        sf        = (skelSurfaceGame_t *)drawSurfs[i].surface;
+        skelmodel = RB_FindSkelSurfaceMesh(ent->e.tiki, sf, &mesh);
+        if (!skelmodel) {
+            continue;
+        }
+
+        render_count = RB_SkelSurfaceRenderCount(ent, sf, skelmodel, mesh);
+        if (!render_count) {
+            continue;
+        }
+
+        entry = RB_FindSkinCache(ent, sf, ent->e.tiki->load_scale * ent->e.scale, qtrue);
+        if (!entry || entry->skinned || entry->firstVert >= 0) {
+            continue;
+        }
+
+        if (!entry->numVerts) {
+            entry->entity           = ent;
+            entry->skelmodel        = skelmodel;
+            entry->mesh             = mesh;
+            skinCacheJobs[numJobs++] = entry;
+        }
+
+        // the vertexes are sorted by LOD, skin enough for all the views
+        if (entry->numVerts < (int)render_count) {
+            entry->numVerts = render_count;
+        }
+    }
+
+    numAlloced = 0;
+    for (i = 0; i < numJobs; i++) {
+        entry = skinCacheJobs[i];
+
+        if (RB_AllocSkinCache(entry, entry->numVerts)) {
+            skinCacheJobs[numAlloced++] = entry;
+            skinStats.jobVerts += entry->numVerts;
+        } else {
+            // no room left, RB_SkelMesh will skin it
+            entry->numVerts = 0;
+        }
+    }
+
+    if (r_skinSpeeds->integer) {
+        skinStats.prepareMsec += RB_SkinMsec() - start;
+        start = RB_SkinMsec();
+    }
+
+    if (numAlloced) {
+        ri.RunJobs(RB_SkinCacheJob, skinCacheJobs, numAlloced, r_skinThreads->integer);
+        skinStats.jobSurfaces += numAlloced;
+    }
+
+    if (r_skinSpeeds->integer) {
+        skinStats.jobMsec += RB_SkinMsec() - start;
+    }
+}
+
+/*
+=============
+RB_EndSkinFrame
+
+Empties the skin cache, the poses of the next frame are different
+=============
+*/
+void RB_EndSkinFrame(void)
+{
+    if (r_skinSpeeds->integer) {
+        ri.Printf(
+            PRINT_ALL,
+            "%i skel surfs, %i cached, %i skinned in jobs (%i verts, %.2f msec, prepare %.2f msec), %i verts skinned directly (%.2f msec)\n",
+            skinStats.surfaces,
+            skinStats.cacheHits,
+            skinStats.jobSurfaces,
+            skinStats.jobVerts,
+            skinStats.jobMsec,
+            skinStats.prepareMsec,
+            skinStats.directVerts,
+            skinStats.directMsec
+        );
+    }
+
+    Com_Memset(&skinStats, 0, sizeof(skinStats));
+
+    skinCacheFrame++;
+    skinCacheNumEntries = 0;
+    skinCacheNumVerts   = 0;
 }
 
 /*
@@ -1024,28 +1634,16 @@ void RB_SkelMesh(skelSurfaceGame_t *sf)
     unsigned int       baseIndex, baseVertex;
     unsigned int       render_count;
     unsigned int       indexes;
-    float             *outXyz;
-    vec4_t            *outNormal;
     skelIndex_t       *triangles;
     skelIndex_t       *collapse_map;
     skeletorVertex_t  *newVerts;
-    skeletorMorph_t   *morph;
-    skelWeight_t      *weight;
+    skinCacheEntry_t  *entry;
     int                vertNum;
-    int                morphNum;
-    int                weightNum;
-    skelBoneCache_t   *bones;
-    skelBoneCache_t   *bone;
-    int               *morphs;
-    int               *morphcache;
     float              scale;
     dtiki_t           *tiki;
     int                mesh;
-    int                surf;
     int                i;
     skelHeaderGame_t  *skelmodel;
-    skelSurfaceGame_t *psurface;
-    qboolean           bFound;
     short              collapse[TIKI_MAX_VERTEXES];
 
     if (!r_drawentitypoly->integer) {
@@ -1059,82 +1657,19 @@ void RB_SkelMesh(skelSurfaceGame_t *sf)
     //
     // get the mesh associated with the surface
     //
-    bFound = qfalse;
-    for (mesh = 0; mesh < tiki->numMeshes; mesh++) {
-        skelmodel = ri.TIKI_GetSkel(tiki->mesh[mesh]);
-        psurface  = skelmodel->pSurfaces;
+    skelmodel = RB_FindSkelSurfaceMesh(tiki, sf, &mesh);
+    assert(skelmodel);
 
-        // find the surface
-        for (surf = 0; surf < skelmodel->numSurfaces; surf++) {
-            if (psurface == sf) {
-                bFound = qtrue;
-                break;
-            }
-            psurface = psurface->pNext;
-        }
-
-        if (bFound) {
-            break;
-        }
+    if (!skelmodel) {
+        return;
     }
 
-    assert(bFound);
-
     //
     // Process LOD
     //
-    if (skelmodel->pLOD) {
-        float lod_val;
-        int   renderfx;
-
-        lod_val  = backEnd.currentEntity->lodpercentage[0];
-        renderfx = backEnd.currentEntity->e.renderfx;
-
-        if (sf->numVerts > 3) {
-            skelIndex_t *collapseIndex;
-            int          mid, low, high;
-            int          lod_cutoff;
-
-            if (lod_tool->integer && !strcmp(backEnd.currentEntity->e.tiki->a->name, lod_tikiname->string)
-                && mesh == lod_mesh->integer) {
-                lod_cutoff = GetToolLodCutoff(skelmodel, backEnd.currentEntity->lodpercentage[0]);
-            } else {
-                lod_cutoff = GetLodCutoff(skelmodel, backEnd.currentEntity->lodpercentage[0], renderfx);
-            }
-
-            collapseIndex = sf->pCollapseIndex;
-            if (collapseIndex[2] < lod_cutoff) {
-                return;
-            }
-
-            low = mid = 3;
-            high      = sf->numVerts;
-            while (high >= low) {
-                mid = (low + high) >> 1;
-                if (collapseIndex[mid] < lod_cutoff) {
-                    high = mid - 1;
-                    if (collapseIndex[mid - 1] >= lod_cutoff) {
-                        break;
-                    }
-                } else {
-                    mid++;
-                    low = mid;
-                    if (high == mid || collapseIndex[mid] < lod_cutoff) {
-                        break;
-                    }
-                }
-            }
-
-            render_count = mid;
-        } else {
-            render_count = sf->numVerts;
-        }
-
-        if (!render_count) {
-            return;
-        }
-    } else {
-        render_count = sf->numVerts;
+    render_count = RB_SkelSurfaceRenderCount(backEnd.currentEntity, sf, skelmodel, mesh);
+    if (!render_count) {
+        return;
     }
 
     indexes = sf->numTriangles * 3;
@@ -1146,10 +1681,6 @@ void RB_SkelMesh(skelSurfaceGame_t *sf)
     baseVertex   = tess.numVertexes;
     tess.numVertexes += render_count;
 
-    outXyz    = tess.xyz[baseVertex];
-    outNormal = &tess.normal[baseVertex];
-    newVerts  = sf->pVerts;
-
     if (render_count == sf->numVerts) {
         for (i = 0; i < indexes; i++) {
             tess.indexes[baseIndex + i] = baseVertex + triangles[i];
@@ -1189,215 +1720,60 @@ void RB_SkelMesh(skelSurfaceGame_t *sf)
     }
 
     //
-    // just copy the vertexes
+    // skin the vertexes, or copy them from the skin cache
     //
-    bones  = &TIKI_Skel_Bones[backEnd.currentEntity->e.bonestart];
-    morphs = &skeletorMorphCache[backEnd.currentEntity->e.morphstart];
-
-    if (backEnd.currentEntity->e.hasMorph) {
-        if (mesh > 0) {
-            for (vertNum = 0; vertNum < render_count; vertNum++) {
-                vec3_t normal;
-                vec3_t out;
-                vec3_t totalmorph;
-                int    channelNum;
-                int    boneNum;
-
-                VectorClear(out);
-                VectorClear(outXyz);
-                VectorClear(totalmorph);
-
-                weight = (skelWeight_t *)((byte *)newVerts + sizeof(skeletorVertex_t)
-                                          + sizeof(skeletorMorph_t) * newVerts->numMorphs);
-                morph  = (skeletorMorph_t *)((byte *)newVerts + sizeof(skeletorVertex_t));
-
-                for (morphNum = 0; morphNum < newVerts->numMorphs; morphNum++) {
-                    morphcache = &morphs[morph->morphIndex];
-
-                    if (*morphcache) {
-                        SkelMorphGetXyz(morph, morphcache, totalmorph);
-                    }
-
-                    morph++;
-                }
-
-                if (newVerts->numMorphs) {
-                    channelNum = skelmodel->pBones[morph->morphIndex].channel;
-                } else {
-                    channelNum = skelmodel->pBones[weight->boneIndex].channel;
-                }
-
-                boneNum = ri.TIKI_GetLocalChannel(tiki, channelNum);
-                bone    = &bones[boneNum];
-
-                SkelVertGetNormal(newVerts, bone, normal);
-
-                for (weightNum = 0; weightNum < newVerts->numWeights; weightNum++) {
-                    channelNum = skelmodel->pBones[weight->boneIndex].channel;
-                    boneNum    = ri.TIKI_GetLocalChannel(tiki, channelNum);
-                    bone       = &bones[boneNum];
-
-                    if (!weightNum) {
-                        SkelWeightMorphGetXyz(weight, bone, totalmorph, out);
-                    } else {
-                        SkelWeightGetXyz(weight, bone, out);
-                    }
-
-                    weight++;
-                }
-
-                VectorCopy(normal, *outNormal);
-                VectorScale(out, scale, outXyz);
-
-                tess.texCoords[baseVertex + vertNum][0][0] = newVerts->texCoords[0];
-                tess.texCoords[baseVertex + vertNum][0][1] = newVerts->texCoords[1];
-                // FIXME: fill in lightmapST for completeness?
-
-                newVerts = (skeletorVertex_t *)((byte *)newVerts + sizeof(skeletorVertex_t)
-                                                + sizeof(skeletorMorph_t) * newVerts->numMorphs
-                                                + sizeof(skelWeight_t) * newVerts->numWeights);
-                outXyz += 4;
-                outNormal++;
-            }
-        } else {
-            for (vertNum = 0; vertNum < render_count; vertNum++) {
-                vec3_t normal;
-                vec3_t out;
-                vec3_t totalmorph;
+    skinStats.surfaces++;
 
-                VectorClear(out);
-                VectorClear(outXyz);
-                VectorClear(totalmorph);
-
-                weight = (skelWeight_t *)((byte *)newVerts + sizeof(skeletorVertex_t)
-                                          + sizeof(skeletorMorph_t) * newVerts->numMorphs);
-                morph  = (skeletorMorph_t *)((byte *)newVerts + sizeof(skeletorVertex_t));
-
-                for (morphNum = 0; morphNum < newVerts->numMorphs; morphNum++) {
-                    morphcache = &morphs[morph->morphIndex];
-
-                    if (*morphcache) {
-                        SkelMorphGetXyz(morph, morphcache, totalmorph);
-                    }
-
-                    morph++;
-                }
-
-                if (newVerts->numMorphs) {
-                    bone = &bones[morph->morphIndex];
-                } else {
-                    bone = &bones[weight->boneIndex];
-                }
-
-                SkelVertGetNormal(newVerts, bone, normal);
-
-                for (weightNum = 0; weightNum < newVerts->numWeights; weightNum++) {
-                    bone = &bones[weight->boneIndex];
-
-                    if (!weightNum) {
-                        SkelWeightMorphGetXyz(weight, bone, totalmorph, out);
-                    } else {
-                        SkelWeightGetXyz(weight, bone, out);
-                    }
-
-                    weight++;
-                }
-
-                VectorCopy(normal, *outNormal);
-                VectorScale(out, scale, outXyz);
-
-                tess.texCoords[baseVertex + vertNum][0][0] = newVerts->texCoords[0];
-                tess.texCoords[baseVertex + vertNum][0][1] = newVerts->texCoords[1];
-                // FIXME: fill in lightmapST for completeness?
+    entry = NULL;
+    if (r_skinCache->integer) {
+        entry = RB_FindSkinCache(backEnd.currentEntity, sf, scale, qtrue);
+    }
 
-                newVerts = (skeletorVertex_t *)((byte *)newVerts + sizeof(skeletorVertex_t)
-                                                + sizeof(skeletorMorph_t) * newVerts->numMorphs
-                                                + sizeof(skelWeight_t) * newVerts->numWeights);
-                outXyz += 4;
-                outNormal++;
-            }
-        }
+    if (entry && entry->skinned && entry->numVerts >= (int)render_count) {
+        Com_Memcpy(tess.xyz[baseVertex], skinCacheXyz[entry->firstVert], render_count * sizeof(vec4_t));
+        Com_Memcpy(tess.normal[baseVertex], skinCacheNormal[entry->firstVert], render_count * sizeof(vec4_t));
+        skinStats.cacheHits++;
     } else {
-        if (mesh > 0) {
-            for (vertNum = 0; vertNum < render_count; vertNum++) {
-                vec3_t normal;
-                vec3_t out;
-                int    channelNum;
-                int    boneNum;
-
-                VectorClear(out);
-                VectorClear(outXyz);
-
-                weight = (skelWeight_t *)((byte *)newVerts + sizeof(skeletorVertex_t)
-                                          + sizeof(skeletorMorph_t) * newVerts->numMorphs);
-
-                channelNum = skelmodel->pBones[weight->boneIndex].channel;
-                boneNum    = ri.TIKI_GetLocalChannel(tiki, channelNum);
-                bone       = &bones[boneNum];
-
-                SkelVertGetNormal(newVerts, bone, normal);
-
-                for (weightNum = 0; weightNum < newVerts->numWeights; weightNum++) {
-                    channelNum = skelmodel->pBones[weight->boneIndex].channel;
-                    boneNum    = ri.TIKI_GetLocalChannel(tiki, channelNum);
-                    bone       = &bones[boneNum];
-
-                    SkelWeightGetXyz(weight, bone, out);
-
-                    weight++;
-                }
-
-                VectorCopy(normal, *outNormal);
-                VectorScale(out, scale, outXyz);
-
-                tess.texCoords[baseVertex + vertNum][0][0] = newVerts->texCoords[0];
-                tess.texCoords[baseVertex + vertNum][0][1] = newVerts->texCoords[1];
-                // FIXME: fill in lightmapST for completeness?
-
-                newVerts = (skeletorVertex_t *)((byte *)newVerts + sizeof(skeletorVertex_t)
-                                                + sizeof(skeletorMorph_t) * newVerts->numMorphs
-                                                + sizeof(skelWeight_t) * newVerts->numWeights);
-                outXyz += 4;
-                outNormal++;
-            }
-        } else {
-            for (vertNum = 0; vertNum < render_count; vertNum++) {
-                vec3_t normal;
-                vec3_t out;
-
-                VectorClear(out);
-                VectorClear(outXyz);
-
-                weight = (skelWeight_t *)((byte *)newVerts + sizeof(skeletorVertex_t)
-                                          + sizeof(skeletorMorph_t) * newVerts->numMorphs);
-
-                bone = &bones[weight->boneIndex];
-                SkelVertGetNormal(newVerts, bone, normal);
-
-                for (weightNum = 0; weightNum < newVerts->numWeights; weightNum++) {
-                    bone = &bones[weight->boneIndex];
-
-                    SkelWeightGetXyz(weight, bone, out);
-
-                    weight++;
-                }
-
-                VectorCopy(normal, *outNormal);
-                VectorScale(out, scale, outXyz);
-
-                tess.texCoords[baseVertex + vertNum][0][0] = newVerts->texCoords[0];
-                tess.texCoords[baseVertex + vertNum][0][1] = newVerts->texCoords[1];
-                // FIXME: fill in lightmapST for completeness?
+        double start = r_skinSpeeds->integer ? RB_SkinMsec() : 0;
+
+        RB_SkinSkelSurface(
+            backEnd.currentEntity,
+            sf,
+            skelmodel,
+            mesh,
+            render_count,
+            scale,
+            &tess.xyz[baseVertex],
+            &tess.normal[baseVertex]
+        );
+
+        // keep them for the next views
+        if (entry && !entry->skinned && entry->firstVert < 0 && RB_AllocSkinCache(entry, render_count)) {
+            Com_Memcpy(skinCacheXyz[entry->firstVert], tess.xyz[baseVertex], render_count * sizeof(vec4_t));
+            Com_Memcpy(skinCacheNormal[entry->firstVert], tess.normal[baseVertex], render_count * sizeof(vec4_t));
+            entry->skinned = qtrue;
+        }
 
-                newVerts = (skeletorVertex_t *)((byte *)newVerts + sizeof(skeletorVertex_t)
-                                                + sizeof(skeletorMorph_t) * newVerts->numMorphs
-                                                + sizeof(skelWeight_t) * newVerts->numWeights);
-                outXyz += 4;
-                outNormal++;
-            }
+        skinStats.directVerts += render_count;
+        if (r_skinSpeeds->integer) {
+            skinStats.directMsec += RB_SkinMsec() - start;
         }
     }
 
+    //
+    // copy the texture coordinates
+    //
+    newVerts = sf->pVerts;
+    for (vertNum = 0; vertNum < render_count; vertNum++) {
+        tess.texCoords[baseVertex + vertNum][0][0] = newVerts->texCoords[0];
+        tess.texCoords[baseVertex + vertNum][0][1] = newVerts->texCoords[1];
+        // FIXME: fill in lightmapST for completeness?
+
+        newVerts = (skeletorVertex_t *)((byte *)newVerts + sizeof(skeletorVertex_t)
+                                        + sizeof(skeletorMorph_t) * newVerts->numMorphs
+                                        + sizeof(skelWeight_t) * newVerts->numWeights);
+    }
+
 #if 0
 	if( backEnd.currentEntity->e.staticModelIndex ) {
 		mstaticModel_t *sm;
@@ -1592,13 +1968,13 @@ void RB_StaticMesh(staticSurface_t *staticSurf)
         tess.texCoords[baseVertex + j][1][1] = surf->pStaticTexCoords[j][1][1];
     }
 
-    if (backEndData->staticModelData) {
+    if (backEndData[backEnd.smpFrame]->staticModelData) {
         const size_t offset =
             backEnd.currentStaticModel->firstVertexData + staticSurf->ofsStaticData * sizeof(color4ub_t);
         assert(offset < tr.world->numStaticModelData * sizeof(color4ub_t));
         assert(offset + render_count * sizeof(color4ub_t) <= tr.world->numStaticModelData * sizeof(color4ub_t));
 
-        const color4ub_t *in = (const color4ub_t *)&backEndData->staticModelData[offset];
+        const color4ub_t *in = (const color4ub_t *)&backEndData[backEnd.smpFrame]->staticModelData[offset];
 
         for (i = 0; i < render_count; i++) {
             tess.vertexColors[baseVertex + i][0] = in[i][0];
@@ -52,7 +52,16 @@ R_ToggleSmpFrame
 ====================
 */
 void R_InitNextFrame( void ) {
-	backEndData->commands.used = 0;
+	// Added in OPM
+	if ( glConfig.smpActive ) {
+		// use the other buffers next frame, because another CPU
+		// may still be rendering into the current ones
+		tr.smpFrame ^= 1;
+	} else {
+		tr.smpFrame = 0;
+	}
+
+	backEndData[tr.smpFrame]->commands.used = 0;
 
 	r_firstSceneDrawSurf = 0;
 	r_firstSceneSpriteSurf = 0;
@@ -137,11 +146,11 @@ qboolean RE_AddPolyToScene(qhandle_t hShader, int numVerts, const polyVert_t* ve
 		return qfalse;
 	}
 
-	poly = &backEndData->polys[r_numpolys];
+	poly = &backEndData[tr.smpFrame]->polys[r_numpolys];
 	poly->surfaceType = SF_POLY;
 	poly->hShader = hShader;
 	poly->numVerts = numVerts;
-	poly->verts = &backEndData->polyVerts[r_numpolyverts];
+	poly->verts = &backEndData[tr.smpFrame]->polyVerts[r_numpolyverts];
 	poly->renderfx = renderfx;
 
 	Com_Memcpy(poly->verts, verts, sizeof(polyVert_t) * numVerts);
@@ -188,11 +197,11 @@ void RE_AddTerrainMarkToScene(int iTerrainIndex, qhandle_t hShader, int numVerts
         return;
     }
 
-    terMark = &backEndData->terMarks[r_numtermarks];
+    terMark = &backEndData[tr.smpFrame]->terMarks[r_numtermarks];
     terMark->surfaceType = hShader;
     terMark->iIndex = iTerrainIndex;
     terMark->numVerts = numVerts;
-    terMark->verts = &backEndData->polyVerts[r_numpolyverts];
+    terMark->verts = &backEndData[tr.smpFrame]->polyVerts[r_numpolyverts];
     memcpy(terMark->verts, verts, sizeof(polyVert_t) * numVerts);
 
     r_numtermarks++;
@@ -210,8 +219,8 @@ refEntity_t* RE_GetRenderEntity(int entityNumber) {
     int i;
 
     for (i = 0; i < r_numentities; i++) {
-        if (backEndData->entities[i].e.entityNumber == entityNumber) {
-            return &backEndData->entities[i].e;
+        if (backEndData[tr.smpFrame]->entities[i].e.entityNumber == entityNumber) {
+            return &backEndData[tr.smpFrame]->entities[i].e;
         }
     }
 
@@ -236,9 +245,9 @@ void RE_AddRefEntityToScene( const refEntity_t *ent, int parentEntityNumber) {
 		ri.Error( ERR_DROP, "RE_AddRefEntityToScene: bad reType %i", ent->reType );
 	}
 
-	backEndData->entities[r_numentities].e = *ent;
-	backEndData->entities[r_numentities].bLightGridCalculated = qfalse;
-	backEndData->entities[r_numentities].sphereCalculated = qfalse;
+	backEndData[tr.smpFrame]->entities[r_numentities].e = *ent;
+	backEndData[tr.smpFrame]->entities[r_numentities].bLightGridCalculated = qfalse;
+	backEndData[tr.smpFrame]->entities[r_numentities].sphereCalculated = qfalse;
 
 	if (parentEntityNumber != ENTITYNUM_NONE)
 	{
@@ -249,20 +258,20 @@ void RE_AddRefEntityToScene( const refEntity_t *ent, int parentEntityNumber) {
 		//
 		for (i = r_firstSceneEntity; i < r_numentities; i++)
 		{
-			if (backEndData->entities[i].e.entityNumber == parentEntityNumber)
+			if (backEndData[tr.smpFrame]->entities[i].e.entityNumber == parentEntityNumber)
 			{
-				backEndData->entities[r_numentities].e.parentEntity = i - r_firstSceneEntity;
+				backEndData[tr.smpFrame]->entities[r_numentities].e.parentEntity = i - r_firstSceneEntity;
 				break;
 			}
 		}
 
 		if (i == r_numentities) {
-			backEndData->entities[i].e.parentEntity = ENTITYNUM_NONE;
+			backEndData[tr.smpFrame]->entities[i].e.parentEntity = ENTITYNUM_NONE;
 		}
 	}
 	else
 	{
-		backEndData->entities[r_numentities].e.parentEntity = ENTITYNUM_NONE;
+		backEndData[tr.smpFrame]->entities[r_numentities].e.parentEntity = ENTITYNUM_NONE;
 	}
 
 	r_numentities++;
@@ -280,7 +289,7 @@ void RE_AddRefSpriteToScene(const refEntity_t* ent) {
 		return;
 	}
 
-	spr = &backEndData->sprites[r_numsprites];
+	spr = &backEndData[tr.smpFrame]->sprites[r_numsprites];
 	VectorCopy(ent->origin, spr->origin);
 	spr->surftype = SF_SPRITE;
     spr->hModel = ent->hModel;
@@ -314,7 +323,7 @@ void RE_AddDynamicLightToScene( const vec3_t org, float intensity, float r, floa
 	if ( intensity <= 0 ) {
 		return;
 	}
-	dl = &backEndData->dlights[r_numdlights++];
+	dl = &backEndData[tr.smpFrame]->dlights[r_numdlights++];
 	VectorCopy (org, dl->origin);
 	dl->radius = intensity;
 	dl->color[0] = r;
@@ -515,27 +524,27 @@ void RE_RenderScene( const refdef_t *fd ) {
 	tr.refdef.floatTime = tr.refdef.time * 0.001f;
 
 	tr.refdef.numDrawSurfs = r_firstSceneDrawSurf;
-	tr.refdef.drawSurfs = backEndData->drawSurfs;
+	tr.refdef.drawSurfs = backEndData[tr.smpFrame]->drawSurfs;
 
     tr.refdef.numSpriteSurfs = r_firstSceneSpriteSurf;
-    tr.refdef.spriteSurfs = backEndData->spriteSurfs;
+    tr.refdef.spriteSurfs = backEndData[tr.smpFrame]->spriteSurfs;
 
 	tr.refdef.num_entities = r_numentities - r_firstSceneEntity;
-	tr.refdef.entities = &backEndData->entities[r_firstSceneEntity];
+	tr.refdef.entities = &backEndData[tr.smpFrame]->entities[r_firstSceneEntity];
 
 	tr.refdef.num_sprites = r_numsprites - r_firstSceneSprite;
-	tr.refdef.sprites = &backEndData->sprites[r_firstSceneSprite];
+	tr.refdef.sprites = &backEndData[tr.smpFrame]->sprites[r_firstSceneSprite];
 
 	tr.refdef.num_dlights = r_numdlights - r_firstSceneDlight;
-	tr.refdef.dlights = &backEndData->dlights[r_firstSceneDlight];
+	tr.refdef.dlights = &backEndData[tr.smpFrame]->dlights[r_firstSceneDlight];
 
 	tr.refdef.numTerMarks = r_numtermarks - r_firstSceneTerMark;
-	tr.refdef.terMarks = &backEndData->terMarks[r_firstSceneTerMark];
+	tr.refdef.terMarks = &backEndData[tr.smpFrame]->terMarks[r_firstSceneTerMark];
 
 	tr.refdef.numPolys = r_numpolys - r_firstScenePoly;
-	tr.refdef.polys = &backEndData->polys[r_firstScenePoly];
+	tr.refdef.polys = &backEndData[tr.smpFrame]->polys[r_firstScenePoly];
 
-	backEndData->staticModelData = tr.refdef.staticModelData;
+	backEndData[tr.smpFrame]->staticModelData = tr.refdef.staticModelData;
 
 	// turn off dynamic lighting globally by clearing all the
 	// dlights if it needs to be disabled or if vertex lighting is enabled
@@ -1062,10 +1062,10 @@ static void ComputeColors( shaderStage_t *pStage )
 		RB_CalcAlphaFromConstant((unsigned char*)tess.svars.colors, backEnd.color2D[3]);
 		break;
 	case AGEN_SKYALPHA:
-		RB_CalcAlphaFromConstant((unsigned char*)tess.svars.colors, tr.refdef.sky_alpha * 255.0);
+		RB_CalcAlphaFromConstant((unsigned char*)tess.svars.colors, backEnd.refdef.sky_alpha * 255.0);
 		break;
 	case AGEN_ONE_MINUS_SKYALPHA:
-		RB_CalcAlphaFromConstant((unsigned char*)tess.svars.colors, (1.0 - tr.refdef.sky_alpha) * 255.0);
+		RB_CalcAlphaFromConstant((unsigned char*)tess.svars.colors, (1.0 - backEnd.refdef.sky_alpha) * 255.0);
 		break;
 	case AGEN_SCOORD:
 		RB_CalcAlphaFromTexCoords(
@@ -1441,10 +1441,10 @@ static void RB_IterateStagesGeneric( shaderCommands_t *input )
 			break;
 		}
 
-		if (pStage->alphaGen == AGEN_SKYALPHA && tr.refdef.sky_alpha < 0.01) {
+		if (pStage->alphaGen == AGEN_SKYALPHA && backEnd.refdef.sky_alpha < 0.01) {
 			continue;
 		}
-		else if (pStage->alphaGen == AGEN_ONE_MINUS_SKYALPHA && tr.refdef.sky_alpha > 0.99) {
+		else if (pStage->alphaGen == AGEN_ONE_MINUS_SKYALPHA && backEnd.refdef.sky_alpha > 0.99) {
 			continue;
 		}
 
@@ -1855,7 +1855,7 @@ void RB_EndSurface( void ) {
 	//
 	tess.currentStageIteratorFunc();
 
-	if (!(tr.refdef.rdflags & RDF_NOWORLDMODEL) && !backEnd.in2D)
+	if (!(backEnd.refdef.rdflags & RDF_NOWORLDMODEL) && !backEnd.in2D)
 	{
 		//
 		// draw debugging stuff
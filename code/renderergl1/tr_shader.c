@@ -2850,7 +2850,7 @@ sortedIndex.
 ==============
 */
 static void FixRenderCommandList( int newShader ) {
-	renderCommandList_t	*cmdList = &backEndData->commands;
+	renderCommandList_t	*cmdList = &backEndData[tr.smpFrame]->commands;
 
 	if( cmdList ) {
 		const void *curCmd = cmdList->cmds;
@@ -3402,6 +3402,13 @@ shader_t* R_FindShader(const char* name, int lightmapIndex, qboolean mipRawImage
 		currentShader = AddShaderTextToHash(strippedName, hash);
 	}
 
+	// Added in OPM
+	// make sure the render thread is stopped, because we
+	// are probably going to have to upload an image
+	if ( glConfig.smpActive ) {
+		R_SyncRenderThread();
+	}
+
 	// clear the global shader
 	Com_Memset( &shader, 0, sizeof( shader ) );
     Com_Memset(&unfoggedStages, 0, sizeof(unfoggedStages));
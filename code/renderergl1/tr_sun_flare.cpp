@@ -69,6 +69,10 @@ public:
     // Whether or not it's inside a portal sky
     bool inportalsky;
 
+    // Added in OPM
+    //  visibility traced by the front end for the current flare
+    bool visible;
+
     qboolean initted;
 
 public:
@@ -79,6 +83,7 @@ public:
         color[2] = 1.0;
         alpha    = 1.0;
         initted  = false;
+        visible  = false;
     }
 
     bool         CheckRange();
@@ -94,6 +99,8 @@ public:
     void SetColor(const float *c) { VectorCopy(c, color); }
 
     void SetAlpha(float a) { alpha = a; }
+
+    void SetVisible(bool vis) { visible = vis; }
 };
 
 class dlight_lens_flare : public lens_flare
@@ -126,24 +133,37 @@ dlight_lens_flare dlights;
 sun_flare_class   sunFlare;
 int               lens_flare::max_flares;
 
-void lens_flare::SetVect(const float *vect)
+/*
+=============
+R_FlareVectors
+
+Computes the drawn position and the trace end point of a flare.
+Added in OPM: shared by the front end traces and the back end drawing
+=============
+*/
+static void R_FlareVectors(trRefdef_t *refdef, const float *vect, bool inportalsky, vec3_t v, vec3_t trace_v)
 {
     if (inportalsky) {
         vec3_t offset;
         vec3_t rot_offset;
 
-        VectorSubtract(vect, tr.refdef.sky_origin, offset);
-        VectorRotate(offset, tr.refdef.sky_axis, rot_offset);
-        VectorAdd(tr.refdef.vieworg, rot_offset, v);
+        VectorSubtract(vect, refdef->sky_origin, offset);
+        VectorRotate(offset, refdef->sky_axis, rot_offset);
+        VectorAdd(refdef->vieworg, rot_offset, v);
 
         VectorNormalize(offset);
-        VectorMA(tr.refdef.vieworg, 16384, offset, trace_v);
+        VectorMA(refdef->vieworg, 16384, offset, trace_v);
     } else {
         VectorCopy(vect, v);
         VectorCopy(vect, trace_v);
     }
 }
 
+void lens_flare::SetVect(const float *vect)
+{
+    R_FlareVectors(&backEnd.refdef, vect, inportalsky, v, trace_v);
+}
+
 void lens_flare::InPortalSky()
 {
     inportalsky = true;
@@ -167,14 +187,9 @@ bool lens_flare::CheckRange()
 
 bool lens_flare::CheckRay()
 {
-    trace_t trace;
-
-    ri.CM_BoxTrace(&trace, backEnd.viewParms.ori.origin, trace_v, vec3_origin, vec3_origin, 0, CONTENTS_SOLID, qfalse);
-    if (inportalsky) {
-        return (trace.surfaceFlags & 4) != 0;
-    }
-
-    return trace.fraction == 1.0;
+    // Added in OPM
+    //  the trace is done by the front end in R_TraceLensFlares
+    return visible;
 }
 
 bool lens_flare::ScreenCalc()
@@ -193,14 +208,14 @@ bool lens_flare::ScreenCalc()
     VectorClear4(eye);
     for (i = 0; i < 4; i++) {
         for (j = 0; j < 4; j++) {
-            eye[i] += point[j] * tr.ori.modelMatrix[i + j * 4];
+            eye[i] += point[j] * backEnd.viewParms.world.modelMatrix[i + j * 4];
         }
     }
 
     VectorClear4(clip);
     for (i = 0; i < 4; i++) {
         for (j = 0; j < 4; j++) {
-            clip[i] += eye[j] * tr.viewParms.projectionMatrix[i + j * 4];
+            clip[i] += eye[j] * backEnd.viewParms.projectionMatrix[i + j * 4];
         }
     }
 
@@ -525,8 +540,6 @@ void R_DrawLensFlares()
 {
     int i;
 
-    R_RotateForViewer();
-
     qglPushMatrix();
     qglLoadIdentity();
     qglMatrixMode(GL_PROJECTION);
@@ -553,6 +566,7 @@ void R_DrawLensFlares()
             }
 
             dlights.SetVect(backEnd.refdef.entities[i].e.origin);
+            dlights.SetVisible((backEnd.viewParms.entityFlareVisible[i >> 3] & (1 << (i & 7))) != 0);
 
             //
             // Set the dlight color from entity
@@ -576,6 +590,7 @@ void R_DrawLensFlares()
             }
 
             torches.SetVect(backEnd.refdef.entities[i].e.origin);
+            torches.SetVisible((backEnd.viewParms.entityFlareVisible[i >> 3] & (1 << (i & 7))) != 0);
 
             rgb[0] = backEnd.refdef.entities[i].e.shaderRGBA[0] / 255.0;
             rgb[1] = backEnd.refdef.entities[i].e.shaderRGBA[1] / 255.0;
@@ -591,6 +606,7 @@ void R_DrawLensFlares()
             || (backEnd.refdef.dlights[i].type & dlighttype_t::additive)) {
             dlights.NotInPortalSky();
             dlights.SetVect(backEnd.refdef.dlights[i].origin);
+            dlights.SetVisible((backEnd.viewParms.dlightFlareVisible & (1u << i)) != 0);
             dlights.SetColor(backEnd.refdef.dlights[i].color);
 
             dlights.Try();
@@ -613,24 +629,114 @@ void R_InitLensFlare()
 }
 
 bool sun_flare_class::SunCheckRay()
+{
+    // Added in OPM
+    //  the trace is done by the front end in R_TraceLensFlares
+    return backEnd.viewParms.sunFlareVisible != qfalse;
+}
+
+/*
+=============
+R_TraceSunFlare
+=============
+*/
+static qboolean R_TraceSunFlare()
 {
     mnode_t *pViewLeaf;
     trace_t  trace;
+    vec3_t   end;
+
+    if (!s_sun.exists || !s_sun.szFlareName[0]) {
+        return qfalse;
+    }
 
     pViewLeaf = R_PointInLeaf(tr.refdef.vieworg);
 
     if (pViewLeaf->area == -1 || !tr.world->vis || tr.sSunLight.leaf != (mnode_s *)-1
         || pViewLeaf->numlights && pViewLeaf->lights[0] == &tr.sSunLight) {
-        ri.CM_BoxTrace(
-            &trace, backEnd.viewParms.ori.origin, trace_v, vec3_origin, vec3_origin, 0, CONTENTS_SOLID, qfalse
-        );
+        VectorMA(tr.viewParms.ori.origin, 16384, s_sun.flaredirection, end);
+        ri.CM_BoxTrace(&trace, tr.viewParms.ori.origin, end, vec3_origin, vec3_origin, 0, CONTENTS_SOLID, qfalse);
 
         if (trace.surfaceFlags & SURF_SKY) {
-            return true;
+            return qtrue;
         }
     }
 
-    return false;
+    return qfalse;
+}
+
+/*
+=============
+R_TraceFlare
+=============
+*/
+static bool R_TraceFlare(const float *origin, bool inportalsky)
+{
+    trace_t trace;
+    vec3_t  v;
+    vec3_t  trace_v;
+
+    R_FlareVectors(&tr.refdef, origin, inportalsky, v, trace_v);
+
+    ri.CM_BoxTrace(&trace, tr.viewParms.ori.origin, trace_v, vec3_origin, vec3_origin, 0, CONTENTS_SOLID, qfalse);
+    if (inportalsky) {
+        return (trace.surfaceFlags & 4) != 0;
+    }
+
+    return trace.fraction == 1.0;
+}
+
+/*
+=============
+R_TraceLensFlares
+
+Traces the visibility of the sun and of every flare of the current view
+into tr.viewParms, so R_DrawLensFlares doesn't have to use the collision
+model from the render thread
+=============
+*/
+void R_TraceLensFlares()
+{
+    const trRefEntity_t *ent;
+    int                  i;
+
+    tr.viewParms.sunFlareVisible    = qfalse;
+    tr.viewParms.dlightFlareVisible = 0;
+    Com_Memset(tr.viewParms.entityFlareVisible, 0, sizeof(tr.viewParms.entityFlareVisible));
+
+    if ((tr.refdef.rdflags & (RDF_HUD | RDF_NOWORLDMODEL)) || !tr.world) {
+        return;
+    }
+
+    tr.viewParms.sunFlareVisible = R_TraceSunFlare();
+
+    for (i = 0; i < tr.refdef.num_entities; i++) {
+        ent = &tr.refdef.entities[i];
+
+        if ((tr.viewParms.isPortalSky && !(ent->e.renderfx & RF_SKYENTITY))
+            || (!tr.viewParms.isPortalSky && (ent->e.renderfx & RF_SKYENTITY))) {
+            continue;
+        }
+
+        if (!(ent->e.renderfx & (RF_LENSFLARE | RF_VIEWLENSFLARE))) {
+            continue;
+        }
+
+        if (R_TraceFlare(ent->e.origin, (ent->e.renderfx & RF_SKYENTITY) != 0)) {
+            tr.viewParms.entityFlareVisible[i >> 3] |= 1 << (i & 7);
+        }
+    }
+
+    for (i = 0; i < tr.refdef.num_dlights; i++) {
+        if (!(tr.refdef.dlights[i].type & dlighttype_t::lensflare)
+            && !(tr.refdef.dlights[i].type & dlighttype_t::additive)) {
+            continue;
+        }
+
+        if (R_TraceFlare(tr.refdef.dlights[i].origin, false)) {
+            tr.viewParms.dlightFlareVisible |= 1u << i;
+        }
+    }
 }
 
 void sun_flare_class::SunScreenCalc()
@@ -646,14 +752,14 @@ void sun_flare_class::SunScreenCalc()
     VectorClear4(eye);
     for (i = 0; i < 4; i++) {
         for (j = 0; j < 4; j++) {
-            eye[i] += point[j] * tr.ori.modelMatrix[i + j * 4];
+            eye[i] += point[j] * backEnd.viewParms.world.modelMatrix[i + j * 4];
         }
     }
 
     VectorClear4(clip);
     for (i = 0; i < 4; i++) {
         for (j = 0; j < 4; j++) {
-            clip[i] += eye[j] * tr.viewParms.projectionMatrix[i + j * 4];
+            clip[i] += eye[j] * backEnd.viewParms.projectionMatrix[i + j * 4];
         }
     }
 
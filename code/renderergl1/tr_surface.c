@@ -408,7 +408,7 @@ void RB_SurfaceFace( srfSurfaceFace_t *surf ) {
 	numPoints = surf->numPoints;
 
 	needsNormal = qfalse;
-	if (tess.shader->needsNormal || tess.shader->needsLSpherical || tr.refdef.num_dlights) {
+	if (tess.shader->needsNormal || tess.shader->needsLSpherical || backEnd.refdef.num_dlights) {
 		needsNormal = qtrue;
 	}
 
@@ -578,7 +578,7 @@ void RB_SurfaceGrid( srfGridMesh_t *cv ) {
 		texCoords = tess.texCoords[numVertexes][0];
 		color = ( unsigned char * ) &tess.vertexColors[numVertexes];
 		vDlightBits = &tess.vertexDlightBits[numVertexes];
-		needsNormal = tess.shader->needsNormal || tess.shader->needsLSpherical || tr.refdef.num_dlights;
+		needsNormal = tess.shader->needsNormal || tess.shader->needsLSpherical || backEnd.refdef.num_dlights;
 
 		if ( tess.dlightMap ) {
 			for ( i = 0 ; i < rows ; i++ ) {
@@ -812,6 +812,10 @@ void RB_DrawTerrainTris(srfTerrain_t* p) {
 	int i;
 	terraInt numv;
 	int dlightBits;
+	// Added in OPM
+	// the front end may be tessellating the next frame, draw the copy
+	terrainVert_t* verts = backEnd.terrainVerts;
+	const terraTri_t* tris = backEnd.terrainTris;
 
 	RB_CHECKOVERFLOW(p->nVerts, p->nTris * 3);
 
@@ -821,14 +825,14 @@ void RB_DrawTerrainTris(srfTerrain_t* p) {
 	{
 		float lmScale = (1.0 / LIGHTMAP_SIZE) / p->lmapStep;
 
-		for (i = p->iVertHead; i; i = g_pVert[i].iNext) {
+		for (i = p->iVertHead; i; i = verts[i].iNext) {
 			assert(tess.numVertexes < SHADER_MAX_VERTEXES);
 
-			VectorCopy(g_pVert[i].xyz, tess.xyz[tess.numVertexes]);
-			tess.texCoords[tess.numVertexes][0][0] = g_pVert[i].texCoords[0][0];
-			tess.texCoords[tess.numVertexes][0][1] = g_pVert[i].texCoords[0][1];
-			tess.texCoords[tess.numVertexes][1][0] = g_pVert[i].xyz[0] * lmScale + p->lmapX;
-			tess.texCoords[tess.numVertexes][1][1] = g_pVert[i].xyz[1] * lmScale + p->lmapY;
+			VectorCopy(verts[i].xyz, tess.xyz[tess.numVertexes]);
+			tess.texCoords[tess.numVertexes][0][0] = verts[i].texCoords[0][0];
+			tess.texCoords[tess.numVertexes][0][1] = verts[i].texCoords[0][1];
+			tess.texCoords[tess.numVertexes][1][0] = verts[i].xyz[0] * lmScale + p->lmapX;
+			tess.texCoords[tess.numVertexes][1][1] = verts[i].xyz[1] * lmScale + p->lmapY;
 			tess.normal[tess.numVertexes][0] = 0;
 			tess.normal[tess.numVertexes][1] = 0;
 			tess.normal[tess.numVertexes][2] = 1.0;
@@ -837,20 +841,20 @@ void RB_DrawTerrainTris(srfTerrain_t* p) {
 			tess.vertexColors[tess.numVertexes][2] = -1;
 			tess.vertexColors[tess.numVertexes][3] = -1;
 
-			g_pVert[i].iVertArray = tess.numVertexes;
+			verts[i].iVertArray = tess.numVertexes;
 			tess.numVertexes++;
 		}
 	}
 	else
 	{
-		for (i = p->iVertHead; i; i = g_pVert[i].iNext) {
+		for (i = p->iVertHead; i; i = verts[i].iNext) {
 			assert(tess.numVertexes < SHADER_MAX_VERTEXES);
 
-			VectorCopy(g_pVert[i].xyz, tess.xyz[tess.numVertexes]);
-			tess.texCoords[tess.numVertexes][0][0] = g_pVert[i].texCoords[0][0];
-			tess.texCoords[tess.numVertexes][0][1] = g_pVert[i].texCoords[0][1];
-			tess.texCoords[tess.numVertexes][1][0] = g_pVert[i].texCoords[1][0];
-			tess.texCoords[tess.numVertexes][1][1] = g_pVert[i].texCoords[1][1];
+			VectorCopy(verts[i].xyz, tess.xyz[tess.numVertexes]);
+			tess.texCoords[tess.numVertexes][0][0] = verts[i].texCoords[0][0];
+			tess.texCoords[tess.numVertexes][0][1] = verts[i].texCoords[0][1];
+			tess.texCoords[tess.numVertexes][1][0] = verts[i].texCoords[1][0];
+			tess.texCoords[tess.numVertexes][1][1] = verts[i].texCoords[1][1];
 			tess.vertexDlightBits[tess.numVertexes] = dlightBits;
 			tess.normal[tess.numVertexes][0] = 0;
 			tess.normal[tess.numVertexes][1] = 0;
@@ -860,23 +864,23 @@ void RB_DrawTerrainTris(srfTerrain_t* p) {
 			tess.vertexColors[tess.numVertexes][2] = -1;
 			tess.vertexColors[tess.numVertexes][3] = -1;
 
-			g_pVert[i].iVertArray = tess.numVertexes;
+			verts[i].iVertArray = tess.numVertexes;
 			tess.numVertexes++;
 		}
 	}
 
-	for (i = p->iTriHead; i; i = g_pTris[i].iNext)
+	for (i = p->iTriHead; i; i = tris[i].iNext)
 	{
 		assert(tess.numVertexes < SHADER_MAX_INDEXES);
 
 		//
 		// Make sure these can be drawn
 		//
-		if (g_pTris[i].byConstChecks & 4)
+		if (tris[i].byConstChecks & 4)
 		{
-			tess.indexes[tess.numIndexes] = g_pVert[g_pTris[i].iPt[0]].iVertArray;
-			tess.indexes[tess.numIndexes + 1] = g_pVert[g_pTris[i].iPt[1]].iVertArray;
-			tess.indexes[tess.numIndexes + 2] = g_pVert[g_pTris[i].iPt[2]].iVertArray;
+			tess.indexes[tess.numIndexes] = verts[tris[i].iPt[0]].iVertArray;
+			tess.indexes[tess.numIndexes + 1] = verts[tris[i].iPt[1]].iVertArray;
+			tess.indexes[tess.numIndexes + 2] = verts[tris[i].iPt[2]].iVertArray;
 			tess.numIndexes += 3;
 		}
 	}
@@ -45,6 +45,9 @@ typedef struct {
 static int         lastswipeframe;
 static int         numswipes;
 static rendswipe_t swipes[MAX_SWIPES];
+// Added in OPM
+//  copies drawn by the render thread, for each frame being built
+static rendswipe_t backendswipes[SMP_FRAMES][MAX_SWIPES];
 
 /*
 ======================
@@ -104,6 +107,46 @@ RE_SwipeEnd
 */
 void RE_SwipeEnd() {}
 
+/*
+======================
+R_SwipePointFaded
+
+Added in OPM
+======================
+*/
+static qboolean R_SwipePointFaded(const rendswipe_t *swipe, int index)
+{
+    const rswipepoint_t *swipepoint = &swipe->swipes[index];
+    float                f;
+
+    f = 1.0 - (swipe->time - swipepoint->time) * (float)(1.0 / swipe->life);
+    return (f > 0 && swipe->time >= swipepoint->time) ? qfalse : qtrue;
+}
+
+/*
+======================
+R_CopySwipe
+
+Added in OPM
+Returns the surface the back end draws for the swipe.
+The render thread draws a copy, the front end keeps adding points
+and resetting the swipes for the next frame
+======================
+*/
+static surfaceType_t *R_CopySwipe(const rendswipe_t *swipe, int index)
+{
+    rendswipe_t *copy;
+
+    if (!glConfig.smpActive) {
+        return (surfaceType_t *)&swipe->surftype;
+    }
+
+    copy = &backendswipes[tr.smpFrame][index];
+    Com_Memcpy(copy, swipe, offsetof(rendswipe_t, swipes) + swipe->numswipes * sizeof(rswipepoint_t));
+
+    return &copy->surftype;
+}
+
 /*
 ======================
 R_AddSwipeSurfaces
@@ -139,7 +182,14 @@ void R_AddSwipeSurfaces()
         }
 
         shader = R_GetShaderByHandle(swipe->shader);
-        R_AddDrawSurf(&swipe->surftype, shader, 0);
+        R_AddDrawSurf(R_CopySwipe(swipe, at), shader, 0);
+
+        // Added in OPM
+        //  The swipe is done once its last point has faded,
+        //  reset it here as the back end may be drawing a copy
+        if (R_SwipePointFaded(swipe, swipe->numswipes - 1)) {
+            swipe->numswipes = 0;
+        }
     }
 }
 
@@ -174,8 +224,6 @@ void RB_DrawSwipeSurface(surfaceType_t *pswipe)
             RB_Vertex3fv(swipepoint->points[0]);
             RB_Texcoord2f(i / (float)swipe->numswipes, 1.0);
             RB_Vertex3fv(swipepoint->points[1]);
-        } else if (i == swipe->numswipes - 1) {
-            swipe->numswipes = 0;
         }
     }
 
@@ -699,6 +699,17 @@ static void R_PreTessellateTerrain()
     g_pTris  = ri.Hunk_Alloc(g_nTris * sizeof(terraTri_t), h_dontcare);
     g_pVert  = ri.Hunk_Alloc(g_nVerts * sizeof(terrainVert_t), h_dontcare);
 
+    // Added in OPM
+    //  The render thread draws a copy of the terrain,
+    //  the front end tessellates the next frame in the meantime
+    if (glConfig.smpActive) {
+        for (size_t i = 0; i < SMP_FRAMES; i++) {
+            backEndData[i]->terrainSurfs = ri.Hunk_Alloc(numTerrainPatches * sizeof(srfTerrain_t), h_dontcare);
+            backEndData[i]->terrainTris  = ri.Hunk_Alloc(g_nTris * sizeof(terraTri_t), h_dontcare);
+            backEndData[i]->terrainVerts = ri.Hunk_Alloc(g_nVerts * sizeof(terrainVert_t), h_dontcare);
+        }
+    }
+
     // Init triangles & vertices
     R_TerrainHeapInit();
     R_TerrainPatchesInit();
@@ -1309,6 +1320,51 @@ void R_MarkTerrainPatch(cTerraPatchUnpacked_t *pPatch)
     tr.world->activeTerraPatches = pPatch;
 }
 
+/*
+================
+R_TerrainDrawSurface
+
+Added in OPM
+Returns the surface the back end draws for the patch
+================
+*/
+static surfaceType_t *R_TerrainDrawSurface(cTerraPatchUnpacked_t *patch)
+{
+    srfTerrain_t *terrainSurfs = backEndData[tr.smpFrame]->terrainSurfs;
+
+    if (terrainSurfs) {
+        // copied by R_CopyTerrain when the commands are issued
+        return (surfaceType_t *)&terrainSurfs[patch - tr.world->terraPatches];
+    }
+
+    return (surfaceType_t *)&patch->drawinfo;
+}
+
+/*
+================
+R_CopyTerrain
+
+Added in OPM
+Copies the tessellated terrain for the render thread, as the front end
+splits and merges the triangles for the next frame while it draws
+================
+*/
+void R_CopyTerrain(backEndData_t *data)
+{
+    int i;
+
+    if (!data->terrainSurfs || !tr.world || tr.world->numTerraPatches <= 0) {
+        return;
+    }
+
+    for (i = 0; i < tr.world->numTerraPatches; i++) {
+        data->terrainSurfs[i] = tr.world->terraPatches[i].drawinfo;
+    }
+
+    Com_Memcpy(data->terrainTris, g_pTris, g_nTris * sizeof(terraTri_t));
+    Com_Memcpy(data->terrainVerts, g_pVert, g_nVerts * sizeof(terrainVert_t));
+}
+
 /*
 ================
 R_AddTerrainSurfaces
@@ -1336,7 +1392,7 @@ void R_AddTerrainSurfaces()
                 assert(patch->shader);
 
                 dlight = R_CheckDlightTerrain(patch, (1 << (tr.refdef.num_dlights)) - 1);
-                R_AddDrawSurf((surfaceType_t *)&patch->drawinfo, patch->shader, dlight);
+                R_AddDrawSurf(R_TerrainDrawSurface(patch), patch->shader, dlight);
             }
 
             if (ter_count->integer && (g_nSplit || g_nMerge)) {
@@ -1360,7 +1416,7 @@ void R_AddTerrainSurfaces()
             assert(patch->shader);
 
             dlight = R_CheckDlightTerrain(patch, (1 << (tr.refdef.num_dlights)) - 1);
-            R_AddDrawSurf((surfaceType_t *)&patch->drawinfo, patch->shader, dlight);
+            R_AddDrawSurf(R_TerrainDrawSurface(patch), patch->shader, dlight);
         }
     }
 }
@@ -1495,6 +1551,10 @@ void R_TerrainRestart_f(void)
         return;
     }
 
+    // Added in OPM
+    //  the render thread may still be drawing the terrain
+    R_IssuePendingRenderCommands();
+
     R_TerrainFree();
 
     R_PreTessellateTerrain();
@@ -1673,6 +1733,22 @@ Frees terrain memory
 */
 void R_TerrainFree()
 {
+    int i;
+
+    // Added in OPM
+    for (i = 0; i < SMP_FRAMES; i++) {
+        if (!backEndData[i] || !backEndData[i]->terrainSurfs) {
+            continue;
+        }
+
+        ri.Free(backEndData[i]->terrainSurfs);
+        ri.Free(backEndData[i]->terrainTris);
+        ri.Free(backEndData[i]->terrainVerts);
+        backEndData[i]->terrainSurfs = NULL;
+        backEndData[i]->terrainTris  = NULL;
+        backEndData[i]->terrainVerts = NULL;
+    }
+
     if (g_pVert) {
         ri.Free(g_pVert);
         g_pVert = NULL;
@@ -70,6 +70,8 @@ void ScriptCompiler::Reset()
     bCanContinue = false;
 
     prev_opcode_pos = 0;
+
+    jumpLocations.FreeObjectList();
 }
 
 unsigned char ScriptCompiler::PrevOpcode()
@@ -88,6 +90,12 @@ void ScriptCompiler::AbsorbPrevOpcode()
 
     code_pos -= OpcodeLength(PrevOpcode());
 
+    if (jumpLocations.NumObjects() && jumpLocations.ObjectAt(jumpLocations.NumObjects()) == code_pos) {
+        // Added in OPM
+        //  the jump doesn't exist anymore
+        jumpLocations.RemoveObjectAt(jumpLocations.NumObjects());
+    }
+
     if (!prev_opcode_pos) {
         prev_opcode_pos = 100;
     }
@@ -287,6 +295,16 @@ void ScriptCompiler::EmitBoolJumpFalse(unsigned int sourcePos)
 {
     if (PrevOpcode() == OP_UN_CAST_BOOLEAN) {
         AbsorbPrevOpcode();
+
+        // Added in OPM
+        //  fuse the comparison with the jump
+        int prev = PrevOpcode();
+        if (g_scriptoptimize->integer && prev >= OP_BIN_EQUALITY && prev <= OP_BIN_GREATER_THAN_OR_EQUAL) {
+            AbsorbPrevOpcode();
+            EmitOpcode(OP_BIN_EQUALITY_JUMP_FALSE4 + (prev - OP_BIN_EQUALITY), sourcePos);
+            return;
+        }
+
         EmitOpcode(OP_VAR_JUMP_FALSE4, sourcePos);
     } else {
         EmitOpcode(OP_BOOL_JUMP_FALSE4, sourcePos);
@@ -541,6 +559,63 @@ void ScriptCompiler::EmitFunc1(int opcode, unsigned int sourcePos)
     EmitOpcode(opcode, sourcePos);
 }
 
+void ScriptCompiler::EmitFunc2(int opcode, unsigned int sourcePos)
+{
+    ScriptVariable a;
+    ScriptVariable b;
+
+    //
+    // Added in OPM
+    //  Fold the operation if both operands are constant numbers
+    //
+    if (g_scriptoptimize->integer && EvalPrevValue(b)) {
+        AbsorbPrevOpcode();
+
+        if (EvalPrevValue(a) && EvalFunc2(opcode, a, b)) {
+            AbsorbPrevOpcode();
+            return EmitValue(a, sourcePos);
+        }
+
+        // Can't be folded, put back the second operand
+        EmitValue(b, sourcePos);
+    }
+
+    EmitOpcode(opcode, sourcePos);
+}
+
+void ScriptCompiler::EmitCalcVector(unsigned int sourcePos)
+{
+    ScriptVariable x;
+    ScriptVariable y;
+    ScriptVariable z;
+
+    //
+    // Added in OPM
+    //  Store the vector directly if all components are constant numbers
+    //
+    if (g_scriptoptimize->integer && EvalPrevValue(z)) {
+        AbsorbPrevOpcode();
+
+        if (EvalPrevValue(y)) {
+            AbsorbPrevOpcode();
+
+            if (EvalPrevValue(x)) {
+                AbsorbPrevOpcode();
+
+                EmitOpcode(OP_STORE_VECTOR, sourcePos);
+                EmitOpcodeValue(Vector(x.floatValue(), y.floatValue(), z.floatValue()), sizeof(Vector));
+                return;
+            }
+
+            EmitValue(y, sourcePos);
+        }
+
+        EmitValue(z, sourcePos);
+    }
+
+    EmitOpcode(OP_CALC_VECTOR, sourcePos);
+}
+
 /*
 void ScriptCompiler::EmitFunction(int iParamCount, sval_t val, unsigned int sourcePos)
 {
@@ -907,6 +982,11 @@ void ScriptCompiler::EmitOpcode(int opcode, unsigned int sourcePos)
     prev_opcodes[prev_opcode_pos].VarStackOffset     = iVarStackOffset;
     prev_opcodes[(prev_opcode_pos + 1) % 100].opcode = OP_PREVIOUS;
 
+    if (IsJumpOpcode(opcode)) {
+        // Added in OPM
+        jumpLocations.AddObject(code_pos);
+    }
+
     EmitOpcodeValue((byte)opcode, sizeof(byte));
 }
 
@@ -1078,7 +1158,7 @@ __emit:
         EmitValue(val.node[1]);
         EmitValue(val.node[2]);
         EmitValue(val.node[3]);
-        EmitOpcode(OP_CALC_VECTOR, val.node[4].sourcePosValue);
+        EmitCalcVector(val.node[4].sourcePosValue);
         break;
 
     case ENUM_neg_int_labeled_statement:
@@ -1250,7 +1330,7 @@ __emit:
     case ENUM_func2_expr:
         EmitValue(val.node[2]);
         EmitValue(val.node[3]);
-        EmitOpcode(val.node[1].byteValue, val.node[4].sourcePosValue);
+        EmitFunc2(val.node[1].byteValue, val.node[4].sourcePosValue);
         break;
 
     case ENUM_statement_list:
@@ -1414,6 +1494,189 @@ bool ScriptCompiler::EvalPrevValue(ScriptVariable& var)
     return true;
 }
 
+/*
+====================
+EvalFunc2
+
+Added in OPM
+Evaluates a binary opcode at compile time, like the VM does.
+Returns false if the result is only known at runtime
+or if the VM would throw an error
+====================
+*/
+bool ScriptCompiler::EvalFunc2(int opcode, ScriptVariable& a, ScriptVariable& b)
+{
+    switch (opcode) {
+    case OP_BIN_DIVIDE:
+    case OP_BIN_PERCENTAGE:
+        if (!b.floatValue()) {
+            // let the VM report the division by zero
+            return false;
+        }
+        break;
+    case OP_BIN_BITWISE_AND:
+    case OP_BIN_BITWISE_OR:
+    case OP_BIN_BITWISE_EXCL_OR:
+    case OP_BIN_SHIFT_LEFT:
+    case OP_BIN_SHIFT_RIGHT:
+        if (a.GetType() != VARIABLE_INTEGER || b.GetType() != VARIABLE_INTEGER) {
+            return false;
+        }
+        break;
+    }
+
+    try {
+        switch (opcode) {
+        case OP_BIN_BITWISE_AND:
+            a &= b;
+            break;
+        case OP_BIN_BITWISE_OR:
+            a |= b;
+            break;
+        case OP_BIN_BITWISE_EXCL_OR:
+            a ^= b;
+            break;
+        case OP_BIN_EQUALITY:
+            a.setIntValue(a == b);
+            break;
+        case OP_BIN_INEQUALITY:
+            a.setIntValue(a != b);
+            break;
+        case OP_BIN_GREATER_THAN:
+            a.greaterthan(b);
+            break;
+        case OP_BIN_GREATER_THAN_OR_EQUAL:
+            a.greaterthanorequal(b);
+            break;
+        case OP_BIN_LESS_THAN:
+            a.lessthan(b);
+            break;
+        case OP_BIN_LESS_THAN_OR_EQUAL:
+            a.lessthanorequal(b);
+            break;
+        case OP_BIN_PLUS:
+            a += b;
+            break;
+        case OP_BIN_MINUS:
+            a -= b;
+            break;
+        case OP_BIN_MULTIPLY:
+            a *= b;
+            break;
+        case OP_BIN_DIVIDE:
+            a /= b;
+            break;
+        case OP_BIN_PERCENTAGE:
+            a %= b;
+            break;
+        case OP_BIN_SHIFT_LEFT:
+            a <<= b;
+            break;
+        case OP_BIN_SHIFT_RIGHT:
+            a >>= b;
+            break;
+        default:
+            return false;
+        }
+    } catch (ScriptException&) {
+        return false;
+    }
+
+    return a.GetType() == VARIABLE_INTEGER || a.GetType() == VARIABLE_FLOAT;
+}
+
+/*
+====================
+GetJumpTarget
+
+Added in OPM
+Returns the code position the jump opcode at pos goes to
+====================
+*/
+unsigned char *ScriptCompiler::GetJumpTarget(unsigned char *pos)
+{
+    unsigned int offset;
+
+    Com_Memcpy(&offset, pos + 1, sizeof(offset));
+
+    if (*pos == OP_JUMP_BACK4) {
+        return pos + 1 - offset;
+    }
+
+    return pos + 1 + sizeof(unsigned int) + offset;
+}
+
+/*
+====================
+SetJumpTarget
+
+Added in OPM
+====================
+*/
+void ScriptCompiler::SetJumpTarget(unsigned char *pos, unsigned char *target)
+{
+    unsigned int offset;
+
+    if (*pos == OP_JUMP_BACK4) {
+        offset = pos + 1 - target;
+    } else {
+        offset = target - (pos + 1 + sizeof(unsigned int));
+    }
+
+    EmitAt(pos + 1, offset, sizeof(offset));
+}
+
+/*
+====================
+OptimizeJumps
+
+Added in OPM
+Jump threading: a jump that lands on an unconditional jump
+goes directly to the final destination.
+The code size doesn't change so labels stay valid
+====================
+*/
+void ScriptCompiler::OptimizeJumps()
+{
+    unsigned char *pos;
+    unsigned char *target;
+    unsigned char *next;
+    int            i, j;
+
+    for (i = 1; i <= jumpLocations.NumObjects(); i++) {
+        pos    = jumpLocations.ObjectAt(i);
+        target = GetJumpTarget(pos);
+
+        // follow the chain, with a limit for jumps that loop
+        for (j = 0; j < 16; j++) {
+            if (*target != OP_JUMP4 && *target != OP_JUMP_BACK4) {
+                break;
+            }
+
+            next = GetJumpTarget(target);
+            if (next == pos || next == target) {
+                break;
+            }
+
+            target = next;
+        }
+
+        if (target == GetJumpTarget(pos)) {
+            continue;
+        }
+
+        if (*pos == OP_JUMP4 || *pos == OP_JUMP_BACK4) {
+            // the direction can change for unconditional jumps
+            *pos = target > pos ? OP_JUMP4 : OP_JUMP_BACK4;
+        } else if (target < pos + 1 + sizeof(unsigned int)) {
+            // other jumps can only go forward
+            continue;
+        }
+
+        SetJumpTarget(pos, target);
+    }
+}
+
 void ScriptCompiler::ProcessBreakJumpLocations(int iStartBreakJumpLocCount)
 {
     if (iBreakJumpLocCount > iStartBreakJumpLocCount) {
@@ -1575,6 +1838,10 @@ bool ScriptCompiler::Compile(GameScript *gameScript, unsigned char *progBuffer,
         EmitEof(-1);
 
         if (compileSuccess) {
+            if (g_scriptoptimize->integer) {
+                OptimizeJumps();
+            }
+
             stateScript->AddLabel("", code_ptr);
 
             outLength = code_pos - code_ptr;
@@ -1591,6 +1858,7 @@ bool ScriptCompiler::Compile(GameScript *gameScript, unsigned char *progBuffer,
     }
 
     parsetree_freeall();
+    jumpLocations.FreeObjectList();
 
     return success;
 }
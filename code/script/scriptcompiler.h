@@ -68,6 +68,10 @@ public:
     unsigned char *apucContinueJumpLocations[CONTINUE_JUMP_LOCATION_COUNT];
     int            iContinueJumpLocCount;
 
+    // Added in OPM
+    //  every jump opcode emitted, for the jump threading pass
+    Container<unsigned char *> jumpLocations;
+
     bool compileSuccess;
 
     static int current_label;
@@ -108,6 +112,8 @@ public:
     void EmitField(sval_t listener_val, sval_t field_val, unsigned int sourcePos);
     void EmitFloat(float value, unsigned int sourcePos);
     void EmitFunc1(int opcode, unsigned int sourcePos);
+    void EmitFunc2(int opcode, unsigned int sourcePos);
+    void EmitCalcVector(unsigned int sourcePos);
     //void EmitFunction(int iParamCount, sval_t val, unsigned int sourcePos);
     void EmitIfElseJump(sval_t if_stmt, sval_t else_stmt, unsigned int sourcePos);
     void EmitIfJump(sval_t if_stmt, unsigned int sourcePos);
@@ -138,6 +144,11 @@ public:
     void EmitWhileJump(sval_t while_expr, sval_t while_stmt, sval_t inc_stmt, unsigned int sourcePos);
 
     bool EvalPrevValue(ScriptVariable& var);
+    bool EvalFunc2(int opcode, ScriptVariable& a, ScriptVariable& b);
+
+    unsigned char *GetJumpTarget(unsigned char *pos);
+    void           SetJumpTarget(unsigned char *pos, unsigned char *target);
+    void           OptimizeJumps();
 
     void ProcessBreakJumpLocations(int iStartBreakJumpLocCount);
     void ProcessContinueJumpLocations(int iStartContinueJumpLocCount);
@@ -192,6 +192,16 @@ typedef enum {
     OP_END,
     OP_RETURN,
 
+    // Added in OPM
+    //  Comparison followed by OP_VAR_JUMP_FALSE4,
+    //  in the same order as the OP_BIN comparisons
+    OP_BIN_EQUALITY_JUMP_FALSE4,
+    OP_BIN_INEQUALITY_JUMP_FALSE4,
+    OP_BIN_LESS_THAN_JUMP_FALSE4,
+    OP_BIN_GREATER_THAN_JUMP_FALSE4,
+    OP_BIN_LESS_THAN_OR_EQUAL_JUMP_FALSE4,
+    OP_BIN_GREATER_THAN_OR_EQUAL_JUMP_FALSE4,
+
     OP_PREVIOUS,
     OP_MAX = OP_PREVIOUS
 } opcode_e;
@@ -202,3 +212,4 @@ int         OpcodeLength(int opcode);
 int         OpcodeVarStackOffset(int opcode);
 void        SetOpcodeVarStackOffset(int opcode, int iVarStackOffset);
 bool        IsExternalOpcode(int opcode);
+bool        IsJumpOpcode(int opcode);
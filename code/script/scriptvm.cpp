@@ -466,9 +466,10 @@ bool ScriptVM::doJumpVarIf(bool booleanValue)
 
 void ScriptVM::loadTopInternal(Listener *listener)
 {
-    const const_str variable = fetchOpcodeValue<op_name_t>();
+    ScriptCache *const cache    = GetScript()->GetCache(m_CodePos);
+    const const_str    variable = fetchOpcodeValue<op_name_t>();
 
-    if (!executeSetter(listener, variable)) {
+    if (!executeSetter(listener, variable, cache)) {
         // just set the variable
         ScriptVariable& pTop = m_VMStack.GetTop();
         listener->Vars()->SetVariable(variable, std::move(pTop));
@@ -477,10 +478,11 @@ void ScriptVM::loadTopInternal(Listener *listener)
 
 ScriptVariable *ScriptVM::storeTopInternal(Listener *listener)
 {
-    const const_str variable = fetchOpcodeValue<op_name_t>();
-    ScriptVariable *listenerVar;
+    ScriptCache *const cache    = GetScript()->GetCache(m_CodePos);
+    const const_str    variable = fetchOpcodeValue<op_name_t>();
+    ScriptVariable    *listenerVar;
 
-    if (!executeGetter(listener, variable)) {
+    if (!executeGetter(listener, variable, cache)) {
         ScriptVariable& pTop = m_VMStack.GetTop();
         listenerVar          = listener->Vars()->GetOrCreateVariable(variable);
 
@@ -494,9 +496,10 @@ ScriptVariable *ScriptVM::storeTopInternal(Listener *listener)
 
 void ScriptVM::loadStoreTop(Listener *listener)
 {
-    const const_str variable = fetchOpcodeValue<op_name_t>();
+    ScriptCache *const cache    = GetScript()->GetCache(m_CodePos);
+    const const_str    variable = fetchOpcodeValue<op_name_t>();
 
-    if (!executeSetter(listener, variable)) {
+    if (!executeSetter(listener, variable, cache)) {
         // just set the variable
         ScriptVariable& pTop = m_VMStack.GetTop();
         listener->Vars()->SetVariable(variable, pTop);
@@ -537,25 +540,23 @@ ScriptVariable *ScriptVM::storeTop<true>(Listener *listener)
 
 template<>
 void ScriptVM::executeCommandInternal<false>(
-    Event& ev, Listener *listener, ScriptVariable *fromVar, op_parmNum_t iParamCount
+    Event& ev, Listener *listener, ScriptVariable *fromVar, op_parmNum_t iParamCount, ScriptCache *cache
 )
 {
     transferVarsToEvent(ev, fromVar, iParamCount);
 
-    checkValidEvent(ev, listener);
-    listener->ProcessScriptEvent(ev);
+    processCommand(ev, listener, checkValidEvent(ev, listener, cache));
 }
 
 template<>
 void ScriptVM::executeCommandInternal<true>(
-    Event& ev, Listener *listener, ScriptVariable *fromVar, op_parmNum_t iParamCount
+    Event& ev, Listener *listener, ScriptVariable *fromVar, op_parmNum_t iParamCount, ScriptCache *cache
 )
 {
     transferVarsToEvent(ev, fromVar, iParamCount);
 
     try {
-        checkValidEvent(ev, listener);
-        listener->ProcessScriptEvent(ev);
+        processCommand(ev, listener, checkValidEvent(ev, listener, cache));
     } catch (...) {
         m_VMStack.GetTop().Clear();
         throw;
@@ -566,31 +567,39 @@ void ScriptVM::executeCommandInternal<true>(
 }
 
 template<>
-void ScriptVM::executeCommand<false, false>(Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum)
+void ScriptVM::executeCommand<false, false>(
+    Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum, ScriptCache *cache
+)
 {
     ScriptCommandEvent ev = iParamCount ? ScriptCommandEvent(eventnum, iParamCount) : ScriptCommandEvent(eventnum);
-    return executeCommandInternal<false>(ev, listener, m_VMStack.GetTopArray(1), iParamCount);
+    return executeCommandInternal<false>(ev, listener, m_VMStack.GetTopArray(1), iParamCount, cache);
 }
 
 template<>
-void ScriptVM::executeCommand<true, false>(Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum)
+void ScriptVM::executeCommand<true, false>(
+    Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum, ScriptCache *cache
+)
 {
     ScriptCommandEvent ev = iParamCount ? ScriptCommandEvent(eventnum, iParamCount) : ScriptCommandEvent(eventnum);
-    return executeCommandInternal<false>(ev, listener, m_VMStack.GetTopArray(1), iParamCount);
+    return executeCommandInternal<false>(ev, listener, m_VMStack.GetTopArray(1), iParamCount, cache);
 }
 
 template<>
-void ScriptVM::executeCommand<false, true>(Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum)
+void ScriptVM::executeCommand<false, true>(
+    Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum, ScriptCache *cache
+)
 {
     ScriptCommandEvent ev = iParamCount ? ScriptCommandEvent(eventnum, iParamCount) : ScriptCommandEvent(eventnum);
-    return executeCommandInternal<true>(ev, listener, m_VMStack.GetTopArray(), iParamCount);
+    return executeCommandInternal<true>(ev, listener, m_VMStack.GetTopArray(), iParamCount, cache);
 }
 
 template<>
-void ScriptVM::executeCommand<true, true>(Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum)
+void ScriptVM::executeCommand<true, true>(
+    Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum, ScriptCache *cache
+)
 {
     ScriptCommandEvent ev = iParamCount ? ScriptCommandEvent(eventnum, iParamCount) : ScriptCommandEvent(eventnum);
-    return executeCommandInternal<true>(ev, listener, m_VMStack.GetTopArray(), iParamCount);
+    return executeCommandInternal<true>(ev, listener, m_VMStack.GetTopArray(), iParamCount, cache);
 }
 
 void ScriptVM::transferVarsToEvent(Event& ev, ScriptVariable *fromVar, op_parmNum_t count)
@@ -598,10 +607,24 @@ void ScriptVM::transferVarsToEvent(Event& ev, ScriptVariable *fromVar, op_parmNu
     ev.CopyValues(fromVar, count);
 }
 
-void ScriptVM::checkValidEvent(Event& ev, Listener* listener) {
-    ClassDef *c = listener->classinfo();
+ResponseDef<Class> *ScriptVM::checkValidEvent(Event& ev, Listener *listener, ScriptCache *cache)
+{
+    ClassDef           *c = listener->classinfo();
+    ResponseDef<Class> *responses;
+    int                 way;
+
+    // Added in OPM
+    //  the response is cached for the last classes of the listeners
+    if (cache) {
+        way = cache->Find(c);
+        if (way != -1) {
+            return cache->value[way].response;
+        }
+    }
+
+    responses = c->responseLookup[ev.eventnum];
 
-    if (!c->GetDef(&ev)) {
+    if (!responses || !responses->def) {
         if (listener == m_Thread) {
             ScriptError("Failed execution of command '%s'", ev.getName());
         } else if (listener->isSubclassOf(SimpleEntity)) {
@@ -610,13 +633,54 @@ void ScriptVM::checkValidEvent(Event& ev, Listener* listener) {
             ScriptError("Failed execution of command '%s' for class '%s'", ev.getName(), c->classname);
         }
     }
+
+    if (cache) {
+        way                        = cache->Add(c);
+        cache->value[way].response = responses;
+    }
+
+    return responses;
 }
 
-bool ScriptVM::executeGetter(Listener *listener, op_evName_t eventName)
+/*
+====================
+processCommand
+
+Same as Listener::ProcessScriptEvent(),
+with the response that was already found
+====================
+*/
+void ScriptVM::processCommand(Event& ev, Listener *listener, ResponseDef<Class> *responses)
 {
-    int eventNum = Event::FindGetterEventNum(eventName);
+    Response response = responses->response;
+
+    if (response) {
+        (listener->*response)(&ev);
+    }
+}
 
-    if (eventNum && listener->classinfo()->GetDef(eventNum)) {
+bool ScriptVM::executeGetter(Listener *listener, op_evName_t eventName, ScriptCache *cache)
+{
+    ClassDef *c = listener->classinfo();
+    int       eventNum;
+    int       way;
+
+    // Added in OPM
+    //  the getter is cached for the last classes of the listeners
+    if (cache) {
+        way = cache->Find(c);
+        if (way != -1) {
+            eventNum = cache->value[way].eventNum;
+        } else {
+            eventNum                   = resolveGetter(c, eventName);
+            way                        = cache->Add(c);
+            cache->value[way].eventNum = eventNum;
+        }
+    } else {
+        eventNum = resolveGetter(c, eventName);
+    }
+
+    if (eventNum) {
         ScriptCommandEvent ev(eventNum);
 
         listener->ProcessScriptEvent(ev);
@@ -625,22 +689,33 @@ bool ScriptVM::executeGetter(Listener *listener, op_evName_t eventName)
         pTop                 = std::move(ev.GetValue());
 
         return true;
-    } else {
-        eventNum = Event::FindSetterEventNum(eventName);
-        assert(!eventNum || !listener->classinfo()->GetDef(eventNum));
-        if (eventNum && listener->classinfo()->GetDef(eventNum)) {
-            ScriptError("Cannot set a read-only variable");
-        }
     }
 
     return false;
 }
 
-bool ScriptVM::executeSetter(Listener *listener, op_evName_t eventName)
+bool ScriptVM::executeSetter(Listener *listener, op_evName_t eventName, ScriptCache *cache)
 {
-    int eventNum = Event::FindSetterEventNum(eventName);
+    ClassDef *c = listener->classinfo();
+    int       eventNum;
+    int       way;
+
+    // Added in OPM
+    //  the setter is cached for the last classes of the listeners
+    if (cache) {
+        way = cache->Find(c);
+        if (way != -1) {
+            eventNum = cache->value[way].eventNum;
+        } else {
+            eventNum                   = resolveSetter(c, eventName);
+            way                        = cache->Add(c);
+            cache->value[way].eventNum = eventNum;
+        }
+    } else {
+        eventNum = resolveSetter(c, eventName);
+    }
 
-    if (eventNum && listener->classinfo()->GetDef(eventNum)) {
+    if (eventNum) {
         ScriptCommandEvent ev(eventNum, 1);
 
         ScriptVariable& pTop = m_VMStack.GetTop();
@@ -649,29 +724,69 @@ bool ScriptVM::executeSetter(Listener *listener, op_evName_t eventName)
         listener->ProcessScriptEvent(ev);
 
         return true;
-    } else {
-        eventNum = Event::FindSetterEventNum(eventName);
-        assert(!eventNum || !listener->classinfo()->GetDef(eventNum));
-        if (eventNum && listener->classinfo()->GetDef(eventNum)) {
-            ScriptError("Cannot get a write-only variable");
-        }
     }
 
     return false;
 }
 
+/*
+====================
+resolveGetter
+
+Returns the getter event of the field for the class,
+or 0 if the field is a variable
+====================
+*/
+int ScriptVM::resolveGetter(ClassDef *c, op_evName_t eventName)
+{
+    int eventNum = Event::FindGetterEventNum(eventName);
+
+    if (eventNum && c->GetDef(eventNum)) {
+        return eventNum;
+    }
+
+    eventNum = Event::FindSetterEventNum(eventName);
+    assert(!eventNum || !c->GetDef(eventNum));
+    if (eventNum && c->GetDef(eventNum)) {
+        ScriptError("Cannot set a read-only variable");
+    }
+
+    return 0;
+}
+
+/*
+====================
+resolveSetter
+
+Returns the setter event of the field for the class,
+or 0 if the field is a variable
+====================
+*/
+int ScriptVM::resolveSetter(ClassDef *c, op_evName_t eventName)
+{
+    int eventNum = Event::FindSetterEventNum(eventName);
+
+    if (eventNum && c->GetDef(eventNum)) {
+        return eventNum;
+    }
+
+    return 0;
+}
+
 void ScriptVM::execCmdCommon(op_parmNum_t param)
 {
-    const op_ev_t eventNum = fetchOpcodeValue<op_ev_t>();
+    ScriptCache *const cache    = GetScript()->GetCache(m_CodePos);
+    const op_ev_t      eventNum = fetchOpcodeValue<op_ev_t>();
 
     m_VMStack.Pop(param);
 
-    executeCommand(m_Thread, param, eventNum);
+    executeCommand(m_Thread, param, eventNum, cache);
 }
 
 void ScriptVM::execCmdMethodCommon(op_parmNum_t param)
 {
     const ScriptVariable& a        = m_VMStack.Pop();
+    ScriptCache *const    cache    = GetScript()->GetCache(m_CodePos);
     const op_ev_t         eventNum = fetchOpcodeValue<op_ev_t>();
 
     m_VMStack.Pop(param);
@@ -695,7 +810,7 @@ void ScriptVM::execCmdMethodCommon(op_parmNum_t param)
                 // if the listener is NULL, don't throw an exception
                 // it would be unfair if the other listeners executed the command
                 if (listener) {
-                    executeCommand<true>(listener, param, eventNum);
+                    executeCommand<true>(listener, param, eventNum, cache);
                 }
             }
         } else {
@@ -706,7 +821,7 @@ void ScriptVM::execCmdMethodCommon(op_parmNum_t param)
             for (uintptr_t i = array.arraysize(); i > 0; i--) {
                 Listener *const listener = array.listenerAt(i);
                 if (listener) {
-                    executeCommand<true>(listener, param, eventNum);
+                    executeCommand<true>(listener, param, eventNum, cache);
                 }
             }
         }
@@ -717,13 +832,14 @@ void ScriptVM::execCmdMethodCommon(op_parmNum_t param)
             throw ScriptException("command '%s' applied to NULL listener", Event::GetEventName(eventNum));
         }
 
-        executeCommand<true>(listener, param, eventNum);
+        executeCommand<true>(listener, param, eventNum, cache);
     }
 }
 
 void ScriptVM::execMethodCommon(op_parmNum_t param)
 {
     const ScriptVariable& a        = m_VMStack.Pop();
+    ScriptCache *const    cache    = GetScript()->GetCache(m_CodePos);
     const op_ev_t         eventNum = fetchOpcodeValue<op_ev_t>();
 
     m_VMStack.Pop(param);
@@ -736,7 +852,7 @@ void ScriptVM::execMethodCommon(op_parmNum_t param)
         throw ScriptException("command '%s' applied to NULL listener", Event::GetEventName(eventNum));
     }
 
-    executeCommand<true, true>(listener, param, eventNum);
+    executeCommand<true, true>(listener, param, eventNum, cache);
 }
 
 void ScriptVM::execFunction(ScriptMaster& Director)
@@ -1002,14 +1118,107 @@ void ScriptVM::End()
     LeaveFunction();
 }
 
+//
+// Added in OPM
+//  Opcode dispatch used by ExecuteLoop().
+//  With bThreaded, each opcode jumps directly to the next opcode's handler
+//  through a table of label addresses instead of going back through the switch,
+//  which gives the branch predictor one indirect jump per opcode.
+//  Compilers without labels as values always use the switch.
+//
+#if defined(__GNUC__) || defined(__clang__)
+#    define VM_COMPUTED_GOTO 1
+#else
+#    define VM_COMPUTED_GOTO 0
+#endif
+
+#if VM_COMPUTED_GOTO
+
+#    define VM_LABEL(op)      vm_label_##op
+#    define VM_CASE(op)       case op: VM_LABEL(op):
+#    define VM_DEFAULT()      default: VM_LABEL(default):
+#    define VM_TARGET(op)     dispatchTable[op] = &&VM_LABEL(op)
+#    define VM_NEXT()                               \
+        if (bThreaded) {                            \
+            if (++Director.cmdCount >= 15000) {     \
+                CheckCommandOverflow(opcode);       \
+            }                                       \
+            if (state != STATE_RUNNING) {           \
+                break;                              \
+            }                                       \
+            m_PrevCodePos = m_CodePos;              \
+            opcode        = m_CodePos++;            \
+            goto *dispatchTable[*opcode];           \
+        }                                           \
+        break
+
+#else
+
+#    define VM_CASE(op)  case op:
+#    define VM_DEFAULT() default:
+#    define VM_NEXT()    break
+
+#endif
+
 /*
 ====================
-Execute
+CheckCommandOverflow
 
-Executes a program
+Called every 15000 commands to check if the thread
+has been running for too long
 ====================
 */
-void ScriptVM::Execute(ScriptVariable *data, int dataSize, str label)
+void ScriptVM::CheckCommandOverflow(unsigned char *opcode)
+{
+    if (!Director.cmdTime) {
+        Director.cmdTime  = gi.Milliseconds();
+        Director.cmdCount = 0;
+        return;
+    }
+
+    if (gi.Milliseconds() - Director.cmdTime < Director.maxTime) {
+        Director.cmdCount = 0;
+        return;
+    }
+
+    // The maximum execution time was reached
+    if (level.m_LoopProtection) {
+        Director.cmdTime = gi.Milliseconds();
+
+        GetScript()->PrintSourcePos(m_CodePos, true);
+        gi.DPrintf2("\n");
+
+        state = STATE_EXECUTION;
+
+        if (level.m_LoopDrop) {
+            ScriptException::next_abort = -1;
+        }
+
+        ScriptError("Command overflow. Possible infinite loop in thread.\n");
+    }
+
+    VM_DPrintf("Update of script position - This is not an error.\n");
+    VM_DPrintf("=================================================\n");
+    m_ScriptClass->GetScript()->PrintSourcePos(opcode, true);
+    VM_DPrintf("=================================================\n");
+
+    Director.cmdCount = 0;
+}
+
+/*
+====================
+ExecuteLoop
+
+Runs opcodes until the VM stops running.
+Without bThreaded, this is the original loop: the trace
+and the exception handler are set up for each opcode.
+With bThreaded, the trace is never checked and opcodes
+are executed inside a single try block until an exception
+is thrown.
+====================
+*/
+template<bool bThreaded>
+void ScriptVM::ExecuteLoop(void)
 {
     unsigned char *opcode;
 
@@ -1026,561 +1235,736 @@ void ScriptVM::Execute(ScriptVariable *data, int dataSize, str label)
 
     TargetList *targetList;
 
-    if (Director.stackCount >= MAX_STACK_DEPTH) {
-        state = STATE_EXECUTION;
-
-        ScriptException::next_abort = -1;
-        throw ScriptException("stack overflow");
-    }
+#if VM_COMPUTED_GOTO
+    static void *dispatchTable[256];
 
-    if (label.length()) {
-        // Throw if label is not found
-        m_CodePos = m_ScriptClass->FindLabel(label);
-        if (!m_CodePos) {
-            ScriptError("ScriptVM::Execute: label '%s' does not exist in '%s'.", label.c_str(), Filename().c_str());
+    if (bThreaded && !dispatchTable[0]) {
+        for (int i = 0; i < 256; i++) {
+            dispatchTable[i] = &&VM_LABEL(default);
         }
-    }
 
-    if (g_scripttrace->integer && CanScriptTracePrint()) {
-        gi.DPrintf2(
-            "+++FRAME: %i (%p) +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n",
-            Director.stackCount,
-            this
-        );
+        VM_TARGET(OP_BIN_BITWISE_AND);
+        VM_TARGET(OP_BIN_BITWISE_OR);
+        VM_TARGET(OP_BIN_BITWISE_EXCL_OR);
+        VM_TARGET(OP_BIN_EQUALITY);
+        VM_TARGET(OP_BIN_INEQUALITY);
+        VM_TARGET(OP_BIN_GREATER_THAN);
+        VM_TARGET(OP_BIN_GREATER_THAN_OR_EQUAL);
+        VM_TARGET(OP_BIN_LESS_THAN);
+        VM_TARGET(OP_BIN_LESS_THAN_OR_EQUAL);
+        VM_TARGET(OP_BIN_PLUS);
+        VM_TARGET(OP_BIN_MINUS);
+        VM_TARGET(OP_BIN_MULTIPLY);
+        VM_TARGET(OP_BIN_DIVIDE);
+        VM_TARGET(OP_BIN_PERCENTAGE);
+        VM_TARGET(OP_BIN_SHIFT_LEFT);
+        VM_TARGET(OP_BIN_SHIFT_RIGHT);
+        VM_TARGET(OP_BOOL_JUMP_FALSE4);
+        VM_TARGET(OP_BOOL_JUMP_TRUE4);
+        VM_TARGET(OP_VAR_JUMP_FALSE4);
+        VM_TARGET(OP_VAR_JUMP_TRUE4);
+        VM_TARGET(OP_BIN_EQUALITY_JUMP_FALSE4);
+        VM_TARGET(OP_BIN_INEQUALITY_JUMP_FALSE4);
+        VM_TARGET(OP_BIN_LESS_THAN_JUMP_FALSE4);
+        VM_TARGET(OP_BIN_GREATER_THAN_JUMP_FALSE4);
+        VM_TARGET(OP_BIN_LESS_THAN_OR_EQUAL_JUMP_FALSE4);
+        VM_TARGET(OP_BIN_GREATER_THAN_OR_EQUAL_JUMP_FALSE4);
+        VM_TARGET(OP_BOOL_LOGICAL_AND);
+        VM_TARGET(OP_BOOL_LOGICAL_OR);
+        VM_TARGET(OP_VAR_LOGICAL_AND);
+        VM_TARGET(OP_VAR_LOGICAL_OR);
+        VM_TARGET(OP_BOOL_STORE_FALSE);
+        VM_TARGET(OP_BOOL_STORE_TRUE);
+        VM_TARGET(OP_BOOL_UN_NOT);
+        VM_TARGET(OP_CALC_VECTOR);
+        VM_TARGET(OP_EXEC_CMD0);
+        VM_TARGET(OP_EXEC_CMD1);
+        VM_TARGET(OP_EXEC_CMD2);
+        VM_TARGET(OP_EXEC_CMD3);
+        VM_TARGET(OP_EXEC_CMD4);
+        VM_TARGET(OP_EXEC_CMD5);
+        VM_TARGET(OP_EXEC_CMD_COUNT1);
+        VM_TARGET(OP_EXEC_CMD_METHOD0);
+        VM_TARGET(OP_EXEC_CMD_METHOD1);
+        VM_TARGET(OP_EXEC_CMD_METHOD2);
+        VM_TARGET(OP_EXEC_CMD_METHOD3);
+        VM_TARGET(OP_EXEC_CMD_METHOD4);
+        VM_TARGET(OP_EXEC_CMD_METHOD5);
+        VM_TARGET(OP_EXEC_CMD_METHOD_COUNT1);
+        VM_TARGET(OP_EXEC_METHOD0);
+        VM_TARGET(OP_EXEC_METHOD1);
+        VM_TARGET(OP_EXEC_METHOD2);
+        VM_TARGET(OP_EXEC_METHOD3);
+        VM_TARGET(OP_EXEC_METHOD4);
+        VM_TARGET(OP_EXEC_METHOD5);
+        VM_TARGET(OP_EXEC_METHOD_COUNT1);
+        VM_TARGET(OP_FUNC);
+        VM_TARGET(OP_JUMP4);
+        VM_TARGET(OP_JUMP_BACK4);
+        VM_TARGET(OP_LOAD_ARRAY_VAR);
+        VM_TARGET(OP_LOAD_FIELD_VAR);
+        VM_TARGET(OP_LOAD_CONST_ARRAY1);
+        VM_TARGET(OP_LOAD_GAME_VAR);
+        VM_TARGET(OP_LOAD_GROUP_VAR);
+        VM_TARGET(OP_LOAD_LEVEL_VAR);
+        VM_TARGET(OP_LOAD_LOCAL_VAR);
+        VM_TARGET(OP_LOAD_OWNER_VAR);
+        VM_TARGET(OP_LOAD_PARM_VAR);
+        VM_TARGET(OP_LOAD_SELF_VAR);
+        VM_TARGET(OP_LOAD_STORE_GAME_VAR);
+        VM_TARGET(OP_LOAD_STORE_GROUP_VAR);
+        VM_TARGET(OP_LOAD_STORE_LEVEL_VAR);
+        VM_TARGET(OP_LOAD_STORE_LOCAL_VAR);
+        VM_TARGET(OP_LOAD_STORE_OWNER_VAR);
+        VM_TARGET(OP_LOAD_STORE_PARM_VAR);
+        VM_TARGET(OP_LOAD_STORE_SELF_VAR);
+        VM_TARGET(OP_MARK_STACK_POS);
+        VM_TARGET(OP_STORE_PARAM);
+        VM_TARGET(OP_RESTORE_STACK_POS);
+        VM_TARGET(OP_STORE_ARRAY);
+        VM_TARGET(OP_STORE_ARRAY_REF);
+        VM_TARGET(OP_STORE_FIELD_REF);
+        VM_TARGET(OP_STORE_FIELD);
+        VM_TARGET(OP_STORE_FLOAT);
+        VM_TARGET(OP_STORE_INT0);
+        VM_TARGET(OP_STORE_INT1);
+        VM_TARGET(OP_STORE_INT2);
+        VM_TARGET(OP_STORE_INT3);
+        VM_TARGET(OP_STORE_INT4);
+        VM_TARGET(OP_STORE_GAME_VAR);
+        VM_TARGET(OP_STORE_GROUP_VAR);
+        VM_TARGET(OP_STORE_LEVEL_VAR);
+        VM_TARGET(OP_STORE_LOCAL_VAR);
+        VM_TARGET(OP_STORE_OWNER_VAR);
+        VM_TARGET(OP_STORE_PARM_VAR);
+        VM_TARGET(OP_STORE_SELF_VAR);
+        VM_TARGET(OP_STORE_GAME);
+        VM_TARGET(OP_STORE_GROUP);
+        VM_TARGET(OP_STORE_LEVEL);
+        VM_TARGET(OP_STORE_LOCAL);
+        VM_TARGET(OP_STORE_OWNER);
+        VM_TARGET(OP_STORE_PARM);
+        VM_TARGET(OP_STORE_SELF);
+        VM_TARGET(OP_STORE_NIL);
+        VM_TARGET(OP_STORE_NULL);
+        VM_TARGET(OP_STORE_STRING);
+        VM_TARGET(OP_STORE_VECTOR);
+        VM_TARGET(OP_SWITCH);
+        VM_TARGET(OP_UN_CAST_BOOLEAN);
+        VM_TARGET(OP_UN_COMPLEMENT);
+        VM_TARGET(OP_UN_MINUS);
+        VM_TARGET(OP_UN_DEC);
+        VM_TARGET(OP_UN_INC);
+        VM_TARGET(OP_UN_SIZE);
+        VM_TARGET(OP_UN_TARGETNAME);
+        VM_TARGET(OP_VAR_UN_NOT);
+        VM_TARGET(OP_DONE);
+        VM_TARGET(OP_NOP);
     }
+#endif
 
-    Director.stackCount++;
+    while (state == STATE_RUNNING) {
+        try {
+            do {
+                if (!bThreaded && g_scripttrace->integer && CanScriptTracePrint()) {
+                    switch (g_scripttrace->integer) {
+                    case 1:
+                    case 3:
+                        ScriptTrace1();
+                        break;
+                    case 2:
+                    case 4:
+                        ScriptTrace2();
+                        break;
+                    }
+                }
 
-    if (dataSize) {
-        SetFastData(data, dataSize);
-    }
+                m_PrevCodePos = m_CodePos;
 
-    state = STATE_RUNNING;
+                opcode = m_CodePos++;
+                switch (*opcode) {
+                VM_CASE(OP_BIN_BITWISE_AND)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-    while (state == STATE_RUNNING) {
-        if (g_scripttrace->integer && CanScriptTracePrint()) {
-            switch (g_scripttrace->integer) {
-            case 1:
-            case 3:
-                ScriptTrace1();
-                break;
-            case 2:
-            case 4:
-                ScriptTrace2();
-                break;
-            }
-        }
+                    *b &= *a;
+                    VM_NEXT();
 
-        m_PrevCodePos = m_CodePos;
+                VM_CASE(OP_BIN_BITWISE_OR)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-        try {
-            if (!m_VMStack.m_bMarkStack) {
-                /*
-				assert(pTop >= localStack && pTop < localStack + localStackSize);
-				if (pTop < localStack)
-				{
-					deleteThread = true;
-					state = STATE_EXECUTION;
-
-					error("VM stack error. Negative stack value %d.\n", pTop - localStack);
-					break;
-				}
-				else if (pTop >= localStack + localStackSize)
-				{
-					deleteThread = true;
-					state = STATE_EXECUTION;
-
-					error("VM stack error. Exceeded the maximum stack size %d.\n", localStackSize);
-					break;
-				}
-				*/
-            }
+                    *b |= *a;
+                    VM_NEXT();
 
-            opcode = m_CodePos++;
-            switch (*opcode) {
-            case OP_BIN_BITWISE_AND:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_BITWISE_EXCL_OR)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                *b &= *a;
-                break;
+                    *b ^= *a;
+                    VM_NEXT();
 
-            case OP_BIN_BITWISE_OR:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_EQUALITY)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                *b |= *a;
-                break;
+                    b->setIntValue(*b == *a);
+                    VM_NEXT();
 
-            case OP_BIN_BITWISE_EXCL_OR:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_INEQUALITY)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                *b ^= *a;
-                break;
+                    b->setIntValue(*b != *a);
+                    VM_NEXT();
 
-            case OP_BIN_EQUALITY:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_GREATER_THAN)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                b->setIntValue(*b == *a);
-                break;
+                    b->greaterthan(*a);
+                    VM_NEXT();
 
-            case OP_BIN_INEQUALITY:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_GREATER_THAN_OR_EQUAL)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                b->setIntValue(*b != *a);
-                break;
+                    b->greaterthanorequal(*a);
+                    VM_NEXT();
 
-            case OP_BIN_GREATER_THAN:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_LESS_THAN)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                b->greaterthan(*a);
-                break;
+                    b->lessthan(*a);
+                    VM_NEXT();
 
-            case OP_BIN_GREATER_THAN_OR_EQUAL:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_LESS_THAN_OR_EQUAL)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                b->greaterthanorequal(*a);
-                break;
+                    b->lessthanorequal(*a);
+                    VM_NEXT();
 
-            case OP_BIN_LESS_THAN:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_PLUS)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                b->lessthan(*a);
-                break;
+                    *b += *a;
+                    VM_NEXT();
 
-            case OP_BIN_LESS_THAN_OR_EQUAL:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_MINUS)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                b->lessthanorequal(*a);
-                break;
+                    *b -= *a;
+                    VM_NEXT();
 
-            case OP_BIN_PLUS:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_MULTIPLY)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                *b += *a;
-                break;
+                    *b *= *a;
+                    VM_NEXT();
 
-            case OP_BIN_MINUS:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_DIVIDE)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                *b -= *a;
-                break;
+                    *b /= *a;
+                    VM_NEXT();
 
-            case OP_BIN_MULTIPLY:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_PERCENTAGE)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                *b *= *a;
-                break;
+                    *b %= *a;
+                    VM_NEXT();
 
-            case OP_BIN_DIVIDE:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_SHIFT_LEFT)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                *b /= *a;
-                break;
+                    *b <<= *a;
+                    VM_NEXT();
 
-            case OP_BIN_PERCENTAGE:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BIN_SHIFT_RIGHT)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.GetTop();
 
-                *b %= *a;
-                break;
+                    *b >>= *a;
+                    VM_NEXT();
 
-            case OP_BIN_SHIFT_LEFT:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_BOOL_JUMP_FALSE4)
+                    doJumpIf(!m_VMStack.Pop().m_data.intValue);
+                    VM_NEXT();
 
-                *b <<= *a;
-                break;
+                VM_CASE(OP_BOOL_JUMP_TRUE4)
+                    doJumpIf(m_VMStack.Pop().m_data.intValue);
+                    VM_NEXT();
 
-            case OP_BIN_SHIFT_RIGHT:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.GetTop();
+                VM_CASE(OP_VAR_JUMP_FALSE4)
+                    doJumpIf(!m_VMStack.Pop().booleanValue());
+                    VM_NEXT();
 
-                *b >>= *a;
-                break;
+                VM_CASE(OP_VAR_JUMP_TRUE4)
+                    doJumpIf(m_VMStack.Pop().booleanValue());
+                    VM_NEXT();
 
-            case OP_BOOL_JUMP_FALSE4:
-                doJumpIf(!m_VMStack.Pop().m_data.intValue);
-                break;
+                // Added in OPM
+                //  comparisons fused with OP_VAR_JUMP_FALSE4 by the compiler
+                VM_CASE(OP_BIN_EQUALITY_JUMP_FALSE4)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.Pop();
 
-            case OP_BOOL_JUMP_TRUE4:
-                doJumpIf(m_VMStack.Pop().m_data.intValue);
-                break;
+                    doJumpIf(!(*b == *a));
+                    VM_NEXT();
 
-            case OP_VAR_JUMP_FALSE4:
-                doJumpIf(!m_VMStack.Pop().booleanValue());
-                break;
+                VM_CASE(OP_BIN_INEQUALITY_JUMP_FALSE4)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.Pop();
 
-            case OP_VAR_JUMP_TRUE4:
-                doJumpIf(m_VMStack.Pop().booleanValue());
-                break;
+                    doJumpIf(!(*b != *a));
+                    VM_NEXT();
 
-            case OP_BOOL_LOGICAL_AND:
-                doJumpVarIf(!m_VMStack.GetTop().m_data.intValue);
-                break;
+                VM_CASE(OP_BIN_LESS_THAN_JUMP_FALSE4)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.Pop();
 
-            case OP_BOOL_LOGICAL_OR:
-                doJumpVarIf(m_VMStack.GetTop().m_data.intValue);
-                break;
+                    try {
+                        b->lessthan(*a);
+                    } catch (...) {
+                        doJumpIf(!b->booleanValue());
+                        throw;
+                    }
 
-            case OP_VAR_LOGICAL_AND:
-                if (!doJumpVarIf(m_VMStack.GetTop().booleanValue())) {
-                    m_VMStack.GetTop().SetFalse();
-                }
-                break;
+                    doJumpIf(!b->booleanValue());
+                    VM_NEXT();
 
-            case OP_VAR_LOGICAL_OR:
-                if (!doJumpVarIf(!m_VMStack.GetTop().booleanValue())) {
-                    m_VMStack.GetTop().SetTrue();
-                }
-                break;
+                VM_CASE(OP_BIN_GREATER_THAN_JUMP_FALSE4)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.Pop();
 
-            case OP_BOOL_STORE_FALSE:
-                m_VMStack.PushAndGet().SetFalse();
-                break;
+                    try {
+                        b->greaterthan(*a);
+                    } catch (...) {
+                        doJumpIf(!b->booleanValue());
+                        throw;
+                    }
 
-            case OP_BOOL_STORE_TRUE:
-                m_VMStack.PushAndGet().SetTrue();
-                break;
+                    doJumpIf(!b->booleanValue());
+                    VM_NEXT();
 
-            case OP_BOOL_UN_NOT:
-                m_VMStack.GetTop().m_data.intValue = (m_VMStack.GetTop().m_data.intValue == 0);
-                break;
+                VM_CASE(OP_BIN_LESS_THAN_OR_EQUAL_JUMP_FALSE4)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.Pop();
 
-            case OP_CALC_VECTOR:
-                c = &m_VMStack.Pop();
-                b = &m_VMStack.Pop();
-                a = &m_VMStack.GetTop();
+                    try {
+                        b->lessthanorequal(*a);
+                    } catch (...) {
+                        doJumpIf(!b->booleanValue());
+                        throw;
+                    }
 
-                m_VMStack.GetTop().setVectorValue(Vector(a->floatValue(), b->floatValue(), c->floatValue()));
-                break;
+                    doJumpIf(!b->booleanValue());
+                    VM_NEXT();
 
-            case OP_EXEC_CMD0:
-                {
-                    execCmdCommon(0);
-                    break;
-                }
+                VM_CASE(OP_BIN_GREATER_THAN_OR_EQUAL_JUMP_FALSE4)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.Pop();
 
-            case OP_EXEC_CMD1:
-                {
-                    execCmdCommon(1);
-                    break;
-                }
+                    try {
+                        b->greaterthanorequal(*a);
+                    } catch (...) {
+                        doJumpIf(!b->booleanValue());
+                        throw;
+                    }
 
-            case OP_EXEC_CMD2:
-                {
-                    execCmdCommon(2);
-                    break;
-                }
+                    doJumpIf(!b->booleanValue());
+                    VM_NEXT();
 
-            case OP_EXEC_CMD3:
-                {
-                    execCmdCommon(3);
-                    break;
-                }
+                VM_CASE(OP_BOOL_LOGICAL_AND)
+                    doJumpVarIf(!m_VMStack.GetTop().m_data.intValue);
+                    VM_NEXT();
 
-            case OP_EXEC_CMD4:
-                {
-                    execCmdCommon(4);
-                    break;
-                }
+                VM_CASE(OP_BOOL_LOGICAL_OR)
+                    doJumpVarIf(m_VMStack.GetTop().m_data.intValue);
+                    VM_NEXT();
 
-            case OP_EXEC_CMD5:
-                {
-                    execCmdCommon(5);
-                    break;
-                }
+                VM_CASE(OP_VAR_LOGICAL_AND)
+                    if (!doJumpVarIf(m_VMStack.GetTop().booleanValue())) {
+                        m_VMStack.GetTop().SetFalse();
+                    }
+                    VM_NEXT();
 
-            case OP_EXEC_CMD_COUNT1:
-                {
-                    const op_parmNum_t numParms = fetchOpcodeValue<op_parmNum_t>();
-                    execCmdCommon(numParms);
-                    break;
-                }
+                VM_CASE(OP_VAR_LOGICAL_OR)
+                    if (!doJumpVarIf(!m_VMStack.GetTop().booleanValue())) {
+                        m_VMStack.GetTop().SetTrue();
+                    }
+                    VM_NEXT();
 
-            case OP_EXEC_CMD_METHOD0:
-                {
-                    execCmdMethodCommon(0);
-                    break;
-                }
+                VM_CASE(OP_BOOL_STORE_FALSE)
+                    m_VMStack.PushAndGet().SetFalse();
+                    VM_NEXT();
 
-            case OP_EXEC_CMD_METHOD1:
-                {
-                    execCmdMethodCommon(1);
-                    break;
-                }
+                VM_CASE(OP_BOOL_STORE_TRUE)
+                    m_VMStack.PushAndGet().SetTrue();
+                    VM_NEXT();
 
-            case OP_EXEC_CMD_METHOD2:
-                {
-                    execCmdMethodCommon(2);
-                    break;
-                }
+                VM_CASE(OP_BOOL_UN_NOT)
+                    m_VMStack.GetTop().m_data.intValue = (m_VMStack.GetTop().m_data.intValue == 0);
+                    VM_NEXT();
 
-            case OP_EXEC_CMD_METHOD3:
-                {
-                    execCmdMethodCommon(3);
-                    break;
-                }
+                VM_CASE(OP_CALC_VECTOR)
+                    c = &m_VMStack.Pop();
+                    b = &m_VMStack.Pop();
+                    a = &m_VMStack.GetTop();
 
-            case OP_EXEC_CMD_METHOD4:
-                {
-                    execCmdMethodCommon(4);
-                    break;
-                }
+                    m_VMStack.GetTop().setVectorValue(Vector(a->floatValue(), b->floatValue(), c->floatValue()));
+                    VM_NEXT();
 
-            case OP_EXEC_CMD_METHOD5:
-                {
-                    execCmdMethodCommon(5);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD0)
+                    {
+                        execCmdCommon(0);
+                        VM_NEXT();
+                    }
 
-            case OP_EXEC_CMD_METHOD_COUNT1:
-                {
-                    const op_parmNum_t numParms = fetchOpcodeValue<op_parmNum_t>();
-                    execCmdMethodCommon(numParms);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD1)
+                    {
+                        execCmdCommon(1);
+                        VM_NEXT();
+                    }
 
-            case OP_EXEC_METHOD0:
-                {
-                    execMethodCommon(0);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD2)
+                    {
+                        execCmdCommon(2);
+                        VM_NEXT();
+                    }
 
-            case OP_EXEC_METHOD1:
-                {
-                    execMethodCommon(1);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD3)
+                    {
+                        execCmdCommon(3);
+                        VM_NEXT();
+                    }
 
-            case OP_EXEC_METHOD2:
-                {
-                    execMethodCommon(2);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD4)
+                    {
+                        execCmdCommon(4);
+                        VM_NEXT();
+                    }
 
-            case OP_EXEC_METHOD3:
-                {
-                    execMethodCommon(3);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD5)
+                    {
+                        execCmdCommon(5);
+                        VM_NEXT();
+                    }
 
-            case OP_EXEC_METHOD4:
-                {
-                    execMethodCommon(4);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD_COUNT1)
+                    {
+                        const op_parmNum_t numParms = fetchOpcodeValue<op_parmNum_t>();
+                        execCmdCommon(numParms);
+                        VM_NEXT();
+                    }
 
-            case OP_EXEC_METHOD5:
-                {
-                    execMethodCommon(5);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD_METHOD0)
+                    {
+                        execCmdMethodCommon(0);
+                        VM_NEXT();
+                    }
 
-            case OP_EXEC_METHOD_COUNT1:
-                {
-                    const op_parmNum_t numParms = fetchOpcodeValue<op_parmNum_t>();
-                    execMethodCommon(numParms);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD_METHOD1)
+                    {
+                        execCmdMethodCommon(1);
+                        VM_NEXT();
+                    }
 
-            case OP_FUNC:
-                {
-                    execFunction(Director);
-                    break;
-                }
+                VM_CASE(OP_EXEC_CMD_METHOD2)
+                    {
+                        execCmdMethodCommon(2);
+                        VM_NEXT();
+                    }
+
+                VM_CASE(OP_EXEC_CMD_METHOD3)
+                    {
+                        execCmdMethodCommon(3);
+                        VM_NEXT();
+                    }
+
+                VM_CASE(OP_EXEC_CMD_METHOD4)
+                    {
+                        execCmdMethodCommon(4);
+                        VM_NEXT();
+                    }
 
-            case OP_JUMP4:
-                jump(fetchOpcodeValue<unsigned int>());
-                break;
+                VM_CASE(OP_EXEC_CMD_METHOD5)
+                    {
+                        execCmdMethodCommon(5);
+                        VM_NEXT();
+                    }
 
-            case OP_JUMP_BACK4:
-                jumpBack(fetchActualOpcodeValue<unsigned int>());
-                break;
+                VM_CASE(OP_EXEC_CMD_METHOD_COUNT1)
+                    {
+                        const op_parmNum_t numParms = fetchOpcodeValue<op_parmNum_t>();
+                        execCmdMethodCommon(numParms);
+                        VM_NEXT();
+                    }
 
-            case OP_LOAD_ARRAY_VAR:
-                a = &m_VMStack.Pop();
-                b = &m_VMStack.Pop();
-                c = &m_VMStack.Pop();
+                VM_CASE(OP_EXEC_METHOD0)
+                    {
+                        execMethodCommon(0);
+                        VM_NEXT();
+                    }
 
-                b->setArrayAt(*a, *c);
-                break;
+                VM_CASE(OP_EXEC_METHOD1)
+                    {
+                        execMethodCommon(1);
+                        VM_NEXT();
+                    }
 
-            case OP_LOAD_FIELD_VAR:
-                a = &m_VMStack.Pop();
+                VM_CASE(OP_EXEC_METHOD2)
+                    {
+                        execMethodCommon(2);
+                        VM_NEXT();
+                    }
 
-                try {
-                    try {
-                        listener = a->listenerValue();
+                VM_CASE(OP_EXEC_METHOD3)
+                    {
+                        execMethodCommon(3);
+                        VM_NEXT();
+                    }
 
-                        if (listener == NULL) {
-                            fieldNameIndex = fetchActualOpcodeValue<op_name_t>();
-                            ScriptError(
-                                "Field '%s' applied to NULL listener", Director.GetString(fieldNameIndex).c_str()
-                            );
+                VM_CASE(OP_EXEC_METHOD4)
+                    {
+                        execMethodCommon(4);
+                        VM_NEXT();
+                    }
+
+                VM_CASE(OP_EXEC_METHOD5)
+                    {
+                        execMethodCommon(5);
+                        VM_NEXT();
+                    }
+
+                VM_CASE(OP_EXEC_METHOD_COUNT1)
+                    {
+                        const op_parmNum_t numParms = fetchOpcodeValue<op_parmNum_t>();
+                        execMethodCommon(numParms);
+                        VM_NEXT();
+                    }
+
+                VM_CASE(OP_FUNC)
+                    {
+                        execFunction(Director);
+                        VM_NEXT();
+                    }
+
+                VM_CASE(OP_JUMP4)
+                    jump(fetchOpcodeValue<unsigned int>());
+                    VM_NEXT();
+
+                VM_CASE(OP_JUMP_BACK4)
+                    jumpBack(fetchActualOpcodeValue<unsigned int>());
+                    VM_NEXT();
+
+                VM_CASE(OP_LOAD_ARRAY_VAR)
+                    a = &m_VMStack.Pop();
+                    b = &m_VMStack.Pop();
+                    c = &m_VMStack.Pop();
+
+                    b->setArrayAt(*a, *c);
+                    VM_NEXT();
+
+                VM_CASE(OP_LOAD_FIELD_VAR)
+                    a = &m_VMStack.Pop();
+
+                    try {
+                        try {
+                            listener = a->listenerValue();
+
+                            if (listener == NULL) {
+                                fieldNameIndex = fetchActualOpcodeValue<op_name_t>();
+                                ScriptError(
+                                    "Field '%s' applied to NULL listener", Director.GetString(fieldNameIndex).c_str()
+                                );
+                            }
+                        } catch (...) {
+                            skipField();
+                            throw;
                         }
+
+                        loadTop(listener);
                     } catch (...) {
-                        skipField();
+                        m_VMStack.Pop();
                         throw;
                     }
 
-                    loadTop(listener);
-                } catch (...) {
-                    m_VMStack.Pop();
-                    throw;
-                }
+                    VM_NEXT();
 
-                break;
+                VM_CASE(OP_LOAD_CONST_ARRAY1)
+                    {
+                        op_arrayParmNum_t numParms = fetchOpcodeValue<op_arrayParmNum_t>();
 
-            case OP_LOAD_CONST_ARRAY1:
-                {
-                    op_arrayParmNum_t numParms = fetchOpcodeValue<op_arrayParmNum_t>();
+                        ScriptVariable& pTop = m_VMStack.PopAndGet(numParms - 1);
+                        pTop.setConstArrayValue(&pTop, numParms);
+                        VM_NEXT();
+                    }
 
-                    ScriptVariable& pTop = m_VMStack.PopAndGet(numParms - 1);
-                    pTop.setConstArrayValue(&pTop, numParms);
-                    break;
-                }
+                VM_CASE(OP_LOAD_GAME_VAR)
+                    loadTop(&game);
+                    VM_NEXT();
 
-            case OP_LOAD_GAME_VAR:
-                loadTop(&game);
-                break;
+                VM_CASE(OP_LOAD_GROUP_VAR)
+                    loadTop(m_ScriptClass);
+                    VM_NEXT();
 
-            case OP_LOAD_GROUP_VAR:
-                loadTop(m_ScriptClass);
-                break;
+                VM_CASE(OP_LOAD_LEVEL_VAR)
+                    loadTop(&level);
+                    VM_NEXT();
 
-            case OP_LOAD_LEVEL_VAR:
-                loadTop(&level);
-                break;
+                VM_CASE(OP_LOAD_LOCAL_VAR)
+                    loadTop(m_Thread);
+                    VM_NEXT();
 
-            case OP_LOAD_LOCAL_VAR:
-                loadTop(m_Thread);
-                break;
+                VM_CASE(OP_LOAD_OWNER_VAR)
+                    if (!m_ScriptClass->m_Self) {
+                        m_VMStack.Pop();
+                        m_CodePos += sizeof(unsigned int);
+                        ScriptError("self is NULL");
+                    }
 
-            case OP_LOAD_OWNER_VAR:
-                if (!m_ScriptClass->m_Self) {
-                    m_VMStack.Pop();
-                    m_CodePos += sizeof(unsigned int);
-                    ScriptError("self is NULL");
-                }
+                    if (!m_ScriptClass->m_Self->GetScriptOwner()) {
+                        m_VMStack.Pop();
+                        m_CodePos += sizeof(unsigned int);
+                        ScriptError("self.owner is NULL");
+                    }
 
-                if (!m_ScriptClass->m_Self->GetScriptOwner()) {
-                    m_VMStack.Pop();
-                    m_CodePos += sizeof(unsigned int);
-                    ScriptError("self.owner is NULL");
-                }
+                    loadTop(m_ScriptClass->m_Self->GetScriptOwner());
+                    VM_NEXT();
 
-                loadTop(m_ScriptClass->m_Self->GetScriptOwner());
-                break;
+                VM_CASE(OP_LOAD_PARM_VAR)
+                    loadTop(&parm);
+                    VM_NEXT();
 
-            case OP_LOAD_PARM_VAR:
-                loadTop(&parm);
-                break;
+                VM_CASE(OP_LOAD_SELF_VAR)
+                    if (!m_ScriptClass->m_Self) {
+                        m_VMStack.Pop();
+                        m_CodePos += sizeof(unsigned int);
+                        ScriptError("self is NULL");
+                    }
 
-            case OP_LOAD_SELF_VAR:
-                if (!m_ScriptClass->m_Self) {
-                    m_VMStack.Pop();
-                    m_CodePos += sizeof(unsigned int);
-                    ScriptError("self is NULL");
-                }
+                    loadTop(m_ScriptClass->m_Self);
+                    VM_NEXT();
 
-                loadTop(m_ScriptClass->m_Self);
-                break;
+                VM_CASE(OP_LOAD_STORE_GAME_VAR)
+                    loadStoreTop(&game);
+                    VM_NEXT();
 
-            case OP_LOAD_STORE_GAME_VAR:
-                loadStoreTop(&game);
-                break;
+                VM_CASE(OP_LOAD_STORE_GROUP_VAR)
+                    loadStoreTop(m_ScriptClass);
+                    VM_NEXT();
 
-            case OP_LOAD_STORE_GROUP_VAR:
-                loadStoreTop(m_ScriptClass);
-                break;
+                VM_CASE(OP_LOAD_STORE_LEVEL_VAR)
+                    loadStoreTop(&level);
+                    VM_NEXT();
 
-            case OP_LOAD_STORE_LEVEL_VAR:
-                loadStoreTop(&level);
-                break;
+                VM_CASE(OP_LOAD_STORE_LOCAL_VAR)
+                    loadStoreTop(m_Thread);
+                    VM_NEXT();
 
-            case OP_LOAD_STORE_LOCAL_VAR:
-                loadStoreTop(m_Thread);
-                break;
+                VM_CASE(OP_LOAD_STORE_OWNER_VAR)
+                    if (!m_ScriptClass->m_Self) {
+                        m_CodePos += sizeof(unsigned int);
+                        ScriptError("self is NULL");
+                    }
 
-            case OP_LOAD_STORE_OWNER_VAR:
-                if (!m_ScriptClass->m_Self) {
-                    m_CodePos += sizeof(unsigned int);
-                    ScriptError("self is NULL");
-                }
+                    if (!m_ScriptClass->m_Self->GetScriptOwner()) {
+                        m_CodePos += sizeof(unsigned int);
+                        ScriptError("self.owner is NULL");
+                    }
 
-                if (!m_ScriptClass->m_Self->GetScriptOwner()) {
-                    m_CodePos += sizeof(unsigned int);
-                    ScriptError("self.owner is NULL");
-                }
+                    loadStoreTop(m_ScriptClass->m_Self->GetScriptOwner());
+                    VM_NEXT();
+
+                VM_CASE(OP_LOAD_STORE_PARM_VAR)
+                    loadStoreTop(&parm);
+                    VM_NEXT();
 
-                loadStoreTop(m_ScriptClass->m_Self->GetScriptOwner());
-                break;
+                VM_CASE(OP_LOAD_STORE_SELF_VAR)
+                    if (!m_ScriptClass->m_Self) {
+                        m_CodePos += sizeof(unsigned int);
+                        ScriptError("self is NULL");
+                    }
 
-            case OP_LOAD_STORE_PARM_VAR:
-                loadStoreTop(&parm);
-                break;
+                    loadStoreTop(m_ScriptClass->m_Self);
+                    VM_NEXT();
 
-            case OP_LOAD_STORE_SELF_VAR:
-                if (!m_ScriptClass->m_Self) {
-                    m_CodePos += sizeof(unsigned int);
-                    ScriptError("self is NULL");
-                }
+                VM_CASE(OP_MARK_STACK_POS)
+                    m_StackPos   = &m_VMStack.GetTop();
+                    m_VMStack.m_bMarkStack = true;
+                    VM_NEXT();
 
-                loadStoreTop(m_ScriptClass->m_Self);
-                break;
+                VM_CASE(OP_STORE_PARAM)
+                    if (fastEvent.dataSize) {
+                        m_VMStack.SetTop(*(fastEvent.data++));
+                        fastEvent.dataSize--;
+                    } else {
+                        m_VMStack.SetTop(*(m_StackPos + 1));
+                        m_VMStack.GetTop().Clear();
+                    }
+                    VM_NEXT();
 
-            case OP_MARK_STACK_POS:
-                m_StackPos   = &m_VMStack.GetTop();
-                m_VMStack.m_bMarkStack = true;
-                break;
+                VM_CASE(OP_RESTORE_STACK_POS)
+                    m_VMStack.SetTop(*m_StackPos);
+                    m_VMStack.m_bMarkStack = false;
+                    VM_NEXT();
 
-            case OP_STORE_PARAM:
-                if (fastEvent.dataSize) {
-                    m_VMStack.SetTop(*(fastEvent.data++));
-                    fastEvent.dataSize--;
-                } else {
-                    m_VMStack.SetTop(*(m_StackPos + 1));
-                    m_VMStack.GetTop().Clear();
-                }
-                break;
+                VM_CASE(OP_STORE_ARRAY)
+                    m_VMStack.Pop();
+                    m_VMStack.GetTop().evalArrayAt(*(m_VMStack.GetTopPtr() + 1));
+                    VM_NEXT();
 
-            case OP_RESTORE_STACK_POS:
-                m_VMStack.SetTop(*m_StackPos);
-                m_VMStack.m_bMarkStack = false;
-                break;
+                VM_CASE(OP_STORE_ARRAY_REF)
+                    m_VMStack.Pop();
+                    m_VMStack.GetTop().setArrayRefValue(*(m_VMStack.GetTopPtr() + 1));
+                    VM_NEXT();
 
-            case OP_STORE_ARRAY:
-                m_VMStack.Pop();
-                m_VMStack.GetTop().evalArrayAt(*(m_VMStack.GetTopPtr() + 1));
-                break;
+                VM_CASE(OP_STORE_FIELD_REF)
+                    try {
+                        try {
+                            listener = m_VMStack.GetTop().listenerValue();
+
+                            if (listener == nullptr) {
+                                fieldNameIndex = fetchActualOpcodeValue<op_name_t>();
+                                ScriptError(
+                                    "Field '%s' applied to NULL listener", Director.GetString(fieldNameIndex).c_str()
+                                );
+                            }
+                        } catch (...) {
+                            skipField();
+                            m_VMStack.GetTop().Clear();
+                            throw;
+                        }
 
-            case OP_STORE_ARRAY_REF:
-                m_VMStack.Pop();
-                m_VMStack.GetTop().setArrayRefValue(*(m_VMStack.GetTopPtr() + 1));
-                break;
+                        ScriptVariable *const listenerVar = storeTop<true>(listener);
 
-            case OP_STORE_FIELD_REF:
-                try {
+                        if (listenerVar) {
+                            // having a listener variable means the variable was just created
+                            m_VMStack.GetTop().setRefValue(listenerVar);
+                        }
+                    } catch (...) {
+                        ScriptVariable *const pTop = m_VMStack.GetTopPtr();
+                        pTop->setRefValue(pTop);
+                        throw;
+                    }
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_FIELD)
                     try {
                         listener = m_VMStack.GetTop().listenerValue();
 
                         if (listener == nullptr) {
                             fieldNameIndex = fetchActualOpcodeValue<op_name_t>();
-                            ScriptError(
-                                "Field '%s' applied to NULL listener", Director.GetString(fieldNameIndex).c_str()
-                            );
+                            ScriptError("Field '%s' applied to NULL listener", Director.GetString(fieldNameIndex).c_str());
                         }
                     } catch (...) {
                         skipField();
@@ -1588,297 +1972,288 @@ void ScriptVM::Execute(ScriptVariable *data, int dataSize, str label)
                         throw;
                     }
 
-                    ScriptVariable *const listenerVar = storeTop<true>(listener);
+                    storeTop<true>(listener);
+                    VM_NEXT();
 
-                    if (listenerVar) {
-                        // having a listener variable means the variable was just created
-                        m_VMStack.GetTop().setRefValue(listenerVar);
-                    }
-                    break;
-                } catch (...) {
-                    ScriptVariable *const pTop = m_VMStack.GetTopPtr();
-                    pTop->setRefValue(pTop);
-                    throw;
-                }
+                VM_CASE(OP_STORE_FLOAT)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setFloatValue(fetchOpcodeValue<float>());
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_INT0)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setIntValue(0);
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_INT1)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setIntValue(fetchOpcodeValue<byte>());
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_INT2)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setIntValue(fetchOpcodeValue<short>());
+                    VM_NEXT();
 
-            case OP_STORE_FIELD:
-                try {
-                    listener = m_VMStack.GetTop().listenerValue();
+                VM_CASE(OP_STORE_INT3)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setIntValue(fetchOpcodeValue<short3>());
+                    VM_NEXT();
 
-                    if (listener == nullptr) {
-                        fieldNameIndex = fetchActualOpcodeValue<op_name_t>();
-                        ScriptError("Field '%s' applied to NULL listener", Director.GetString(fieldNameIndex).c_str());
+                VM_CASE(OP_STORE_INT4)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setIntValue(fetchOpcodeValue<int>());
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_GAME_VAR)
+                    storeTop(&game);
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_GROUP_VAR)
+                    storeTop(m_ScriptClass);
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_LEVEL_VAR)
+                    storeTop(&level);
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_LOCAL_VAR)
+                    storeTop(m_Thread);
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_OWNER_VAR)
+                    if (!m_ScriptClass->m_Self) {
+                        m_VMStack.PushAndGet().Clear();
+                        m_CodePos += sizeof(unsigned int);
+                        ScriptError("self is NULL");
                     }
-                } catch (...) {
-                    skipField();
-                    m_VMStack.GetTop().Clear();
-                    throw;
-                }
 
-                storeTop<true>(listener);
-                break;
-
-            case OP_STORE_FLOAT:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setFloatValue(fetchOpcodeValue<float>());
-                break;
-
-            case OP_STORE_INT0:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setIntValue(0);
-                break;
-
-            case OP_STORE_INT1:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setIntValue(fetchOpcodeValue<byte>());
-                break;
-
-            case OP_STORE_INT2:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setIntValue(fetchOpcodeValue<short>());
-                break;
-
-            case OP_STORE_INT3:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setIntValue(fetchOpcodeValue<short3>());
-                break;
-
-            case OP_STORE_INT4:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setIntValue(fetchOpcodeValue<int>());
-                break;
-
-            case OP_STORE_GAME_VAR:
-                storeTop(&game);
-                break;
-
-            case OP_STORE_GROUP_VAR:
-                storeTop(m_ScriptClass);
-                break;
-
-            case OP_STORE_LEVEL_VAR:
-                storeTop(&level);
-                break;
-
-            case OP_STORE_LOCAL_VAR:
-                storeTop(m_Thread);
-                break;
-
-            case OP_STORE_OWNER_VAR:
-                if (!m_ScriptClass->m_Self) {
-                    m_VMStack.PushAndGet().Clear();
-                    m_CodePos += sizeof(unsigned int);
-                    ScriptError("self is NULL");
-                }
+                    if (!m_ScriptClass->m_Self->GetScriptOwner()) {
+                        m_VMStack.PushAndGet().Clear();
+                        m_CodePos += sizeof(unsigned int);
+                        ScriptError("self.owner is NULL");
+                    }
 
-                if (!m_ScriptClass->m_Self->GetScriptOwner()) {
-                    m_VMStack.PushAndGet().Clear();
-                    m_CodePos += sizeof(unsigned int);
-                    ScriptError("self.owner is NULL");
-                }
+                    storeTop(m_ScriptClass->m_Self->GetScriptOwner());
+                    VM_NEXT();
 
-                storeTop(m_ScriptClass->m_Self->GetScriptOwner());
-                break;
+                VM_CASE(OP_STORE_PARM_VAR)
+                    storeTop(&parm);
+                    VM_NEXT();
 
-            case OP_STORE_PARM_VAR:
-                storeTop(&parm);
-                break;
+                VM_CASE(OP_STORE_SELF_VAR)
+                    if (!m_ScriptClass->m_Self) {
+                        m_VMStack.PushAndGet().Clear();
+                        m_CodePos += sizeof(unsigned int);
+                        ScriptError("self is NULL");
+                    }
 
-            case OP_STORE_SELF_VAR:
-                if (!m_ScriptClass->m_Self) {
-                    m_VMStack.PushAndGet().Clear();
-                    m_CodePos += sizeof(unsigned int);
-                    ScriptError("self is NULL");
-                }
+                    storeTop(m_ScriptClass->m_Self);
+                    VM_NEXT();
 
-                storeTop(m_ScriptClass->m_Self);
-                break;
+                VM_CASE(OP_STORE_GAME)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setListenerValue(&game);
+                    VM_NEXT();
 
-            case OP_STORE_GAME:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setListenerValue(&game);
-                break;
+                VM_CASE(OP_STORE_GROUP)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setListenerValue(m_ScriptClass);
+                    VM_NEXT();
 
-            case OP_STORE_GROUP:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setListenerValue(m_ScriptClass);
-                break;
+                VM_CASE(OP_STORE_LEVEL)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setListenerValue(&level);
+                    VM_NEXT();
 
-            case OP_STORE_LEVEL:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setListenerValue(&level);
-                break;
+                VM_CASE(OP_STORE_LOCAL)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setListenerValue(m_Thread);
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_OWNER)
+                    if (m_ScriptClass->m_Self) {
+                        m_VMStack.Push();
+                    } else {
+                        m_VMStack.PushAndGet().Clear();
+                        ScriptError("self is NULL");
+                    }
 
-            case OP_STORE_LOCAL:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setListenerValue(m_Thread);
-                break;
+                    m_VMStack.GetTop().setListenerValue(m_ScriptClass->m_Self->GetScriptOwner());
+                    VM_NEXT();
 
-            case OP_STORE_OWNER:
-                if (m_ScriptClass->m_Self) {
+                VM_CASE(OP_STORE_PARM)
                     m_VMStack.Push();
-                } else {
-                    m_VMStack.PushAndGet().Clear();
-                    ScriptError("self is NULL");
-                }
+                    m_VMStack.GetTop().setListenerValue(&parm);
+                    VM_NEXT();
 
-                m_VMStack.GetTop().setListenerValue(m_ScriptClass->m_Self->GetScriptOwner());
-                break;
-
-            case OP_STORE_PARM:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setListenerValue(&parm);
-                break;
-
-            case OP_STORE_SELF:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setListenerValue(m_ScriptClass->m_Self);
-                break;
-
-            case OP_STORE_NIL:
-                m_VMStack.Push();
-                m_VMStack.GetTop().Clear();
-                break;
-
-            case OP_STORE_NULL:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setListenerValue(NULL);
-                break;
-
-            case OP_STORE_STRING:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setConstStringValue(fetchOpcodeValue<unsigned int>());
-                break;
-
-            case OP_STORE_VECTOR:
-                m_VMStack.Push();
-                m_VMStack.GetTop().setVectorValue(fetchOpcodeValue<Vector>());
-                break;
-
-            case OP_SWITCH:
-                if (!Switch(fetchActualOpcodeValue<StateScript *>(), m_VMStack.Pop())) {
-                    m_CodePos += sizeof(StateScript *);
-                }
-                break;
-
-            case OP_UN_CAST_BOOLEAN:
-                m_VMStack.GetTop().CastBoolean();
-                break;
-
-            case OP_UN_COMPLEMENT:
-                m_VMStack.GetTop().complement();
-                break;
-
-            case OP_UN_MINUS:
-                m_VMStack.GetTop().minus();
-                break;
-
-            case OP_UN_DEC:
-                m_VMStack.GetTop()--;
-                break;
-
-            case OP_UN_INC:
-                m_VMStack.GetTop()++;
-                break;
-
-            case OP_UN_SIZE:
-                m_VMStack.GetTop().setIntValue((int)m_VMStack.GetTop().size());
-                break;
-
-            case OP_UN_TARGETNAME:
-                // retrieve the target name
-                if (world) {
-                    targetList = world->GetExistingTargetList(m_VMStack.GetTop().stringValue());
-                } else {
-                    // Added in OPM
-                    //  don't use the target list if the world is NULL
-                    targetList = NULL;
-                }
+                VM_CASE(OP_STORE_SELF)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setListenerValue(m_ScriptClass->m_Self);
+                    VM_NEXT();
 
-                if (!targetList || !targetList->list.NumObjects()) {
-                    str targetname = m_VMStack.GetTop().stringValue();
-                    // the target name was not found
+                VM_CASE(OP_STORE_NIL)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().Clear();
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_NULL)
+                    m_VMStack.Push();
                     m_VMStack.GetTop().setListenerValue(NULL);
+                    VM_NEXT();
+
+                VM_CASE(OP_STORE_STRING)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setConstStringValue(fetchOpcodeValue<unsigned int>());
+                    VM_NEXT();
 
-                    if ((*m_PrevCodePos >= OP_BIN_EQUALITY && *m_PrevCodePos <= OP_BIN_GREATER_THAN_OR_EQUAL)
-                        || (*m_PrevCodePos >= OP_BOOL_UN_NOT && *m_PrevCodePos <= OP_UN_CAST_BOOLEAN)) {
-                        ScriptError("Targetname '%s' does not exist.", targetname.c_str());
+                VM_CASE(OP_STORE_VECTOR)
+                    m_VMStack.Push();
+                    m_VMStack.GetTop().setVectorValue(fetchOpcodeValue<Vector>());
+                    VM_NEXT();
+
+                VM_CASE(OP_SWITCH)
+                    if (!Switch(fetchActualOpcodeValue<StateScript *>(), m_VMStack.Pop())) {
+                        m_CodePos += sizeof(StateScript *);
+                    }
+                    VM_NEXT();
+
+                VM_CASE(OP_UN_CAST_BOOLEAN)
+                    m_VMStack.GetTop().CastBoolean();
+                    VM_NEXT();
+
+                VM_CASE(OP_UN_COMPLEMENT)
+                    m_VMStack.GetTop().complement();
+                    VM_NEXT();
+
+                VM_CASE(OP_UN_MINUS)
+                    m_VMStack.GetTop().minus();
+                    VM_NEXT();
+
+                VM_CASE(OP_UN_DEC)
+                    m_VMStack.GetTop()--;
+                    VM_NEXT();
+
+                VM_CASE(OP_UN_INC)
+                    m_VMStack.GetTop()++;
+                    VM_NEXT();
+
+                VM_CASE(OP_UN_SIZE)
+                    m_VMStack.GetTop().setIntValue((int)m_VMStack.GetTop().size());
+                    VM_NEXT();
+
+                VM_CASE(OP_UN_TARGETNAME)
+                    // retrieve the target name
+                    if (world) {
+                        targetList = world->GetExistingTargetList(m_VMStack.GetTop().stringValue());
+                    } else {
+                        // Added in OPM
+                        //  don't use the target list if the world is NULL
+                        targetList = NULL;
                     }
-                } else if (targetList->list.NumObjects() == 1) {
-                    // single listener
-                    m_VMStack.GetTop().setListenerValue(targetList->list.ObjectAt(1));
-                } else if (targetList->list.NumObjects() > 1) {
-                    // multiple listeners
-                    m_VMStack.GetTop().setContainerValue((Container<SafePtr<Listener>> *)&targetList->list);
-                }
-                break;
 
-            case OP_VAR_UN_NOT:
-                m_VMStack.GetTop().setIntValue(m_VMStack.GetTop().booleanValue());
-                break;
+                    if (!targetList || !targetList->list.NumObjects()) {
+                        str targetname = m_VMStack.GetTop().stringValue();
+                        // the target name was not found
+                        m_VMStack.GetTop().setListenerValue(NULL);
 
-            case OP_DONE:
-                End();
-                break;
+                        if ((*m_PrevCodePos >= OP_BIN_EQUALITY && *m_PrevCodePos <= OP_BIN_GREATER_THAN_OR_EQUAL)
+                            || (*m_PrevCodePos >= OP_BOOL_UN_NOT && *m_PrevCodePos <= OP_UN_CAST_BOOLEAN)) {
+                            ScriptError("Targetname '%s' does not exist.", targetname.c_str());
+                        }
+                    } else if (targetList->list.NumObjects() == 1) {
+                        // single listener
+                        m_VMStack.GetTop().setListenerValue(targetList->list.ObjectAt(1));
+                    } else if (targetList->list.NumObjects() > 1) {
+                        // multiple listeners
+                        m_VMStack.GetTop().setContainerValue((Container<SafePtr<Listener>> *)&targetList->list);
+                    }
+                    VM_NEXT();
 
-            case OP_NOP:
-                break;
+                VM_CASE(OP_VAR_UN_NOT)
+                    m_VMStack.GetTop().setIntValue(m_VMStack.GetTop().booleanValue());
+                    VM_NEXT();
 
-            default:
-                assert(!"Invalid opcode");
-                if (*opcode < OP_MAX) {
-                    gi.DPrintf("unknown opcode %d ('%s')\n", *opcode, OpcodeName(*opcode));
-                } else {
-                    gi.DPrintf("unknown opcode %d\n", *opcode);
-                }
-                break;
-            }
+                VM_CASE(OP_DONE)
+                    End();
+                    VM_NEXT();
 
-            Director.cmdCount++;
+                VM_CASE(OP_NOP)
+                    VM_NEXT();
 
-            if (Director.cmdCount >= 15000) {
-                if (!Director.cmdTime) {
-                    Director.cmdTime = gi.Milliseconds();
-                    Director.cmdCount = 0;
-                    continue;
+                VM_DEFAULT()
+                    assert(!"Invalid opcode");
+                    if (*opcode < OP_MAX) {
+                        gi.DPrintf("unknown opcode %d ('%s')\n", *opcode, OpcodeName(*opcode));
+                    } else {
+                        gi.DPrintf("unknown opcode %d\n", *opcode);
+                    }
+                    VM_NEXT();
                 }
 
-                if (gi.Milliseconds() - Director.cmdTime < Director.maxTime) {
-                    Director.cmdCount = 0;
-                    continue;
+                if (!bThreaded || !VM_COMPUTED_GOTO) {
+                    if (++Director.cmdCount >= 15000) {
+                        CheckCommandOverflow(opcode);
+                    }
                 }
+            } while (bThreaded && state == STATE_RUNNING);
+        } catch (ScriptException& exc) {
+            HandleScriptException(exc);
+        }
+    }
+}
 
-                // The maximum execution time was reached
-                if (level.m_LoopProtection) {
-                    Director.cmdTime = gi.Milliseconds();
+/*
+====================
+Execute
 
-                    GetScript()->PrintSourcePos(m_CodePos, true);
-                    gi.DPrintf2("\n");
+Executes a program
+====================
+*/
+void ScriptVM::Execute(ScriptVariable *data, int dataSize, str label)
+{
+    if (Director.stackCount >= MAX_STACK_DEPTH) {
+        state = STATE_EXECUTION;
 
-                    state = STATE_EXECUTION;
+        ScriptException::next_abort = -1;
+        throw ScriptException("stack overflow");
+    }
 
-                    if (level.m_LoopDrop) {
-                        ScriptException::next_abort = -1;
-                    }
+    if (label.length()) {
+        // Throw if label is not found
+        m_CodePos = m_ScriptClass->FindLabel(label);
+        if (!m_CodePos) {
+            ScriptError("ScriptVM::Execute: label '%s' does not exist in '%s'.", label.c_str(), Filename().c_str());
+        }
+    }
 
-                    ScriptError("Command overflow. Possible infinite loop in thread.\n");
-                    break;
-                }
+    if (g_scripttrace->integer && CanScriptTracePrint()) {
+        gi.DPrintf2(
+            "+++FRAME: %i (%p) +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++\n",
+            Director.stackCount,
+            this
+        );
+    }
 
-                VM_DPrintf("Update of script position - This is not an error.\n");
-                VM_DPrintf("=================================================\n");
-                m_ScriptClass->GetScript()->PrintSourcePos(opcode, true);
-                VM_DPrintf("=================================================\n");
+    Director.stackCount++;
 
-                Director.cmdCount = 0;
-            }
-        } catch (ScriptException& exc) {
-            HandleScriptException(exc);
-        }
+    if (dataSize) {
+        SetFastData(data, dataSize);
+    }
+
+    state = STATE_RUNNING;
+
+    // Added in OPM
+    //  Tracing is only done by the switch loop
+    if (g_scriptdispatch->integer && !g_scripttrace->integer) {
+        ExecuteLoop<true>();
+    } else {
+        ExecuteLoop<false>();
     }
 
     Director.stackCount--;
 
+
     if (g_scripttrace->integer && CanScriptTracePrint()) {
         gi.DPrintf2(
             "---FRAME: %i (%p) -------------------------------------------------------------------\n",
@@ -171,13 +171,18 @@ private:
     void error(const char *format, ...);
 
     template<bool bMethod = false, bool bReturn = false>
-    void executeCommand(Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum);
+    void executeCommand(Listener *listener, op_parmNum_t iParamCount, op_evName_t eventnum, ScriptCache *cache);
     template<bool bReturn>
-    void executeCommandInternal(Event& ev, Listener *listener, ScriptVariable *fromVar, op_parmNum_t iParamCount);
-    bool executeGetter(Listener *listener, op_evName_t eventName);
-    bool executeSetter(Listener *listener, op_evName_t eventName);
-    void transferVarsToEvent(Event& ev, ScriptVariable *fromVar, op_parmNum_t count);
-    void checkValidEvent(Event& ev, Listener *listener);
+    void executeCommandInternal(
+        Event& ev, Listener *listener, ScriptVariable *fromVar, op_parmNum_t iParamCount, ScriptCache *cache
+    );
+    bool                executeGetter(Listener *listener, op_evName_t eventName, ScriptCache *cache);
+    bool                executeSetter(Listener *listener, op_evName_t eventName, ScriptCache *cache);
+    int                 resolveGetter(ClassDef *c, op_evName_t eventName);
+    int                 resolveSetter(ClassDef *c, op_evName_t eventName);
+    void                transferVarsToEvent(Event& ev, ScriptVariable *fromVar, op_parmNum_t count);
+    ResponseDef<Class> *checkValidEvent(Event& ev, Listener *listener, ScriptCache *cache);
+    void                processCommand(Event& ev, Listener *listener, ResponseDef<Class> *responses);
 
     void            loadTopInternal(Listener *listener);
     ScriptVariable *storeTopInternal(Listener *listener);
@@ -194,6 +199,10 @@ private:
 
     unsigned char *ProgBuffer();
     void           HandleScriptException(ScriptException& exc);
+    void           CheckCommandOverflow(unsigned char *opcode);
+
+    template<bool bThreaded>
+    void ExecuteLoop(void);
 
 public:
     void *operator new(size_t size);
@@ -1216,3 +1216,218 @@ void GLimp_EndFrame( void )
 		r_fullscreen->modified = qfalse;
 	}
 }
+
+/*
+===========================================================
+
+SMP acceleration
+
+Added in OPM
+The back end runs on its own thread when r_smp is set.
+The GL context is only current on one thread at a time,
+the front end takes it back whenever it waits for the renderer.
+
+===========================================================
+*/
+
+static SDL_mutex		*smpMutex = NULL;
+static SDL_cond			*renderCommandsEvent = NULL;
+static SDL_cond			*renderCompletedEvent = NULL;
+static SDL_Thread		*renderThread = NULL;
+static void				(*glimpRenderThread)( void ) = NULL;
+
+static volatile void	*smpData = NULL;
+static volatile qboolean smpDataReady;
+
+/*
+===============
+GLimp_SetCurrentContext
+===============
+*/
+static void GLimp_SetCurrentContext( qboolean enable )
+{
+	if ( enable ) {
+		SDL_GL_MakeCurrent( SDL_window, SDL_glContext );
+	} else {
+		SDL_GL_MakeCurrent( SDL_window, NULL );
+	}
+}
+
+/*
+===============
+GLimp_ShutdownRenderThread
+===============
+*/
+static void GLimp_ShutdownRenderThread( void )
+{
+	if ( smpMutex ) {
+		SDL_DestroyMutex( smpMutex );
+		smpMutex = NULL;
+	}
+
+	if ( renderCommandsEvent ) {
+		SDL_DestroyCond( renderCommandsEvent );
+		renderCommandsEvent = NULL;
+	}
+
+	if ( renderCompletedEvent ) {
+		SDL_DestroyCond( renderCompletedEvent );
+		renderCompletedEvent = NULL;
+	}
+
+	glimpRenderThread = NULL;
+	renderThread = NULL;
+}
+
+/*
+===============
+GLimp_RenderThreadWrapper
+===============
+*/
+static int GLimp_RenderThreadWrapper( void *arg )
+{
+	ri.Printf( PRINT_DEVELOPER, "Render thread starting\n" );
+
+	glimpRenderThread();
+
+	ri.Printf( PRINT_DEVELOPER, "Render thread terminating\n" );
+
+	return 0;
+}
+
+/*
+===============
+GLimp_SpawnRenderThread
+===============
+*/
+qboolean GLimp_SpawnRenderThread( void (*function)( void ) )
+{
+	if ( renderThread ) {
+		ri.Printf( PRINT_ALL, "Already a render thread? Trying to clean it up...\n" );
+		GLimp_WakeRenderer( NULL );
+	}
+
+	smpMutex = SDL_CreateMutex();
+	renderCommandsEvent = SDL_CreateCond();
+	renderCompletedEvent = SDL_CreateCond();
+
+	if ( !smpMutex || !renderCommandsEvent || !renderCompletedEvent ) {
+		ri.Printf( PRINT_ALL, "GLimp_SpawnRenderThread: SDL error: %s\n", SDL_GetError() );
+		GLimp_ShutdownRenderThread();
+		return qfalse;
+	}
+
+	// the render thread starts sleeping on GLimp_RendererSleep,
+	// as if it had just completed a batch of commands
+	smpData = (void *)1;
+	smpDataReady = qfalse;
+	glimpRenderThread = function;
+
+	renderThread = SDL_CreateThread( GLimp_RenderThreadWrapper, "render", NULL );
+	if ( !renderThread ) {
+		ri.Printf( PRINT_ALL, "GLimp_SpawnRenderThread: SDL_CreateThread() failed: %s\n", SDL_GetError() );
+		GLimp_ShutdownRenderThread();
+		smpData = NULL;
+		return qfalse;
+	}
+
+	return qtrue;
+}
+
+/*
+===============
+GLimp_RendererSleep
+
+Called by the render thread once it's done with a batch of commands,
+returns the next batch or NULL if the thread must exit
+===============
+*/
+void *GLimp_RendererSleep( void )
+{
+	void *data;
+
+	GLimp_SetCurrentContext( qfalse );
+
+	SDL_LockMutex( smpMutex );
+	{
+		smpData = NULL;
+		smpDataReady = qfalse;
+
+		// after this, the front end can exit GLimp_FrontEndSleep
+		SDL_CondSignal( renderCompletedEvent );
+
+		while ( !smpDataReady ) {
+			SDL_CondWait( renderCommandsEvent, smpMutex );
+		}
+
+		data = (void *)smpData;
+	}
+	SDL_UnlockMutex( smpMutex );
+
+	if ( data ) {
+		GLimp_SetCurrentContext( qtrue );
+	}
+
+	return data;
+}
+
+/*
+===============
+GLimp_FrontEndSleep
+
+Waits until the render thread is idle, then takes the context back
+===============
+*/
+void GLimp_FrontEndSleep( void )
+{
+	SDL_LockMutex( smpMutex );
+	{
+		while ( smpData ) {
+			SDL_CondWait( renderCompletedEvent, smpMutex );
+		}
+	}
+	SDL_UnlockMutex( smpMutex );
+
+	GLimp_SetCurrentContext( qtrue );
+}
+
+/*
+===============
+GLimp_WakeRenderer
+
+Hands a batch of commands to the render thread, which must be idle.
+A NULL batch makes it exit, the context is then back on the calling thread
+===============
+*/
+void GLimp_WakeRenderer( void *data )
+{
+	GLimp_SetCurrentContext( qfalse );
+
+	SDL_LockMutex( smpMutex );
+	{
+		assert( smpData == NULL );
+		smpData = data;
+		smpDataReady = qtrue;
+
+		// after this, the renderer can continue through GLimp_RendererSleep
+		SDL_CondSignal( renderCommandsEvent );
+	}
+	SDL_UnlockMutex( smpMutex );
+
+	if ( !data ) {
+		SDL_WaitThread( renderThread, NULL );
+		GLimp_ShutdownRenderThread();
+		GLimp_SetCurrentContext( qtrue );
+	}
+}
+
+
+/*
+===============
+GLimp_InRenderThread
+===============
+*/
+qboolean GLimp_InRenderThread( void )
+{
+	return renderThread && SDL_GetThreadID( renderThread ) == SDL_ThreadID();
+}
@@ -57,9 +57,18 @@ typedef struct voipServerPacket_s
 } voipServerPacket_t;
 #endif
 
+// Added in OPM
+//  Link of an entity in the entity list of a PVS cluster
+typedef struct svClusterLink_s {
+	struct svClusterLink_s	*prev;
+	struct svClusterLink_s	*next;
+	int						entityNum;
+} svClusterLink_t;
+
 typedef struct svEntity_s {
 	struct worldSector_s *worldSector;
 	struct svEntity_s *nextEntityInWorldSector;
+	struct svEntity_s *prevEntityInWorldSector;	// Added in OPM
 	
 	entityState_t	baseline;		// for delta compression of initial sighting
 	int			numClusters;		// if -1, use headnode instead
@@ -67,6 +76,9 @@ typedef struct svEntity_s {
 	int			lastCluster;		// if all the clusters don't fit in clusternums
 	int			areanum, areanum2;
 	int			snapshotCounter;	// used to prevent double adding from portal views
+	// Added in OPM
+	int				numClusterLinks;
+	svClusterLink_t	clusterLinks[MAX_ENT_CLUSTERS];	// in the lists of sv_clusterEntities
 } svEntity_t;
 
 typedef enum {
@@ -377,6 +389,9 @@ extern	cvar_t	*sv_netprofile;
 extern	cvar_t	*sv_netprofileoverlay;
 extern	cvar_t	*sv_netoptimize;
 extern	cvar_t	*sv_netoptimize_vistime;
+extern	cvar_t	*sv_snapshotthreads;
+extern	cvar_t	*sv_deltacache;
+extern	cvar_t	*sv_deltacachestats;
 extern	cvar_t	*g_netoptimize;
 extern	cvar_t	*sv_chatter;
 extern	cvar_t	*sv_gamename;
@@ -582,11 +597,19 @@ void SV_LinkEntity( gentity_t *ent );
 // sets ent->leafnums[] for pvs determination even if the entity
 // is not solid
 
+// Added in OPM
+//  entities linked in each PVS cluster, with a head node per cluster.
+//  Entities that touch more than MAX_ENT_CLUSTERS clusters aren't in any list
+extern	svClusterLink_t	*sv_clusterEntities;
+extern	int				sv_numClusterEntities;
+
 
 clipHandle_t SV_ClipHandleForEntity( const gentity_t *ent );
+clipHandle_t SV_ClipHandleForEntityContext( traceContext_t *ctx, const gentity_t *ent );
 
 
 void SV_SectorList_f( void );
+void SV_PauseSectorStats( qboolean pause );
 
 
 int SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int *entityList, int maxcount );
@@ -605,6 +628,7 @@ qboolean SV_SightTraceEntity( gentity_t *touch, const vec3_t start, const vec3_t
 qboolean SV_SightTrace( const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int passEntityNum2, int contentmask, qboolean cylinder );
 qboolean SV_HitEntity(gentity_t* pEnt, gentity_t* pOther);
 void SV_Trace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, qboolean cylinder, qboolean traceDeep );
+void SV_TraceBatch( trace_t *results, const vec3_t *starts, const vec3_t mins, const vec3_t maxs, const vec3_t *ends, int count, int passEntityNum, int contentmask, qboolean cylinder, qboolean traceDeep );
 void SV_TraceDeep( trace_t *results, const vec3_t vStart, const vec3_t vEnd, int iBrushMask, gentity_t *touch );
 // mins and maxs are relative
 
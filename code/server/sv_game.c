@@ -1569,7 +1569,21 @@ SV_Malloc
 */
 void *SV_Malloc( size_t size )
 {
-	return Z_TagMalloc( size, TAG_GAME );
+	// count the allocation for the game code calling it
+	return Z_TagMallocCaller( size, TAG_GAME, Z_RETURN_ADDRESS() );
+}
+
+/*
+===============
+SV_MallocCaller
+
+Added in OPM
+For the game wrappers that know who they allocate for
+===============
+*/
+void *SV_MallocCaller( size_t size, const void *caller )
+{
+	return Z_TagMallocCaller( size, TAG_GAME, caller );
 }
 
 void SV_Free( void* ptr )
@@ -1589,6 +1603,10 @@ void SV_ShutdownGameProgs( void ) {
 		return;
 	}
 
+	// Added in OPM
+	//  the level ends here
+	Z_WriteStats( sv_mapname->string );
+
 	ge->Shutdown();
 	Sys_UnloadGame();
 
@@ -1911,6 +1929,8 @@ void SV_InitGameProgs( void ) {
 
 	// Added in OPM
 	import.pvssoundindex				= SV_PVSSoundIndex;
+	import.traceBatch					= SV_TraceBatch;
+	import.MallocCaller					= SV_MallocCaller;
 
 	ge = Sys_GetGameAPI( &import );
 
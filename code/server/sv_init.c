@@ -1092,6 +1092,14 @@ void SV_Init (void)
     sv_netprofileoverlay = Cvar_Get("sv_netprofileoverlay", "0", 0);
     sv_netoptimize = Cvar_Get("sv_netoptimize", "0", 0);
 	sv_netoptimize_vistime = Cvar_Get("sv_netoptimize_vistime", "200", 0);
+	// Added in OPM
+	//  number of threads building client snapshots, 0 or 1 builds them one after the other
+	sv_snapshotthreads = Cvar_Get("sv_snapshotthreads", "0", 0);
+	// Added in OPM
+	//  share the encoded entity deltas between clients,
+	//  the hits and misses of the last frame are reported in sv_deltacachestats
+	sv_deltacache = Cvar_Get("sv_deltacache", "1", 0);
+	sv_deltacachestats = Cvar_Get("sv_deltacachestats", "0 0", CVAR_ROM);
     g_netoptimize = Cvar_Get("g_netoptimize", "1", 0);
 	sv_chatter = Cvar_Get( "sv_chatter", "0", 0 );
 	sv_lanForceRate = Cvar_Get ("sv_lanForceRate", "1", CVAR_ARCHIVE );
@@ -66,6 +66,9 @@ cvar_t	*sv_netprofile;
 cvar_t	*sv_netprofileoverlay;
 cvar_t	*sv_netoptimize;
 cvar_t	*sv_netoptimize_vistime;
+cvar_t	*sv_snapshotthreads;
+cvar_t	*sv_deltacache;
+cvar_t	*sv_deltacachestats;
 cvar_t	*g_netoptimize;
 cvar_t	*g_gametype;
 cvar_t	*g_gametypestring;
@@ -49,6 +49,150 @@ A normal server packet will look like:
 =============================================================================
 */
 
+// Added in OPM
+//  Entity deltas encoded during the current frame.
+//  Clients often write the same delta, from the baseline or
+//  from the same previous frame, so it is only encoded once
+#define DELTA_CACHE_HASH_SIZE		1024
+#define DELTA_CACHE_ENTRIES			2048
+#define DELTA_CACHE_BYTES			0x40000
+#define DELTA_CACHE_MAX_DELTA		4096	// bytes reserved to encode one delta
+
+typedef struct deltaCacheEntry_s {
+	struct deltaCacheEntry_s	*next;
+	unsigned int				fromHash;
+	unsigned int				toHash;
+	qboolean					force;
+	int							offset;		// in bytes, in the data of the cache
+	int							numBits;
+	entityState_t				from;
+	entityState_t				to;
+} deltaCacheEntry_t;
+
+typedef struct {
+	int					time;
+	float				frameTime;
+	int					numEntries;
+	int					dataSize;
+	int					hits;
+	int					misses;
+	deltaCacheEntry_t	*hashTable[DELTA_CACHE_HASH_SIZE];
+	deltaCacheEntry_t	entries[DELTA_CACHE_ENTRIES];
+	byte				data[DELTA_CACHE_BYTES];
+} deltaCache_t;
+
+static deltaCache_t sv_deltaCache;
+
+/*
+=============
+SV_ClearDeltaCache
+
+Empties the cache when the frame changes
+=============
+*/
+static void SV_ClearDeltaCache( void ) {
+	if ( sv_deltaCache.time == svs.time && sv_deltaCache.frameTime == sv.frameTime ) {
+		return;
+	}
+
+	if ( sv_deltaCache.hits || sv_deltaCache.misses ) {
+		Cvar_Set( "sv_deltacachestats", va( "%i %i", sv_deltaCache.hits, sv_deltaCache.misses ) );
+	}
+
+	sv_deltaCache.time = svs.time;
+	sv_deltaCache.frameTime = sv.frameTime;
+	sv_deltaCache.numEntries = 0;
+	sv_deltaCache.dataSize = 0;
+	sv_deltaCache.hits = 0;
+	sv_deltaCache.misses = 0;
+	Com_Memset( sv_deltaCache.hashTable, 0, sizeof( sv_deltaCache.hashTable ) );
+}
+
+/*
+=============
+SV_HashEntityState
+=============
+*/
+static unsigned int SV_HashEntityState( const entityState_t *state ) {
+	const unsigned int	*p;
+	unsigned int		hash;
+	int					i;
+
+	p = (const unsigned int *)state;
+	hash = 2166136261u;
+	for ( i = 0 ; i < sizeof( *state ) / sizeof( *p ) ; i++ ) {
+		hash = ( hash ^ p[i] ) * 16777619u;
+	}
+
+	return hash;
+}
+
+/*
+=============
+SV_WriteCachedDeltaEntity
+
+Same as MSG_WriteDeltaEntity, but the encoded delta is
+shared with the other clients writing the same one this frame
+=============
+*/
+static void SV_WriteCachedDeltaEntity( msg_t *msg, entityState_t *from, entityState_t *to, qboolean force ) {
+	deltaCacheEntry_t	*entry;
+	unsigned int		fromHash, toHash;
+	int					hash;
+	msg_t				delta;
+
+	if ( !sv_deltacache->integer || !to ) {
+		MSG_WriteDeltaEntity( msg, from, to, force, sv.frameTime );
+		return;
+	}
+
+	SV_ClearDeltaCache();
+
+	fromHash = SV_HashEntityState( from );
+	toHash = SV_HashEntityState( to );
+	hash = ( fromHash ^ ( toHash * 31 ) ^ force ) & ( DELTA_CACHE_HASH_SIZE - 1 );
+
+	for ( entry = sv_deltaCache.hashTable[hash] ; entry ; entry = entry->next ) {
+		if ( entry->fromHash == fromHash && entry->toHash == toHash && entry->force == force
+			&& !memcmp( &entry->from, from, sizeof( *from ) ) && !memcmp( &entry->to, to, sizeof( *to ) ) ) {
+			sv_deltaCache.hits++;
+			MSG_WriteEncodedBits( msg, sv_deltaCache.data + entry->offset, entry->numBits );
+			return;
+		}
+	}
+
+	sv_deltaCache.misses++;
+
+	if ( sv_deltaCache.numEntries == DELTA_CACHE_ENTRIES
+		|| sv_deltaCache.dataSize + DELTA_CACHE_MAX_DELTA > DELTA_CACHE_BYTES ) {
+		// full until the next frame
+		MSG_WriteDeltaEntity( msg, from, to, force, sv.frameTime );
+		return;
+	}
+
+	MSG_Init( &delta, sv_deltaCache.data + sv_deltaCache.dataSize, DELTA_CACHE_MAX_DELTA );
+	MSG_WriteDeltaEntity( &delta, from, to, force, sv.frameTime );
+	if ( delta.overflowed ) {
+		MSG_WriteDeltaEntity( msg, from, to, force, sv.frameTime );
+		return;
+	}
+
+	entry = &sv_deltaCache.entries[sv_deltaCache.numEntries++];
+	entry->fromHash = fromHash;
+	entry->toHash = toHash;
+	entry->force = force;
+	entry->offset = sv_deltaCache.dataSize;
+	entry->numBits = delta.bit;
+	entry->from = *from;
+	entry->to = *to;
+	entry->next = sv_deltaCache.hashTable[hash];
+	sv_deltaCache.hashTable[hash] = entry;
+
+	sv_deltaCache.dataSize += ( delta.bit + 7 ) >> 3;
+
+	MSG_WriteEncodedBits( msg, sv_deltaCache.data + entry->offset, entry->numBits );
+}
+
 /*
 =============
 SV_EmitPacketEntities
@@ -92,7 +236,7 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 			// delta update from old position
 			// because the force parm is qfalse, this will not result
 			// in any bytes being emitted if the entity has not changed at all
-			MSG_WriteDeltaEntity (msg, oldent, newent, qfalse, sv.frameTime);
+			SV_WriteCachedDeltaEntity (msg, oldent, newent, qfalse);
 			oldindex++;
 			newindex++;
 			continue;
@@ -100,7 +244,7 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 
 		if ( newnum < oldnum ) {
 			// this is a new entity, send it from the baseline
-			MSG_WriteDeltaEntity (msg, &sv.svEntities[newnum].baseline, newent, qtrue, sv.frameTime);
+			SV_WriteCachedDeltaEntity (msg, &sv.svEntities[newnum].baseline, newent, qtrue);
 			newindex++;
 			continue;
 		}
@@ -272,6 +416,54 @@ typedef struct {
 	int		snapshotEntities[MAX_SNAPSHOT_ENTITIES];	
 } snapshotEntityNumbers_t;
 
+// Added in OPM
+//  The state of a snapshot being built.
+//  Building a snapshot doesn't change anything outside of its client,
+//  the changes to entities are kept here and applied once it's finished,
+//  so the snapshots of all clients can be built in parallel
+typedef struct {
+	client_t				*client;
+	qboolean				valid;						// the client has an entity to view from
+	qboolean				scanned;					// the entity list was scanned
+	const char				*error;						// reported once the build is finished
+	snapshotEntityNumbers_t	entityNumbers;
+	byte					added[MAX_GENTITIES];		// prevents double adding from portal views
+	int						renderfx[MAX_GENTITIES];	// renderfx of the added entities
+	int						numTouched;
+	int						touched[MAX_GENTITIES];		// entities whose renderfx is set
+	traceContext_t			*traceContext;				// for the visibility traces
+} snapshotBuild_t;
+
+static snapshotBuild_t sv_snapshotBuilds[MAX_CLIENTS];
+
+// Added in OPM
+//  Entities that must be checked by every snapshot whatever
+//  the clusters they are in, set before the snapshots of a frame are built.
+//  The other entities are only checked when one of their clusters is visible
+#define SNAPSHOT_CANDIDATE_WORDS (MAX_GENTITIES / 32)
+
+static unsigned int	sv_snapshotCandidates[SNAPSHOT_CANDIDATE_WORDS];
+static qboolean		sv_snapshotEntitiesSent;
+
+// Added in OPM
+//  Results of the client visibility traces for sv_netoptimize,
+//  computed once per frame for each pair of clients.
+//  The traces between the eyes of both clients are symmetric
+//  and only stored for fromNum < toNum
+typedef enum {
+	CLIENTVIS_UNKNOWN,
+	CLIENTVIS_HIDDEN,
+	CLIENTVIS_VISIBLE
+} clientVisResult_t;
+
+typedef struct {
+	int		time;										// svs.time of the results
+	byte	between[2][MAX_CLIENTS][MAX_CLIENTS];		// eye to eye, then with predicted positions
+	byte	lowered[2][MAX_CLIENTS][MAX_CLIENTS];		// eye to the lowered eye of the other client
+} clientVisibility_t;
+
+static clientVisibility_t sv_clientVisibility;
+
 /*
 =======================
 SV_QsortEntityNumbers
@@ -283,8 +475,11 @@ static int QDECL SV_QsortEntityNumbers( const void *a, const void *b ) {
 	ea = (int *)a;
 	eb = (int *)b;
 
+	// Added in OPM
+	//  duplicated entities are checked after sorting,
+	//  as the sort may run outside of the main thread
 	if ( *ea == *eb ) {
-		Com_Error( ERR_DROP, "SV_QsortEntityStates: duplicated entity" );
+		return 0;
 	}
 
 	if ( *ea < *eb ) {
@@ -326,7 +521,7 @@ SV_ClipMoveToBSPEntities
 
 ====================
 */
-static qboolean SV_ClipMoveToBSPEntities(const vec3_t start, const vec3_t end, int mask) {
+static qboolean SV_ClipMoveToBSPEntities(traceContext_t *ctx, const vec3_t start, const vec3_t end, int mask) {
 	int				i, num;
 	int				touchlist[MAX_GENTITIES];
 	gentity_t		*touch;
@@ -362,9 +557,9 @@ static qboolean SV_ClipMoveToBSPEntities(const vec3_t start, const vec3_t end, i
 		}
 
 		// might intersect, so do an exact clip
-		clipHandle = SV_ClipHandleForEntity(touch);
+		clipHandle = SV_ClipHandleForEntityContext(ctx, touch);
 
-		CM_TransformedBoxTrace(&trace, start, end,
+		CM_TransformedBoxTraceContext(ctx, &trace, start, end,
 			vec3_origin, vec3_origin, clipHandle, mask,
 			touch->s.origin, touch->r.currentAngles, qfalse);
 
@@ -381,34 +576,127 @@ static qboolean SV_ClipMoveToBSPEntities(const vec3_t start, const vec3_t end, i
 SV_WorldTrace
 ===============
 */
-qboolean SV_WorldTrace(const vec3_t start, const vec3_t end, int mask)
+qboolean SV_WorldTrace(traceContext_t *ctx, const vec3_t start, const vec3_t end, int mask)
 {
 	trace_t trace = { 0 };
 
-    CM_BoxTrace(&trace, start, end, vec3_origin, vec3_origin, 0, mask, qfalse);
+    CM_BoxTraceContext(ctx, &trace, start, end, vec3_origin, vec3_origin, 0, mask, qfalse);
 	if (trace.fraction != 1) {
 		return qfalse;
 	}
 
 	// Also test against brush models
-	return SV_ClipMoveToBSPEntities(start, end, mask);
+	return SV_ClipMoveToBSPEntities(ctx, start, end, mask);
+}
+
+/*
+===============
+SV_ClearClientVisibility
+
+Added in OPM
+Forgets the visibility results of the previous frame
+===============
+*/
+static void SV_ClearClientVisibility(void) {
+	if (sv_clientVisibility.time == svs.time) {
+		return;
+	}
+
+	Com_Memset(&sv_clientVisibility, 0, sizeof(sv_clientVisibility));
+	sv_clientVisibility.time = svs.time;
+}
+
+/*
+===============
+SV_PointsInPVS
+
+Added in OPM
+Returns false if nothing can be seen between both points,
+so the trace between them can be skipped
+===============
+*/
+static qboolean SV_PointsInPVS(const vec3_t p1, const vec3_t p2) {
+	int		leafnum1, leafnum2;
+	int		cluster1, cluster2;
+	byte	*mask;
+
+	leafnum1 = CM_PointLeafnum(p1);
+	leafnum2 = CM_PointLeafnum(p2);
+
+	cluster1 = CM_LeafCluster(leafnum1);
+	cluster2 = CM_LeafCluster(leafnum2);
+	if (cluster1 < 0 || cluster2 < 0) {
+		// in a solid, let the trace decide
+		return qtrue;
+	}
+
+	mask = CM_ClusterPVS(cluster1);
+	if (mask && !(mask[cluster2 >> 3] & (1 << (cluster2 & 7)))) {
+		return qfalse;
+	}
+
+	// a door blocks sight
+	return CM_AreasConnected(CM_LeafArea(leafnum1), CM_LeafArea(leafnum2));
+}
+
+/*
+===============
+SV_VisibilityTrace
+
+Added in OPM
+Returns the result stored in the visibility matrix,
+tracing if there is none yet.
+Snapshots built at the same time can both trace
+the same points, they get the same result
+===============
+*/
+static qboolean SV_VisibilityTrace(traceContext_t *ctx, byte *result, const vec3_t start, const vec3_t end) {
+	byte value;
+
+	Com_LockJobs();
+	value = *result;
+	Com_UnlockJobs();
+
+	if (value == CLIENTVIS_UNKNOWN) {
+		if (SV_PointsInPVS(start, end) && SV_WorldTrace(ctx, start, end, (CONTENTS_SLIME | CONTENTS_LAVA | CONTENTS_SOLID))) {
+			value = CLIENTVIS_VISIBLE;
+		} else {
+			value = CLIENTVIS_HIDDEN;
+		}
+
+		Com_LockJobs();
+		*result = value;
+		Com_UnlockJobs();
+	}
+
+	return value == CLIENTVIS_VISIBLE;
 }
 
 /*
 ===============
 SV_ClientIsVisibleTrace
+
+Added in OPM: the results are kept in the visibility matrix,
+the trace between both points is shared with the other client
 ===============
 */
-qboolean SV_ClientIsVisibleTrace(const vec3_t fromOrigin, const vec3_t toOrigin, float height, float dot) {
+qboolean SV_ClientIsVisibleTrace(traceContext_t *ctx, int toNum, int fromNum, qboolean predicted, const vec3_t fromOrigin, const vec3_t toOrigin, float height, float dot) {
 	vec3_t dir;
 	vec3_t end;
+	byte* result;
 
 	VectorSubtract(toOrigin, fromOrigin, dir);
     VectorNormalize(dir);
     //VectorMA(toOrigin, -height, dir, end);
 	VectorCopy(toOrigin, end);
 
-	if (SV_WorldTrace(fromOrigin, end, (CONTENTS_SLIME | CONTENTS_LAVA | CONTENTS_SOLID))) {
+	if (fromNum < toNum) {
+		result = &sv_clientVisibility.between[predicted][fromNum][toNum];
+	} else {
+		result = &sv_clientVisibility.between[predicted][toNum][fromNum];
+	}
+
+	if (SV_VisibilityTrace(ctx, result, fromOrigin, end)) {
 		return qtrue;
 	}
 
@@ -417,7 +705,7 @@ qboolean SV_ClientIsVisibleTrace(const vec3_t fromOrigin, const vec3_t toOrigin,
     }
 
 	end[2] -= height;
-	return SV_WorldTrace(fromOrigin, end, (CONTENTS_SLIME | CONTENTS_LAVA | CONTENTS_SOLID));
+	return SV_VisibilityTrace(ctx, &sv_clientVisibility.lowered[predicted][fromNum][toNum], fromOrigin, end);
 }
 
 /*
@@ -425,7 +713,7 @@ qboolean SV_ClientIsVisibleTrace(const vec3_t fromOrigin, const vec3_t toOrigin,
 SV_ClientIsVisible
 ===============
 */
-qboolean SV_ClientIsVisible(int toNum, int fromNum, int distCheck, const vec3_t forward, const vec3_t right) {
+qboolean SV_ClientIsVisible(traceContext_t *ctx, int toNum, int fromNum, int distCheck, const vec3_t forward, const vec3_t right) {
 	client_t* fromClient;
 	playerState_t *fromPs, *toPs;
 	vec3_t dir;
@@ -479,7 +767,7 @@ qboolean SV_ClientIsVisible(int toNum, int fromNum, int distCheck, const vec3_t
 	VectorNormalize(dir);
 
 	dot = DotProduct(forward, dir);
-	if (SV_ClientIsVisibleTrace(fromOrigin, toOrigin, toPs->viewheight / 2, dot)) {
+	if (SV_ClientIsVisibleTrace(ctx, toNum, fromNum, qfalse, fromOrigin, toOrigin, toPs->viewheight / 2, dot)) {
 		fromClient->lastVisCheckTime[toNum] = svs.time + sv_netoptimize_vistime->integer;
 		return qtrue;
 	}
@@ -495,7 +783,7 @@ qboolean SV_ClientIsVisible(int toNum, int fromNum, int distCheck, const vec3_t
 	VectorMA(fromOrigin, sv.frameTime * 3, fromPs->velocity, fromOrigin);
 	VectorMA(toOrigin, sv.frameTime * 3, toPs->velocity, toOrigin);
 
-	if (SV_ClientIsVisibleTrace(fromOrigin, toOrigin, toPs->viewheight / 2, dot)) {
+	if (SV_ClientIsVisibleTrace(ctx, toNum, fromNum, qtrue, fromOrigin, toOrigin, toPs->viewheight / 2, dot)) {
         fromClient->lastVisCheckTime[toNum] = svs.time + sv_netoptimize_vistime->integer;
         return qtrue;
 	}
@@ -509,30 +797,35 @@ qboolean SV_ClientIsVisible(int toNum, int fromNum, int distCheck, const vec3_t
 SV_AddEntToSnapshot
 ===============
 */
-static void SV_AddEntToSnapshot( svEntity_t *svEnt, gentity_t *gEnt, snapshotEntityNumbers_t *eNums, svEntity_t* portalEnt, qboolean portalsky) {
+static void SV_AddEntToSnapshot( svEntity_t *svEnt, gentity_t *gEnt, snapshotBuild_t *build, svEntity_t* portalEnt, qboolean portalsky) {
+	snapshotEntityNumbers_t *eNums = &build->entityNumbers;
+	int num = gEnt->s.number;
+
 	// if we have already added this entity to this snapshot, don't add again
-	if ( svEnt->snapshotCounter == sv.snapshotCounter ) {
-		gEnt->s.renderfx &= ~(RF_SHADOW_PLANE | RF_WRAP_FRAMES);
-		gEnt->s.renderfx |= RF_WRAP_FRAMES;
+	if ( build->added[num] ) {
+		build->renderfx[num] &= ~(RF_SHADOW_PLANE | RF_WRAP_FRAMES);
+		build->renderfx[num] |= RF_WRAP_FRAMES;
 		return;
 	}
-	svEnt->snapshotCounter = sv.snapshotCounter;
+	build->added[num] = qtrue;
+	build->renderfx[num] = gEnt->s.renderfx;
+	build->touched[build->numTouched++] = num;
 
 	// if we are full, silently discard entities
 	if ( eNums->numSnapshotEntities == MAX_SNAPSHOT_ENTITIES ) {
 		return;
 	}
 
-	gEnt->s.renderfx &= ~(RF_SHADOW_PLANE | RF_WRAP_FRAMES | RF_SKYENTITY);
+	build->renderfx[num] &= ~(RF_SHADOW_PLANE | RF_WRAP_FRAMES | RF_SKYENTITY);
 
 	if ( portalEnt ) {
-		gEnt->s.renderfx |= RF_SHADOW_PLANE;
+		build->renderfx[num] |= RF_SHADOW_PLANE;
 	} else if ( portalsky ) {
-		gEnt->s.renderfx |= RF_SKYENTITY;
+		build->renderfx[num] |= RF_SKYENTITY;
 	}
 
-	gEnt->r.lastNetTime = svs.time - svs.startTime;
-	eNums->snapshotEntities[ eNums->numSnapshotEntities ] = gEnt->s.number;
+	// lastNetTime is set when the snapshot is finished
+	eNums->snapshotEntities[ eNums->numSnapshotEntities ] = num;
 	eNums->numSnapshotEntities++;
 }
 
@@ -579,12 +872,88 @@ int EntityDistCheck(const vec3_t origin, const vec3_t forward, const gentity_t*
 	return CULL_CLIP;
 }
 
+/*
+===============
+SV_PrepareSnapshots
+
+Added in OPM
+Finds the entities that snapshots must always check, either because
+they are sent regardless of their position, or because their visibility
+doesn't come from their own clusters
+===============
+*/
+static void SV_PrepareSnapshots(void) {
+	gentity_t	*ent;
+	svEntity_t	*svEnt;
+	int			e;
+
+	Com_Memset( sv_snapshotCandidates, 0, sizeof( sv_snapshotCandidates ) );
+	sv_snapshotEntitiesSent = qfalse;
+
+	// before the snapshots start tracing
+	SV_ClearClientVisibility();
+
+	if ( !sv.state ) {
+		return;
+	}
+
+	for ( e = 0 ; e < sv.num_entities ; e++ ) {
+		ent = SV_GentityNum(e);
+		if ( !ent->inuse || !ent->r.linked ) {
+			continue;
+		}
+
+		svEnt = SV_SvEntityForGentity( ent );
+
+		if ( ent->s.parent != ENTITYNUM_NONE
+			|| ( ent->r.svFlags & ( SVF_BROADCAST | SVF_SENDONCE ) )
+			|| ( ent->s.renderfx & ( RF_SKYORIGIN | RF_VIEWMODEL ) )
+			|| ( ent->s.loopSound && ent->s.loopSoundMinDist == LEVEL_WIDE_MIN_DIST )
+			|| svEnt->lastCluster ) {
+			sv_snapshotCandidates[e >> 5] |= 1u << ( e & 31 );
+		}
+	}
+}
+
+/*
+===============
+SV_AddVisibleClusterEntities
+
+Added in OPM
+Adds the entities in the clusters of the PVS to the candidates
+===============
+*/
+static void SV_AddVisibleClusterEntities( unsigned int *candidates, const byte *pvs ) {
+	svClusterLink_t	*head;
+	svClusterLink_t	*link;
+	int				cluster;
+	int				num;
+
+	for ( cluster = 0 ; cluster < sv_numClusterEntities ; cluster++ ) {
+		if ( !pvs[cluster >> 3] ) {
+			// skip the whole byte
+			cluster |= 7;
+			continue;
+		}
+
+		if ( !( pvs[cluster >> 3] & ( 1 << ( cluster & 7 ) ) ) ) {
+			continue;
+		}
+
+		head = &sv_clusterEntities[cluster];
+		for ( link = head->next ; link != head ; link = link->next ) {
+			num = link->entityNum;
+			candidates[num >> 5] |= 1u << ( num & 31 );
+		}
+	}
+}
+
 /*
 ===============
 SV_AddEntitiesVisibleFromPoint
 ===============
 */
-static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t* frame, snapshotEntityNumbers_t* eNums, svEntity_t* portalEnt, qboolean portalsky, client_t* client, const vec3_t angles ) {
+static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t* frame, snapshotBuild_t* build, svEntity_t* portalEnt, qboolean portalsky, client_t* client, const vec3_t angles ) {
 	int		e, i;
 	gentity_t *ent;
 	gentity_t *parentEnt;
@@ -600,6 +969,7 @@ static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t
 	int		num;
 	int		check = 0;
 	vec3_t	forward, right;
+	unsigned int	candidates[SNAPSHOT_CANDIDATE_WORDS];
 
 	// during an error shutdown message we may need to transmit
 	// the shutdown message after the server has shutdown, so
@@ -616,6 +986,7 @@ static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t
 	}
 
 	leafnum = CM_PointLeafnum (origin);
+
 	clientarea = CM_LeafArea (leafnum);
 	clientcluster = CM_LeafCluster (leafnum);
 
@@ -628,7 +999,26 @@ static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t
 
 	c_fullsend = 0;
 
-	for ( e = 0 ; e < sv.num_entities ; e++ ) {
+	// entities are marked as sent when the snapshot is finished
+	build->scanned = qtrue;
+
+	// Added in OPM
+	//  only check the entities that can possibly be sent,
+	//  still in ascending order so the snapshot is the same
+	Com_Memcpy( candidates, sv_snapshotCandidates, sizeof( candidates ) );
+	SV_AddVisibleClusterEntities( candidates, clientpvs );
+
+	for ( e = 0 ; e < sv.num_entities && !build->error ; e++ ) {
+		if ( !candidates[e >> 5] ) {
+			// skip the whole word
+			e |= 31;
+			continue;
+		}
+
+		if ( !( candidates[e >> 5] & ( 1u << ( e & 31 ) ) ) ) {
+			continue;
+		}
+
 		ent = SV_GentityNum(e);
 
 		// never send unused entities
@@ -636,9 +1026,6 @@ static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t
 			continue;
 		}
 
-		// mark the entity as sent
-		ent->r.svFlags |= SVF_SENT;
-
 		// never send entities that aren't linked in
 		if ( !ent->r.linked ) {
 			continue;
@@ -683,17 +1070,18 @@ static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t
 		svEnt = SV_SvEntityForGentity( ent );
 
 		// don't double add an entity through portals
-		if ( svEnt->snapshotCounter == sv.snapshotCounter ) {
+		if ( build->added[ent->s.number] ) {
 			continue;
 		}
 
 		if (ent->s.renderfx & RF_SKYORIGIN) {
 			if (sv.skyportal && !portalsky && !portalEnt) {
 				if (skyorigin) {
-					Com_Error(ERR_DROP, "SV_AddEntitiesVisibleFromPoint: duplicate sky origin");
+					build->error = "SV_AddEntitiesVisibleFromPoint: duplicate sky origin";
+					return;
 				}
 				skyorigin = ent;
-				SV_AddEntToSnapshot(svEnt, ent, eNums, NULL, qfalse);
+				SV_AddEntToSnapshot(svEnt, ent, build, NULL, qfalse);
 			}
 			continue;
 		}
@@ -701,14 +1089,14 @@ static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t
 		// broadcast entities are always sent
 		// or broadcast entities that are sent once
 		if ( (ent->r.svFlags & SVF_BROADCAST) || (ent->r.svFlags & SVF_SENDONCE)  ) {
-			SV_AddEntToSnapshot( svEnt, ent, eNums, portalEnt, portalsky);
+			SV_AddEntToSnapshot( svEnt, ent, build, portalEnt, portalsky);
 			continue;
 		}
 
 		if (parentEnt) {
 			svEntity_t* parentSvEnt = SV_SvEntityForGentity(parentEnt);
-			if (parentSvEnt->snapshotCounter == sv.snapshotCounter) {
-				SV_AddEntToSnapshot(svEnt, ent, eNums, portalEnt, portalsky);
+			if (build->added[ent->s.parent]) {
+				SV_AddEntToSnapshot(svEnt, ent, build, portalEnt, portalsky);
 				continue;
 			} else if (g_gametype->integer != GT_SINGLE_PLAYER && ent->s.parent < svs.iNumClients) {
 				SV_AddNonPVSSound(client, ent);
@@ -727,7 +1115,7 @@ static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t
 
 		if ((ent->s.loopSound && ent->s.loopSoundMinDist == LEVEL_WIDE_MIN_DIST) || ent->s.renderfx & RF_VIEWMODEL) {
             // loopsound entities should be sent regardless
-			SV_AddEntToSnapshot(svEnt, ent, eNums, portalEnt, portalsky);
+			SV_AddEntToSnapshot(svEnt, ent, build, portalEnt, portalsky);
             continue;
 		}
 
@@ -785,30 +1173,30 @@ static void SV_AddEntitiesVisibleFromPoint(const vec3_t origin, clientSnapshot_t
 			}
 		}
 
-		if (svEnt->snapshotCounter == sv.snapshotCounter) {
-			ent->s.renderfx &= ~(RF_WRAP_FRAMES | RF_SHADOW_PLANE);
-			ent->s.renderfx |= RF_WRAP_FRAMES;
+		if (build->added[ent->s.number]) {
+			build->renderfx[ent->s.number] &= ~(RF_WRAP_FRAMES | RF_SHADOW_PLANE);
+			build->renderfx[ent->s.number] |= RF_WRAP_FRAMES;
 			continue;
 		}
 
 		if (g_gametype->integer != GT_SINGLE_PLAYER && ent->s.number < svs.iNumClients) {
-			if (!SV_ClientIsVisible(ent->s.number, client - svs.clients, check, forward, right)) {
+			if (!SV_ClientIsVisible(build->traceContext, ent->s.number, client - svs.clients, check, forward, right)) {
 				SV_AddNonPVSSound(client, ent);
 				continue;
 			}
 		}
 
 		// add it
-		SV_AddEntToSnapshot( svEnt, ent, eNums, portalEnt, portalsky);
+		SV_AddEntToSnapshot( svEnt, ent, build, portalEnt, portalsky);
 
 		// if its a portal entity, add everything visible from its camera position
 		if ( ent->r.svFlags & SVF_PORTAL && svEnt != portalEnt ) {
-			SV_AddEntitiesVisibleFromPoint( ent->s.origin2, frame, eNums, svEnt, qfalse, client, angles  );
+			SV_AddEntitiesVisibleFromPoint( ent->s.origin2, frame, build, svEnt, qfalse, client, angles  );
 		}
 	}
 
-	if (!portalsky && skyorigin && !portalEnt) {
-		SV_AddEntitiesVisibleFromPoint(skyorigin->s.origin, frame, eNums, NULL, qtrue, client, angles);
+	if (!portalsky && skyorigin && !portalEnt && !build->error) {
+		SV_AddEntitiesVisibleFromPoint(skyorigin->s.origin, frame, build, NULL, qtrue, client, angles);
 	}
 }
 
@@ -1024,29 +1412,44 @@ This properly handles multiple recursive portals, but the render
 currently doesn't.
 
 For viewing through other player's eyes, clent can be something other than client->gentity
+
+Added in OPM: only changes the client and the build,
+SV_FinishClientSnapshot must be called afterwards
 =============
 */
-static void SV_BuildClientSnapshot( client_t *client ) {
+static void SV_BuildClientSnapshot( snapshotBuild_t *build ) {
 	vec3_t						org;
 	vec3_t						ang;
 	clientSnapshot_t			*frame;
-	snapshotEntityNumbers_t		entityNumbers;
+	snapshotEntityNumbers_t		*entityNumbers;
 	int							i;
-	gentity_t					*ent;
-	entityState_t				*state;
 	svEntity_t					*svEnt;
 	gentity_t					*clent;
 	int							clientNum;
 	playerState_t				*ps;
+	client_t					*client;
+
+	client = build->client;
+	entityNumbers = &build->entityNumbers;
 
-	// bump the counter used to prevent double adding
-	sv.snapshotCounter++;
+	if ( !build->traceContext ) {
+		build->traceContext = CM_CreateTraceContext();
+	}
+
+	// clear the entities added to the previous snapshot
+	for ( i = 0 ; i < build->numTouched ; i++ ) {
+		build->added[build->touched[i]] = qfalse;
+	}
+	build->numTouched = 0;
+	build->valid = qfalse;
+	build->scanned = qfalse;
+	build->error = NULL;
 
 	// this is the frame we are creating
 	frame = &client->frames[ client->netchan.outgoingSequence & PACKET_MASK ];
 
 	// clear everything in this snapshot
-	entityNumbers.numSnapshotEntities = 0;
+	entityNumbers->numSnapshotEntities = 0;
 	Com_Memset( frame->areabits, 0, sizeof( frame->areabits ) );
 
   // https://zerowing.idsoftware.com/bugzilla/show_bug.cgi?id=62
@@ -1057,6 +1460,8 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 		return;
 	}
 
+	build->valid = qtrue;
+
 	// grab the current playerState_t
 	ps = SV_GameClientNum( client - svs.clients );
 	frame->ps = *ps;
@@ -1068,7 +1473,8 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 	// be regenerated from the playerstate
 	clientNum = frame->ps.clientNum;
 	if ( clientNum < 0 || clientNum >= MAX_GENTITIES ) {
-		Com_Error( ERR_DROP, "SV_SvEntityForGentity: bad gEnt" );
+		build->error = "SV_SvEntityForGentity: bad gEnt";
+		return;
 	}
 	svEnt = &sv.svEntities[ clientNum ];
 	
@@ -1087,31 +1493,100 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 		VectorCopy(ps->viewangles, ang);
 	}
 
-	SV_AddEntToSnapshot(svEnt, SV_GentityNum(client - svs.clients), &entityNumbers, NULL, qfalse);
+	SV_AddEntToSnapshot(svEnt, SV_GentityNum(client - svs.clients), build, NULL, qfalse);
 
 	// add all the entities directly visible to the eye, which
 	// may include portal entities that merge other viewpoints
-	SV_AddEntitiesVisibleFromPoint( org, frame, &entityNumbers, NULL, qfalse, client, ang );
+	SV_AddEntitiesVisibleFromPoint( org, frame, build, NULL, qfalse, client, ang );
+
+	if ( build->error ) {
+		return;
+	}
 
 	// if there were portals visible, there may be out of order entities
 	// in the list which will need to be resorted for the delta compression
 	// to work correctly.  This also catches the error condition
 	// of an entity being included twice.
-	qsort( entityNumbers.snapshotEntities, entityNumbers.numSnapshotEntities, 
-		sizeof( entityNumbers.snapshotEntities[0] ), SV_QsortEntityNumbers );
+	qsort( entityNumbers->snapshotEntities, entityNumbers->numSnapshotEntities, 
+		sizeof( entityNumbers->snapshotEntities[0] ), SV_QsortEntityNumbers );
+
+	for ( i = 1 ; i < entityNumbers->numSnapshotEntities ; i++ ) {
+		if ( entityNumbers->snapshotEntities[i] == entityNumbers->snapshotEntities[i - 1] ) {
+			build->error = "SV_QsortEntityStates: duplicated entity";
+			return;
+		}
+	}
 
 	// now that all viewpoint's areabits have been OR'd together, invert
 	// all of them to make it a mask vector, which is what the renderer wants
 	for ( i = 0 ; i < MAX_MAP_AREA_BYTES/4 ; i++ ) {
 		((int *)frame->areabits)[i] = ((int *)frame->areabits)[i] ^ -1;
 	}
+}
+
+/*
+=============
+SV_BuildClientSnapshotJob
+=============
+*/
+static void SV_BuildClientSnapshotJob( void *data, int index ) {
+	SV_BuildClientSnapshot( &((snapshotBuild_t *)data)[index] );
+}
+
+/*
+=============
+SV_FinishClientSnapshot
+
+Added in OPM
+Applies the changes of the build to the entities, in the same order
+they would be made if the snapshots were built one after the other,
+then copies off the entity states
+=============
+*/
+static void SV_FinishClientSnapshot( snapshotBuild_t *build ) {
+	clientSnapshot_t			*frame;
+	snapshotEntityNumbers_t		*entityNumbers;
+	int							i;
+	gentity_t					*ent;
+	entityState_t				*state;
+	client_t					*client;
+
+	client = build->client;
+	entityNumbers = &build->entityNumbers;
+
+	if ( build->error ) {
+		Com_Error( ERR_DROP, "%s", build->error );
+	}
+
+	if ( !build->valid ) {
+		return;
+	}
+
+	frame = &client->frames[ client->netchan.outgoingSequence & PACKET_MASK ];
+
+	if ( build->scanned && !sv_snapshotEntitiesSent ) {
+		// mark the entities as sent, once per frame
+		sv_snapshotEntitiesSent = qtrue;
+		for ( i = 0 ; i < sv.num_entities ; i++ ) {
+			ent = SV_GentityNum(i);
+			if ( ent->inuse ) {
+				ent->r.svFlags |= SVF_SENT;
+			}
+		}
+	}
+
+	for ( i = 0 ; i < build->numTouched ; i++ ) {
+		ent = SV_GentityNum(build->touched[i]);
+		ent->s.renderfx = build->renderfx[build->touched[i]];
+	}
 
-	
 	// copy the entity states out
 	frame->num_entities = 0;
 	frame->first_entity = svs.nextSnapshotEntities;
-	for ( i = 0 ; i < entityNumbers.numSnapshotEntities ; i++ ) {
-		ent = SV_GentityNum(entityNumbers.snapshotEntities[i]);
+	for ( i = 0 ; i < entityNumbers->numSnapshotEntities ; i++ ) {
+		ent = SV_GentityNum(entityNumbers->snapshotEntities[i]);
+		ent->r.lastNetTime = svs.time - svs.startTime;
+
 		if (ent->client && ent->s.number < svs.iNumClients) {
 			assert(ent->s.number < MAX_CLIENTS);
 			client->lastRadarTime[ent->s.number] = svs.time;
@@ -1199,18 +1674,17 @@ void SV_SendMessageToClient(msg_t *msg, client_t *client)
 
 /*
 =======================
-SV_SendClientSnapshot
-
-Also called by SV_FinalMessage
+SV_SendBuiltClientSnapshot
 
+Added in OPM
 =======================
 */
-void SV_SendClientSnapshot( client_t *client ) {
+static void SV_SendBuiltClientSnapshot( snapshotBuild_t *build ) {
+	client_t	*client = build->client;
 	byte		msg_buf[MAX_MSGLEN];
 	msg_t		msg;
 
-	// build the snapshot
-	SV_BuildClientSnapshot( client );
+	SV_FinishClientSnapshot( build );
 
 	// bots need to have their snapshots build, but
 	// the query them directly without needing to be sent
@@ -1261,6 +1735,26 @@ void SV_SendClientSnapshot( client_t *client ) {
 	SV_SendMessageToClient( &msg, client );
 }
 
+/*
+=======================
+SV_SendClientSnapshot
+
+Also called by SV_FinalMessage
+
+=======================
+*/
+void SV_SendClientSnapshot( client_t *client ) {
+	static snapshotBuild_t build;
+
+	SV_PrepareSnapshots();
+
+	// build the snapshot
+	build.client = client;
+	SV_BuildClientSnapshot( &build );
+
+	SV_SendBuiltClientSnapshot( &build );
+}
+
 /*
 =======================
 SV_SendClientMessages
@@ -1270,8 +1764,14 @@ void SV_SendClientMessages(void)
 {
 	int				i;
 	int				rate;
+	int				numBuilds;
 	client_t		*c;
 
+	numBuilds = 0;
+
+	// Added in OPM
+	SV_PrepareSnapshots();
+
 	// send a message to each connected client
 	for(i=0; i < sv_maxclients->integer; i++)
 	{
@@ -1309,11 +1809,37 @@ void SV_SendClientMessages(void)
 			}
 		}
 
+		if (sv_snapshotthreads->integer > 1) {
+			// Added in OPM
+			//  built below with the other clients
+			sv_snapshotBuilds[numBuilds++].client = c;
+			continue;
+		}
+
 		// generate and send a new message
-		SV_SendClientSnapshot(c);
+		sv_snapshotBuilds[0].client = c;
+		SV_BuildClientSnapshot(&sv_snapshotBuilds[0]);
+		SV_SendBuiltClientSnapshot(&sv_snapshotBuilds[0]);
 		c->lastSnapshotTime = svs.time;
 		c->rateDelayed = qfalse;
     }
+
+	if (numBuilds) {
+		// Added in OPM
+		//  build all snapshots in parallel, then send them in order
+		//  the sector statistics are only counted on the main thread
+		SV_PauseSectorStats(qtrue);
+		Com_RunJobs(SV_BuildClientSnapshotJob, sv_snapshotBuilds, numBuilds, sv_snapshotthreads->integer);
+		SV_PauseSectorStats(qfalse);
+
+		for (i = 0; i < numBuilds; i++) {
+			c = sv_snapshotBuilds[i].client;
+
+			SV_SendBuiltClientSnapshot(&sv_snapshotBuilds[i]);
+			c->lastSnapshotTime = svs.time;
+			c->rateDelayed = qfalse;
+		}
+	}
 }
 
 qboolean SV_IsValidSnapshotClient(client_t* client) {
@@ -43,6 +43,24 @@ clipHandle_t SV_ClipHandleForEntity( const gentity_t *ent ) {
 	return CM_TempBoxModel( ent->r.mins, ent->r.maxs, ent->r.contents );
 }
 
+/*
+================
+SV_ClipHandleForEntityContext
+
+Added in OPM
+Same as SV_ClipHandleForEntity, for the traces of the context
+================
+*/
+clipHandle_t SV_ClipHandleForEntityContext( traceContext_t *ctx, const gentity_t *ent ) {
+	if ( ent->r.bmodel && ent->solid != SOLID_BBOX ) {
+		// explicit hulls in the BSP model
+		return CM_InlineModel( ent->s.modelindex );
+	}
+
+	// create a temp tree from bounding box sizes
+	return CM_TempBoxModelContext( ctx, ent->r.mins, ent->r.maxs, ent->r.contents );
+}
+
 
 
 /*
@@ -51,25 +69,50 @@ clipHandle_t SV_ClipHandleForEntity( const gentity_t *ent ) {
 ENTITY CHECKING
 
 To avoid linearly searching through lists of entities during environment testing,
-the world is carved up with an evenly spaced, axially aligned bsp tree.  Entities
-are kept in chains either at the final leafs, or at the first node that splits
-them, which prevents having to deal with multiple fragments of a single entity.
+the world is carved up with loose grids of increasing cell size.  An entity is
+kept in a single cell, the one of the finest grid that is large enough for it
+and that contains its center.  The bounds of a cell are loose, they extend by
+half a cell on each side, so the whole entity is inside them.  Entities larger
+than the world, or outside of it, are kept in a separate list.
 
 ===============================================================================
 */
 
 typedef struct worldSector_s {
-	int		axis;		// -1 = leaf node
-	float	dist;
-	struct worldSector_s	*children[2];
 	svEntity_t	*entities;
 } worldSector_t;
 
-#define	AREA_DEPTH	4
-#define	AREA_NODES	64
+#define	SECTOR_CELL_SIZE	256		// cell size of the finest grid
+#define	SECTOR_MAX_CELLS	128		// cells along an axis of the finest grid
+#define	MAX_SECTOR_LEVELS	16
 
-worldSector_t	sv_worldSectors[AREA_NODES];
-int			sv_numworldSectors;
+typedef struct {
+	float			cellSize;
+	int				width, height;
+	worldSector_t	*cells;
+} sectorLevel_t;
+
+typedef struct {
+	vec2_t			mins;
+	int				numLevels;
+	sectorLevel_t	levels[MAX_SECTOR_LEVELS];
+	worldSector_t	*sectors;
+	int				numSectors;
+	worldSector_t	outside;		// entities that fit in no cell
+
+	// statistics since the last sectorlist,
+	// only counted by the queries made on the main thread
+	int64_t			numQueries;
+	int64_t			numSectorsVisited;
+	int64_t			numEntitiesTested;
+	int				statsStartTime;
+	qboolean		statsPaused;
+} sectorGrid_t;
+
+static sectorGrid_t	sv_sectorGrid;
+
+svClusterLink_t	*sv_clusterEntities;
+int				sv_numClusterEntities;
 
 
 /*
@@ -78,61 +121,266 @@ SV_SectorList_f
 ===============
 */
 void SV_SectorList_f( void ) {
-	int				i, c;
-	worldSector_t	*sec;
+	int				i, j, c;
+	int				total, max, used;
+	sectorLevel_t	*level;
 	svEntity_t		*ent;
 
-	for ( i = 0 ; i < AREA_NODES ; i++ ) {
-		sec = &sv_worldSectors[i];
+	for ( i = 0 ; i < sv_sectorGrid.numLevels ; i++ ) {
+		level = &sv_sectorGrid.levels[i];
+
+		total = max = used = 0;
+		for ( j = 0 ; j < level->width * level->height ; j++ ) {
+			c = 0;
+			for ( ent = level->cells[j].entities ; ent ; ent = ent->nextEntityInWorldSector ) {
+				c++;
+			}
+
+			total += c;
+			if ( c ) {
+				used++;
+			}
+			if ( c > max ) {
+				max = c;
+			}
+		}
+		Com_Printf( "level %i: %ix%i cells of %i, %i entities in %i cells, at most %i in a cell\n",
+			i, level->width, level->height, (int)level->cellSize, total, used, max );
+	}
+
+	c = 0;
+	for ( ent = sv_sectorGrid.outside.entities ; ent ; ent = ent->nextEntityInWorldSector ) {
+		c++;
+	}
+	Com_Printf( "outside: %i entities\n", c );
+
+	if ( sv_sectorGrid.numQueries ) {
+		Com_Printf( "%.0f queries in %.1f seconds, %.1f sectors visited and %.1f entities tested per query\n",
+			(double)sv_sectorGrid.numQueries,
+			( Sys_Milliseconds() - sv_sectorGrid.statsStartTime ) / 1000.0,
+			(double)sv_sectorGrid.numSectorsVisited / sv_sectorGrid.numQueries,
+			(double)sv_sectorGrid.numEntitiesTested / sv_sectorGrid.numQueries );
+	}
+
+	// start a new period
+	sv_sectorGrid.numQueries = 0;
+	sv_sectorGrid.numSectorsVisited = 0;
+	sv_sectorGrid.numEntitiesTested = 0;
+	sv_sectorGrid.statsStartTime = Sys_Milliseconds();
+}
+
+/*
+===============
+SV_PauseSectorStats
+
+Added in OPM
+Stops counting the queries while other threads may make some,
+like while the snapshots are built in parallel
+===============
+*/
+void SV_PauseSectorStats( qboolean pause ) {
+	sv_sectorGrid.statsPaused = pause;
+}
+
+/*
+===============
+SV_CreateWorldSectors
+
+Added in OPM
+Builds the grids for the given world size
+===============
+*/
+static void SV_CreateWorldSectors( const vec3_t mins, const vec3_t maxs ) {
+	sectorLevel_t	*level;
+	float			cellSize;
+	float			size;
+	int				numSectors;
+	int				i;
+
+	if ( sv_sectorGrid.sectors ) {
+		Z_Free( sv_sectorGrid.sectors );
+	}
+	Com_Memset( &sv_sectorGrid, 0, sizeof( sv_sectorGrid ) );
+	sv_sectorGrid.statsStartTime = Sys_Milliseconds();
+
+	sv_sectorGrid.mins[0] = mins[0];
+	sv_sectorGrid.mins[1] = mins[1];
+	size = Q_max( maxs[0] - mins[0], maxs[1] - mins[1] );
+
+	cellSize = SECTOR_CELL_SIZE;
+	while ( cellSize * SECTOR_MAX_CELLS < size ) {
+		cellSize *= 2;
+	}
+
+	// up to a single cell covering the whole world
+	numSectors = 0;
+	for ( i = 0 ; i < MAX_SECTOR_LEVELS ; i++ ) {
+		level = &sv_sectorGrid.levels[i];
+		level->cellSize = cellSize;
+		level->width = Q_max( 1, (int)ceil( ( maxs[0] - mins[0] ) / cellSize ) );
+		level->height = Q_max( 1, (int)ceil( ( maxs[1] - mins[1] ) / cellSize ) );
+		numSectors += level->width * level->height;
+		sv_sectorGrid.numLevels++;
+
+		if ( cellSize >= size ) {
+			break;
+		}
+		cellSize *= 2;
+	}
+
+	sv_sectorGrid.sectors = Z_Malloc( sizeof( worldSector_t ) * numSectors );
+	sv_sectorGrid.numSectors = numSectors;
+
+	numSectors = 0;
+	for ( i = 0 ; i < sv_sectorGrid.numLevels ; i++ ) {
+		level = &sv_sectorGrid.levels[i];
+		level->cells = &sv_sectorGrid.sectors[numSectors];
+		numSectors += level->width * level->height;
+	}
+}
+
+/*
+===============
+SV_SectorForBounds
+
+Added in OPM
+Returns the sector an entity with the given bounds is kept in
+===============
+*/
+static worldSector_t *SV_SectorForBounds( const vec3_t absmin, const vec3_t absmax ) {
+	sectorLevel_t	*level;
+	float			size;
+	int				x, y;
+	int				i;
+
+	size = Q_max( absmax[0] - absmin[0], absmax[1] - absmin[1] );
 
-		c = 0;
-		for ( ent = sec->entities ; ent ; ent = ent->nextEntityInWorldSector ) {
-			c++;
+	for ( i = 0 ; i < sv_sectorGrid.numLevels ; i++ ) {
+		level = &sv_sectorGrid.levels[i];
+		if ( size > level->cellSize ) {
+			continue;
 		}
-		Com_Printf( "sector %i: %i entities\n", i, c );
+
+		x = (int)floor( ( ( absmin[0] + absmax[0] ) * 0.5 - sv_sectorGrid.mins[0] ) / level->cellSize );
+		y = (int)floor( ( ( absmin[1] + absmax[1] ) * 0.5 - sv_sectorGrid.mins[1] ) / level->cellSize );
+		if ( x < 0 || x >= level->width || y < 0 || y >= level->height ) {
+			break;
+		}
+
+		return &level->cells[y * level->width + x];
 	}
+
+	return &sv_sectorGrid.outside;
 }
 
 /*
 ===============
-SV_CreateworldSector
+SV_UnlinkSector
 
-Builds a uniformly subdivided tree for the given world size
+Added in OPM
 ===============
 */
-static worldSector_t *SV_CreateworldSector( int depth, vec3_t mins, vec3_t maxs ) {
-	worldSector_t	*anode;
-	vec3_t		size;
-	vec3_t		mins1, maxs1, mins2, maxs2;
-
-	anode = &sv_worldSectors[sv_numworldSectors];
-	sv_numworldSectors++;
-
-	if (depth == AREA_DEPTH) {
-		anode->axis = -1;
-		anode->children[0] = anode->children[1] = NULL;
-		return anode;
-	}
-	
-	VectorSubtract (maxs, mins, size);
-	if (size[0] > size[1]) {
-		anode->axis = 0;
+static void SV_UnlinkSector( svEntity_t *ent ) {
+	if ( !ent->worldSector ) {
+		return;
+	}
+
+	if ( ent->prevEntityInWorldSector ) {
+		ent->prevEntityInWorldSector->nextEntityInWorldSector = ent->nextEntityInWorldSector;
 	} else {
-		anode->axis = 1;
+		ent->worldSector->entities = ent->nextEntityInWorldSector;
+	}
+
+	if ( ent->nextEntityInWorldSector ) {
+		ent->nextEntityInWorldSector->prevEntityInWorldSector = ent->prevEntityInWorldSector;
+	}
+
+	ent->worldSector = NULL;
+	ent->nextEntityInWorldSector = NULL;
+	ent->prevEntityInWorldSector = NULL;
+}
+
+/*
+===============
+SV_LinkSector
+
+Added in OPM
+===============
+*/
+static void SV_LinkSector( svEntity_t *ent, worldSector_t *sector ) {
+	ent->worldSector = sector;
+	ent->prevEntityInWorldSector = NULL;
+	ent->nextEntityInWorldSector = sector->entities;
+	if ( sector->entities ) {
+		sector->entities->prevEntityInWorldSector = ent;
+	}
+	sector->entities = ent;
+}
+
+/*
+===============
+SV_UnlinkClusters
+
+Added in OPM
+Removes the entity from the entity lists of the clusters
+===============
+*/
+static void SV_UnlinkClusters( svEntity_t *ent ) {
+	svClusterLink_t	*link;
+	int				i;
+
+	for ( i = 0 ; i < ent->numClusterLinks ; i++ ) {
+		link = &ent->clusterLinks[i];
+		link->prev->next = link->next;
+		link->next->prev = link->prev;
+	}
+
+	ent->numClusterLinks = 0;
+}
+
+/*
+===============
+SV_LinkClusters
+
+Added in OPM
+Adds the entity to the entity lists of its clusters
+===============
+*/
+static void SV_LinkClusters( svEntity_t *ent ) {
+	svClusterLink_t	*head;
+	svClusterLink_t	*link;
+	int				cluster;
+	int				i, j;
+
+	if ( ent->lastCluster ) {
+		// too many clusters, always checked by snapshots
+		return;
 	}
 
-	anode->dist = 0.5 * (maxs[anode->axis] + mins[anode->axis]);
-	VectorCopy (mins, mins1);	
-	VectorCopy (mins, mins2);	
-	VectorCopy (maxs, maxs1);	
-	VectorCopy (maxs, maxs2);	
-	
-	maxs1[anode->axis] = mins2[anode->axis] = anode->dist;
-	
-	anode->children[0] = SV_CreateworldSector (depth+1, mins2, maxs2);
-	anode->children[1] = SV_CreateworldSector (depth+1, mins1, maxs1);
+	for ( i = 0 ; i < ent->numClusters ; i++ ) {
+		cluster = ent->clusternums[i];
+		if ( cluster < 0 || cluster >= sv_numClusterEntities ) {
+			continue;
+		}
+
+		// multiple leafs can be in the same cluster
+		for ( j = 0 ; j < i ; j++ ) {
+			if ( ent->clusternums[j] == cluster ) {
+				break;
+			}
+		}
+		if ( j != i ) {
+			continue;
+		}
 
-	return anode;
+		head = &sv_clusterEntities[cluster];
+		link = &ent->clusterLinks[ent->numClusterLinks++];
+		link->entityNum = ent - sv.svEntities;
+		link->prev = head;
+		link->next = head->next;
+		head->next->prev = link;
+		head->next = link;
+	}
 }
 
 /*
@@ -148,13 +396,39 @@ void SV_ClearWorld( void ) {
 	int				num;
 	char			name[ 16 ];
 
-	Com_Memset( sv_worldSectors, 0, sizeof(sv_worldSectors) );
-	sv_numworldSectors = 0;
+	// Added in OPM
+	//  create the entity lists of the clusters,
+	//  and put back the entities that are already in
+	if ( sv_clusterEntities ) {
+		Z_Free( sv_clusterEntities );
+	}
+
+	sv_numClusterEntities = CM_NumClusters();
+	sv_clusterEntities = Z_Malloc( sizeof( svClusterLink_t ) * ( sv_numClusterEntities + 1 ) );
+	for ( i = 0 ; i < sv_numClusterEntities ; i++ ) {
+		sv_clusterEntities[i].prev = sv_clusterEntities[i].next = &sv_clusterEntities[i];
+		sv_clusterEntities[i].entityNum = -1;
+	}
+
+	for ( i = 0 ; i < MAX_GENTITIES ; i++ ) {
+		if ( sv.svEntities[i].numClusterLinks ) {
+			sv.svEntities[i].numClusterLinks = 0;
+			SV_LinkClusters( &sv.svEntities[i] );
+		}
+	}
 
 	// get world map bounds
 	h = CM_InlineModel( 0 );
 	CM_ModelBounds( h, mins, maxs );
-	SV_CreateworldSector( 0, mins, maxs );
+	SV_CreateWorldSectors( mins, maxs );
+
+	// Added in OPM
+	//  the previous sectors are gone
+	for ( i = 0 ; i < MAX_GENTITIES ; i++ ) {
+		sv.svEntities[i].worldSector = NULL;
+		sv.svEntities[i].nextEntityInWorldSector = NULL;
+		sv.svEntities[i].prevEntityInWorldSector = NULL;
+	}
 
 	// set inline models
 	num = CM_NumInlineModels();
@@ -174,32 +448,15 @@ SV_UnlinkEntity
 */
 void SV_UnlinkEntity( gentity_t *gEnt ) {
 	svEntity_t		*ent;
-	svEntity_t		*scan;
-	worldSector_t	*ws;
 
 	ent = SV_SvEntityForGentity( gEnt );
 
 	gEnt->r.linked = qfalse;
 
-	ws = ent->worldSector;
-	if ( !ws ) {
-		return;		// not linked in anywhere
-	}
-	ent->worldSector = NULL;
+	// Added in OPM
+	SV_UnlinkClusters( ent );
 
-	if ( ws->entities == ent ) {
-		ws->entities = ent->nextEntityInWorldSector;
-		return;
-	}
-
-	for ( scan = ws->entities ; scan ; scan = scan->nextEntityInWorldSector ) {
-		if ( scan->nextEntityInWorldSector == ent ) {
-			scan->nextEntityInWorldSector = ent->nextEntityInWorldSector;
-			return;
-		}
-	}
-
-	Com_Printf( "WARNING: SV_UnlinkEntity: not found in worldSector\n" );
+	SV_UnlinkSector( ent );
 }
 
 
@@ -211,7 +468,7 @@ SV_LinkEntity
 */
 #define MAX_TOTAL_ENT_LEAFS		128
 void SV_LinkEntity( gentity_t *gEnt ) {
-	worldSector_t	*node;
+	worldSector_t	*sector;
 	int			leafs[MAX_TOTAL_ENT_LEAFS];
 	int			cluster;
 	int			num_leafs;
@@ -223,9 +480,11 @@ void SV_LinkEntity( gentity_t *gEnt ) {
 
 	ent = SV_SvEntityForGentity( gEnt );
 
-	if ( ent->worldSector ) {
-		SV_UnlinkEntity( gEnt );	// unlink from old position
-	}
+	// Added in OPM
+	//  the entity stays in its world sector if it's still the right one,
+	//  it may also be in clusters without being in a world sector
+	gEnt->r.linked = qfalse;
+	SV_UnlinkClusters( ent );
 
 	switch( gEnt->solid )
 	{
@@ -298,6 +557,7 @@ void SV_LinkEntity( gentity_t *gEnt ) {
 	// if none of the leafs were inside the map, the
 	// entity is outside the world and can be considered unlinked
 	if ( !num_leafs ) {
+		SV_UnlinkSector( ent );
 		return;
 	}
 
@@ -340,26 +600,19 @@ void SV_LinkEntity( gentity_t *gEnt ) {
 		ent->lastCluster = CM_LeafCluster( lastLeaf );
 	}
 
+	// Added in OPM
+	SV_LinkClusters( ent );
+
 	gEnt->r.linkcount++;
 
-	// find the first world sector node that the ent's box crosses
-	node = sv_worldSectors;
-	while (1)
-	{
-		if (node->axis == -1)
-			break;
-		if( gEnt->r.absmin[ node->axis ] > node->dist )
-			node = node->children[0];
-		else if( gEnt->r.absmax[ node->axis ] < node->dist )
-			node = node->children[1];
-		else
-			break;		// crosses the node
-	}
-	
+	// find the world sector the entity fits in
+	sector = SV_SectorForBounds( gEnt->r.absmin, gEnt->r.absmax );
+
 	// link it in
-	ent->worldSector = node;
-	ent->nextEntityInWorldSector = node->entities;
-	node->entities = ent;
+	if ( sector != ent->worldSector ) {
+		SV_UnlinkSector( ent );
+		SV_LinkSector( ent, sector );
+	}
 
 	gEnt->r.linked = qtrue;
 }
@@ -379,79 +632,98 @@ typedef struct {
 	const float	*maxs;
 	int			*list;
 	int			count, maxcount;
+	int			numSectorsVisited;
+	int			numEntitiesTested;
 } areaParms_t;
 
 
 /*
 ====================
-SV_AreaEntities_r
+SV_AreaEntitiesInSector
 
+Returns qfalse if the list is full
 ====================
 */
-static void SV_AreaEntities_r( worldSector_t *node, areaParms_t *ap ) {
-	svEntity_t	*check, *next;
-	gentity_t		*gcheck;
-	worldSector_t	*nodestack[ 8 ];
-	int				iStackPos;
+static qboolean SV_AreaEntitiesInSector( worldSector_t *sector, areaParms_t *ap ) {
+	svEntity_t	*check;
+	gentity_t	*gcheck;
 
-	iStackPos = 0;
+	ap->numSectorsVisited++;
 
-	while( 1 )
-	{
-		while( 1 )
-		{
-			for( check = node->entities; check; check = next ) {
-				next = check->nextEntityInWorldSector;
-
-				gcheck = SV_GEntityForSvEntity( check );
-
-				if( gcheck->r.absmin[ 0 ] > ap->maxs[ 0 ]
-					|| gcheck->r.absmin[ 1 ] > ap->maxs[ 1 ]
-					|| gcheck->r.absmin[ 2 ] > ap->maxs[ 2 ]
-					|| gcheck->r.absmax[ 0 ] < ap->mins[ 0 ]
-					|| gcheck->r.absmax[ 1 ] < ap->mins[ 1 ]
-					|| gcheck->r.absmax[ 2 ] < ap->mins[ 2 ] ) {
-					continue;
-				}
+	for( check = sector->entities; check; check = check->nextEntityInWorldSector ) {
+		gcheck = SV_GEntityForSvEntity( check );
 
-				if( ap->count == ap->maxcount ) {
-					Com_Printf( "SV_AreaEntities: MAXCOUNT\n" );
-					return;
-				}
+		ap->numEntitiesTested++;
 
-				ap->list[ ap->count ] = check - sv.svEntities;
-				ap->count++;
-			}
+		if( gcheck->r.absmin[ 0 ] > ap->maxs[ 0 ]
+			|| gcheck->r.absmin[ 1 ] > ap->maxs[ 1 ]
+			|| gcheck->r.absmin[ 2 ] > ap->maxs[ 2 ]
+			|| gcheck->r.absmax[ 0 ] < ap->mins[ 0 ]
+			|| gcheck->r.absmax[ 1 ] < ap->mins[ 1 ]
+			|| gcheck->r.absmax[ 2 ] < ap->mins[ 2 ] ) {
+			continue;
+		}
 
-			if( node->axis == -1 ) {
-				break;		// terminal node
-			}
+		if( ap->count == ap->maxcount ) {
+			Com_Printf( "SV_AreaEntities: MAXCOUNT\n" );
+			return qfalse;
+		}
 
-			// recurse down both sides
-			if( ap->maxs[ node->axis ] > node->dist ) {
-				nodestack[ iStackPos++ ] = node->children[ 0 ];
-			}
+		ap->list[ ap->count ] = check - sv.svEntities;
+		ap->count++;
+	}
 
-			if( ap->mins[ node->axis ] < node->dist ) {
-				node = node->children[ 1 ];
-			} else {
-				break;
-			}
-		}
+	return qtrue;
+}
 
-		if( !iStackPos ) {
-			return;
-		}
+/*
+================
+SV_AreaEntitiesInGrid
 
-		iStackPos--;
+Added in OPM
+Goes through the cells of each grid whose loose bounds touch the given bounds
+================
+*/
+static void SV_AreaEntitiesInGrid( areaParms_t *ap ) {
+	sectorLevel_t	*level;
+	int				x0, x1, y0, y1;
+	int				x, y;
+	int				i;
 
-		node = nodestack[ iStackPos ];
+	if ( !SV_AreaEntitiesInSector( &sv_sectorGrid.outside, ap ) ) {
+		return;
+	}
+
+	for ( i = sv_sectorGrid.numLevels - 1 ; i >= 0 ; i-- ) {
+		level = &sv_sectorGrid.levels[i];
+
+		// the cells extend by half a cell on each side
+		x0 = (int)ceil( ( ap->mins[0] - sv_sectorGrid.mins[0] ) / level->cellSize - 1.5 );
+		x1 = (int)floor( ( ap->maxs[0] - sv_sectorGrid.mins[0] ) / level->cellSize + 0.5 );
+		y0 = (int)ceil( ( ap->mins[1] - sv_sectorGrid.mins[1] ) / level->cellSize - 1.5 );
+		y1 = (int)floor( ( ap->maxs[1] - sv_sectorGrid.mins[1] ) / level->cellSize + 0.5 );
+
+		x0 = Q_max( x0, 0 );
+		y0 = Q_max( y0, 0 );
+		x1 = Q_min( x1, level->width - 1 );
+		y1 = Q_min( y1, level->height - 1 );
+
+		for ( y = y0 ; y <= y1 ; y++ ) {
+			for ( x = x0 ; x <= x1 ; x++ ) {
+				if ( !SV_AreaEntitiesInSector( &level->cells[y * level->width + x], ap ) ) {
+					return;
+				}
+			}
+		}
 	}
 }
 
 /*
 ================
 SV_AreaEntities
+
+The statistics are counted by the query and only added while they
+aren't paused, so queries made on other threads don't touch them
 ================
 */
 int SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int *entityList, int maxcount ) {
@@ -462,8 +734,16 @@ int SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int *entityList, int
 	ap.list = entityList;
 	ap.count = 0;
 	ap.maxcount = maxcount;
+	ap.numSectorsVisited = 0;
+	ap.numEntitiesTested = 0;
+
+	SV_AreaEntitiesInGrid( &ap );
 
-	SV_AreaEntities_r( sv_worldSectors, &ap );
+	if ( !sv_sectorGrid.statsPaused ) {
+		sv_sectorGrid.numQueries++;
+		sv_sectorGrid.numSectorsVisited += ap.numSectorsVisited;
+		sv_sectorGrid.numEntitiesTested += ap.numEntitiesTested;
+	}
 
 	return ap.count;
 }
@@ -790,20 +1070,19 @@ qboolean SV_HitEntity(gentity_t* pEnt, gentity_t* pOther)
 
 /*
 ==================
-SV_Trace
+SV_ClipTraceToEntities
 
-Moves the given mins/maxs volume through the world from start to end.
-passEntityNum and entities owned by passEntityNum are explicitly not checked.
+Added in OPM
+Clips the trace through the world to the solid entities
 ==================
 */
-void SV_Trace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, qboolean cylinder, qboolean traceDeep ) {
+static void SV_ClipTraceToEntities( trace_t *results, const trace_t *worldTrace, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, qboolean cylinder, qboolean traceDeep ) {
 	moveclip_t	clip;
 	int			i;
 
 	Com_Memset ( &clip, 0, sizeof ( moveclip_t ) );
 
-	// clip to world
-	CM_BoxTrace( &clip.trace, start, end, mins, maxs, 0, contentmask, cylinder );
+	clip.trace = *worldTrace;
 	clip.trace.entityNum = clip.trace.fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
 	if ( clip.trace.fraction == 0 ) {
 		*results = clip.trace;
@@ -840,6 +1119,43 @@ void SV_Trace( trace_t *results, const vec3_t start, const vec3_t mins, const ve
 	*results = clip.trace;
 }
 
+/*
+==================
+SV_Trace
+
+Moves the given mins/maxs volume through the world from start to end.
+passEntityNum and entities owned by passEntityNum are explicitly not checked.
+==================
+*/
+void SV_Trace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, qboolean cylinder, qboolean traceDeep ) {
+	trace_t		trace;
+
+	// clip to world
+	CM_BoxTrace( &trace, start, end, mins, maxs, 0, contentmask, cylinder );
+
+	SV_ClipTraceToEntities( results, &trace, start, mins, maxs, end, passEntityNum, contentmask, cylinder, traceDeep );
+}
+
+/*
+==================
+SV_TraceBatch
+
+Added in OPM
+Same as calling SV_Trace for each pair of start and end points,
+the traces through the world are done together
+==================
+*/
+void SV_TraceBatch( trace_t *results, const vec3_t *starts, const vec3_t mins, const vec3_t maxs, const vec3_t *ends, int count, int passEntityNum, int contentmask, qboolean cylinder, qboolean traceDeep ) {
+	int			i;
+
+	// clip to world
+	CM_BoxTraceBatch( results, starts, ends, count, mins, maxs, contentmask, cylinder );
+
+	for ( i = 0 ; i < count ; i++ ) {
+		SV_ClipTraceToEntities( &results[i], &results[i], starts[i], mins, maxs, ends[i], passEntityNum, contentmask, cylinder, traceDeep );
+	}
+}
+
 /*
 =============
 SV_GetShaderPointer
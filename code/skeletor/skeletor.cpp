@@ -1065,27 +1065,11 @@ int skeletor_c::GetMorphWeightFrame(int index, float time, int *data)
 
 float DecodeFrameValue(skanChannelHdr *channelFrames, int desiredFrameNum)
 {
-    skanGameFrame *foundFrame;
-    size_t         frameSize;
-    int            i;
+    size_t frameSize;
 
     frameSize = (sizeof(skanGameFrame) - sizeof(skanGameFrame::pChannelData) + sizeof(float));
 
-    foundFrame = channelFrames->ary_frames;
-
-    for (i = 0; i < channelFrames->nFramesInChannel; i++) {
-        if (foundFrame->nFrameNum >= desiredFrameNum) {
-            break;
-        }
-
-        foundFrame = (skanGameFrame *)((byte *)foundFrame + frameSize);
-    }
-
-    if (foundFrame->nFrameNum > desiredFrameNum) {
-        foundFrame = (skanGameFrame *)((byte *)channelFrames->ary_frames + foundFrame->nPrevFrameIndex * frameSize);
-    }
-
-    return foundFrame->pChannelData[0];
+    return FindRLEFrame(channelFrames, frameSize, desiredFrameNum)->pChannelData[0];
 }
 
 int skeletor_c::GetMorphWeightFrame(int *data)
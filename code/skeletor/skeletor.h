@@ -243,6 +243,8 @@ extern "C" {
 
     void SkeletorLoadBoneFromBuffer(skelChannelList_c *boneList, boneData_t *boneData, skelBone_Base **bone);
     void SkeletorLoadBonesFromBuffer(skelChannelList_c *boneList, skelHeaderGame_t *buffer, skelBone_Base **bone);
+    // Added in OPM
+    void SkeletorRLECheck_f(void);
 
 #ifdef __cplusplus
 }
@@ -77,6 +77,9 @@ typedef struct skelAnimDataGameHeader_s skelAnimDataGameHeader_t;
 
 #ifdef __cplusplus
 
+// Added in OPM
+skanGameFrame *FindRLEFrame(skanChannelHdr *channelFrames, size_t frameSize, int desiredFrameNum);
+
 typedef struct skelAnimDataGameHeader_s {
     int                  flags;
     size_t               nBytesUsed;
@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "q_shared.h"
 #include "qcommon.h"
 #include "skeletor.h"
+#include <tiki.h>
 
 char            *skelBone_Names[8];
 ChannelNameTable skeletor_c::m_channelNames;
@@ -163,38 +164,62 @@ void SkeletorLoadBonesFromBuffer(skelChannelList_c *boneList, skelHeaderGame_t *
     }
 }
 
-float *DecodeRLEPosValue(skanChannelHdr *channelFrames, int desiredFrameNum)
+/*
+===============
+FindRLEFrame
+
+Added in OPM
+Returns the stored frame to use for the desired frame number.
+Stored frames are sorted by frame number, so they can be
+binary searched instead of being scanned from the first one
+===============
+*/
+skanGameFrame *FindRLEFrame(skanChannelHdr *channelFrames, size_t frameSize, int desiredFrameNum)
 {
-    skanGameFrame *foundFrame = channelFrames->ary_frames;
-    size_t         frameSize;
-    int            i;
+    skanGameFrame *foundFrame;
+    int            low, high, mid;
 
-    frameSize = (sizeof(skanGameFrame) - sizeof(skanGameFrame::pChannelData) + sizeof(vec3_t));
+    // find the first frame at or after the desired frame
+    low  = 0;
+    high = channelFrames->nFramesInChannel - 1;
 
-    for (i = 0; i < channelFrames->nFramesInChannel; i++) {
-        if (foundFrame->nFrameNum >= desiredFrameNum) {
-            break;
-        }
+    while (low < high) {
+        mid        = (low + high) >> 1;
+        foundFrame = (skanGameFrame *)((byte *)channelFrames->ary_frames + mid * frameSize);
 
-        foundFrame = (skanGameFrame *)((byte *)foundFrame + frameSize);
+        if (foundFrame->nFrameNum < desiredFrameNum) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
     }
 
+    foundFrame = (skanGameFrame *)((byte *)channelFrames->ary_frames + low * frameSize);
+
     if (foundFrame->nFrameNum > desiredFrameNum) {
         foundFrame = (skanGameFrame *)((byte *)channelFrames->ary_frames + foundFrame->nPrevFrameIndex * frameSize);
     }
 
-    return foundFrame->pChannelData;
+    return foundFrame;
 }
 
-float *DecodeRLERotValue(skanChannelHdr *channelFrames, int desiredFrameNum)
+/*
+===============
+FindRLEFrameLinear
+
+Added in OPM
+The original scan from the first stored frame, kept as a reference
+for SkeletorRLECheck_f. It stops at the last stored frame.
+===============
+*/
+static skanGameFrame *FindRLEFrameLinear(skanChannelHdr *channelFrames, size_t frameSize, int desiredFrameNum)
 {
-    skanGameFrame *foundFrame = channelFrames->ary_frames;
-    size_t         frameSize;
+    skanGameFrame *foundFrame;
     int            i;
 
-    frameSize = (sizeof(skanGameFrame) - sizeof(skanGameFrame::pChannelData) + sizeof(vec4_t));
+    foundFrame = channelFrames->ary_frames;
 
-    for (i = 0; i < channelFrames->nFramesInChannel; i++) {
+    for (i = 0; i < channelFrames->nFramesInChannel - 1; i++) {
         if (foundFrame->nFrameNum >= desiredFrameNum) {
             break;
         }
@@ -206,198 +231,553 @@ float *DecodeRLERotValue(skanChannelHdr *channelFrames, int desiredFrameNum)
         foundFrame = (skanGameFrame *)((byte *)channelFrames->ary_frames + foundFrame->nPrevFrameIndex * frameSize);
     }
 
-    return foundFrame->pChannelData;
+    return foundFrame;
 }
 
-SkelQuat skelAnimStoreFrameList_c::GetSlerpValue(int globalChannelNum) const
+/*
+===============
+SkeletorRLECheckAnim
+
+Added in OPM
+Loads a skeletal animation and checks that FindRLEFrame returns the same
+frame as the linear scan for every frame of every channel
+===============
+*/
+static void SkeletorRLECheckAnim(const char *path)
+{
+    skelAnimDataGameHeader_t *data;
+    skanChannelHdr           *channel;
+    size_t                    frameSize;
+    int                       numChecked;
+    int                       numLookups;
+    int                       numMismatches;
+    int                       i, k;
+
+    data = SkeletorCacheFileCallback(path);
+    if (!data) {
+        Com_Printf("%s: couldn't load the animation\n", path);
+        return;
+    }
+
+    numChecked    = 0;
+    numLookups    = 0;
+    numMismatches = 0;
+
+    for (i = 0; i < data->nTotalChannels; i++) {
+        channel = &data->ary_channels[i];
+
+        switch (GetBoneChannelType(data->channelList.ChannelName(skeletor_c::ChannelNames(), i))) {
+        case CHANNEL_ROTATION:
+            frameSize = (sizeof(skanGameFrame) - sizeof(skanGameFrame::pChannelData) + sizeof(vec4_t));
+            break;
+        case CHANNEL_POSITION:
+            frameSize = (sizeof(skanGameFrame) - sizeof(skanGameFrame::pChannelData) + sizeof(vec3_t));
+            break;
+        default:
+            continue;
+        }
+
+        if (channel->nFramesInChannel <= 0) {
+            continue;
+        }
+
+        for (k = 0; k < data->numFrames; k++) {
+            if (FindRLEFrame(channel, frameSize, k) != FindRLEFrameLinear(channel, frameSize, k)) {
+                numMismatches++;
+            }
+            numLookups++;
+        }
+
+        numChecked++;
+    }
+
+    Com_Printf(
+        "%s: %d frames, %d of %d channels, %d lookups: %d mismatches\n",
+        path,
+        data->numFrames,
+        numChecked,
+        data->nTotalChannels,
+        numLookups,
+        numMismatches
+    );
+
+    skelAnimDataGameHeader_s::DeallocAnimData(data);
+}
+
+/*
+===============
+SkeletorRLECheck_f
+
+Added in OPM
+skelrlecheck [channels]
+skelrlecheck <animation.skc> [...]
+
+Builds random run-length compressed channels laid out like the loaded ones,
+and checks that FindRLEFrame returns the same frame as the linear scan
+for every frame number. Also times both lookups.
+When given animation files, checks their channels instead
+===============
+*/
+void SkeletorRLECheck_f(void)
+{
+    skanChannelHdr channel;
+    skanGameFrame *frame;
+    size_t         frameSize;
+    unsigned int   seed;
+    int            numChannels;
+    int            numLookups;
+    int            numMismatches;
+    int            maxFrames;
+    int            frameNum;
+    int            lastFrameNum;
+    int            startTime;
+    int            linearTime;
+    int            binaryTime;
+    int            i, j, k;
+    size_t         sum;
+
+    numChannels = 2000;
+    if (Cmd_Argc() > 1) {
+        if (!Q_isanumber(Cmd_Argv(1))) {
+            for (i = 1; i < Cmd_Argc(); i++) {
+                SkeletorRLECheckAnim(Cmd_Argv(i));
+            }
+            return;
+        }
+
+        numChannels = atoi(Cmd_Argv(1));
+    }
+
+    if (numChannels <= 0) {
+        Com_Printf("Usage: skelrlecheck [channels] or skelrlecheck <animation.skc> [...]\n");
+        return;
+    }
+
+    maxFrames = 300;
+    frameSize = (sizeof(skanGameFrame) - sizeof(skanGameFrame::pChannelData) + sizeof(vec4_t));
+
+    channel.ary_frames = (skanGameFrame *)Z_Malloc(maxFrames * frameSize);
+
+    // fixed seed so runs can be compared
+    seed          = 1;
+    numLookups    = 0;
+    numMismatches = 0;
+    linearTime    = 0;
+    binaryTime    = 0;
+    sum           = 0;
+
+    for (i = 0; i < numChannels; i++) {
+        seed                     = seed * 1103515245 + 12345;
+        channel.nFramesInChannel = 1 + (seed >> 16) % maxFrames;
+
+        // frames are stored in ascending order, skipping the ones
+        // that compressed into the previous frame
+        frameNum = 0;
+        for (j = 0; j < channel.nFramesInChannel; j++) {
+            frame                  = (skanGameFrame *)((byte *)channel.ary_frames + j * frameSize);
+            frame->nFrameNum       = frameNum;
+            frame->nPrevFrameIndex = j > 0 ? j - 1 : 0;
+
+            seed = seed * 1103515245 + 12345;
+            frameNum += 1 + (seed >> 16) % 4;
+        }
+
+        lastFrameNum = frameNum;
+
+        for (k = 0; k <= lastFrameNum; k++) {
+            if (FindRLEFrame(&channel, frameSize, k) != FindRLEFrameLinear(&channel, frameSize, k)) {
+                numMismatches++;
+            }
+            numLookups++;
+        }
+
+        startTime = Sys_Milliseconds();
+        for (j = 0; j < 10; j++) {
+            for (k = 0; k <= lastFrameNum; k++) {
+                sum += (size_t)FindRLEFrameLinear(&channel, frameSize, k);
+            }
+        }
+        linearTime += Sys_Milliseconds() - startTime;
+
+        startTime = Sys_Milliseconds();
+        for (j = 0; j < 10; j++) {
+            for (k = 0; k <= lastFrameNum; k++) {
+                sum += (size_t)FindRLEFrame(&channel, frameSize, k);
+            }
+        }
+        binaryTime += Sys_Milliseconds() - startTime;
+    }
+
+    Z_Free(channel.ary_frames);
+
+    Com_Printf(
+        "%d channels, %d lookups: %d mismatches\n"
+        "linear scan %d ms, binary search %d ms for %d timed lookups (%u)\n",
+        numChannels,
+        numLookups,
+        numMismatches,
+        linearTime,
+        binaryTime,
+        numLookups * 10,
+        (unsigned int)(sum & 0xff)
+    );
+}
+
+float *DecodeRLEPosValue(skanChannelHdr *channelFrames, int desiredFrameNum)
+{
+    size_t frameSize;
+
+    frameSize = (sizeof(skanGameFrame) - sizeof(skanGameFrame::pChannelData) + sizeof(vec3_t));
+
+    return FindRLEFrame(channelFrames, frameSize, desiredFrameNum)->pChannelData;
+}
+
+float *DecodeRLERotValue(skanChannelHdr *channelFrames, int desiredFrameNum)
 {
-    SkelQuat  actionQuat, movementQuat;
-    SkelQuat  outQuat;
-    float     totalWeight;
-    SkelQuat *pIncomingQuat;
-    float     incomingWeight;
-    int       localChannelNum;
-    float     channelActionWeight;
-    //float movementWeight;
+    size_t frameSize;
+
+    frameSize = (sizeof(skanGameFrame) - sizeof(skanGameFrame::pChannelData) + sizeof(vec4_t));
+
+    return FindRLEFrame(channelFrames, frameSize, desiredFrameNum)->pChannelData;
+}
+
+//
+// Added in OPM
+//  Four-wide float helpers used to blend the channels.
+//  A quaternion fills a whole register, positions leave the last lane at zero
+//
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    include <xmmintrin.h>
+
+typedef __m128 skelSimd4_t;
+
+static inline skelSimd4_t Skel4_Zero()
+{
+    return _mm_setzero_ps();
+}
+
+static inline skelSimd4_t Skel4_Set(float x, float y, float z, float w)
+{
+    return _mm_setr_ps(x, y, z, w);
+}
+
+static inline skelSimd4_t Skel4_Load(const float *v)
+{
+    return _mm_loadu_ps(v);
+}
+
+static inline void Skel4_Store(skelSimd4_t v, float *out)
+{
+    _mm_storeu_ps(out, v);
+}
+
+static inline skelSimd4_t Skel4_Scale(skelSimd4_t v, float s)
+{
+    return _mm_mul_ps(v, _mm_set1_ps(s));
+}
+
+static inline skelSimd4_t Skel4_MulAdd(skelSimd4_t a, skelSimd4_t v, float s)
+{
+    return _mm_add_ps(a, _mm_mul_ps(v, _mm_set1_ps(s)));
+}
+
+static inline float Skel4_Dot(skelSimd4_t a, skelSimd4_t b)
+{
+    __m128 m = _mm_mul_ps(a, b);
+    __m128 s = _mm_add_ps(m, _mm_movehl_ps(m, m));
+
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(s);
+}
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+
+typedef float32x4_t skelSimd4_t;
+
+static inline skelSimd4_t Skel4_Zero()
+{
+    return vdupq_n_f32(0);
+}
+
+static inline skelSimd4_t Skel4_Set(float x, float y, float z, float w)
+{
+    const float v[4] = {x, y, z, w};
+    return vld1q_f32(v);
+}
+
+static inline skelSimd4_t Skel4_Load(const float *v)
+{
+    return vld1q_f32(v);
+}
+
+static inline void Skel4_Store(skelSimd4_t v, float *out)
+{
+    vst1q_f32(out, v);
+}
+
+static inline skelSimd4_t Skel4_Scale(skelSimd4_t v, float s)
+{
+    return vmulq_n_f32(v, s);
+}
+
+static inline skelSimd4_t Skel4_MulAdd(skelSimd4_t a, skelSimd4_t v, float s)
+{
+    return vaddq_f32(a, vmulq_n_f32(v, s));
+}
+
+static inline float Skel4_Dot(skelSimd4_t a, skelSimd4_t b)
+{
+    float32x4_t m = vmulq_f32(a, b);
+    float32x2_t s = vadd_f32(vget_low_f32(m), vget_high_f32(m));
+
+    s = vpadd_f32(s, s);
+    return vget_lane_f32(s, 0);
+}
+
+#else
+
+typedef struct {
+    float v[4];
+} skelSimd4_t;
+
+static inline skelSimd4_t Skel4_Zero()
+{
+    skelSimd4_t r = {
+        {0, 0, 0, 0}
+    };
+    return r;
+}
+
+static inline skelSimd4_t Skel4_Set(float x, float y, float z, float w)
+{
+    skelSimd4_t r = {
+        {x, y, z, w}
+    };
+    return r;
+}
+
+static inline skelSimd4_t Skel4_Load(const float *v)
+{
+    return Skel4_Set(v[0], v[1], v[2], v[3]);
+}
+
+static inline void Skel4_Store(skelSimd4_t v, float *out)
+{
+    out[0] = v.v[0];
+    out[1] = v.v[1];
+    out[2] = v.v[2];
+    out[3] = v.v[3];
+}
+
+static inline skelSimd4_t Skel4_Scale(skelSimd4_t v, float s)
+{
+    return Skel4_Set(v.v[0] * s, v.v[1] * s, v.v[2] * s, v.v[3] * s);
+}
+
+static inline skelSimd4_t Skel4_MulAdd(skelSimd4_t a, skelSimd4_t v, float s)
+{
+    return Skel4_Set(a.v[0] + v.v[0] * s, a.v[1] + v.v[1] * s, a.v[2] + v.v[2] * s, a.v[3] + v.v[3] * s);
+}
+
+static inline float Skel4_Dot(skelSimd4_t a, skelSimd4_t b)
+{
+    return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3];
+}
+
+#endif
+
+// Position channels only store 3 floats, don't read past them
+static inline skelSimd4_t Skel4_Load3(const float *v)
+{
+    return Skel4_Set(v[0], v[1], v[2], 0);
+}
+
+/*
+===============
+SkelBlendRotFrames
+
+Added in OPM
+Sums the weighted rotations of the blend frames that have the channel,
+flipping the ones that are in the opposite hemisphere.
+Returns the number of frames that were added
+===============
+*/
+static int SkelBlendRotFrames(
+    const skanBlendInfo *pFrames, int numFrames, int globalChannelNum, skelSimd4_t& outQuat, float& totalWeight
+)
+{
+    const skanBlendInfo *pFrame;
+    skelSimd4_t          incomingQuat;
+    float                incomingWeight;
+    int                  localChannelNum;
     int                  nTotal;
     int                  i;
-    const skanBlendInfo *pFrame;
-    float                t;
-
-    actionQuat.Set(0, 0, 0, 0);
-    movementQuat.Set(0, 0, 0, 0);
 
+    outQuat     = Skel4_Zero();
+    totalWeight = 0.0;
     nTotal      = 0;
+
+    for (i = 0; i < numFrames; i++) {
+        pFrame = &pFrames[i];
+
+        localChannelNum = pFrame->pAnimationData->channelList.GetLocalFromGlobal(globalChannelNum);
+        if (localChannelNum < 0) {
+            continue;
+        }
+
+        incomingWeight = pFrame->weight;
+        if (incomingWeight == 0.0) {
+            continue;
+        }
+
+        incomingQuat =
+            Skel4_Load(DecodeRLERotValue(&pFrame->pAnimationData->ary_channels[localChannelNum], pFrame->frame));
+        totalWeight += incomingWeight;
+        nTotal++;
+
+        if (Skel4_Dot(incomingQuat, outQuat) < 0.0) {
+            incomingWeight = -incomingWeight;
+        }
+
+        outQuat = Skel4_MulAdd(outQuat, incomingQuat, incomingWeight);
+    }
+
+    return nTotal;
+}
+
+/*
+===============
+SkelBlendPosFrames
+
+Added in OPM
+Sums the weighted positions of the blend frames that have the channel
+===============
+*/
+static void SkelBlendPosFrames(
+    const skanBlendInfo *pFrames, int numFrames, int globalChannelNum, skelSimd4_t& outVec, float& totalWeight
+)
+{
+    const skanBlendInfo *pFrame;
+    int                  localChannelNum;
+    int                  i;
+
+    outVec      = Skel4_Zero();
     totalWeight = 0.0;
 
-    if (actionWeight > 0.001) {
-        for (i = 0; i < numActionFrames; i++) {
-            pFrame = &m_blendInfo[i + MAX_SKEL_BLEND_MOVEMENT_FRAMES];
-
-            localChannelNum = pFrame->pAnimationData->channelList.GetLocalFromGlobal(globalChannelNum);
-            if (localChannelNum >= 0) {
-                incomingWeight = pFrame->weight;
-                if (incomingWeight == 0.0) {
-                    continue;
-                }
-                pIncomingQuat = (SkelQuat *)DecodeRLERotValue(
-                    &pFrame->pAnimationData->ary_channels[localChannelNum], pFrame->frame
-                );
-                totalWeight += incomingWeight;
-                nTotal++;
-
-                if (DotProduct4(*pIncomingQuat, actionQuat) >= 0.0) {
-                    actionQuat.x += pIncomingQuat->x * incomingWeight;
-                    actionQuat.y += pIncomingQuat->y * incomingWeight;
-                    actionQuat.z += pIncomingQuat->z * incomingWeight;
-                    actionQuat.w += pIncomingQuat->w * incomingWeight;
-                } else {
-                    actionQuat.x -= pIncomingQuat->x * incomingWeight;
-                    actionQuat.y -= pIncomingQuat->y * incomingWeight;
-                    actionQuat.z -= pIncomingQuat->z * incomingWeight;
-                    actionQuat.w -= pIncomingQuat->w * incomingWeight;
-                }
-            }
+    for (i = 0; i < numFrames; i++) {
+        pFrame = &pFrames[i];
+
+        localChannelNum = pFrame->pAnimationData->channelList.GetLocalFromGlobal(globalChannelNum);
+        if (localChannelNum < 0) {
+            continue;
         }
+
+        totalWeight += pFrame->weight;
+        outVec = Skel4_MulAdd(
+            outVec,
+            Skel4_Load3(DecodeRLEPosValue(&pFrame->pAnimationData->ary_channels[localChannelNum], pFrame->frame)),
+            pFrame->weight
+        );
+    }
+}
+
+SkelQuat skelAnimStoreFrameList_c::GetSlerpValue(int globalChannelNum) const
+{
+    skelSimd4_t actionQuat, movementQuat;
+    skelSimd4_t outQuat;
+    SkelQuat    result;
+    float       totalWeight;
+    float       channelActionWeight;
+    int         nTotal;
+    float       t;
+
+    actionQuat = Skel4_Zero();
+    nTotal     = 0;
+
+    if (actionWeight > 0.001) {
+        nTotal = SkelBlendRotFrames(
+            &m_blendInfo[MAX_SKEL_BLEND_MOVEMENT_FRAMES], numActionFrames, globalChannelNum, actionQuat, totalWeight
+        );
     }
 
     if (nTotal) {
         channelActionWeight = actionWeight;
         if (nTotal > 1) {
-            t = 1.0 / actionQuat.Length();
+            t = 1.0 / sqrt(Skel4_Dot(actionQuat, actionQuat));
         } else {
             t = 1.0 / totalWeight;
         }
 
-        actionQuat.x = actionQuat.x * t;
-        actionQuat.y = actionQuat.y * t;
-        actionQuat.z = actionQuat.z * t;
-        actionQuat.w = actionQuat.w * t;
+        actionQuat = Skel4_Scale(actionQuat, t);
     } else {
         channelActionWeight = 0.0;
     }
 
-    nTotal      = 0;
-    totalWeight = 0.0;
+    movementQuat = Skel4_Zero();
+    nTotal       = 0;
 
     if (channelActionWeight < 0.999) {
-        for (i = 0; i < numMovementFrames; i++) {
-            pFrame = &m_blendInfo[i];
-
-            localChannelNum = pFrame->pAnimationData->channelList.GetLocalFromGlobal(globalChannelNum);
-            if (localChannelNum >= 0) {
-                incomingWeight = pFrame->weight;
-                if (incomingWeight == 0.0) {
-                    continue;
-                }
-                pIncomingQuat = (SkelQuat *)DecodeRLERotValue(
-                    &pFrame->pAnimationData->ary_channels[localChannelNum], pFrame->frame
-                );
-                totalWeight += incomingWeight;
-                nTotal++;
-
-                if (DotProduct4(*pIncomingQuat, movementQuat) >= 0.0) {
-                    movementQuat.x += pIncomingQuat->x * incomingWeight;
-                    movementQuat.y += pIncomingQuat->y * incomingWeight;
-                    movementQuat.z += pIncomingQuat->z * incomingWeight;
-                    movementQuat.w += pIncomingQuat->w * incomingWeight;
-                } else {
-                    movementQuat.x -= pIncomingQuat->x * incomingWeight;
-                    movementQuat.y -= pIncomingQuat->y * incomingWeight;
-                    movementQuat.z -= pIncomingQuat->z * incomingWeight;
-                    movementQuat.w -= pIncomingQuat->w * incomingWeight;
-                }
-            }
-        }
+        nTotal = SkelBlendRotFrames(m_blendInfo, numMovementFrames, globalChannelNum, movementQuat, totalWeight);
     }
 
     if (nTotal) {
         if (nTotal > 1) {
-            t = 1.0 / movementQuat.Length();
+            t = 1.0 / sqrt(Skel4_Dot(movementQuat, movementQuat));
         } else {
             t = 1.0 / totalWeight;
         }
 
-        movementQuat.x = movementQuat.x * t;
-        movementQuat.y = movementQuat.y * t;
-        movementQuat.z = movementQuat.z * t;
-        movementQuat.w = movementQuat.w * t;
+        movementQuat = Skel4_Scale(movementQuat, t);
     } else {
-        movementQuat.w = 1.0;
+        movementQuat = Skel4_Set(0, 0, 0, 1);
     }
 
     if (channelActionWeight < 0.001) {
-        outQuat.x = movementQuat.x;
-        outQuat.y = movementQuat.y;
-        outQuat.z = movementQuat.z;
-        outQuat.w = movementQuat.w;
-        return outQuat;
+        Skel4_Store(movementQuat, result.val);
+        return result;
     } else if (channelActionWeight >= 0.999) {
-        outQuat.x = actionQuat.x;
-        outQuat.y = actionQuat.y;
-        outQuat.z = actionQuat.z;
-        outQuat.w = actionQuat.w;
-        return outQuat;
+        Skel4_Store(actionQuat, result.val);
+        return result;
     }
 
     t = 1.0 - channelActionWeight;
 
-    if (DotProduct4(actionQuat, movementQuat) >= 0.0) {
-        outQuat.x = movementQuat.x * t + actionQuat.x * channelActionWeight;
-        outQuat.y = movementQuat.y * t + actionQuat.y * channelActionWeight;
-        outQuat.z = movementQuat.z * t + actionQuat.z * channelActionWeight;
-        outQuat.w = movementQuat.w * t + actionQuat.w * channelActionWeight;
+    if (Skel4_Dot(actionQuat, movementQuat) >= 0.0) {
+        outQuat = Skel4_MulAdd(Skel4_Scale(movementQuat, t), actionQuat, channelActionWeight);
     } else {
-        outQuat.x = movementQuat.x * t - actionQuat.x * channelActionWeight;
-        outQuat.y = movementQuat.y * t - actionQuat.y * channelActionWeight;
-        outQuat.z = movementQuat.z * t - actionQuat.z * channelActionWeight;
-        outQuat.w = movementQuat.w * t - actionQuat.w * channelActionWeight;
+        outQuat = Skel4_MulAdd(Skel4_Scale(movementQuat, t), actionQuat, -channelActionWeight);
     }
 
-    t         = 1.0 / outQuat.Length();
-    outQuat.x = outQuat.x * t;
-    outQuat.y = outQuat.y * t;
-    outQuat.z = outQuat.z * t;
-    outQuat.w = outQuat.w * t;
+    t = 1.0 / sqrt(Skel4_Dot(outQuat, outQuat));
+    Skel4_Store(Skel4_Scale(outQuat, t), result.val);
 
-    return outQuat;
+    return result;
 }
 
 void skelAnimStoreFrameList_c::GetLerpValue3(int globalChannelNum, SkelVec3 *outVec) const
 {
-    float                totalWeight;
-    SkelVec3             incomingVec;
-    float                incomingWeight;
-    int                  localChannelNum;
-    vec3_t               result;
-    float                t;
-    float                channelActionWeight;
-    int                  i;
-    const skanBlendInfo *pFrame;
+    skelSimd4_t actionVec;
+    skelSimd4_t movementVec;
+    float       totalWeight;
+    float       channelActionWeight;
+    float       t;
+    vec4_t      result;
 
+    actionVec   = Skel4_Zero();
     totalWeight = 0.0;
 
     if (actionWeight > 0.001) {
-        VectorClear(result);
-
-        for (i = 0; i < numActionFrames; i++) {
-            pFrame = &m_blendInfo[i + MAX_SKEL_BLEND_MOVEMENT_FRAMES];
-
-            localChannelNum = pFrame->pAnimationData->channelList.GetLocalFromGlobal(globalChannelNum);
-            if (localChannelNum >= 0) {
-                incomingWeight = pFrame->weight;
-                incomingVec = DecodeRLEPosValue(&pFrame->pAnimationData->ary_channels[localChannelNum], pFrame->frame);
-                totalWeight += incomingWeight;
-                result[0] += incomingVec[0] * incomingWeight;
-                result[1] += incomingVec[1] * incomingWeight;
-                result[2] += incomingVec[2] * incomingWeight;
-            }
-        }
+        SkelBlendPosFrames(
+            &m_blendInfo[MAX_SKEL_BLEND_MOVEMENT_FRAMES], numActionFrames, globalChannelNum, actionVec, totalWeight
+        );
     }
 
     if (totalWeight != 0.0) {
-        t = 1.0 / totalWeight;
-        VectorScale(result, t, *outVec);
+        t         = 1.0 / totalWeight;
+        actionVec = Skel4_Scale(actionVec, t);
+        Skel4_Store(actionVec, result);
+        VectorCopy(result, *outVec);
         channelActionWeight = actionWeight;
     } else {
         VectorClear(*outVec);
@@ -408,28 +788,12 @@ void skelAnimStoreFrameList_c::GetLerpValue3(int globalChannelNum, SkelVec3 *out
         return;
     }
 
-    totalWeight = 0.0;
-    VectorClear(result);
-
-    for (i = 0; i < numMovementFrames; i++) {
-        pFrame = &m_blendInfo[i];
-
-        localChannelNum = pFrame->pAnimationData->channelList.GetLocalFromGlobal(globalChannelNum);
-        if (localChannelNum >= 0) {
-            incomingWeight = pFrame->weight;
-            incomingVec    = DecodeRLEPosValue(&pFrame->pAnimationData->ary_channels[localChannelNum], pFrame->frame);
-            totalWeight += incomingWeight;
-            result[0] += incomingVec[0] * incomingWeight;
-            result[1] += incomingVec[1] * incomingWeight;
-            result[2] += incomingVec[2] * incomingWeight;
-        }
-    }
+    SkelBlendPosFrames(m_blendInfo, numMovementFrames, globalChannelNum, movementVec, totalWeight);
 
     if (totalWeight != 0.0) {
-        t         = 1.0 / totalWeight * (1.0 - channelActionWeight);
-        outVec->x = outVec->x * channelActionWeight + result[0] * t;
-        outVec->y = outVec->y * channelActionWeight + result[1] * t;
-        outVec->z = outVec->z * channelActionWeight + result[2] * t;
+        t = 1.0 / totalWeight * (1.0 - channelActionWeight);
+        Skel4_Store(Skel4_MulAdd(Skel4_Scale(actionVec, channelActionWeight), movementVec, t), result);
+        VectorCopy(result, *outVec);
     }
 }
 